@@ -0,0 +1,54 @@
+# Convenient-OCR图形界面程序
+QT       += widgets
+
+# 应用程序信息
+TARGET = ConvenientOCRApplication
+VERSION = 1.0.0
+
+include(ocrcore.pri)
+
+# 编译器配置
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+# 源文件
+SOURCES += \
+    main.cpp \
+    mainwindow.cpp \
+    startupprofiler.cpp \
+    screencapture.cpp \
+    licensedialog.cpp
+
+# 头文件
+HEADERS += \
+    mainwindow.h \
+    startupprofiler.h \
+    screencapture.h \
+    licensedialog.h
+
+# UI文件
+FORMS += \
+    mainwindow.ui \
+    licensedialog.ui
+
+# 资源文件（如果有图标等）
+# RESOURCES += resources.qrc
+
+# Windows特定配置
+win32 {
+    # Windows应用程序图标
+    # RC_ICONS = icon.ico
+
+    # 版本信息
+    VERSION_PE_HEADER = $$VERSION
+    QMAKE_TARGET_COMPANY = "Convenient-OCR Application"
+    QMAKE_TARGET_PRODUCT = "Convenient-OCR Intelligent Text Recognition Tool"
+    QMAKE_TARGET_DESCRIPTION = "Convenient-OCR智能文字识别工具"
+    QMAKE_TARGET_COPYRIGHT = "Copyright (C) 2024"
+}
+
+# 部署配置
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
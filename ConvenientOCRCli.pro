@@ -0,0 +1,39 @@
+# Convenient-OCR命令行批量识别工具
+QT       -= widgets
+
+CONFIG += console
+CONFIG -= app_bundle
+
+# 应用程序信息
+TARGET = ConvenientOCRCli
+VERSION = 1.0.0
+
+include(ocrcore.pri)
+
+# 源文件
+SOURCES += \
+    climain.cpp \
+    batchrunner.cpp \
+    persistentjobqueue.cpp \
+    hotfolderprocessor.cpp
+
+# 头文件
+HEADERS += \
+    batchrunner.h \
+    persistentjobqueue.h \
+    hotfolderprocessor.h
+
+# Windows特定配置
+win32 {
+    # 版本信息
+    VERSION_PE_HEADER = $$VERSION
+    QMAKE_TARGET_COMPANY = "Convenient-OCR Application"
+    QMAKE_TARGET_PRODUCT = "Convenient-OCR Command Line Tool"
+    QMAKE_TARGET_DESCRIPTION = "Convenient-OCR命令行批量识别工具"
+    QMAKE_TARGET_COPYRIGHT = "Copyright (C) 2024"
+}
+
+# 部署配置
+qnx: target.path = /tmp/ConvenientOCRApplication/bin
+else: unix:!android: target.path = /opt/ConvenientOCRApplication/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,452 @@
+#include "batchrunner.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent>
+#include <algorithm>
+
+/**
+ * @brief BatchRunner构造函数
+ * @param engines 已初始化的OCR引擎，每个引擎对应一个识别槽位
+ * @param parent 父对象指针
+ */
+BatchRunner::BatchRunner(const QList<OCREngine *> &engines, QObject *parent)
+    : QObject(parent)
+    , m_nextFile(0)
+    , m_finishedFiles(0)
+    , m_failedFiles(0)
+    , m_running(false)
+{
+    for (OCREngine *engine : engines) {
+        Slot *slot = new Slot;
+        slot->engine = engine;
+        slot->fileIndex = -1;
+        slot->loadWatcher = new QFutureWatcher<FileProcessor::ProcessResult>(this);
+        slot->ocrWatcher = new QFutureWatcher<OCREngine::OCRResult>(this);
+
+        connect(slot->loadWatcher, &QFutureWatcher<FileProcessor::ProcessResult>::finished,
+                this, [this, slot]() { onFileLoaded(slot); });
+        connect(slot->ocrWatcher, &QFutureWatcher<OCREngine::OCRResult>::finished,
+                this, [this, slot]() { onFileRecognized(slot); });
+
+        m_slots.append(slot);
+    }
+}
+
+/**
+ * @brief BatchRunner析构函数，等待进行中的任务结束
+ */
+BatchRunner::~BatchRunner()
+{
+    for (Slot *slot : m_slots) {
+        slot->loadWatcher->waitForFinished();
+        slot->ocrWatcher->cancel();
+        slot->ocrWatcher->waitForFinished();
+        delete slot;
+    }
+}
+
+/**
+ * @brief 开始批量识别
+ * @param files 输入文件列表
+ * @param options 识别选项
+ */
+void BatchRunner::start(const QList<InputFile> &files, const Options &options)
+{
+    m_files = files;
+    m_options = options;
+    m_nextFile = 0;
+    m_finishedFiles = 0;
+    m_failedFiles = 0;
+    m_running = true;
+
+    if (m_files.isEmpty() || m_slots.isEmpty()) {
+        m_running = false;
+        QMetaObject::invokeMethod(this, [this]() { emit finished(m_failedFiles); }, Qt::QueuedConnection);
+        return;
+    }
+
+    for (Slot *slot : m_slots) {
+        startNextFile(slot);
+    }
+}
+
+/**
+ * @brief 为空闲槽位分配下一个文件
+ * @param slot 槽位
+ */
+void BatchRunner::startNextFile(Slot *slot)
+{
+    slot->fileIndex = -1;
+
+    while (m_nextFile < m_files.size()) {
+        const int fileIndex = m_nextFile++;
+        const InputFile &file = m_files.at(fileIndex);
+
+        if (m_options.skipExisting && QFileInfo::exists(outputPathFor(file, m_options))) {
+            m_finishedFiles++;
+            emit fileFinished(file.filePath, true, "结果已存在，跳过", m_finishedFiles, m_files.size());
+            continue;
+        }
+
+        slot->fileIndex = fileIndex;
+        slot->timer.start();
+
+        // 超大图像跳过整图加载，直接分块识别（作为一页）
+        if (shouldTile(file.filePath, m_options)) {
+            slot->loaded = FileProcessor::ProcessResult();
+            slot->loaded.success = true;
+            slot->loaded.pageCount = 1;
+            slot->loaded.pageNames.append(QFileInfo(file.filePath).baseName());
+            slot->ocrWatcher->setFuture(submitTiled(slot->engine, file.filePath, m_options));
+            return;
+        }
+
+        // PDF文件边渲染边识别，页数在识别结束时由结果给出
+        if (shouldStream(file.filePath, m_options)) {
+            slot->loaded = FileProcessor::ProcessResult();
+            slot->loaded.success = true;
+            slot->ocrWatcher->setFuture(submitStreaming(slot->engine, file.filePath, m_options));
+            return;
+        }
+
+        // 每个加载任务使用独立的FileProcessor（其临时文件列表不是线程安全的）
+        const QString filePath = file.filePath;
+        const int maxWidth = m_options.maxWidth;
+        const int maxHeight = m_options.maxHeight;
+        const ImagePreprocessor::Options preprocess = m_options.preprocess;
+        slot->loadWatcher->setFuture(QtConcurrent::run([filePath, maxWidth, maxHeight, preprocess]() {
+            FileProcessor processor;
+            FileProcessor::ProcessResult result = processor.processFile(filePath, maxWidth, maxHeight);
+            ImagePreprocessor::processAll(result.images, preprocess);
+            return result;
+        }));
+        return;
+    }
+
+    // 没有剩余文件：所有文件都完成时结束（排队发送，调用方可在start()之后才进入事件循环）
+    if (m_running && m_finishedFiles == m_files.size()) {
+        m_running = false;
+        QMetaObject::invokeMethod(this, [this]() { emit finished(m_failedFiles); }, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief 文件加载完成，提交识别
+ * @param slot 槽位
+ */
+void BatchRunner::onFileLoaded(Slot *slot)
+{
+    slot->loaded = slot->loadWatcher->result();
+    slot->loadWatcher->setFuture(QFuture<FileProcessor::ProcessResult>());
+
+    if (!slot->loaded.success || slot->loaded.images.isEmpty()) {
+        QString message = slot->loaded.errorMessage.isEmpty() ? "文件中没有可识别的页面"
+                                                              : slot->loaded.errorMessage;
+        slot->loaded = FileProcessor::ProcessResult();
+        finishFile(slot, false, message);
+        return;
+    }
+
+    slot->ocrWatcher->setFuture(slot->engine->submitDocument(slot->loaded.images, slot->loaded.extractedTexts,
+                                                             m_options.language));
+}
+
+/**
+ * @brief 识别完成，写出结果
+ * @param slot 槽位
+ */
+void BatchRunner::onFileRecognized(Slot *slot)
+{
+    QFuture<OCREngine::OCRResult> future = slot->ocrWatcher->future();
+    int pageCount = slot->loaded.pageCount;
+    QStringList pageNames = slot->loaded.pageNames;
+    slot->loaded = FileProcessor::ProcessResult();
+
+    // 流式识别的页数为结果的进度最大值
+    if (pageCount == 0 && future.isValid()) {
+        pageCount = future.progressMaximum();
+        for (int i = 0; i < pageCount; ++i) {
+            pageNames.append(QString("页面 %1").arg(i + 1));
+        }
+    }
+    slot->ocrWatcher->setFuture(QFuture<OCREngine::OCRResult>());
+
+    // 结果按页面索引存放；缺失的页面（识别被中止）按失败处理
+    QList<OCREngine::OCRResult> pageResults;
+    int failedPages = 0;
+    for (int i = 0; i < pageCount; ++i) {
+        OCREngine::OCRResult pageResult;
+        if (future.isValid() && future.isResultReadyAt(i)) {
+            pageResult = future.resultAt(i);
+        } else {
+            pageResult.errorMessage = "识别未完成";
+        }
+        if (!pageResult.success) {
+            failedPages++;
+        }
+        pageResults.append(pageResult);
+    }
+
+    QString errorMessage;
+    const qint64 elapsedMs = slot->timer.elapsed();
+    if (!writeResult(m_files.at(slot->fileIndex), m_options, pageResults, pageNames, elapsedMs, &errorMessage)) {
+        finishFile(slot, false, errorMessage);
+        return;
+    }
+
+    QString message = QString("%1页，%2秒").arg(pageCount).arg(elapsedMs / 1000.0, 0, 'f', 1);
+    if (failedPages > 0) {
+        message += QString("，%1页识别失败").arg(failedPages);
+    }
+    finishFile(slot, failedPages == 0, message);
+}
+
+/**
+ * @brief 结束当前文件并继续下一个
+ * @param slot 槽位
+ * @param success 是否成功
+ * @param message 结果说明
+ */
+void BatchRunner::finishFile(Slot *slot, bool success, const QString &message)
+{
+    m_finishedFiles++;
+    if (!success) {
+        m_failedFiles++;
+    }
+    emit fileFinished(m_files.at(slot->fileIndex).filePath, success, message,
+                      m_finishedFiles, m_files.size());
+
+    startNextFile(slot);
+}
+
+/**
+ * @brief 判断输入文件是否应分块识别
+ * @param filePath 文件路径
+ * @param options 识别选项
+ * @return 是否分块识别
+ */
+bool BatchRunner::shouldTile(const QString &filePath, const Options &options)
+{
+    return options.maxWidth == 0 && options.maxHeight == 0 && TiledRecognizer::shouldTile(filePath, options.tiling);
+}
+
+/**
+ * @brief 判断输入文件是否应流式识别
+ * @param filePath 文件路径
+ * @param options 识别选项
+ * @return 是否流式识别
+ */
+bool BatchRunner::shouldStream(const QString &filePath, const Options &options)
+{
+    return options.pdfStreaming.enabled && FileProcessor::getFileType(filePath) == FileProcessor::DOCUMENT_PDF;
+}
+
+/**
+ * @brief 异步流式识别PDF输入文件
+ * @param engine OCR引擎
+ * @param filePath 文件路径
+ * @param options 识别选项
+ * @return 按页面索引存放识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> BatchRunner::submitStreaming(OCREngine *engine, const QString &filePath,
+                                                           const Options &options)
+{
+    PdfStreamRecognizer::Options streaming = options.pdfStreaming;
+    streaming.maxWidth = options.maxWidth;
+    streaming.maxHeight = options.maxHeight;
+    streaming.preprocess = options.preprocess;
+    return PdfStreamRecognizer::submitFile(engine, filePath, options.language, streaming);
+}
+
+/**
+ * @brief 异步分块识别输入文件
+ * @param engine OCR引擎
+ * @param filePath 文件路径
+ * @param options 识别选项
+ * @return 包含一个识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> BatchRunner::submitTiled(OCREngine *engine, const QString &filePath,
+                                                       const Options &options)
+{
+    TiledRecognizer::Options tiling = options.tiling;
+    tiling.preprocess = options.preprocess;
+    return TiledRecognizer::submitFile(engine, filePath, options.language, tiling);
+}
+
+/**
+ * @brief 写出识别结果
+ * @param file 输入文件
+ * @param options 识别选项
+ * @param pageResults 逐页识别结果
+ * @param pageNames 页面名称
+ * @param elapsedMs 处理耗时
+ * @param errorMessage 失败时返回错误信息
+ * @return 是否成功写出
+ */
+bool BatchRunner::writeResult(const InputFile &file,
+                              const Options &options,
+                              const QList<OCREngine::OCRResult> &pageResults,
+                              const QStringList &pageNames,
+                              qint64 elapsedMs,
+                              QString *errorMessage)
+{
+    QByteArray data;
+    if (options.format == JSON) {
+        QJsonArray pages;
+        int processedPages = 0;
+        for (int i = 0; i < pageResults.size(); ++i) {
+            const OCREngine::OCRResult &pageResult = pageResults.at(i);
+
+            QJsonObject page;
+            page.insert("index", i + 1);
+            page.insert("name", pageNames.value(i));
+            page.insert("success", pageResult.success);
+            if (pageResult.success) {
+                page.insert("text", pageResult.text);
+                page.insert("confidence", double(pageResult.confidence));
+                page.insert("blank", pageResult.blankPage);
+                page.insert("extracted", pageResult.extracted);
+                page.insert("layout", pageResult.layout.toJson());
+                processedPages++;
+            } else {
+                page.insert("error", pageResult.errorMessage);
+            }
+            pages.append(page);
+        }
+
+        QJsonObject root;
+        root.insert("file", file.filePath);
+        root.insert("language", options.language);
+        root.insert("pageCount", pageResults.size());
+        root.insert("processedPages", processedPages);
+        root.insert("elapsedMs", elapsedMs);
+        root.insert("pages", pages);
+        data = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    } else if (pageResults.size() == 1) {
+        const OCREngine::OCRResult &pageResult = pageResults.first();
+        data = (pageResult.success ? pageResult.text
+                                   : QString("错误: %1").arg(pageResult.errorMessage)).toUtf8();
+    } else {
+        OCREngine::BatchOCRResult batchResult;
+        batchResult.totalPages = pageResults.size();
+        OCREngine::finalizeBatchResult(batchResult, pageResults, pageNames);
+        data = batchResult.combinedText.toUtf8();
+    }
+
+    const QString outputPath = outputPathFor(file, options);
+    if (!QDir().mkpath(QFileInfo(outputPath).absolutePath())) {
+        *errorMessage = QString("无法创建输出目录: %1").arg(QFileInfo(outputPath).absolutePath());
+        return false;
+    }
+
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        *errorMessage = QString("无法写入结果文件: %1").arg(output.errorString());
+        return false;
+    }
+    output.write(data);
+    if (!output.commit()) {
+        *errorMessage = QString("无法写入结果文件: %1").arg(output.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 展开输入路径
+ * @param paths 文件或目录路径
+ * @param recursive 是否递归子目录
+ * @param errors 返回无法识别的路径
+ * @return 输入文件列表
+ */
+QList<BatchRunner::InputFile> BatchRunner::collectInputs(const QStringList &paths, bool recursive,
+                                                         QStringList *errors)
+{
+    QList<InputFile> files;
+    for (const QString &path : paths) {
+        QFileInfo info(path);
+        if (info.isFile()) {
+            if (!FileProcessor::isFileSupported(path)) {
+                errors->append(QString("不支持的文件格式: %1").arg(path));
+                continue;
+            }
+            files.append({info.absoluteFilePath(), info.fileName()});
+        } else if (info.isDir()) {
+            QDir root(info.absoluteFilePath());
+            QStringList dirFiles;
+            QDirIterator it(root.absolutePath(), QDir::Files | QDir::Readable,
+                            recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+            while (it.hasNext()) {
+                const QString filePath = it.next();
+                if (FileProcessor::isFileSupported(filePath)) {
+                    dirFiles.append(filePath);
+                }
+            }
+            std::sort(dirFiles.begin(), dirFiles.end());
+            for (const QString &filePath : dirFiles) {
+                files.append({filePath, root.relativeFilePath(filePath)});
+            }
+        } else {
+            errors->append(QString("文件或目录不存在: %1").arg(path));
+        }
+    }
+    return files;
+}
+
+/**
+ * @brief 读取清单文件
+ * @param manifestPath 清单文件路径（"-"表示标准输入）
+ * @param errors 返回读取错误
+ * @return 清单中的路径列表
+ */
+QStringList BatchRunner::readManifest(const QString &manifestPath, QStringList *errors)
+{
+    QFile file;
+    QDir baseDir = QDir::current();
+    if (manifestPath == "-") {
+        if (!file.open(stdin, QIODevice::ReadOnly | QIODevice::Text)) {
+            errors->append("无法读取标准输入");
+            return QStringList();
+        }
+    } else {
+        file.setFileName(manifestPath);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            errors->append(QString("无法打开清单文件: %1").arg(manifestPath));
+            return QStringList();
+        }
+        baseDir = QFileInfo(manifestPath).absoluteDir();
+    }
+
+    QStringList paths;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        paths.append(QDir::cleanPath(baseDir.absoluteFilePath(line)));
+    }
+    return paths;
+}
+
+/**
+ * @brief 获取输入文件对应的结果文件路径
+ * @param file 输入文件
+ * @param options 识别选项
+ * @return 结果文件路径
+ */
+QString BatchRunner::outputPathFor(const InputFile &file, const Options &options)
+{
+    const QString suffix = options.format == JSON ? ".json" : ".txt";
+    if (options.outputDir.isEmpty()) {
+        return file.filePath + suffix;
+    }
+    return QDir(options.outputDir).absoluteFilePath(file.relativePath + suffix);
+}
@@ -0,0 +1,223 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include "ocrengine.h"
+#include "fileprocessor.h"
+#include "imagepreprocessor.h"
+#include "tiledrecognizer.h"
+#include "pdfstreamrecognizer.h"
+
+/**
+ * @brief 命令行批量识别调度器
+ *
+ * 不依赖任何界面组件。每个识别槽位拥有独立的OCR引擎，多个文件同时在不同槽位中
+ * 加载和识别（文件级并行），每个文件的各页由引擎自身并发识别（页面级并行）。
+ * 同一时刻只有正在处理的文件的页面图像驻留内存，适合处理数千个文档的批量任务。
+ * 每个输入文件识别完成后立即写出一个文本或JSON结果文件。
+ * 超大图像不整图加载，而是由TiledRecognizer分块解码并行识别。
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 结果输出格式
+     */
+    enum OutputFormat {
+        TEXT,           // 纯文本（多页文档按页面分节）
+        JSON            // 结构化JSON（逐页文本、置信度和版面结构）
+    };
+
+    /**
+     * @brief 待识别的输入文件
+     */
+    struct InputFile {
+        QString filePath;       // 文件绝对路径
+        QString relativePath;   // 输出目录中使用的相对路径（保留输入目录的层级）
+    };
+
+    /**
+     * @brief 批量识别选项
+     */
+    struct Options {
+        QString language;       // 识别语言代码
+        QString outputDir;      // 输出目录（为空时写在输入文件旁边）
+        OutputFormat format;    // 输出格式
+        int maxWidth;           // 页面图像最大宽度（0表示不限制）
+        int maxHeight;          // 页面图像最大高度（0表示不限制）
+        bool skipExisting;      // 结果文件已存在时跳过该输入
+        ImagePreprocessor::Options preprocess;  // 识别前的图像预处理
+        TiledRecognizer::Options tiling;        // 超大图像的分块识别（设置了最大宽高时不分块）
+        PdfStreamRecognizer::Options pdfStreaming;  // PDF文件边渲染边识别（最大宽高和预处理取自上面的选项）
+
+        Options() : language("chi_sim+eng"), format(TEXT), maxWidth(0), maxHeight(0), skipExisting(false) {}
+    };
+
+    /**
+     * @brief 构造调度器
+     * @param engines 已初始化的OCR引擎，每个引擎对应一个识别槽位（不拥有）
+     * @param parent 父对象指针
+     */
+    explicit BatchRunner(const QList<OCREngine *> &engines, QObject *parent = nullptr);
+    ~BatchRunner();
+
+    /**
+     * @brief 开始批量识别（立即返回，全部完成后发送finished信号）
+     * @param files 输入文件列表
+     * @param options 识别选项
+     */
+    void start(const QList<InputFile> &files, const Options &options);
+
+    /**
+     * @brief 展开输入路径：文件直接加入，目录中受支持的文件按名称顺序加入
+     * @param paths 文件或目录路径
+     * @param recursive 是否递归子目录
+     * @param errors 返回无法识别的路径
+     * @return 输入文件列表
+     */
+    static QList<InputFile> collectInputs(const QStringList &paths, bool recursive, QStringList *errors);
+
+    /**
+     * @brief 读取清单文件（每行一个文件或目录路径，空行和以#开头的行被忽略，
+     *        相对路径相对于清单文件所在目录；路径为"-"时从标准输入读取）
+     * @param manifestPath 清单文件路径
+     * @param errors 返回读取错误
+     * @return 清单中的路径列表
+     */
+    static QStringList readManifest(const QString &manifestPath, QStringList *errors);
+
+    /**
+     * @brief 获取输入文件对应的结果文件路径
+     * @param file 输入文件
+     * @param options 识别选项
+     * @return 结果文件路径（输入文件名后追加.txt或.json，避免同名不同格式的文件冲突）
+     */
+    static QString outputPathFor(const InputFile &file, const Options &options);
+
+    /**
+     * @brief 判断输入文件是否应分块识别
+     * @param filePath 文件路径
+     * @param options 识别选项
+     * @return 是否分块识别
+     */
+    static bool shouldTile(const QString &filePath, const Options &options);
+
+    /**
+     * @brief 异步分块识别输入文件（预处理选项同样作用于各分块）
+     * @param engine OCR引擎
+     * @param filePath 文件路径
+     * @param options 识别选项
+     * @return 包含一个识别结果的QFuture
+     */
+    static QFuture<OCREngine::OCRResult> submitTiled(OCREngine *engine, const QString &filePath,
+                                                     const Options &options);
+
+    /**
+     * @brief 判断输入文件是否应流式识别（边渲染边识别）
+     * @param filePath 文件路径
+     * @param options 识别选项
+     * @return 是否流式识别
+     */
+    static bool shouldStream(const QString &filePath, const Options &options);
+
+    /**
+     * @brief 异步流式识别PDF输入文件
+     * @param engine OCR引擎
+     * @param filePath 文件路径
+     * @param options 识别选项
+     * @return 按页面索引存放识别结果的QFuture（进度最大值为页数）
+     */
+    static QFuture<OCREngine::OCRResult> submitStreaming(OCREngine *engine, const QString &filePath,
+                                                         const Options &options);
+
+    /**
+     * @brief 写出识别结果（先写临时文件再替换）
+     * @param file 输入文件
+     * @param options 识别选项（决定输出格式和位置）
+     * @param pageResults 逐页识别结果
+     * @param pageNames 页面名称
+     * @param elapsedMs 处理耗时
+     * @param errorMessage 失败时返回错误信息
+     * @return 是否成功写出
+     */
+    static bool writeResult(const InputFile &file,
+                            const Options &options,
+                            const QList<OCREngine::OCRResult> &pageResults,
+                            const QStringList &pageNames,
+                            qint64 elapsedMs,
+                            QString *errorMessage);
+
+signals:
+    /**
+     * @brief 单个文件处理完成信号
+     * @param filePath 输入文件路径
+     * @param success 是否成功（部分页面失败也视为失败）
+     * @param message 结果说明（页数、耗时或错误信息）
+     * @param finishedFiles 已完成的文件数
+     * @param totalFiles 总文件数
+     */
+    void fileFinished(const QString &filePath, bool success, const QString &message,
+                      int finishedFiles, int totalFiles);
+
+    /**
+     * @brief 全部文件处理完成信号
+     * @param failedFiles 失败的文件数
+     */
+    void finished(int failedFiles);
+
+private:
+    /**
+     * @brief 识别槽位
+     */
+    struct Slot {
+        OCREngine *engine;                                          // 该槽位专用的引擎
+        QFutureWatcher<FileProcessor::ProcessResult> *loadWatcher;  // 文件加载任务
+        QFutureWatcher<OCREngine::OCRResult> *ocrWatcher;           // 识别任务
+        FileProcessor::ProcessResult loaded;                        // 已加载的页面
+        int fileIndex;                                              // 正在处理的文件下标（-1表示空闲）
+        QElapsedTimer timer;                                        // 当前文件的处理计时
+    };
+
+    /**
+     * @brief 为空闲槽位分配下一个文件
+     * @param slot 槽位
+     */
+    void startNextFile(Slot *slot);
+
+    /**
+     * @brief 文件加载完成，提交识别
+     * @param slot 槽位
+     */
+    void onFileLoaded(Slot *slot);
+
+    /**
+     * @brief 识别完成，写出结果
+     * @param slot 槽位
+     */
+    void onFileRecognized(Slot *slot);
+
+    /**
+     * @brief 结束当前文件并继续下一个
+     * @param slot 槽位
+     * @param success 是否成功
+     * @param message 结果说明
+     */
+    void finishFile(Slot *slot, bool success, const QString &message);
+
+private:
+    QList<Slot *> m_slots;          // 识别槽位
+    QList<InputFile> m_files;       // 输入文件
+    Options m_options;              // 识别选项
+    int m_nextFile;                 // 下一个待分配的文件下标
+    int m_finishedFiles;            // 已完成的文件数
+    int m_failedFiles;              // 失败的文件数
+    bool m_running;                 // 是否正在执行（保证finished只发送一次）
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,465 @@
+#include "batchrunner.h"
+#include "tesseractocrengine.h"
+#include "remoteocrengine.h"
+#include "ocrservice.h"
+#include "hotfolderprocessor.h"
+#include "persistentjobqueue.h"
+#include "ocrresultcache.h"
+#include "ocrmetrics.h"
+#include "ocrtracer.h"
+#include "ocrcostmodel.h"
+#include "imagepreprocessor.h"
+#include "fileprocessor.h"
+
+#ifdef HAVE_TESSERACT_LIB
+#include "tesseractlibocrengine.h"
+#endif
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QDir>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+namespace {
+
+/**
+ * @brief 进程退出码
+ */
+enum ExitCode {
+    EXIT_OK = 0,            // 全部文件识别成功
+    EXIT_FAILED_FILES = 1,  // 部分文件识别失败
+    EXIT_USAGE = 2,         // 参数错误或没有输入文件
+    EXIT_ENGINE = 3         // OCR引擎初始化失败
+};
+
+/**
+ * @brief 标准错误输出（进度和错误信息，标准输出保持干净）
+ */
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+/**
+ * @brief 测量图像预处理的耗时并输出到标准输出
+ * @param imagePath 测试图像路径
+ * @return 退出码
+ */
+int benchmarkPreprocess(const QString &imagePath)
+{
+    const QImage image(imagePath);
+    if (image.isNull()) {
+        err() << "无法读取图像: " << imagePath << Qt::endl;
+        return EXIT_USAGE;
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1: %2x%3，%4，向量指令: %5")
+               .arg(imagePath).arg(image.width()).arg(image.height())
+               .arg(image.hasAlphaChannel() ? "带透明通道" : "不透明")
+               .arg(ImagePreprocessor::simdLevelName(ImagePreprocessor::supportedSimdLevel()))
+        << Qt::endl;
+
+    const QList<ImagePreprocessor::BenchmarkResult> results = ImagePreprocessor::benchmark(image);
+    for (const ImagePreprocessor::BenchmarkResult &result : results) {
+        out << QString("%1  %2 毫秒/百万像素").arg(result.name, -24).arg(result.msPerMegapixel, 9, 'f', 2);
+        if (result.encodedBytes >= 0) {
+            out << QString("  %1 KB").arg(result.encodedBytes / 1024.0, 0, 'f', 1);
+        }
+        out << Qt::endl;
+    }
+    return EXIT_OK;
+}
+
+/**
+ * @brief 按命令行参数创建并配置OCR引擎
+ * @param engineName 引擎名称（tesseract或tesseract-lib；指定--remote时忽略）
+ * @param parser 命令行解析器
+ * @param pageConcurrency 每个文件的页面并发数
+ * @param parent 父对象指针
+ * @return OCR引擎（由调用方释放），名称无效时返回nullptr
+ */
+OCREngine *createEngine(const QString &engineName, const QCommandLineParser &parser,
+                        int pageConcurrency, QObject *parent)
+{
+    if (parser.isSet("remote")) {
+        const int tcpPort = parser.value("tcp-port").toInt();
+        return new RemoteOCREngine(tcpPort > 0 ? QString("tcp://127.0.0.1:%1").arg(tcpPort)
+                                               : parser.value("service-name"),
+                                   parent);
+    }
+
+    const QString tessdata = parser.value("tessdata");
+    const int psm = parser.value("psm").toInt();
+    const int oem = parser.value("oem").toInt();
+
+    if (engineName == "tesseract") {
+        TesseractOCREngine *engine = new TesseractOCREngine(parent);
+        if (parser.isSet("tesseract")) {
+            engine->setTesseractPath(parser.value("tesseract"));
+        }
+        if (!tessdata.isEmpty()) {
+            engine->setTessDataPath(tessdata);
+        }
+        engine->setOCREngineMode(oem);
+        engine->setPageSegmentationMode(psm);
+        engine->setMaxConcurrentPages(pageConcurrency);
+        return engine;
+    }
+
+#ifdef HAVE_TESSERACT_LIB
+    if (engineName == "tesseract-lib") {
+        TesseractLibOCREngine *engine = new TesseractLibOCREngine(parent);
+        if (!tessdata.isEmpty()) {
+            engine->setTessDataPath(tessdata);
+        }
+        engine->setOCREngineMode(oem);
+        engine->setPageSegmentationMode(psm);
+        return engine;
+    }
+#endif
+
+    return nullptr;
+}
+
+/**
+ * @brief 创建并初始化所有引擎
+ * @param parser 命令行解析器
+ * @param count 引擎数
+ * @param pageConcurrency 每个引擎的页面并发数
+ * @param resultCache 共享的结果缓存
+ * @param engines 返回创建的引擎（由调用方释放）
+ * @return 成功返回EXIT_OK，否则返回退出码
+ */
+int createEngines(const QCommandLineParser &parser, int count, int pageConcurrency,
+                  OCRResultCache *resultCache, QList<OCREngine *> *engines)
+{
+    ImagePreprocessor::BlankPageOptions blankPageOptions;
+    blankPageOptions.enabled = !parser.isSet("keep-blank-pages");
+    blankPageOptions.inkContrast = qBound(1, parser.value("blank-contrast").toInt(), 254);
+    blankPageOptions.minInkHeight = qMax(1, parser.value("blank-ink-height").toInt());
+
+    for (int i = 0; i < count; ++i) {
+        OCREngine *engine = createEngine(parser.value("engine"), parser, pageConcurrency, nullptr);
+        if (!engine) {
+            err() << "未知的OCR引擎: " << parser.value("engine") << Qt::endl;
+            return EXIT_USAGE;
+        }
+        engines->append(engine);
+
+        QString initError;
+        QMetaObject::Connection connection =
+            QObject::connect(engine, &OCREngine::errorOccurred, [&initError](const QString &message) {
+                initError = message;
+            });
+        const bool initialized = engine->initialize();
+        QObject::disconnect(connection);
+
+        if (!initialized) {
+            err() << "OCR引擎初始化失败: " << initError << Qt::endl;
+            return EXIT_ENGINE;
+        }
+
+        engine->setResultCache(resultCache);
+        engine->setBlankPageOptions(blankPageOptions);
+    }
+    return EXIT_OK;
+}
+
+} // namespace
+
+/**
+ * @brief 命令行批量识别工具入口
+ *
+ * 与图形界面共用FileProcessor和OCR引擎，不需要显示器和界面组件，
+ * 适合在构建服务器和批处理任务中识别大量文档。
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    // 与图形界面使用相同的应用程序信息，共享工具探测结果、耗时模型和磁盘缓存
+    a.setOrganizationName("ConvenientOCRApp");
+    a.setOrganizationDomain("ocrapp.local");
+    a.setApplicationName("ConvenientOCRApplication");
+    a.setApplicationVersion("1.0");
+
+    OCRMetrics::installExportersFromEnvironment();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Convenient-OCR命令行批量识别工具");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("inputs", "待识别的图像、PDF文件或目录", "[inputs...]");
+    parser.addOptions({
+        {{"m", "manifest"}, "从清单文件读取输入路径（每行一个，\"-\"表示标准输入）", "file"},
+        {{"r", "recursive"}, "递归识别目录中的子目录"},
+        {{"o", "output-dir"}, "结果输出目录（默认写在输入文件旁边）", "dir"},
+        {{"f", "format"}, "输出格式：text或json", "format", "text"},
+        {{"l", "language"}, "识别语言代码", "lang", "chi_sim+eng"},
+        {{"j", "jobs"}, "同时处理的文件数（服务模式下为同时处理的请求数）", "n", QString::number(qMax(1, QThread::idealThreadCount() / 4))},
+        {"page-jobs", "每个文件同时识别的页数（默认按CPU核数和文件并发数计算）", "n"},
+#ifdef HAVE_TESSERACT_LIB
+        {"engine", "OCR引擎：tesseract或tesseract-lib", "engine", "tesseract"},
+#else
+        {"engine", "OCR引擎：tesseract", "engine", "tesseract"},
+#endif
+        {"tesseract", "tesseract可执行文件路径", "path"},
+        {"tessdata", "tessdata目录", "dir"},
+        {"psm", "页面分割模式", "mode", "3"},
+        {"oem", "OCR引擎模式", "mode", "3"},
+        {"max-width", "页面图像最大宽度（0表示不限制）", "pixels", "0"},
+        {"max-height", "页面图像最大高度（0表示不限制）", "pixels", "0"},
+        {"preprocess", "识别前的图像预处理：none、gray（灰度）、otsu（全局二值化）或sauvola（自适应二值化）", "method", "none"},
+        {"bilevel", "二值化结果以1位图像交给引擎（与--preprocess otsu或sauvola一起使用）"},
+        {"normalize-text-size", "按估计的文字x高度缩放页面（缩小高分辨率扫描件，放大截图中的小字）"},
+        {"x-height", "文字尺寸归一化的目标x高度", "pixels", "22"},
+        {"keep-blank-pages", "空白页也交给引擎识别（默认跳过空白页，结果中标记为空白）"},
+        {"blank-contrast", "空白页检测中与背景灰度相差超过该值的像素视为墨迹", "level", "64"},
+        {"blank-ink-height", "有墨迹的行累计高度低于该值的页面视为空白页", "pixels", "6"},
+        {"no-pdf-streaming", "PDF文件先渲染全部页面再识别（默认边渲染边识别）"},
+        {"pdf-chunk-pages", "边渲染边识别时每次渲染的页数（默认按CPU核数）", "n", "0"},
+        {"render-jobs", "渲染一个PDF文件时同时运行的渲染进程或线程数（0表示CPU核数的一半，1表示不并行）", "n", "0"},
+        {"render-memory-mb", "并行渲染PDF时所有渲染进程或线程合计的内存预算（0表示不限制）", "mb", "1024"},
+        {"pdf-backend", "PDF渲染方式：auto（编译了poppler-qt6时在进程内渲染）或pdftoppm", "backend", "auto"},
+        {"pdf-dpi", "PDF页面的渲染分辨率", "dpi", "200"},
+        {"pdf-gray", "PDF页面渲染为灰度图像"},
+        {"no-embedded-images", "扫描PDF的页面也重新渲染，不直接提取页面中的扫描图像"},
+        {"no-text-layer", "PDF页面的文本层也不直接使用，全部页面渲染后识别"},
+        {"text-layer-min-chars", "非空白字符少于该值的PDF文本层视为没有文本层，该页仍然识别", "n", "20"},
+        {"no-tiling", "超大图像（4000万像素以上）也整图识别，不分块"},
+        {"tile-size", "超大图像分块识别时分块的边长", "pixels", "3000"},
+        {"benchmark-preprocess", "测量图像预处理每百万像素的耗时并与直接编码原图对比，然后退出", "image"},
+        {"skip-existing", "结果文件已存在时跳过该输入"},
+        {"no-cache", "不使用识别结果磁盘缓存"},
+        {"similar-pages", "复用近似重复页面（重新扫描、传真、重复封面）的识别结果（默认关闭，逐像素确认内容一致后才复用）"},
+        {"similarity", "判定为近似重复页面的最低相似度（0-1，越高越严格）", "value", "0.95"},
+        {"watch", "监视文件夹：自动识别放入其中的文件（-r包括子目录），直到进程被终止", "dir"},
+        {"settle-ms", "监视文件夹时，文件大小保持不变多久后视为写入完成（毫秒）", "ms", "2000"},
+        {"queue-dir", "监视文件夹时持久化队列的保存目录（默认按监视目录存放在应用数据目录中）", "dir"},
+        {"serve", "以常驻服务方式运行：预热引擎后通过本地套接字接受识别请求"},
+        {"remote", "通过正在运行的OCR服务识别，本进程不初始化引擎"},
+        {"service-name", "OCR服务的本地套接字名称", "name", OCRService::defaultServerName()},
+        {"tcp-port", "OCR服务的回环TCP端口（服务端额外监听，客户端改用TCP连接；0表示不使用）", "port", "0"},
+        {{"q", "quiet"}, "只输出错误信息"}
+    });
+    parser.process(a);
+
+    // 解析参数
+    BatchRunner::Options options;
+    options.language = parser.value("language");
+    options.outputDir = parser.value("output-dir");
+    options.maxWidth = qMax(0, parser.value("max-width").toInt());
+    options.maxHeight = qMax(0, parser.value("max-height").toInt());
+    options.skipExisting = parser.isSet("skip-existing");
+    options.preprocess.bilevel = parser.isSet("bilevel");
+    options.preprocess.normalizeTextSize = parser.isSet("normalize-text-size");
+    options.preprocess.targetXHeight = qBound(8, parser.value("x-height").toInt(), 200);
+    options.pdfStreaming.enabled = !parser.isSet("no-pdf-streaming");
+    options.pdfStreaming.chunkPages = qMax(0, parser.value("pdf-chunk-pages").toInt());
+    FileProcessor::setRenderLimits(parser.value("render-jobs").toInt(),
+                                   qint64(parser.value("render-memory-mb").toLongLong()) * 1024 * 1024);
+    FileProcessor::setRenderOptions(parser.value("pdf-dpi").toInt(), parser.isSet("pdf-gray"));
+    FileProcessor::TextLayerOptions textLayer;
+    textLayer.enabled = !parser.isSet("no-text-layer");
+    textLayer.minCharacters = qMax(1, parser.value("text-layer-min-chars").toInt());
+    FileProcessor::setTextLayerOptions(textLayer);
+    FileProcessor::setEmbeddedImageExtraction(!parser.isSet("no-embedded-images"));
+    options.tiling.enabled = !parser.isSet("no-tiling");
+    options.tiling.tileSize = qMax(512, parser.value("tile-size").toInt());
+
+    bool preprocessValid = false;
+    options.preprocess.method = ImagePreprocessor::methodFromName(parser.value("preprocess"), &preprocessValid);
+    if (!preprocessValid) {
+        err() << "未知的预处理方式: " << parser.value("preprocess") << Qt::endl;
+        return EXIT_USAGE;
+    }
+
+    const QString pdfBackend = parser.value("pdf-backend").toLower();
+    if (pdfBackend == "auto") {
+        FileProcessor::setPdfBackend(FileProcessor::PDF_BACKEND_AUTO);
+    } else if (pdfBackend == "pdftoppm") {
+        FileProcessor::setPdfBackend(FileProcessor::PDF_BACKEND_PDFTOPPM);
+    } else {
+        err() << "未知的PDF渲染方式: " << parser.value("pdf-backend") << Qt::endl;
+        return EXIT_USAGE;
+    }
+
+    const QString format = parser.value("format").toLower();
+    if (format == "json") {
+        options.format = BatchRunner::JSON;
+    } else if (format == "text" || format == "txt") {
+        options.format = BatchRunner::TEXT;
+    } else {
+        err() << "未知的输出格式: " << format << Qt::endl;
+        return EXIT_USAGE;
+    }
+
+    if (parser.isSet("benchmark-preprocess")) {
+        return benchmarkPreprocess(parser.value("benchmark-preprocess"));
+    }
+
+    // 收集输入文件
+    QStringList errors;
+    QStringList inputPaths = parser.positionalArguments();
+    if (parser.isSet("manifest")) {
+        inputPaths.append(BatchRunner::readManifest(parser.value("manifest"), &errors));
+    }
+    const QList<BatchRunner::InputFile> files =
+        BatchRunner::collectInputs(inputPaths, parser.isSet("recursive"), &errors);
+
+    for (const QString &error : errors) {
+        err() << error << Qt::endl;
+    }
+    const bool serve = parser.isSet("serve");
+    const bool watch = parser.isSet("watch");
+    if (files.isEmpty() && !serve && !watch) {
+        err() << "没有可识别的输入文件" << Qt::endl;
+        parser.showHelp(EXIT_USAGE);
+    }
+
+    // 文件级（服务模式下为请求级）和页面级并发：总并发约等于CPU核数
+    const int fileConcurrency = serve || watch ? qMax(1, parser.value("jobs").toInt())
+                                      : qBound(1, parser.value("jobs").toInt(), int(files.size()));
+    int pageConcurrency = parser.value("page-jobs").toInt();
+    if (pageConcurrency <= 0) {
+        pageConcurrency = qMax(1, QThread::idealThreadCount() / fileConcurrency);
+    }
+
+    // 结果缓存由所有引擎共享
+    OCRResultCache resultCache;
+    resultCache.setSimilarPageMatching(parser.isSet("similar-pages"), parser.value("similarity").toDouble());
+    if (!parser.isSet("no-cache")) {
+        resultCache.enableDiskCache();
+    }
+
+    // 每个文件槽位一个引擎，各自拥有独立的后台线程和tesseract进程
+    QList<OCREngine *> engines;
+    const int engineStatus = createEngines(parser, fileConcurrency, pageConcurrency, &resultCache, &engines);
+    if (engineStatus != EXIT_OK) {
+        qDeleteAll(engines);
+        return engineStatus;
+    }
+
+    const bool quiet = parser.isSet("quiet");
+
+    // 服务模式：引擎、语言模型和缓存常驻，直到进程被终止
+    if (serve) {
+        OCRService *service = new OCRService(engines);
+        if (!service->listen(parser.value("service-name"), quint16(parser.value("tcp-port").toUInt()),
+                             options.language)) {
+            err() << service->errorString() << Qt::endl;
+            delete service;
+            qDeleteAll(engines);
+            return EXIT_ENGINE;
+        }
+
+        err() << QString("OCR服务已启动: %1，%2个引擎").arg(parser.value("service-name")).arg(engines.size())
+              << Qt::endl;
+        QObject::connect(service, &OCRService::jobFinished, &a,
+                         [quiet](bool success, int pageCount, qint64 queuedMs, qint64 elapsedMs) {
+            if (success && quiet) {
+                return;
+            }
+            err() << QString("请求%1: %2页，排队%3毫秒，识别%4毫秒")
+                         .arg(success ? "完成" : "失败").arg(pageCount).arg(queuedMs).arg(elapsedMs)
+                  << Qt::endl;
+        });
+
+        const int exitCode = a.exec();
+        delete service;
+        qDeleteAll(engines);
+        OCRTracer::flush();
+        OCRCostModel::save();
+        return exitCode;
+    }
+
+    // 监视文件夹模式：队列保存在磁盘上，重启后继续处理未完成的文件和页面
+    if (watch) {
+        const QString watchDir = QDir(parser.value("watch")).absolutePath();
+        QString queueDir = parser.value("queue-dir");
+        if (queueDir.isEmpty()) {
+            const QByteArray dirHash = QCryptographicHash::hash(watchDir.toUtf8(), QCryptographicHash::Sha1).toHex();
+            queueDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                       + "/watch-queues/" + QString::fromLatin1(dirHash.left(16));
+        }
+
+        QString errorMessage;
+        PersistentJobQueue queue;
+        if (!queue.open(queueDir, &errorMessage)) {
+            err() << errorMessage << Qt::endl;
+            qDeleteAll(engines);
+            return EXIT_USAGE;
+        }
+
+        HotFolderProcessor *processor = new HotFolderProcessor(engines, &queue);
+        if (!processor->watch(watchDir, parser.isSet("recursive"), options,
+                              parser.value("settle-ms").toInt(), &errorMessage)) {
+            err() << errorMessage << Qt::endl;
+            delete processor;
+            qDeleteAll(engines);
+            return EXIT_USAGE;
+        }
+
+        err() << QString("正在监视: %1（队列中%2个文件）").arg(watchDir).arg(queue.size()) << Qt::endl;
+        QObject::connect(processor, &HotFolderProcessor::fileFinished, &a,
+                         [quiet](const QString &filePath, bool success, const QString &message, int queuedFiles) {
+            if (success && quiet) {
+                return;
+            }
+            err() << QString("%1: %2%3（队列中%4个文件）")
+                         .arg(filePath, success ? QString() : QString("失败 - "), message).arg(queuedFiles)
+                  << Qt::endl;
+        });
+
+        const int exitCode = a.exec();
+        delete processor;
+        qDeleteAll(engines);
+        OCRTracer::flush();
+        OCRCostModel::save();
+        return exitCode;
+    }
+
+    // 开始批量识别
+    BatchRunner *runner = new BatchRunner(engines);
+    QElapsedTimer timer;
+    timer.start();
+
+    QObject::connect(runner, &BatchRunner::fileFinished, &a,
+                     [quiet](const QString &filePath, bool success, const QString &message,
+                             int finishedFiles, int totalFiles) {
+        if (success && quiet) {
+            return;
+        }
+        err() << QString("[%1/%2] %3: %4%5")
+                     .arg(finishedFiles).arg(totalFiles).arg(filePath)
+                     .arg(success ? QString() : QString("失败 - ")).arg(message)
+              << Qt::endl;
+    });
+    QObject::connect(runner, &BatchRunner::finished, &a,
+                     [&a, &timer, quiet, &files](int failedFiles) {
+        if (!quiet) {
+            const double seconds = timer.elapsed() / 1000.0;
+            err() << QString("完成: %1个文件，失败%2个，用时%3秒")
+                         .arg(files.size()).arg(failedFiles).arg(seconds, 0, 'f', 1)
+                  << Qt::endl;
+        }
+        a.exit(failedFiles > 0 ? EXIT_FAILED_FILES : EXIT_OK);
+    });
+
+    runner->start(files, options);
+    const int exitCode = a.exec();
+
+    // 先结束调度器，再销毁引擎（引擎使用的结果缓存最后销毁）
+    delete runner;
+    qDeleteAll(engines);
+
+    OCRTracer::flush();
+    OCRCostModel::save();
+    return exitCode;
+}
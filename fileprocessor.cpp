@@ -1,4 +1,10 @@
 #include "fileprocessor.h"
+#include "toolregistry.h"
+#include "ocrmetrics.h"
+#include "ocrtracer.h"
+#ifdef HAVE_POPPLER_QT
+#include "popplerrenderer.h"
+#endif
 #include <QImageReader>
 #include <QDir>
 #include <QStandardPaths>
@@ -6,9 +12,16 @@
 #include <QDebug>
 #include <QMimeDatabase>
 #include <QRegularExpression>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QFileInfo>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QAtomicInt>
+#include <QSet>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 // 静态成员变量初始化
 QStringList FileProcessor::s_imageExtensions = {
@@ -19,6 +32,54 @@ QStringList FileProcessor::s_documentExtensions = {
     "pdf"
 };
 
+int FileProcessor::s_renderJobs = 0;
+qint64 FileProcessor::s_renderMemoryBudget = qint64(1024) * 1024 * 1024;
+int FileProcessor::s_renderDpi = 200;
+bool FileProcessor::s_renderGrayscale = false;
+FileProcessor::PdfBackend FileProcessor::s_pdfBackend = FileProcessor::PDF_BACKEND_AUTO;
+FileProcessor::TextLayerOptions FileProcessor::s_textLayerOptions;
+bool FileProcessor::s_extractEmbeddedImages = true;
+
+// 单个pdftoppm进程的超时时间（毫秒）
+static const int PDF_RENDER_TIMEOUT = 60000;
+
+// 嵌入图像按分辨率换算后的尺寸与页面尺寸允许的相对误差
+static const double EMBEDDED_IMAGE_COVERAGE_TOLERANCE = 0.03;
+
+// 校验嵌入图像时缩略图的渲染分辨率（DPI）
+static const int EMBEDDED_IMAGE_VERIFY_DPI = 24;
+
+// 嵌入图像与缩略图逐像素灰度差的平均值上限
+static const int EMBEDDED_IMAGE_MAX_DIFFERENCE = 16;
+
+// 页面尺寸未知时按A4估算文本层密度（point）
+static const QSizeF DEFAULT_PAGE_SIZE(595.0, 842.0);
+
+/**
+ * @brief 运行Poppler命令行工具并等待结束
+ * @param toolPath 可执行文件路径
+ * @param arguments 命令行参数
+ * @param output 不为空时写入标准输出
+ * @return 是否正常结束
+ */
+static bool runPopplerTool(const QString &toolPath, const QStringList &arguments, QByteArray *output)
+{
+    QProcess process;
+    process.start(toolPath, arguments);
+    if (!process.waitForStarted(10000)) {
+        return false;
+    }
+    if (!process.waitForFinished(PDF_RENDER_TIMEOUT)) {
+        process.kill();
+        process.waitForFinished(3000);
+        return false;
+    }
+    if (output) {
+        *output = process.readAllStandardOutput();
+    }
+    return process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+}
+
 /**
  * @brief FileProcessor构造函数
  * @param parent 父对象指针
@@ -28,7 +89,7 @@ FileProcessor::FileProcessor(QObject *parent)
     , m_popplerPath("D:/poppler-25.07.0/bin/pdftoppm.exe")
 {
     // 检测bundled版本的Poppler
-    QString appDir = QApplication::applicationDirPath();
+    QString appDir = QCoreApplication::applicationDirPath();
     QString bundledPopplerPath = appDir + "/poppler/pdftoppm.exe";
 
     if (QFileInfo::exists(bundledPopplerPath)) {
@@ -131,6 +192,7 @@ FileProcessor::ProcessResult FileProcessor::processFile(const QString &filePath,
                                                        int maxWidth,
                                                        int maxHeight)
 {
+    OCRTracer::Span span("file_load");
     ProcessResult result;
 
     if (!QFile::exists(filePath)) {
@@ -194,7 +256,12 @@ FileProcessor::ProcessResult FileProcessor::processImageFile(const QString &file
 
     emit progressUpdated(30, 1, 1);
 
-    QImage image = reader.read();
+    QImage image;
+    {
+        OCRMetrics::ScopedTimer decodeTimer("image_decode");
+        image = reader.read();
+    }
+    OCRMetrics::increment("bytes_read", QFileInfo(filePath).size());
     if (image.isNull()) {
         result.success = false;
         result.errorMessage = "图像文件损坏或格式不正确";
@@ -205,6 +272,7 @@ FileProcessor::ProcessResult FileProcessor::processImageFile(const QString &file
 
     // 如果指定了大小限制，调整图像大小
     if ((maxWidth > 0 || maxHeight > 0) && (image.width() > maxWidth || image.height() > maxHeight)) {
+        OCRMetrics::ScopedTimer resizeTimer("image_resize");
         image = resizeImage(image, maxWidth, maxHeight);
     }
 
@@ -234,6 +302,71 @@ FileProcessor::ProcessResult FileProcessor::processPDFFile(const QString &filePa
 {
     ProcessResult result;
 
+    // 有文本层的页面不渲染，图像为空（调用方跳过识别，界面预览时再按页渲染），其余页面逐段加载
+    const QStringList extractedTexts = extractTextLayer(filePath);
+    if (!extractedTexts.isEmpty()) {
+        const PdfInfo info = readPdfInfo(filePath);
+        const int pageCount = int(extractedTexts.size());
+        if (info.pageCount < 0 || info.pageCount == pageCount) {
+            int page = 1;
+            while (page <= pageCount) {
+                if (!extractedTexts.at(page - 1).isEmpty()) {
+                    result.images.append(QImage());
+                    result.pageNames.append(QString("页面 %1").arg(page));
+                    page++;
+                    continue;
+                }
+
+                int runEnd = page;
+                while (runEnd < pageCount && extractedTexts.at(runEnd).isEmpty()) {
+                    runEnd++;
+                }
+                const ProcessResult loaded = processPDFPages(filePath, page, runEnd, maxWidth, maxHeight, info);
+                if (loaded.images.size() < runEnd - page + 1) {
+                    result = ProcessResult();
+                    result.errorMessage = loaded.errorMessage.isEmpty() ? "无法从PDF文件中提取图像"
+                                                                        : loaded.errorMessage;
+                    return result;
+                }
+                result.images.append(loaded.images);
+                result.pageNames.append(loaded.pageNames);
+                page = runEnd + 1;
+            }
+
+            result.success = true;
+            result.pageCount = pageCount;
+            result.extractedTexts = extractedTexts;
+            return result;
+        }
+    }
+
+    // 扫描页直接提取嵌入图像，其余页面逐段渲染；需要先知道页数
+    if (s_extractEmbeddedImages) {
+        const PdfInfo info = readPdfInfo(filePath);
+        if (info.pageCount > 0) {
+            result = processPDFPages(filePath, 1, info.pageCount, maxWidth, maxHeight, info);
+            if (result.success && result.images.size() == info.pageCount) {
+                return result;
+            }
+            result = ProcessResult();
+        }
+    }
+
+#ifdef HAVE_POPPLER_QT
+    if (s_pdfBackend == PDF_BACKEND_AUTO) {
+        {
+            OCRMetrics::ScopedTimer rasterizeTimer("pdf_rasterize");
+            result = renderPDFInProcess(filePath, 1, 0, maxWidth, maxHeight);
+        }
+        if (result.success) {
+            OCRMetrics::increment("pdf_pages", result.images.size());
+            return result;
+        }
+        qDebug() << "进程内渲染失败，改用pdftoppm:" << result.errorMessage;
+        result = ProcessResult();
+    }
+#endif
+
     // 检查Poppler是否可用
     if (!isPopplerAvailable()) {
         result.success = false;
@@ -251,7 +384,14 @@ FileProcessor::ProcessResult FileProcessor::processPDFFile(const QString &filePa
     emit progressUpdated(10, 0, 0);
 
     // 使用Poppler转换PDF为图像
-    QStringList imageFiles = convertPDFToImagesWithPoppler(filePath, outputDir);
+    QStringList imageFiles;
+    {
+        OCRMetrics::ScopedTimer rasterizeTimer("pdf_rasterize");
+        // 不并行渲染时无需读取页数
+        const PdfInfo info = s_renderJobs != 1 ? readPdfInfo(filePath) : PdfInfo();
+        imageFiles = renderPDFPages(filePath, outputDir, info);
+    }
+    OCRMetrics::increment("pdf_pages", imageFiles.size());
     qDebug() << "PDF转换结果: 共生成" << imageFiles.size() << "个图像文件";
     qDebug() << "图像文件列表:" << imageFiles;
 
@@ -265,36 +405,693 @@ FileProcessor::ProcessResult FileProcessor::processPDFFile(const QString &filePa
     emit progressUpdated(40, 0, imageFiles.size());
 
     // 加载转换得到的图像
+    result = loadRenderedPages(imageFiles, 1, maxWidth, maxHeight);
+
+    // 清理临时文件
+    cleanupTempFiles(imageFiles);
+    QDir(outputDir).removeRecursively();
+
+    // 设置结果
+    result.success = !result.images.isEmpty();
+
+    if (!result.success) {
+        result.errorMessage = "无法从PDF文件中提取图像";
+    }
+
+    return result;
+}
+
+/**
+ * @brief 加载PDF文件中的一段页面
+ * @param filePath PDF文件路径
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @param maxWidth 最大宽度
+ * @param maxHeight 最大高度
+ * @param info 文档信息
+ * @return 处理结果
+ */
+FileProcessor::ProcessResult FileProcessor::processPDFPages(const QString &filePath,
+                                                           int firstPage,
+                                                           int lastPage,
+                                                           int maxWidth,
+                                                           int maxHeight,
+                                                           const PdfInfo &info)
+{
+    const QMap<int, QImage> embeddedImages = extractEmbeddedImages(filePath, firstPage, lastPage, info);
+    if (embeddedImages.isEmpty()) {
+        return rasterizePDFPages(filePath, firstPage, lastPage, maxWidth, maxHeight, info);
+    }
+
+    // 按页码合并：提取的页面直接使用，其间连续的其余页面作为一段渲染
+    ProcessResult result;
+    int page = firstPage;
+    while (page <= lastPage) {
+        if (embeddedImages.contains(page)) {
+            result.images.append(resizeImage(embeddedImages.value(page), maxWidth, maxHeight));
+            result.pageNames.append(QString("页面 %1").arg(page));
+            page++;
+            continue;
+        }
+
+        int runEnd = page;
+        while (runEnd < lastPage && !embeddedImages.contains(runEnd + 1)) {
+            runEnd++;
+        }
+        const ProcessResult rendered = rasterizePDFPages(filePath, page, runEnd, maxWidth, maxHeight, info);
+        result.images.append(rendered.images);
+        result.pageNames.append(rendered.pageNames);
+        if (rendered.images.size() < runEnd - page + 1) {
+            // 页码必须连续，缺页之后的页面不再返回
+            result.errorMessage = rendered.errorMessage;
+            break;
+        }
+        page = runEnd + 1;
+    }
+
+    result.pageCount = result.images.size();
+    result.success = !result.images.isEmpty();
+    if (!result.success && result.errorMessage.isEmpty()) {
+        result.errorMessage = QString("无法从PDF文件的第%1-%2页中提取图像").arg(firstPage).arg(lastPage);
+    }
+    return result;
+}
+
+/**
+ * @brief 直接提取整页扫描图像
+ * @param filePath PDF文件路径
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @param info 文档信息
+ * @return 页码到页面图像的映射
+ */
+QMap<int, QImage> FileProcessor::extractEmbeddedImages(const QString &filePath, int firstPage, int lastPage,
+                                                       const PdfInfo &info)
+{
+    QMap<int, QImage> pageImages;
+    if (!s_extractEmbeddedImages) {
+        return pageImages;
+    }
+
+    OCRMetrics::ScopedTimer extractTimer("pdf_embedded_images", firstPage - 1);
+
+    // 只有一张铺满页面的图像的页面
+    const QMap<int, int> fullPageImages = findFullPageImages(filePath, firstPage, lastPage, info);
+    QList<int> candidates;
+    for (auto it = fullPageImages.constBegin(); it != fullPageImages.constEnd(); ++it) {
+        if (it.value() == 1) {
+            candidates.append(it.key());
+        }
+    }
+    if (candidates.isEmpty()) {
+        return pageImages;
+    }
+
+    QTemporaryDir outputDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/ocr_pdf_XXXXXX");
+    if (!outputDir.isValid()) {
+        return pageImages;
+    }
+
+    // 取出原图（-p在文件名中加入页码，-j保留JPEG原始数据）和用于校验的灰度缩略图
+    const QStringList extractRange = QStringList() << "-f" << QString::number(candidates.first())
+                                                   << "-l" << QString::number(candidates.last());
+    if (!runPopplerTool(popplerToolPath("pdfimages"),
+                        QStringList() << "-p" << "-j" << "-png" << extractRange << filePath
+                                      << outputDir.path() + "/image",
+                        nullptr)) {
+        return pageImages;
+    }
+    const QString thumbnailDir = outputDir.path() + "/thumbnails";
+    QDir().mkpath(thumbnailDir);
+    if (!runPopplerTool(m_popplerPath,
+                        QStringList() << "-png" << "-gray" << "-r" << QString::number(EMBEDDED_IMAGE_VERIFY_DPI)
+                                      << extractRange << filePath << thumbnailDir + "/page",
+                        nullptr)) {
+        return pageImages;
+    }
+
+    // pdfimages文件名: image-<页码>-<序号>.<扩展名>；pdftoppm文件名: page-<页码>.png
+    QMap<int, QString> imageFiles;
+    static const QRegularExpression imageRegex("^image-(\\d+)-\\d+\\.(png|jpg)$");
+    const QStringList extractedFiles = QDir(outputDir.path()).entryList(QDir::Files);
+    for (const QString &file : extractedFiles) {
+        const QRegularExpressionMatch match = imageRegex.match(file);
+        if (match.hasMatch()) {
+            imageFiles.insert(match.captured(1).toInt(), outputDir.filePath(file));
+        }
+    }
+    QMap<int, QString> thumbnailFiles;
+    static const QRegularExpression thumbnailRegex("^page-(\\d+)\\.png$");
+    const QStringList renderedFiles = QDir(thumbnailDir).entryList(QDir::Files);
+    for (const QString &file : renderedFiles) {
+        const QRegularExpressionMatch match = thumbnailRegex.match(file);
+        if (match.hasMatch()) {
+            thumbnailFiles.insert(match.captured(1).toInt(), QDir(thumbnailDir).filePath(file));
+        }
+    }
+
+    for (int page : candidates) {
+        QImage image(imageFiles.value(page));
+        const QImage thumbnail = QImage(thumbnailFiles.value(page)).convertToFormat(QImage::Format_Grayscale8);
+        if (image.isNull() || thumbnail.isNull()) {
+            continue;
+        }
+        OCRMetrics::increment("bytes_read", QFileInfo(imageFiles.value(page)).size());
+
+        // 与缩略图逐像素比较灰度，叠加的矢量内容、旋转或反色都会造成明显差异
+        const QImage scaled = image.convertToFormat(QImage::Format_Grayscale8)
+                                  .scaled(thumbnail.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        qint64 difference = 0;
+        for (int y = 0; y < thumbnail.height(); ++y) {
+            const uchar *expected = thumbnail.constScanLine(y);
+            const uchar *actual = scaled.constScanLine(y);
+            for (int x = 0; x < thumbnail.width(); ++x) {
+                difference += qAbs(int(expected[x]) - int(actual[x]));
+            }
+        }
+        const qint64 pixels = qint64(thumbnail.width()) * thumbnail.height();
+        if (difference > pixels * EMBEDDED_IMAGE_MAX_DIFFERENCE) {
+            qDebug() << "第" << page << "页的嵌入图像与页面渲染结果不一致，改为渲染该页";
+            continue;
+        }
+
+        pageImages.insert(page, image);
+    }
+
+    OCRMetrics::increment("pdf_embedded_pages", pageImages.size());
+    qDebug() << "PDF嵌入图像:" << pageImages.size() << "/" << (lastPage - firstPage + 1) << "页直接提取";
+    return pageImages;
+}
+
+/**
+ * @brief 找出有铺满页面的图像的页面
+ * @param filePath PDF文件路径
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @param info 文档信息
+ * @return 页码到该页图像数的映射
+ */
+QMap<int, int> FileProcessor::findFullPageImages(const QString &filePath, int firstPage, int lastPage,
+                                                 const PdfInfo &info)
+{
+    QMap<int, int> fullPageImages;
+
+    // 列出各页的图像。"pdfimages -list"的输出列:
+    // page num type width height color comp bpc enc interp object ID x-ppi y-ppi size ratio
+    QByteArray listing;
+    const QStringList arguments = QStringList() << "-list" << "-f" << QString::number(firstPage)
+                                                << "-l" << QString::number(lastPage) << filePath;
+    if (!runPopplerTool(popplerToolPath("pdfimages"), arguments, &listing)) {
+        return fullPageImages;
+    }
+
+    // 图像按其分辨率换算后的绘制尺寸（point）与页面尺寸一致时视为铺满页面
+    auto coversPage = [&](const QSizeF &drawn) {
+        if (info.pageSize.isEmpty()) {
+            return true;    // 页面尺寸未知时只依靠调用方的进一步校验
+        }
+        auto close = [](double a, double b) { return qAbs(a - b) <= b * EMBEDDED_IMAGE_COVERAGE_TOLERANCE; };
+        const QSizeF pageSize = info.pageSize;
+        return (close(drawn.width(), pageSize.width()) && close(drawn.height(), pageSize.height())) ||
+               (close(drawn.width(), pageSize.height()) && close(drawn.height(), pageSize.width()));
+    };
+
+    QMap<int, int> imagesPerPage;
+    QSet<int> coveredPages;
+    const QStringList lines = QString::fromLocal8Bit(listing).split('\n');
+    for (const QString &line : lines) {
+        const QStringList columns = line.simplified().split(' ');
+        bool pageOk = false;
+        const int page = columns.value(0).toInt(&pageOk);
+        if (!pageOk || columns.size() < 14) {
+            continue;   // 表头、分隔线或空行
+        }
+        // 软遮罩（smask）、模板（stencil）等也单独列出，计入图像数
+        imagesPerPage[page]++;
+
+        const double xPpi = columns.at(12).toDouble();
+        const double yPpi = columns.at(13).toDouble();
+        if (columns.at(2) == "image" && xPpi > 0 && yPpi > 0
+            && coversPage(QSizeF(columns.at(3).toDouble() * 72.0 / xPpi, columns.at(4).toDouble() * 72.0 / yPpi))) {
+            coveredPages.insert(page);
+        }
+    }
+
+    for (int page : std::as_const(coveredPages)) {
+        fullPageImages.insert(page, imagesPerPage.value(page));
+    }
+    return fullPageImages;
+}
+
+/**
+ * @brief 渲染并加载PDF文件中的一段页面
+ * @param filePath PDF文件路径
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @param maxWidth 最大宽度
+ * @param maxHeight 最大高度
+ * @param info 文档信息
+ * @return 处理结果
+ */
+FileProcessor::ProcessResult FileProcessor::rasterizePDFPages(const QString &filePath,
+                                                             int firstPage,
+                                                             int lastPage,
+                                                             int maxWidth,
+                                                             int maxHeight,
+                                                             const PdfInfo &info)
+{
+    ProcessResult result;
+
+#ifdef HAVE_POPPLER_QT
+    if (s_pdfBackend == PDF_BACKEND_AUTO) {
+        {
+            OCRMetrics::ScopedTimer rasterizeTimer("pdf_rasterize", firstPage - 1);
+            result = renderPDFInProcess(filePath, firstPage, lastPage, maxWidth, maxHeight);
+        }
+        if (result.success) {
+            OCRMetrics::increment("pdf_pages", result.images.size());
+            return result;
+        }
+        qDebug() << "进程内渲染失败，改用pdftoppm:" << result.errorMessage;
+        result = ProcessResult();
+    }
+#endif
+
+    if (!isPopplerAvailable()) {
+        result.errorMessage = "Poppler不可用。请确保Poppler已正确安装并配置路径";
+        return result;
+    }
+
+    // 流式处理时多个段可能同时渲染，每段使用独立的临时目录
+    QTemporaryDir outputDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/ocr_pdf_XXXXXX");
+    if (!outputDir.isValid()) {
+        result.errorMessage = "无法创建临时目录";
+        return result;
+    }
+
+    QStringList imageFiles;
+    {
+        OCRMetrics::ScopedTimer rasterizeTimer("pdf_rasterize", firstPage - 1);
+        imageFiles = renderPDFPages(filePath, outputDir.path(), info, firstPage, lastPage);
+    }
+    OCRMetrics::increment("pdf_pages", imageFiles.size());
+
+    if (imageFiles.isEmpty()) {
+        result.errorMessage = QString("无法转换PDF文件的第%1-%2页").arg(firstPage).arg(lastPage);
+        return result;
+    }
+
+    result = loadRenderedPages(imageFiles, firstPage, maxWidth, maxHeight);
+    cleanupTempFiles(imageFiles);
+
+    result.success = !result.images.isEmpty();
+    if (!result.success) {
+        result.errorMessage = QString("无法从PDF文件的第%1-%2页中提取图像").arg(firstPage).arg(lastPage);
+    }
+    return result;
+}
+
+/**
+ * @brief 用pdfinfo读取PDF文件的页数和页面尺寸
+ * @param filePath PDF文件路径
+ * @return 文档信息
+ */
+FileProcessor::PdfInfo FileProcessor::readPdfInfo(const QString &filePath)
+{
+    PdfInfo info;
+
+#ifdef HAVE_POPPLER_QT
+    // 进程内渲染时直接从文档读取，不必启动pdfinfo
+    if (s_pdfBackend == PDF_BACKEND_AUTO) {
+        PopplerRenderer renderer(filePath);
+        if (renderer.isValid()) {
+            info.pageCount = renderer.pageCount();
+            info.pageSize = renderer.pageSize(0);
+            return info;
+        }
+    }
+#endif
+
+    QProcess process;
+    process.start(popplerToolPath("pdfinfo"), QStringList() << filePath);
+    if (!process.waitForStarted(10000)) {
+        return info;
+    }
+    if (!process.waitForFinished(10000)) {
+        process.kill();
+        process.waitForFinished(3000);
+        return info;
+    }
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        return info;
+    }
+
+    // pdfinfo输出格式: "Pages:          12" 和 "Page size:      595.276 x 841.89 pts (A4)"
+    const QString output = QString::fromLocal8Bit(process.readAllStandardOutput());
+    static const QRegularExpression pagesRegex("^Pages:\\s+(\\d+)", QRegularExpression::MultilineOption);
+    static const QRegularExpression sizeRegex("^Page size:\\s+([\\d.]+) x ([\\d.]+) pts",
+                                              QRegularExpression::MultilineOption);
+    const QRegularExpressionMatch pagesMatch = pagesRegex.match(output);
+    if (pagesMatch.hasMatch()) {
+        info.pageCount = pagesMatch.captured(1).toInt();
+    }
+    const QRegularExpressionMatch sizeMatch = sizeRegex.match(output);
+    if (sizeMatch.hasMatch()) {
+        info.pageSize = QSizeF(sizeMatch.captured(1).toDouble(), sizeMatch.captured(2).toDouble());
+    }
+    return info;
+}
+
+/**
+ * @brief 设置PDF并行渲染的并发数和内存预算
+ * @param jobs 最大并发进程数
+ * @param memoryBudget 内存预算（字节）
+ */
+void FileProcessor::setRenderLimits(int jobs, qint64 memoryBudget)
+{
+    s_renderJobs = qMax(0, jobs);
+    s_renderMemoryBudget = qMax<qint64>(0, memoryBudget);
+}
+
+/**
+ * @brief 提取PDF文件各页的文本层
+ * @param filePath PDF文件路径
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @return 每页的文本
+ */
+QStringList FileProcessor::extractTextLayer(const QString &filePath, int firstPage, int lastPage)
+{
+    if (!s_textLayerOptions.enabled) {
+        return QStringList();
+    }
+
+    OCRMetrics::ScopedTimer extractTimer("text_layer_extract");
+    QStringList pageTexts;
+
+#ifdef HAVE_POPPLER_QT
+    if (s_pdfBackend == PDF_BACKEND_AUTO) {
+        PopplerRenderer renderer(filePath);
+        if (renderer.isValid()) {
+            const int last = lastPage > 0 ? qMin(lastPage, renderer.pageCount()) : renderer.pageCount();
+            for (int page = qMax(1, firstPage); page <= last; ++page) {
+                pageTexts.append(renderer.pageText(page - 1));
+            }
+        }
+    }
+#endif
+
+    if (pageTexts.isEmpty()) {
+        QStringList arguments;
+        arguments << "-layout" << "-enc" << "UTF-8";
+        if (firstPage > 1) {
+            arguments << "-f" << QString::number(firstPage);
+        }
+        if (lastPage > 0) {
+            arguments << "-l" << QString::number(lastPage);
+        }
+        arguments << filePath << "-";   // 输出到标准输出
+
+        QProcess process;
+        process.start(popplerToolPath("pdftotext"), arguments);
+        if (!process.waitForStarted(10000)) {
+            return QStringList();
+        }
+        if (!process.waitForFinished(PDF_RENDER_TIMEOUT)) {
+            process.kill();
+            process.waitForFinished(3000);
+            return QStringList();
+        }
+        if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+            return QStringList();
+        }
+
+        // 每页文本以换页符结束
+        pageTexts = QString::fromUtf8(process.readAllStandardOutput()).split(QChar('\f'));
+        if (!pageTexts.isEmpty() && pageTexts.last().trimmed().isEmpty()) {
+            pageTexts.removeLast();
+        }
+    }
+
+    int usablePages = 0;
+    for (QString &text : pageTexts) {
+        if (isUsableTextLayer(text, s_textLayerOptions)) {
+            text = text.trimmed();
+            usablePages++;
+        } else {
+            text.clear();
+        }
+    }
+
+    // 扫描页上也可能有数字印章、页眉或批注形成的文本层。铺满页面的扫描图像上的文本层
+    // 只有按页面面积计算足够密集（如扫描软件写入的整页OCR文本）时才代替识别
+    if (usablePages > 0 && s_textLayerOptions.minImagePageDensity > 0) {
+        const int first = qMax(1, firstPage);
+        const PdfInfo info = readPdfInfo(filePath);
+        const QMap<int, int> imagePages = findFullPageImages(filePath, first, first + pageTexts.size() - 1, info);
+        const QSizeF pageSize = info.pageSize.isEmpty() ? DEFAULT_PAGE_SIZE : info.pageSize;
+        const double squareInches = pageSize.width() * pageSize.height() / (72.0 * 72.0);
+        for (auto it = imagePages.constBegin(); it != imagePages.constEnd(); ++it) {
+            const int index = it.key() - first;
+            if (index < 0 || index >= pageTexts.size() || pageTexts.at(index).isEmpty()) {
+                continue;
+            }
+            QString &text = pageTexts[index];
+            int characters = 0;
+            for (const QChar ch : std::as_const(text)) {
+                characters += ch.isSpace() ? 0 : 1;
+            }
+            if (characters < squareInches * s_textLayerOptions.minImagePageDensity) {
+                qDebug() << "第" << it.key() << "页为扫描图像，文本层只有" << characters << "个字符，仍需识别";
+                text.clear();
+                usablePages--;
+            }
+        }
+    }
+    OCRMetrics::increment("text_layer_pages", usablePages);
+    qDebug() << "PDF文本层:" << usablePages << "/" << pageTexts.size() << "页可直接使用";
+
+    return usablePages > 0 ? pageTexts : QStringList();
+}
+
+/**
+ * @brief 检查提取的文本层是否可以代替识别
+ * @param text 页面文本
+ * @param options 提取选项
+ * @return 是否可用
+ */
+bool FileProcessor::isUsableTextLayer(const QString &text, const TextLayerOptions &options)
+{
+    int characters = 0;
+    int validCharacters = 0;
+    int wordCharacters = 0;
+    for (const QChar ch : text) {
+        if (ch.isSpace()) {
+            continue;
+        }
+        characters++;
+
+        // 字体缺少ToUnicode映射时提取出替换字符、私用区字符或控制字符
+        const QChar::Category category = ch.category();
+        if (ch == QChar::ReplacementCharacter || category == QChar::Other_PrivateUse ||
+            category == QChar::Other_Control || category == QChar::Other_NotAssigned) {
+            continue;
+        }
+        validCharacters++;
+        if (ch.isLetterOrNumber() || ch.isSurrogate()) {
+            wordCharacters++;
+        }
+    }
+
+    if (characters < options.minCharacters) {
+        return false;
+    }
+    // 可显示字符足够多，且不是以符号为主（编码错位的文本常表现为大量标点符号）
+    return validCharacters >= characters * options.minValidRatio && wordCharacters * 2 >= validCharacters;
+}
+
+/**
+ * @brief 设置PDF文本层提取选项
+ * @param options 提取选项
+ */
+void FileProcessor::setTextLayerOptions(const TextLayerOptions &options)
+{
+    s_textLayerOptions = options;
+}
+
+/**
+ * @brief 获取PDF文本层提取选项
+ * @return 提取选项
+ */
+FileProcessor::TextLayerOptions FileProcessor::textLayerOptions()
+{
+    return s_textLayerOptions;
+}
+
+/**
+ * @brief 设置是否直接提取扫描页的嵌入图像
+ * @param enabled 是否提取
+ */
+void FileProcessor::setEmbeddedImageExtraction(bool enabled)
+{
+    s_extractEmbeddedImages = enabled;
+}
+
+/**
+ * @brief 设置PDF渲染分辨率和颜色
+ * @param dpi 渲染分辨率
+ * @param grayscale 是否渲染为灰度图像
+ */
+void FileProcessor::setRenderOptions(int dpi, bool grayscale)
+{
+    s_renderDpi = qBound(36, dpi, 1200);
+    s_renderGrayscale = grayscale;
+}
+
+/**
+ * @brief 设置PDF渲染后端
+ * @param backend 渲染后端
+ */
+void FileProcessor::setPdfBackend(PdfBackend backend)
+{
+    s_pdfBackend = backend;
+}
+
+/**
+ * @brief 是否编译了进程内PDF渲染
+ * @return 是否可用
+ */
+bool FileProcessor::hasInProcessPdfRenderer()
+{
+#ifdef HAVE_POPPLER_QT
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_POPPLER_QT
+/**
+ * @brief 用poppler-qt6在进程内渲染PDF页面
+ * @param filePath PDF文件路径
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @param maxWidth 最大宽度
+ * @param maxHeight 最大高度
+ * @return 处理结果
+ */
+FileProcessor::ProcessResult FileProcessor::renderPDFInProcess(const QString &filePath, int firstPage, int lastPage,
+                                                              int maxWidth, int maxHeight)
+{
+    ProcessResult result;
+
+    PopplerRenderer renderer(filePath);
+    if (!renderer.isValid()) {
+        result.errorMessage = renderer.errorMessage();
+        return result;
+    }
+
+    const int first = qMax(1, firstPage);
+    const int last = lastPage > 0 ? qMin(lastPage, renderer.pageCount()) : renderer.pageCount();
+    const int pages = last - first + 1;
+    if (pages <= 0) {
+        result.errorMessage = QString("PDF文件中没有第%1页").arg(first);
+        return result;
+    }
+
+    PdfInfo info;
+    info.pageCount = renderer.pageCount();
+    info.pageSize = renderer.pageSize(first - 1);
+    const int jobs = renderConcurrency(info, pages);
+    emit progressUpdated(15, 0, pages);
+
+    // 各线程按页码依次领取页面，写入各自页面的位置
+    QList<QImage> images(pages);
+    QImage *pageImages = images.data();
+    QAtomicInt nextPage(first);
+    auto renderPages = [&](const PopplerRenderer &pageRenderer) {
+        for (int page = nextPage.fetchAndAddRelaxed(1); page <= last; page = nextPage.fetchAndAddRelaxed(1)) {
+            OCRMetrics::ScopedTimer renderTimer("pdf_render_page", page - 1);
+            pageImages[page - first] = pageRenderer.renderPage(page - 1, s_renderDpi, s_renderGrayscale,
+                                                               maxWidth, maxHeight);
+        }
+    };
+
+    // 调用线程也参与渲染；其余线程不占用全局线程池，避免与加载和识别任务互相等待
+    std::vector<std::unique_ptr<QThread>> workers;
+    for (int i = 1; i < jobs; ++i) {
+        workers.emplace_back(QThread::create([&filePath, &renderPages]() {
+            PopplerRenderer workerRenderer(filePath);
+            if (workerRenderer.isValid()) {
+                renderPages(workerRenderer);
+            }
+        }));
+        workers.back()->start();
+    }
+    renderPages(renderer);
+    for (const std::unique_ptr<QThread> &worker : workers) {
+        worker->wait();
+    }
+
+    for (int i = 0; i < pages; ++i) {
+        if (images.at(i).isNull()) {
+            qDebug() << "Poppler渲染第" << first + i << "页失败，只返回此前的页面";
+            break;
+        }
+        // 分辨率已按最大尺寸计算，这里只修正取整造成的少量超出
+        result.images.append(resizeImage(images.at(i), maxWidth, maxHeight));
+        result.pageNames.append(QString("页面 %1").arg(first + i));
+        emit progressUpdated(50 + (50 * (i + 1)) / pages, i + 1, pages);
+    }
+
+    result.pageCount = result.images.size();
+    result.success = !result.images.isEmpty();
+    if (!result.success) {
+        result.errorMessage = QString("无法渲染PDF文件的第%1页").arg(first);
+    }
+    return result;
+}
+#endif
+
+/**
+ * @brief 加载pdftoppm渲染得到的页面图像
+ * @param imageFiles 图像文件路径列表
+ * @param firstPage 第一个文件对应的页码
+ * @param maxWidth 最大宽度
+ * @param maxHeight 最大高度
+ * @return 处理结果
+ */
+FileProcessor::ProcessResult FileProcessor::loadRenderedPages(const QStringList &imageFiles, int firstPage,
+                                                             int maxWidth, int maxHeight)
+{
+    ProcessResult result;
+
     for (int i = 0; i < imageFiles.size(); ++i) {
         const QString &imageFile = imageFiles[i];
-        QImage image(imageFile);
+        const int pageIndex = firstPage - 1 + i;
+        QImage image;
+        {
+            OCRMetrics::ScopedTimer decodeTimer("image_decode", pageIndex);
+            image.load(imageFile);
+        }
+        OCRMetrics::increment("bytes_read", QFileInfo(imageFile).size());
 
         if (!image.isNull()) {
             // 调整图像大小（如果需要）
             if ((maxWidth > 0 || maxHeight > 0) &&
                 (image.width() > maxWidth || image.height() > maxHeight)) {
+                OCRMetrics::ScopedTimer resizeTimer("image_resize", pageIndex);
                 image = resizeImage(image, maxWidth, maxHeight);
             }
 
             result.images.append(image);
-            result.pageNames.append(QString("页面 %1").arg(i + 1));
+            result.pageNames.append(QString("页面 %1").arg(pageIndex + 1));
         }
 
         emit progressUpdated(50 + (50 * (i + 1)) / imageFiles.size(), i + 1, imageFiles.size());
     }
 
-    // 清理临时文件
-    cleanupTempFiles(imageFiles);
-    QDir(outputDir).removeRecursively();
-
-    // 设置结果
-    result.success = !result.images.isEmpty();
     result.pageCount = result.images.size();
-
-    if (!result.success) {
-        result.errorMessage = "无法从PDF文件中提取图像";
-    }
-
     return result;
 }
 
@@ -337,76 +1134,165 @@ QImage FileProcessor::resizeImage(const QImage &image, int maxWidth, int maxHeig
 }
 
 /**
- * @brief 使用Poppler将PDF转换为图像
+ * @brief 计算渲染一段页面时的并发进程数
+ * @param info 文档信息
+ * @param pages 待渲染的页数
+ * @return 并发进程数
+ */
+int FileProcessor::renderConcurrency(const PdfInfo &info, int pages)
+{
+    // 默认只用一半的核：流式识别时渲染与识别同时进行
+    int jobs = s_renderJobs > 0 ? s_renderJobs : qMax(1, QThread::idealThreadCount() / 2);
+    jobs = qMin(jobs, pages);
+
+    if (jobs > 1 && s_renderMemoryBudget > 0) {
+        // pdftoppm逐页渲染，每个进程同一时刻只持有一页位图；按每像素4字节估算，
+        // 再加上与位图相当的页面解析和PNG编码开销。页面尺寸未知时按Letter估算
+        const QSizeF pageSize = info.pageSize.isEmpty() ? QSizeF(612, 792) : info.pageSize;
+        const double pixels = (pageSize.width() * s_renderDpi / 72.0) * (pageSize.height() * s_renderDpi / 72.0);
+        const qint64 bytesPerProcess = qMax<qint64>(1, qint64(pixels * 4 * 2));
+        jobs = int(qMin<qint64>(jobs, qMax<qint64>(1, s_renderMemoryBudget / bytesPerProcess)));
+    }
+
+    return qMax(1, jobs);
+}
+
+/**
+ * @brief 渲染PDF页面，条件允许时按页码区间并行渲染
  * @param pdfPath PDF文件路径
  * @param outputDir 输出目录
- * @return 转换得到的图像文件路径列表
+ * @param info 文档信息
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @return 按页码排序的图像文件路径列表
  */
-QStringList FileProcessor::convertPDFToImagesWithPoppler(const QString &pdfPath, const QString &outputDir)
+QStringList FileProcessor::renderPDFPages(const QString &pdfPath, const QString &outputDir, const PdfInfo &info,
+                                          int firstPage, int lastPage)
 {
-    QStringList imageFiles;
-    QProcess popplerProcess;
-    QString outputPrefix = outputDir + "/page";
-
-    // 构建Poppler pdftoppm命令（高质量PNG输出）
-    QStringList arguments;
-    arguments << "-png";                              // PNG格式输出
-    arguments << "-r" << "200";                       // 分辨率200 DPI（高质量）
-    arguments << "-aa" << "yes";                      // 开启抗锯齿
-    arguments << "-aaVector" << "yes";                // 矢量图形抗锯齿
-    arguments << pdfPath;                             // 输入PDF文件
-    arguments << outputPrefix;                        // 输出文件前缀
+    const int first = firstPage > 0 ? firstPage : 1;
+    const int last = lastPage > 0 ? qMin(lastPage, info.pageCount) : info.pageCount;
+    const int pages = info.pageCount > 0 ? last - first + 1 : 0;
+    const int jobs = pages > 1 ? renderConcurrency(info, pages) : 1;
+    if (jobs <= 1) {
+        return convertPDFToImagesWithPoppler(pdfPath, outputDir, firstPage, lastPage);
+    }
 
-    qDebug() << "Poppler命令:" << m_popplerPath << arguments.join(" ");
+    // 区间数为并发数的两倍：先结束的进程接着渲染剩余区间，各页复杂度不均时负载更平衡。
+    // pdftoppm按文档总页数补零生成文件名，各区间写入同一目录后仍可按页码排序
+    const int rangeCount = qMin(pages, jobs * 2);
+    QList<QPair<int, int>> ranges;
+    for (int i = 0; i < rangeCount; ++i) {
+        ranges.append(qMakePair(first + (pages * i) / rangeCount, first + (pages * (i + 1)) / rangeCount - 1));
+    }
+    qDebug() << "PDF并行渲染:" << pages << "页，" << rangeCount << "个区间，并发进程数" << jobs;
+    OCRMetrics::increment("pdf_render_processes", rangeCount);
     emit progressUpdated(15, 0, 0);
 
-    popplerProcess.start(m_popplerPath, arguments);
-
-    // 监控转换进程
-    if (popplerProcess.waitForStarted(10000)) {
-        emit progressUpdated(20, 0, 0);
-        qDebug() << "Poppler进程已启动";
+    struct RunningRange {
+        std::unique_ptr<QProcess> process;  // pdftoppm进程
+        QElapsedTimer elapsed;              // 已运行时间
+        QPair<int, int> pages;              // 页码区间
+    };
+    std::vector<RunningRange> running;
+    int nextRange = 0;
+    int finishedRanges = 0;
+    bool failed = false;
+
+    while (!failed && (nextRange < ranges.size() || !running.empty())) {
+        // 补足并发进程
+        while (!failed && int(running.size()) < jobs && nextRange < ranges.size()) {
+            RunningRange range;
+            range.pages = ranges.at(nextRange++);
+            range.process.reset(new QProcess);
+            range.process->start(m_popplerPath, popplerArguments(pdfPath, outputDir, range.pages.first, range.pages.second));
+            if (!range.process->waitForStarted(10000)) {
+                qDebug() << "无法启动Poppler进程:" << range.process->errorString();
+                failed = true;
+                break;
+            }
+            range.elapsed.start();
+            running.push_back(std::move(range));
+        }
 
-        // 等待进程完成，期间更新进度
-        int elapsedTime = 0;
-        const int maxWaitTime = 60000; // 60秒超时时间
-        while (popplerProcess.state() == QProcess::Running && elapsedTime < maxWaitTime) {
-            popplerProcess.waitForFinished(2000);  // 等待2秒
-            elapsedTime += 2000;
+        // 轮询各进程，结束的区间检查退出状态
+        for (auto it = running.begin(); !failed && it != running.end();) {
+            QProcess *process = it->process.get();
+            process->waitForFinished(20);
+            if (process->state() != QProcess::NotRunning) {
+                if (it->elapsed.elapsed() > PDF_RENDER_TIMEOUT) {
+                    qDebug() << "Poppler进程超时，页码区间:" << it->pages.first << "-" << it->pages.second;
+                    failed = true;
+                }
+                ++it;
+                continue;
+            }
 
-            // 根据时间估算进度 (20% -> 35%)
-            int estimatedProgress = 20 + (15 * elapsedTime) / maxWaitTime;
-            emit progressUpdated(estimatedProgress, 0, 0);
+            if (process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0) {
+                qDebug() << "Poppler渲染第" << it->pages.first << "-" << it->pages.second << "页失败:"
+                         << QString::fromLocal8Bit(process->readAllStandardError());
+                failed = true;
+            }
+            it = running.erase(it);
+            finishedRanges++;
+            emit progressUpdated(20 + (15 * finishedRanges) / rangeCount, 0, 0);
         }
-    } else {
-        qDebug() << "无法启动Poppler进程:" << popplerProcess.errorString();
-        return imageFiles;
     }
 
-    // 如果进程仍在运行，终止它
-    if (popplerProcess.state() == QProcess::Running) {
-        qDebug() << "Poppler进程超时，正在终止...";
-        popplerProcess.terminate();
-        if (!popplerProcess.waitForFinished(5000)) {
-            popplerProcess.kill();
-            popplerProcess.waitForFinished(3000);
+    // 任一区间失败时整段结果不可用，终止其余进程
+    if (failed) {
+        for (RunningRange &range : running) {
+            range.process->kill();
+            range.process->waitForFinished(3000);
         }
+        return QStringList();
     }
 
-    // 检查进程执行结果
-    int exitCode = popplerProcess.exitCode();
-    QProcess::ExitStatus exitStatus = popplerProcess.exitStatus();
+    emit progressUpdated(35, 0, 0);
 
-    qDebug() << "Poppler进程退出码:" << exitCode;
-    qDebug() << "Poppler进程退出状态:" << exitStatus;
+    const QStringList imageFiles = collectRenderedPages(outputDir);
+    qDebug() << "PDF并行渲染完成，共生成" << imageFiles.size() << "个图像文件";
+    return imageFiles;
+}
 
-    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
-        QString errorOutput = QString::fromLocal8Bit(popplerProcess.readAllStandardError());
-        qDebug() << "Poppler错误输出:" << errorOutput;
-        return imageFiles;
+/**
+ * @brief 生成pdftoppm命令行参数
+ * @param pdfPath PDF文件路径
+ * @param outputDir 输出目录
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @return 参数列表
+ */
+QStringList FileProcessor::popplerArguments(const QString &pdfPath, const QString &outputDir,
+                                            int firstPage, int lastPage)
+{
+    // 构建Poppler pdftoppm命令（高质量PNG输出）
+    QStringList arguments;
+    arguments << "-png";                              // PNG格式输出
+    arguments << "-r" << QString::number(s_renderDpi);    // 分辨率（默认200 DPI）
+    if (s_renderGrayscale) {
+        arguments << "-gray";                         // 灰度输出
     }
+    arguments << "-aa" << "yes";                      // 开启抗锯齿
+    arguments << "-aaVector" << "yes";                // 矢量图形抗锯齿
+    if (firstPage > 0) {
+        arguments << "-f" << QString::number(firstPage);  // 起始页码
+    }
+    if (lastPage > 0) {
+        arguments << "-l" << QString::number(lastPage);   // 结束页码
+    }
+    arguments << pdfPath;                             // 输入PDF文件
+    arguments << outputDir + "/page";                 // 输出文件前缀
+    return arguments;
+}
 
-    emit progressUpdated(35, 0, 0);
+/**
+ * @brief 收集输出目录中pdftoppm生成的图像文件
+ * @param outputDir 输出目录
+ * @return 按页码排序的图像文件路径列表
+ */
+QStringList FileProcessor::collectRenderedPages(const QString &outputDir)
+{
+    QStringList imageFiles;
 
     // 查找生成的图像文件
     QDir dir(outputDir);
@@ -456,32 +1342,89 @@ QStringList FileProcessor::convertPDFToImagesWithPoppler(const QString &pdfPath,
         }
     }
 
-    qDebug() << "PDF转换完成，共生成" << imageFiles.size() << "个图像文件";
+
     return imageFiles;
 }
 
 /**
- * @brief 检查Poppler是否可用
- * @return 是否可用
+ * @brief 使用Poppler将PDF转换为图像
+ * @param pdfPath PDF文件路径
+ * @param outputDir 输出目录
+ * @param firstPage 起始页码
+ * @param lastPage 结束页码
+ * @return 转换得到的图像文件路径列表
  */
-bool FileProcessor::isPopplerAvailable()
+QStringList FileProcessor::convertPDFToImagesWithPoppler(const QString &pdfPath, const QString &outputDir,
+                                                          int firstPage, int lastPage)
 {
-    QProcess testProcess;
-    testProcess.start(m_popplerPath, QStringList() << "-h");
+    QStringList imageFiles;
+    QProcess popplerProcess;
+    const QStringList arguments = popplerArguments(pdfPath, outputDir, firstPage, lastPage);
+
+    qDebug() << "Poppler命令:" << m_popplerPath << arguments.join(" ");
+    emit progressUpdated(15, 0, 0);
+
+    popplerProcess.start(m_popplerPath, arguments);
+
+    // 监控转换进程
+    if (popplerProcess.waitForStarted(10000)) {
+        emit progressUpdated(20, 0, 0);
+        qDebug() << "Poppler进程已启动";
 
-    bool result = testProcess.waitForFinished(10000) &&
-                  testProcess.exitCode() == 0;
+        // 等待进程完成，期间更新进度
+        int elapsedTime = 0;
+        const int maxWaitTime = PDF_RENDER_TIMEOUT;
+        while (popplerProcess.state() == QProcess::Running && elapsedTime < maxWaitTime) {
+            popplerProcess.waitForFinished(2000);  // 等待2秒
+            elapsedTime += 2000;
 
-    if (result) {
-        QString output = QString::fromLocal8Bit(testProcess.readAllStandardOutput());
-        qDebug() << "Poppler版本信息:" << output.split('\n').first();
+            // 根据时间估算进度 (20% -> 35%)
+            int estimatedProgress = 20 + (15 * elapsedTime) / maxWaitTime;
+            emit progressUpdated(estimatedProgress, 0, 0);
+        }
     } else {
-        QString errorOutput = QString::fromLocal8Bit(testProcess.readAllStandardError());
-        qDebug() << "Poppler不可用:" << testProcess.errorString();
-        qDebug() << "错误输出:" << errorOutput;
+        qDebug() << "无法启动Poppler进程:" << popplerProcess.errorString();
+        return imageFiles;
     }
 
-    return result;
+    // 如果进程仍在运行，终止它
+    if (popplerProcess.state() == QProcess::Running) {
+        qDebug() << "Poppler进程超时，正在终止...";
+        popplerProcess.terminate();
+        if (!popplerProcess.waitForFinished(5000)) {
+            popplerProcess.kill();
+            popplerProcess.waitForFinished(3000);
+        }
+    }
+
+    // 检查进程执行结果
+    int exitCode = popplerProcess.exitCode();
+    QProcess::ExitStatus exitStatus = popplerProcess.exitStatus();
+
+    qDebug() << "Poppler进程退出码:" << exitCode;
+    qDebug() << "Poppler进程退出状态:" << exitStatus;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        QString errorOutput = QString::fromLocal8Bit(popplerProcess.readAllStandardError());
+        qDebug() << "Poppler错误输出:" << errorOutput;
+        return imageFiles;
+    }
+
+    emit progressUpdated(35, 0, 0);
+
+    imageFiles = collectRenderedPages(outputDir);
+    qDebug() << "PDF转换完成，共生成" << imageFiles.size() << "个图像文件";
+    return imageFiles;
+}
+
+/**
+ * @brief 检查Poppler是否可用
+ * @return 是否可用
+ */
+bool FileProcessor::isPopplerAvailable()
+{
+    // 探测结果按可执行文件缓存，只有pdftoppm被替换或升级后才会重新执行"pdftoppm -h"
+    return ToolRegistry::pdftoppm(m_popplerPath).available;
 }
 
 /**
@@ -501,6 +1444,21 @@ void FileProcessor::cleanupTempFiles(const QStringList &filePaths)
     m_tempFiles.clear();
 }
 
+/**
+ * @brief 获取与pdftoppm位于同一目录的其他Poppler工具路径
+ * @param toolName 工具名称
+ * @return 可执行文件路径
+ */
+QString FileProcessor::popplerToolPath(const QString &toolName) const
+{
+    QFileInfo popplerInfo(m_popplerPath);
+    if (!popplerInfo.isAbsolute()) {
+        return toolName;
+    }
+    QString suffix = popplerInfo.suffix().isEmpty() ? QString() : "." + popplerInfo.suffix();
+    return popplerInfo.absoluteDir().filePath(toolName + suffix);
+}
+
 /**
  * @brief 获取Poppler pdftoppm可执行文件路径
  * @return Poppler pdftoppm可执行文件路径
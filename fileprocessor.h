@@ -5,6 +5,8 @@
 #include <QImage>
 #include <QStringList>
 #include <QFileInfo>
+#include <QSizeF>
+#include <QMap>
 
 /**
  * @brief 文件处理器类
@@ -32,6 +34,14 @@ public:
         UNKNOWN         // 未知格式
     };
 
+    /**
+     * @brief PDF渲染后端
+     */
+    enum PdfBackend {
+        PDF_BACKEND_AUTO,       // 编译了poppler-qt6时进程内渲染，失败时改用pdftoppm
+        PDF_BACKEND_PDFTOPPM    // 始终调用pdftoppm
+    };
+
     /**
      * @brief 文件处理结果结构体
      */
@@ -41,10 +51,33 @@ public:
         QString errorMessage;       // 错误信息
         int pageCount;              // 页面数量（对于PDF）
         QStringList pageNames;      // 页面名称列表
+        QStringList extractedTexts; // 从PDF文本层提取的文本（与images一一对应，为空的页面需要识别，不为空的页面图像为空；没有文本层时整个列表为空）
 
         ProcessResult() : success(false), pageCount(0) {}
     };
 
+    /**
+     * @brief PDF文本层提取选项
+     */
+    struct TextLayerOptions {
+        bool enabled;           // 是否直接使用PDF文本层（通过检查的页面不再识别）
+        int minCharacters;      // 非空白字符少于该值的页面视为没有文本层（如扫描页上只有页眉页码）
+        double minValidRatio;   // 可显示字符占非空白字符的最低比例（字体编码损坏时会提取出乱码）
+        double minImagePageDensity; // 铺满页面的扫描图像上的文本层每平方英寸至少的非空白字符数（0表示不检查）
+
+        TextLayerOptions() : enabled(true), minCharacters(20), minValidRatio(0.9), minImagePageDensity(3.0) {}
+    };
+
+    /**
+     * @brief pdfinfo读取的PDF文档信息
+     */
+    struct PdfInfo {
+        int pageCount;          // 页数（-1表示未知）
+        QSizeF pageSize;        // 第一页的页面尺寸（单位为point，未知时为空）
+
+        PdfInfo() : pageCount(-1) {}
+    };
+
     explicit FileProcessor(QObject *parent = nullptr);
 
     /**
@@ -97,6 +130,9 @@ public:
 
     /**
      * @brief 处理PDF文件
+     *
+     * 文本层可以直接使用的页面不渲染，在images中对应空图像、在extractedTexts中对应其文本；
+     * 需要显示这些页面时用processPDFPages按页渲染。
      * @param filePath PDF文件路径
      * @param maxWidth 最大宽度
      * @param maxHeight 最大高度
@@ -106,6 +142,101 @@ public:
                                 int maxWidth = 0,
                                 int maxHeight = 0);
 
+    /**
+     * @brief 加载PDF文件中的一段页面
+     *
+     * 只处理firstPage到lastPage的页面，供逐段渲染、边渲染边识别的流式处理使用。
+     * 整页只有一张扫描图像的页面直接提取原图（见extractEmbeddedImages），其余页面渲染（-f/-l）。
+     * 页面名称按页码生成；某页加载失败时只返回此前的页面，页码超出文档页数时返回失败。
+     * @param filePath PDF文件路径
+     * @param firstPage 起始页码（从1开始）
+     * @param lastPage 结束页码（含）
+     * @param maxWidth 最大宽度
+     * @param maxHeight 最大高度
+     * @return 处理结果
+     */
+    ProcessResult processPDFPages(const QString &filePath,
+                                  int firstPage,
+                                  int lastPage,
+                                  int maxWidth = 0,
+                                  int maxHeight = 0,
+                                  const PdfInfo &info = PdfInfo());
+
+    /**
+     * @brief 用pdfinfo读取PDF文件的页数和页面尺寸
+     * @param filePath PDF文件路径
+     * @return 文档信息，pdfinfo不可用或读取失败时页数为-1
+     */
+    PdfInfo readPdfInfo(const QString &filePath);
+
+    /**
+     * @brief 设置PDF并行渲染的并发数和内存预算（对所有FileProcessor生效，应在开始处理前设置）
+     *
+     * pdftoppm是单线程的。已知页数时，文档被切分为若干页码区间，由多个pdftoppm进程同时渲染，
+     * 渲染结果按页码重新排序。并发进程数不超过jobs，也不超过内存预算按页面尺寸估算可容纳的进程数。
+     * @param jobs 最大并发进程数（0表示CPU核数的一半，1表示不并行）
+     * @param memoryBudget 所有渲染进程合计的内存预算（字节，0表示不限制）
+     */
+    static void setRenderLimits(int jobs, qint64 memoryBudget);
+
+    /**
+     * @brief 提取PDF文件各页的文本层
+     *
+     * 编译了poppler-qt6时从文档直接读取，否则调用pdftotext -layout，按换页符拆分为各页文本。
+     * 没有通过isUsableTextLayer检查的页面对应空字符串。有铺满页面的扫描图像的页面（见findFullPageImages），
+     * 文本层往往只是印章或页眉，按页面面积计算的字符密度低于minImagePageDensity时同样为空字符串。
+     * @param filePath PDF文件路径
+     * @param firstPage 起始页码（从1开始）
+     * @param lastPage 结束页码（0表示到最后一页）
+     * @return 每页的文本，提取失败或未启用时为空列表
+     */
+    QStringList extractTextLayer(const QString &filePath, int firstPage = 1, int lastPage = 0);
+
+    /**
+     * @brief 检查提取的文本层是否可以代替识别
+     * @param text 页面文本
+     * @param options 提取选项
+     * @return 是否可用
+     */
+    static bool isUsableTextLayer(const QString &text, const TextLayerOptions &options);
+
+    /**
+     * @brief 设置PDF文本层提取选项（对所有FileProcessor生效，应在开始处理前设置）
+     * @param options 提取选项
+     */
+    static void setTextLayerOptions(const TextLayerOptions &options);
+
+    /**
+     * @brief 设置是否直接提取扫描页的嵌入图像（对所有FileProcessor生效，应在开始处理前设置）
+     * @param enabled 是否提取（默认启用）
+     */
+    static void setEmbeddedImageExtraction(bool enabled);
+
+    /**
+     * @brief 获取PDF文本层提取选项
+     * @return 提取选项
+     */
+    static TextLayerOptions textLayerOptions();
+
+    /**
+     * @brief 设置PDF渲染分辨率和颜色（对所有FileProcessor生效，应在开始处理前设置）
+     * @param dpi 渲染分辨率（默认200）
+     * @param grayscale 是否渲染为灰度图像（默认彩色）
+     */
+    static void setRenderOptions(int dpi, bool grayscale);
+
+    /**
+     * @brief 设置PDF渲染后端（对所有FileProcessor生效，应在开始处理前设置）
+     * @param backend 渲染后端
+     */
+    static void setPdfBackend(PdfBackend backend);
+
+    /**
+     * @brief 是否编译了进程内PDF渲染（poppler-qt6）
+     * @return 是否可用
+     */
+    static bool hasInProcessPdfRenderer();
+
     /**
      * @brief 调整图像大小（保持宽高比）
      * @param image 原始图像
@@ -141,9 +272,125 @@ private:
      * @brief 使用Poppler转换PDF为图像
      * @param pdfPath PDF文件路径
      * @param outputDir 输出目录
+     * @param firstPage 起始页码（0表示从第一页开始）
+     * @param lastPage 结束页码（0表示到最后一页）
      * @return 转换得到的图像文件路径列表
      */
-    QStringList convertPDFToImagesWithPoppler(const QString &pdfPath, const QString &outputDir);
+    QStringList convertPDFToImagesWithPoppler(const QString &pdfPath, const QString &outputDir,
+                                              int firstPage = 0, int lastPage = 0);
+
+    /**
+     * @brief 渲染并加载PDF文件中的一段页面（进程内渲染，失败时改用pdftoppm）
+     * @param filePath PDF文件路径
+     * @param firstPage 起始页码
+     * @param lastPage 结束页码
+     * @param maxWidth 最大宽度
+     * @param maxHeight 最大高度
+     * @param info 文档信息
+     * @return 处理结果
+     */
+    ProcessResult rasterizePDFPages(const QString &filePath, int firstPage, int lastPage,
+                                    int maxWidth, int maxHeight, const PdfInfo &info);
+
+    /**
+     * @brief 直接提取整页扫描图像
+     *
+     * 扫描仪生成的PDF每页只有一张铺满页面的JPEG/CCITT/JBIG2图像，按200 DPI重新渲染既费时又会重采样。
+     * 先用"pdfimages -list"找出只有一张图像、且图像按其分辨率换算后铺满页面的页面，
+     * 再用pdfimages按原始分辨率取出（JPEG保持原样，其他编码解码为PNG）。
+     * 叠加了矢量内容（批注、印章、文字）或图像经过旋转、反色的页面与原图不一致，
+     * 因此每页还要与低分辨率渲染的缩略图比较，差异过大的页面不使用提取的图像。
+     * @param filePath PDF文件路径
+     * @param firstPage 起始页码
+     * @param lastPage 结束页码
+     * @param info 文档信息（用于检查图像是否铺满页面）
+     * @return 页码到页面图像的映射，未启用或没有可提取的页面时为空
+     */
+    QMap<int, QImage> extractEmbeddedImages(const QString &filePath, int firstPage, int lastPage,
+                                            const PdfInfo &info);
+
+    /**
+     * @brief 用"pdfimages -list"找出有铺满页面的图像的页面
+     * @param filePath PDF文件路径
+     * @param firstPage 起始页码
+     * @param lastPage 结束页码
+     * @param info 文档信息（页面尺寸未知时任何图像都视为铺满页面）
+     * @return 页码到该页图像数（含软遮罩等）的映射，只包含有铺满页面的图像的页面；pdfimages不可用时为空
+     */
+    QMap<int, int> findFullPageImages(const QString &filePath, int firstPage, int lastPage, const PdfInfo &info);
+
+#ifdef HAVE_POPPLER_QT
+    /**
+     * @brief 用poppler-qt6在进程内渲染PDF页面
+     *
+     * 页面直接渲染到QImage，不经过临时PNG文件。已知页数时由多个线程同时渲染，
+     * 每个线程各自打开文档，按页码依次领取页面；并发数与pdftoppm并行渲染相同。
+     * 某页渲染失败时只返回此前的页面。
+     * @param filePath PDF文件路径
+     * @param firstPage 起始页码（从1开始）
+     * @param lastPage 结束页码（0表示到最后一页）
+     * @param maxWidth 最大宽度
+     * @param maxHeight 最大高度
+     * @return 处理结果
+     */
+    ProcessResult renderPDFInProcess(const QString &filePath, int firstPage, int lastPage,
+                                     int maxWidth, int maxHeight);
+#endif
+
+    /**
+     * @brief 渲染PDF页面，条件允许时按页码区间并行渲染
+     * @param pdfPath PDF文件路径
+     * @param outputDir 输出目录
+     * @param info 文档信息（页数未知时不并行）
+     * @param firstPage 起始页码（0表示从第一页开始）
+     * @param lastPage 结束页码（0表示到最后一页）
+     * @return 按页码排序的图像文件路径列表，任一区间失败时为空
+     */
+    QStringList renderPDFPages(const QString &pdfPath, const QString &outputDir, const PdfInfo &info,
+                               int firstPage = 0, int lastPage = 0);
+
+    /**
+     * @brief 计算渲染一段页面时的并发进程数
+     * @param info 文档信息
+     * @param pages 待渲染的页数
+     * @return 并发进程数（至少为1）
+     */
+    static int renderConcurrency(const PdfInfo &info, int pages);
+
+    /**
+     * @brief 生成pdftoppm命令行参数
+     * @param pdfPath PDF文件路径
+     * @param outputDir 输出目录
+     * @param firstPage 起始页码（0表示从第一页开始）
+     * @param lastPage 结束页码（0表示到最后一页）
+     * @return 参数列表
+     */
+    static QStringList popplerArguments(const QString &pdfPath, const QString &outputDir,
+                                        int firstPage, int lastPage);
+
+    /**
+     * @brief 收集输出目录中pdftoppm生成的图像文件
+     * @param outputDir 输出目录
+     * @return 按页码排序的图像文件路径列表
+     */
+    QStringList collectRenderedPages(const QString &outputDir);
+
+    /**
+     * @brief 加载pdftoppm渲染得到的页面图像
+     * @param imageFiles 图像文件路径列表（按页码排序）
+     * @param firstPage 第一个文件对应的页码
+     * @param maxWidth 最大宽度
+     * @param maxHeight 最大高度
+     * @return 处理结果（未设置success和errorMessage）
+     */
+    ProcessResult loadRenderedPages(const QStringList &imageFiles, int firstPage, int maxWidth, int maxHeight);
+
+    /**
+     * @brief 获取与pdftoppm位于同一目录的其他Poppler工具路径
+     * @param toolName 工具名称（如"pdfinfo"）
+     * @return 可执行文件路径（pdftoppm从PATH中查找时返回工具名称本身）
+     */
+    QString popplerToolPath(const QString &toolName) const;
 
     /**
      * @brief 检查Poppler是否可用
@@ -174,6 +421,13 @@ private:
     QString m_popplerPath;          // Poppler pdftoppm安装路径
     static QStringList s_imageExtensions;  // 支持的图像扩展名
     static QStringList s_documentExtensions; // 支持的文档扩展名
+    static int s_renderJobs;               // PDF并行渲染的最大并发进程数（0表示自动）
+    static qint64 s_renderMemoryBudget;    // PDF并行渲染的内存预算（字节，0表示不限制）
+    static int s_renderDpi;                // PDF渲染分辨率
+    static bool s_renderGrayscale;         // PDF是否渲染为灰度图像
+    static PdfBackend s_pdfBackend;        // PDF渲染后端
+    static TextLayerOptions s_textLayerOptions; // PDF文本层提取选项
+    static bool s_extractEmbeddedImages;   // 是否直接提取扫描页的嵌入图像
 };
 
 #endif // FILEPROCESSOR_H
\ No newline at end of file
@@ -0,0 +1,420 @@
+#include "hotfolderprocessor.h"
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+#include <QtConcurrent>
+
+namespace {
+
+const int SCAN_DELAY_MS = 300;  // 目录变化后延迟扫描的时间，合并连续的变化通知
+const int RETRY_DELAY_MS = 30000;   // 有页面失败的文件第一次重试前等待的时间，之后每次加倍
+
+} // namespace
+
+/**
+ * @brief HotFolderProcessor构造函数
+ * @param engines 已初始化的OCR引擎
+ * @param queue 已打开的持久化队列
+ * @param parent 父对象指针
+ */
+HotFolderProcessor::HotFolderProcessor(const QList<OCREngine *> &engines, PersistentJobQueue *queue,
+                                       QObject *parent)
+    : QObject(parent)
+    , m_queue(queue)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_scanTimer(new QTimer(this))
+    , m_settleTimer(new QTimer(this))
+    , m_recursive(false)
+    , m_settleMs(2000)
+{
+    for (OCREngine *engine : engines) {
+        Slot *slot = new Slot;
+        slot->engine = engine;
+        slot->busy = false;
+        slot->loadWatcher = new QFutureWatcher<FileProcessor::ProcessResult>(this);
+        slot->ocrWatcher = new QFutureWatcher<OCREngine::OCRResult>(this);
+
+        connect(slot->loadWatcher, &QFutureWatcher<FileProcessor::ProcessResult>::finished,
+                this, [this, slot]() { onFileLoaded(slot); });
+        connect(slot->ocrWatcher, &QFutureWatcher<OCREngine::OCRResult>::resultReadyAt,
+                this, [this, slot](int resultIndex) { onPageReady(slot, resultIndex); });
+        connect(slot->ocrWatcher, &QFutureWatcher<OCREngine::OCRResult>::finished,
+                this, [this, slot]() { onFileRecognized(slot); });
+
+        m_slots.append(slot);
+    }
+
+    // 扫描不随每次变化通知重新计时，持续大量写入时也能定期扫描
+    m_scanTimer->setSingleShot(true);
+    m_scanTimer->setInterval(SCAN_DELAY_MS);
+    connect(m_scanTimer, &QTimer::timeout, this, &HotFolderProcessor::scanDirectory);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        if (!m_scanTimer->isActive()) {
+            m_scanTimer->start();
+        }
+    });
+
+    connect(m_settleTimer, &QTimer::timeout, this, &HotFolderProcessor::checkCandidates);
+}
+
+/**
+ * @brief HotFolderProcessor析构函数，等待进行中的任务结束
+ *
+ * 进行中的任务保留在队列中，已识别的页面已写入日志，下次启动时继续处理。
+ */
+HotFolderProcessor::~HotFolderProcessor()
+{
+    for (Slot *slot : m_slots) {
+        slot->loadWatcher->waitForFinished();
+        slot->ocrWatcher->cancel();
+        slot->ocrWatcher->waitForFinished();
+        delete slot;
+    }
+}
+
+/**
+ * @brief 开始监视目录
+ * @param directory 监视的目录
+ * @param recursive 是否包括子目录
+ * @param options 识别和输出选项
+ * @param settleMs 写入完成判定时长
+ * @param errorMessage 失败时返回错误信息
+ * @return 是否成功
+ */
+bool HotFolderProcessor::watch(const QString &directory, bool recursive, const BatchRunner::Options &options,
+                               int settleMs, QString *errorMessage)
+{
+    QFileInfo info(directory);
+    if (!info.isDir()) {
+        *errorMessage = QString("监视的目录不存在: %1").arg(directory);
+        return false;
+    }
+
+    m_directory = info.absoluteFilePath();
+    m_recursive = recursive;
+    m_options = options;
+    m_settleMs = qMax(0, settleMs);
+    m_settleTimer->setInterval(qBound(200, m_settleMs / 2, 1000));
+
+    if (!m_watcher->addPath(m_directory)) {
+        *errorMessage = QString("无法监视目录: %1").arg(m_directory);
+        return false;
+    }
+
+    // 先继续上次未完成的任务，再扫描程序停止期间放入的文件
+    dispatch();
+    scanDirectory();
+    return true;
+}
+
+/**
+ * @brief 扫描监视的目录
+ */
+void HotFolderProcessor::scanDirectory()
+{
+    QSet<QString> present;
+    const QStringList watchedDirectories = m_watcher->directories();
+
+    QDirIterator it(m_directory, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable,
+                    m_recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        const QString filePath = it.next();
+        const QFileInfo info = it.fileInfo();
+
+        if (info.isDir()) {
+            if (m_recursive && !watchedDirectories.contains(filePath)) {
+                m_watcher->addPath(filePath);
+            }
+            continue;
+        }
+        if (!FileProcessor::isFileSupported(filePath)) {
+            continue;
+        }
+
+        present.insert(filePath);
+        const qint64 modifiedMs = info.lastModified().toMSecsSinceEpoch();
+        if (m_seen.value(filePath, -1) == modifiedMs || m_candidates.contains(filePath)
+            || m_queue->contains(filePath)) {
+            continue;
+        }
+
+        const QString relativePath = QDir(m_directory).relativeFilePath(filePath);
+        if (isProcessed(filePath, relativePath, modifiedMs)) {
+            m_seen.insert(filePath, modifiedMs);
+            continue;
+        }
+
+        Candidate candidate;
+        candidate.relativePath = relativePath;
+        candidate.size = info.size();
+        candidate.modifiedMs = modifiedMs;
+        candidate.stable.start();
+        m_candidates.insert(filePath, candidate);
+    }
+
+    // 忘记已被移走的文件，同名文件再次放入时重新处理
+    for (auto seen = m_seen.begin(); seen != m_seen.end();) {
+        seen = present.contains(seen.key()) ? std::next(seen) : m_seen.erase(seen);
+    }
+
+    if (!m_candidates.isEmpty() && !m_settleTimer->isActive()) {
+        m_settleTimer->start();
+    }
+}
+
+/**
+ * @brief 检查等待中的文件是否已写入完成
+ */
+void HotFolderProcessor::checkCandidates()
+{
+    for (auto it = m_candidates.begin(); it != m_candidates.end();) {
+        const QString filePath = it.key();
+        const QFileInfo info(filePath);
+        if (!info.exists()) {
+            it = m_candidates.erase(it);
+            continue;
+        }
+
+        // 仍在写入：大小或修改时间变化后重新计时
+        const qint64 modifiedMs = info.lastModified().toMSecsSinceEpoch();
+        if (info.size() != it->size || modifiedMs != it->modifiedMs || info.size() == 0) {
+            it->size = info.size();
+            it->modifiedMs = modifiedMs;
+            it->stable.start();
+            ++it;
+            continue;
+        }
+        if (it->stable.elapsed() < m_settleMs) {
+            ++it;
+            continue;
+        }
+
+        // Windows上写入方独占打开文件时无法读取
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            ++it;
+            continue;
+        }
+        file.close();
+
+        m_queue->enqueue(filePath, it->relativePath, it->size, it->modifiedMs);
+        m_seen.insert(filePath, it->modifiedMs);
+        it = m_candidates.erase(it);
+    }
+
+    if (m_candidates.isEmpty()) {
+        m_settleTimer->stop();
+    }
+    dispatch();
+}
+
+/**
+ * @brief 文件是否已有不旧于它的结果
+ * @param filePath 文件路径
+ * @param relativePath 输出目录中使用的相对路径
+ * @param modifiedMs 文件修改时间
+ * @return 是否已处理
+ */
+bool HotFolderProcessor::isProcessed(const QString &filePath, const QString &relativePath,
+                                     qint64 modifiedMs) const
+{
+    const QFileInfo output(BatchRunner::outputPathFor({filePath, relativePath}, m_options));
+    return output.exists() && output.lastModified().toMSecsSinceEpoch() >= modifiedMs;
+}
+
+/**
+ * @brief 为空闲槽位分配队列中的任务
+ */
+void HotFolderProcessor::dispatch()
+{
+    for (Slot *slot : m_slots) {
+        if (slot->busy) {
+            continue;
+        }
+
+        PersistentJobQueue::Job job;
+        while (m_queue->takeNext(&job)) {
+            if (job.attempts <= MAX_ATTEMPTS) {
+                break;
+            }
+            m_queue->complete(job.id);
+            emit fileFinished(job.filePath, false, QString("已尝试%1次仍未完成，放弃处理").arg(MAX_ATTEMPTS),
+                              m_queue->size());
+            job = PersistentJobQueue::Job();
+        }
+        if (job.id == 0) {
+            return;
+        }
+
+        slot->job = job;
+        slot->busy = true;
+        slot->pageNames.clear();
+        slot->submittedPages.clear();
+        slot->timer.start();
+
+        // 超大图像分块识别（作为一页）；该页上次已识别成功时按普通流程直接写出结果
+        if (!job.finishedPages.contains(0) && BatchRunner::shouldTile(job.filePath, m_options)) {
+            slot->pageNames.append(QFileInfo(job.filePath).baseName());
+            slot->submittedPages.append(0);
+            slot->ocrWatcher->setFuture(BatchRunner::submitTiled(slot->engine, job.filePath, m_options));
+            continue;
+        }
+
+        const QString filePath = job.filePath;
+        const int maxWidth = m_options.maxWidth;
+        const int maxHeight = m_options.maxHeight;
+        const ImagePreprocessor::Options preprocess = m_options.preprocess;
+        slot->loadWatcher->setFuture(QtConcurrent::run([filePath, maxWidth, maxHeight, preprocess]() {
+            FileProcessor processor;
+            FileProcessor::ProcessResult result = processor.processFile(filePath, maxWidth, maxHeight);
+            ImagePreprocessor::processAll(result.images, preprocess);
+            return result;
+        }));
+    }
+}
+
+/**
+ * @brief 文件加载完成，提交尚未识别的页面
+ * @param slot 槽位
+ */
+void HotFolderProcessor::onFileLoaded(Slot *slot)
+{
+    const FileProcessor::ProcessResult loaded = slot->loadWatcher->result();
+    slot->loadWatcher->setFuture(QFuture<FileProcessor::ProcessResult>());
+
+    if (!loaded.success || loaded.images.isEmpty()) {
+        finishJob(slot, false, loaded.errorMessage.isEmpty() ? "文件中没有可识别的页面" : loaded.errorMessage);
+        return;
+    }
+
+    slot->pageNames = loaded.pageNames;
+    while (slot->pageNames.size() < loaded.images.size()) {
+        slot->pageNames.append(QString("第%1页").arg(slot->pageNames.size() + 1));
+    }
+
+    // 上次运行中已识别成功的页面不再识别
+    QList<QImage> images;
+    QStringList extractedTexts;
+    for (int i = 0; i < loaded.images.size(); ++i) {
+        if (!slot->job.finishedPages.contains(i)) {
+            slot->submittedPages.append(i);
+            images.append(loaded.images.at(i));
+            extractedTexts.append(loaded.extractedTexts.value(i));
+        }
+    }
+    if (loaded.extractedTexts.isEmpty()) {
+        extractedTexts.clear();
+    }
+
+    if (images.isEmpty()) {
+        onFileRecognized(slot);
+        return;
+    }
+    slot->ocrWatcher->setFuture(slot->engine->submitDocument(images, extractedTexts, m_options.language));
+}
+
+/**
+ * @brief 某页识别完成，记入队列日志
+ * @param slot 槽位
+ * @param resultIndex 识别结果下标
+ */
+void HotFolderProcessor::onPageReady(Slot *slot, int resultIndex)
+{
+    if (resultIndex < 0 || resultIndex >= slot->submittedPages.size()) {
+        return;
+    }
+
+    const OCREngine::OCRResult result = slot->ocrWatcher->resultAt(resultIndex);
+    if (result.success) {
+        const int pageIndex = slot->submittedPages.at(resultIndex);
+        slot->job.finishedPages.insert(pageIndex, result);
+        m_queue->recordPage(slot->job.id, pageIndex, result);
+    }
+}
+
+/**
+ * @brief 所有页面识别完成，写出结果
+ * @param slot 槽位
+ */
+void HotFolderProcessor::onFileRecognized(Slot *slot)
+{
+    QFuture<OCREngine::OCRResult> future = slot->ocrWatcher->future();
+    slot->ocrWatcher->setFuture(QFuture<OCREngine::OCRResult>());
+
+    // 提交识别但失败的页面保留错误信息
+    QHash<int, OCREngine::OCRResult> failedPages;
+    for (int i = 0; i < slot->submittedPages.size(); ++i) {
+        const int pageIndex = slot->submittedPages.at(i);
+        if (slot->job.finishedPages.contains(pageIndex)) {
+            continue;
+        }
+        OCREngine::OCRResult pageResult;
+        if (future.isValid() && future.isResultReadyAt(i)) {
+            pageResult = future.resultAt(i);
+        }
+        if (pageResult.errorMessage.isEmpty()) {
+            pageResult.errorMessage = "识别未完成";
+        }
+        failedPages.insert(pageIndex, pageResult);
+    }
+
+    // 有页面失败且还可以重试时保留任务，下次只识别失败的页面
+    // 立即重试通常会因同样的原因（资源不足、文件仍被占用等）再次失败，等待期间先处理其他文件
+    if (!failedPages.isEmpty() && slot->job.attempts < MAX_ATTEMPTS) {
+        const int retryDelayMs = RETRY_DELAY_MS << qMax(0, slot->job.attempts - 1);
+        slot->busy = false;
+        m_queue->release(slot->job.id, retryDelayMs);
+        emit fileFinished(slot->job.filePath, false,
+                          QString("%1页识别失败，%2秒后重试").arg(failedPages.size()).arg(retryDelayMs / 1000),
+                          m_queue->size());
+        slot->job = PersistentJobQueue::Job();
+        QTimer::singleShot(retryDelayMs, this, [this]() { dispatch(); });
+        dispatch();
+        return;
+    }
+
+    QList<OCREngine::OCRResult> pageResults;
+    for (int i = 0; i < slot->pageNames.size(); ++i) {
+        pageResults.append(slot->job.finishedPages.contains(i) ? slot->job.finishedPages.value(i)
+                                                               : failedPages.value(i));
+    }
+
+    QString errorMessage;
+    const qint64 elapsedMs = slot->timer.elapsed();
+    const BatchRunner::InputFile file = {slot->job.filePath, slot->job.relativePath};
+    if (!BatchRunner::writeResult(file, m_options, pageResults, slot->pageNames, elapsedMs, &errorMessage)) {
+        finishJob(slot, false, errorMessage);
+        return;
+    }
+
+    QString message = QString("%1页，%2秒").arg(pageResults.size()).arg(elapsedMs / 1000.0, 0, 'f', 1);
+    if (slot->submittedPages.size() < pageResults.size()) {
+        message += QString("，%1页沿用上次的结果").arg(pageResults.size() - slot->submittedPages.size());
+    }
+    if (!failedPages.isEmpty()) {
+        message += QString("，%1页识别失败").arg(failedPages.size());
+    }
+    finishJob(slot, failedPages.isEmpty(), message);
+}
+
+/**
+ * @brief 结束当前任务并继续分配
+ * @param slot 槽位
+ * @param success 是否成功
+ * @param message 结果说明
+ */
+void HotFolderProcessor::finishJob(Slot *slot, bool success, const QString &message)
+{
+    const QString filePath = slot->job.filePath;
+    m_queue->complete(slot->job.id);
+    slot->busy = false;
+    slot->job = PersistentJobQueue::Job();
+
+    emit fileFinished(filePath, success, message, m_queue->size());
+    dispatch();
+}
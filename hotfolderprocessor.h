@@ -0,0 +1,156 @@
+#ifndef HOTFOLDERPROCESSOR_H
+#define HOTFOLDERPROCESSOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include "batchrunner.h"
+#include "persistentjobqueue.h"
+
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * @brief 监视文件夹并自动识别放入的文件
+ *
+ * 通过QFileSystemWatcher监视目录（可包括子目录），目录变化后延迟合并扫描，
+ * 新出现的受支持文件在大小和修改时间保持不变一段时间且可以打开后才视为写入完成，
+ * 然后加入持久化队列。队列中的文件由固定数量的引擎槽位处理（每个文件的各页由引擎并发识别），
+ * 每页识别成功后立即记入队列日志，程序重启后只识别尚未完成的页面。
+ * 结果写在输入文件旁边或输出目录中；结果文件比输入文件新的文件不会再次处理。
+ */
+class HotFolderProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造处理器
+     * @param engines 已初始化的OCR引擎，每个引擎对应一个处理槽位（不拥有）
+     * @param queue 已打开的持久化队列（不拥有）
+     * @param parent 父对象指针
+     */
+    HotFolderProcessor(const QList<OCREngine *> &engines, PersistentJobQueue *queue,
+                       QObject *parent = nullptr);
+    ~HotFolderProcessor();
+
+    /**
+     * @brief 开始监视目录（立即扫描一次，并继续处理队列中上次未完成的任务）
+     * @param directory 监视的目录
+     * @param recursive 是否包括子目录
+     * @param options 识别和输出选项
+     * @param settleMs 文件大小和修改时间保持不变多久后视为写入完成（毫秒）
+     * @param errorMessage 失败时返回错误信息
+     * @return 是否成功
+     */
+    bool watch(const QString &directory, bool recursive, const BatchRunner::Options &options,
+               int settleMs, QString *errorMessage);
+
+    /**
+     * @brief 同一文件最多尝试处理的次数（超过后视为失败，避免导致程序崩溃的文件反复重试）
+     */
+    static const int MAX_ATTEMPTS = 3;
+
+signals:
+    /**
+     * @brief 单个文件处理完成信号
+     * @param filePath 输入文件路径
+     * @param success 是否成功
+     * @param message 结果说明
+     * @param queuedFiles 队列中剩余的文件数
+     */
+    void fileFinished(const QString &filePath, bool success, const QString &message, int queuedFiles);
+
+private:
+    /**
+     * @brief 等待写入完成的文件
+     */
+    struct Candidate {
+        QString relativePath;   // 输出目录中使用的相对路径
+        qint64 size;            // 最近一次检查时的大小
+        qint64 modifiedMs;      // 最近一次检查时的修改时间
+        QElapsedTimer stable;   // 大小和修改时间保持不变的时长
+    };
+
+    /**
+     * @brief 处理槽位
+     */
+    struct Slot {
+        OCREngine *engine;                                          // 该槽位专用的引擎
+        QFutureWatcher<FileProcessor::ProcessResult> *loadWatcher;  // 文件加载任务
+        QFutureWatcher<OCREngine::OCRResult> *ocrWatcher;           // 识别任务
+        PersistentJobQueue::Job job;                                // 正在处理的任务
+        bool busy;                                                  // 是否正在处理
+        QStringList pageNames;                                      // 页面名称
+        QList<int> submittedPages;                                  // 提交识别的页面索引（识别结果下标 -> 页面索引）
+        QElapsedTimer timer;                                        // 处理计时
+    };
+
+    /**
+     * @brief 扫描监视的目录，记录新出现或被修改的文件
+     */
+    void scanDirectory();
+
+    /**
+     * @brief 检查等待中的文件是否已写入完成，完成的加入队列
+     */
+    void checkCandidates();
+
+    /**
+     * @brief 文件是否已有不旧于它的结果
+     * @param filePath 文件路径
+     * @param relativePath 输出目录中使用的相对路径
+     * @param modifiedMs 文件修改时间
+     * @return 是否已处理
+     */
+    bool isProcessed(const QString &filePath, const QString &relativePath, qint64 modifiedMs) const;
+
+    /**
+     * @brief 为空闲槽位分配队列中的任务
+     */
+    void dispatch();
+
+    /**
+     * @brief 文件加载完成，提交尚未识别的页面
+     * @param slot 槽位
+     */
+    void onFileLoaded(Slot *slot);
+
+    /**
+     * @brief 某页识别完成，记入队列日志
+     * @param slot 槽位
+     * @param resultIndex 识别结果下标
+     */
+    void onPageReady(Slot *slot, int resultIndex);
+
+    /**
+     * @brief 所有页面识别完成，写出结果
+     * @param slot 槽位
+     */
+    void onFileRecognized(Slot *slot);
+
+    /**
+     * @brief 结束当前任务并继续分配
+     * @param slot 槽位
+     * @param success 是否成功
+     * @param message 结果说明
+     */
+    void finishJob(Slot *slot, bool success, const QString &message);
+
+private:
+    PersistentJobQueue *m_queue;                // 持久化队列
+    QList<Slot *> m_slots;                      // 处理槽位
+    QFileSystemWatcher *m_watcher;              // 目录监视
+    QTimer *m_scanTimer;                        // 合并短时间内的多次目录变化
+    QTimer *m_settleTimer;                      // 定期检查等待中的文件
+    QString m_directory;                        // 监视的目录
+    bool m_recursive;                           // 是否包括子目录
+    BatchRunner::Options m_options;             // 识别和输出选项
+    int m_settleMs;                             // 写入完成判定时长
+    QHash<QString, Candidate> m_candidates;     // 等待写入完成的文件
+    QHash<QString, qint64> m_seen;              // 已入队或已处理的文件 -> 当时的修改时间
+};
+
+#endif // HOTFOLDERPROCESSOR_H
@@ -0,0 +1,1016 @@
+#include "imagepreprocessor.h"
+#include "ocrmetrics.h"
+#include <QPainter>
+#include <QBuffer>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <functional>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OCR_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC和Clang需要为使用向量指令的函数单独指定目标指令集（整个程序仍按基础指令集编译）
+#if defined(__GNUC__) || defined(__clang__)
+#define OCR_TARGET(isa) __attribute__((target(isa)))
+#else
+#define OCR_TARGET(isa)
+#endif
+
+/**
+ * @brief 把一行32位像素转换为灰度（标量实现，也用于处理向量实现剩余的像素）
+ * @param src 源像素（0xffRRGGBB）
+ * @param dst 目标灰度
+ * @param count 像素数
+ */
+static void grayRowScalar(const quint32 *src, uchar *dst, int count)
+{
+    for (int x = 0; x < count; ++x) {
+        const quint32 pixel = src[x];
+        dst[x] = uchar((77 * ((pixel >> 16) & 0xff) + 150 * ((pixel >> 8) & 0xff)
+                        + 29 * (pixel & 0xff) + 128) >> 8);
+    }
+}
+
+/**
+ * @brief 按全局阈值二值化一行（标量实现）
+ * @param src 源灰度
+ * @param dst 目标（0或255）
+ * @param count 像素数
+ * @param threshold 阈值
+ */
+static void thresholdRowScalar(const uchar *src, uchar *dst, int count, int threshold)
+{
+    for (int x = 0; x < count; ++x) {
+        dst[x] = src[x] > threshold ? 255 : 0;
+    }
+}
+
+/**
+ * @brief 统计一行中与背景灰度相差超过阈值的像素数（标量实现）
+ * @param src 灰度
+ * @param count 像素数
+ * @param background 背景灰度
+ * @param contrast 阈值
+ * @return 墨迹像素数
+ */
+static int inkCountScalar(const uchar *src, int count, int background, int contrast)
+{
+    int ink = 0;
+    for (int x = 0; x < count; ++x) {
+        ink += qAbs(int(src[x]) - background) > contrast;
+    }
+    return ink;
+}
+
+#ifdef OCR_X86_SIMD
+/**
+ * @brief 计算4个像素的亮度（SSE2）
+ *
+ * 像素字节按B、G、R、A排列，扩展为16位后与权重做乘加得到(B*29+G*150, R*77)两部分，
+ * 再把每个64位中的两部分相加，得到4个32位亮度值。
+ */
+OCR_TARGET("sse2")
+static inline __m128i lumaSse2(__m128i pixels, __m128i weights, __m128i rounding)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+    lo = _mm_shuffle_epi32(_mm_add_epi32(lo, _mm_srli_epi64(lo, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    hi = _mm_shuffle_epi32(_mm_add_epi32(hi, _mm_srli_epi64(hi, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi64(lo, hi), rounding), 8);
+}
+
+/**
+ * @brief 把一行32位像素转换为灰度（SSE2，每次16个像素）
+ */
+OCR_TARGET("sse2")
+static void grayRowSse2(const quint32 *src, uchar *dst, int count)
+{
+    const __m128i weights = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+    const __m128i rounding = _mm_set1_epi32(128);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i *in = reinterpret_cast<const __m128i *>(src + x);
+        const __m128i y0 = lumaSse2(_mm_loadu_si128(in), weights, rounding);
+        const __m128i y1 = lumaSse2(_mm_loadu_si128(in + 1), weights, rounding);
+        const __m128i y2 = lumaSse2(_mm_loadu_si128(in + 2), weights, rounding);
+        const __m128i y3 = lumaSse2(_mm_loadu_si128(in + 3), weights, rounding);
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), packed);
+    }
+    grayRowScalar(src + x, dst + x, count - x);
+}
+
+/**
+ * @brief 按全局阈值二值化一行（SSE2，每次16个像素）
+ *
+ * SSE2只有有符号字节比较，两边同时翻转最高位后比较结果与无符号比较相同。
+ */
+OCR_TARGET("sse2")
+static void thresholdRowSse2(const uchar *src, uchar *dst, int count, int threshold)
+{
+    const __m128i signBit = _mm_set1_epi8(char(0x80));
+    const __m128i limit = _mm_set1_epi8(char(threshold ^ 0x80));
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        const __m128i mask = _mm_cmpgt_epi8(_mm_xor_si128(pixels, signBit), limit);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), mask);
+    }
+    thresholdRowScalar(src + x, dst + x, count - x, threshold);
+}
+
+/**
+ * @brief 统计一行中的墨迹像素数（SSE2，每次16个像素）
+ *
+ * 两个方向的饱和减法取或得到与背景之差的绝对值，再减去阈值，非零即为墨迹；
+ * 墨迹标记为1后用SAD指令按8字节一组求和。
+ */
+OCR_TARGET("sse2")
+static int inkCountSse2(const uchar *src, int count, int background, int contrast)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i level = _mm_set1_epi8(char(background));
+    const __m128i limit = _mm_set1_epi8(char(contrast));
+
+    __m128i sums = zero;
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        const __m128i difference = _mm_or_si128(_mm_subs_epu8(pixels, level), _mm_subs_epu8(level, pixels));
+        const __m128i quiet = _mm_cmpeq_epi8(_mm_subs_epu8(difference, limit), zero);
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_andnot_si128(quiet, one), zero));
+    }
+
+    quint64 parts[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(parts), sums);
+    return int(parts[0] + parts[1]) + inkCountScalar(src + x, count - x, background, contrast);
+}
+
+/**
+ * @brief 计算8个像素的亮度（AVX2，两个128位通道分别按SSE2的方式计算）
+ */
+OCR_TARGET("avx2")
+static inline __m256i lumaAvx2(__m256i pixels, __m256i weights, __m256i rounding)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(pixels, zero), weights);
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(pixels, zero), weights);
+    lo = _mm256_shuffle_epi32(_mm256_add_epi32(lo, _mm256_srli_epi64(lo, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    hi = _mm256_shuffle_epi32(_mm256_add_epi32(hi, _mm256_srli_epi64(hi, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_srli_epi32(_mm256_add_epi32(_mm256_unpacklo_epi64(lo, hi), rounding), 8);
+}
+
+/**
+ * @brief 把一行32位像素转换为灰度（AVX2，每次32个像素）
+ *
+ * 打包指令在两个128位通道内分别进行，打包后每4个字节为一组的顺序是
+ * 0、2、4、6 | 1、3、5、7，最后用跨通道置换恢复像素顺序。
+ */
+OCR_TARGET("avx2")
+static void grayRowAvx2(const quint32 *src, uchar *dst, int count)
+{
+    const __m256i weights = _mm256_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0,
+                                              29, 150, 77, 0, 29, 150, 77, 0);
+    const __m256i rounding = _mm256_set1_epi32(128);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i *in = reinterpret_cast<const __m256i *>(src + x);
+        const __m256i y0 = lumaAvx2(_mm256_loadu_si256(in), weights, rounding);
+        const __m256i y1 = lumaAvx2(_mm256_loadu_si256(in + 1), weights, rounding);
+        const __m256i y2 = lumaAvx2(_mm256_loadu_si256(in + 2), weights, rounding);
+        const __m256i y3 = lumaAvx2(_mm256_loadu_si256(in + 3), weights, rounding);
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(y0, y1), _mm256_packs_epi32(y2, y3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    grayRowSse2(src + x, dst + x, count - x);
+}
+
+/**
+ * @brief 按全局阈值二值化一行（AVX2，每次32个像素）
+ */
+OCR_TARGET("avx2")
+static void thresholdRowAvx2(const uchar *src, uchar *dst, int count, int threshold)
+{
+    const __m256i signBit = _mm256_set1_epi8(char(0x80));
+    const __m256i limit = _mm256_set1_epi8(char(threshold ^ 0x80));
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x));
+        const __m256i mask = _mm256_cmpgt_epi8(_mm256_xor_si256(pixels, signBit), limit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), mask);
+    }
+    thresholdRowSse2(src + x, dst + x, count - x, threshold);
+}
+/**
+ * @brief 统计一行中的墨迹像素数（AVX2，每次32个像素）
+ */
+OCR_TARGET("avx2")
+static int inkCountAvx2(const uchar *src, int count, int background, int contrast)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i level = _mm256_set1_epi8(char(background));
+    const __m256i limit = _mm256_set1_epi8(char(contrast));
+
+    __m256i sums = zero;
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x));
+        const __m256i difference = _mm256_or_si256(_mm256_subs_epu8(pixels, level), _mm256_subs_epu8(level, pixels));
+        const __m256i quiet = _mm256_cmpeq_epi8(_mm256_subs_epu8(difference, limit), zero);
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_andnot_si256(quiet, one), zero));
+    }
+
+    quint64 parts[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(parts), sums);
+    return int(parts[0] + parts[1] + parts[2] + parts[3])
+           + inkCountSse2(src + x, count - x, background, contrast);
+}
+#endif // OCR_X86_SIMD
+
+/**
+ * @brief 按指令级别转换一行灰度
+ */
+static void grayRow(ImagePreprocessor::SimdLevel level, const quint32 *src, uchar *dst, int count)
+{
+#ifdef OCR_X86_SIMD
+    if (level == ImagePreprocessor::SIMD_AVX2) {
+        grayRowAvx2(src, dst, count);
+        return;
+    }
+    if (level == ImagePreprocessor::SIMD_SSE2) {
+        grayRowSse2(src, dst, count);
+        return;
+    }
+#else
+    Q_UNUSED(level)
+#endif
+    grayRowScalar(src, dst, count);
+}
+
+/**
+ * @brief 按指令级别二值化一行
+ */
+static void thresholdRow(ImagePreprocessor::SimdLevel level, const uchar *src, uchar *dst,
+                         int count, int threshold)
+{
+#ifdef OCR_X86_SIMD
+    if (level == ImagePreprocessor::SIMD_AVX2) {
+        thresholdRowAvx2(src, dst, count, threshold);
+        return;
+    }
+    if (level == ImagePreprocessor::SIMD_SSE2) {
+        thresholdRowSse2(src, dst, count, threshold);
+        return;
+    }
+#else
+    Q_UNUSED(level)
+#endif
+    thresholdRowScalar(src, dst, count, threshold);
+}
+
+/**
+ * @brief 按指令级别统计一行中的墨迹像素数
+ */
+static int inkCount(ImagePreprocessor::SimdLevel level, const uchar *src, int count, int background, int contrast)
+{
+#ifdef OCR_X86_SIMD
+    if (level == ImagePreprocessor::SIMD_AVX2) {
+        return inkCountAvx2(src, count, background, contrast);
+    }
+    if (level == ImagePreprocessor::SIMD_SSE2) {
+        return inkCountSse2(src, count, background, contrast);
+    }
+#else
+    Q_UNUSED(level)
+#endif
+    return inkCountScalar(src, count, background, contrast);
+}
+
+/**
+ * @brief 把一行0/255二值像素打包为1位（高位在前，白色为1）
+ * @param binary 二值像素
+ * @param mono 目标行
+ * @param width 像素数
+ */
+static void packMonoRow(const uchar *binary, uchar *mono, int width)
+{
+    for (int x = 0; x < width; x += 8) {
+        const int count = qMin(8, width - x);
+        uchar byte = 0;
+        for (int i = 0; i < count; ++i) {
+            byte |= uchar((binary[x + i] & 0x80) >> i);
+        }
+        mono[x / 8] = byte;
+    }
+}
+
+/**
+ * @brief 创建与灰度图同尺寸、同分辨率的输出图像
+ * @param gray 灰度图
+ * @param bilevel 是否为1位图像
+ * @return 未填充的输出图像
+ */
+static QImage createOutputImage(const QImage &gray, bool bilevel)
+{
+    QImage output(gray.size(), bilevel ? QImage::Format_Mono : QImage::Format_Grayscale8);
+    if (bilevel) {
+        output.setColorTable({qRgb(0, 0, 0), qRgb(255, 255, 255)});
+    }
+    output.setDotsPerMeterX(gray.dotsPerMeterX());
+    output.setDotsPerMeterY(gray.dotsPerMeterY());
+    return output;
+}
+
+/**
+ * @brief 计算PNG编码后的大小
+ * @param image 图像
+ * @return 字节数
+ */
+static qint64 encodedPngSize(const QImage &image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data.size();
+}
+
+/**
+ * @brief 按选项预处理图像
+ * @param image 原始图像
+ * @param options 预处理选项
+ * @return 处理后的图像
+ */
+QImage ImagePreprocessor::process(const QImage &image, const Options &options)
+{
+    if (image.isNull() || (options.method == NONE && !options.normalizeTextSize)) {
+        return image;
+    }
+
+    // 只归一化文字尺寸时在灰度图上估计，缩放原图
+    if (options.method == NONE) {
+        const double factor = textScaleFactor(toGrayscale(image), options.targetXHeight);
+        if (factor != 1.0) {
+            OCRMetrics::increment("pages_rescaled");
+        }
+        return scaleImage(image, factor);
+    }
+
+    // 先缩放灰度图再二值化，重采样不会在二值图上产生锯齿
+    QImage gray = toGrayscale(image);
+    if (options.normalizeTextSize) {
+        const double factor = textScaleFactor(gray, options.targetXHeight);
+        if (factor != 1.0) {
+            OCRMetrics::increment("pages_rescaled");
+            gray = scaleImage(gray, factor);
+        }
+    }
+
+    switch (options.method) {
+    case OTSU:
+        return binarizeGlobal(gray, otsuThreshold(gray), options.bilevel);
+    case SAUVOLA:
+        return binarizeSauvola(gray, options.windowSize, options.k, options.bilevel);
+    default:
+        return gray;
+    }
+}
+
+/**
+ * @brief 按选项预处理一组页面图像
+ * @param images 页面图像列表
+ * @param options 预处理选项
+ */
+void ImagePreprocessor::processAll(QList<QImage> &images, const Options &options)
+{
+    if (options.method == NONE && !options.normalizeTextSize) {
+        return;
+    }
+
+    for (int i = 0; i < images.size(); ++i) {
+        OCRMetrics::ScopedTimer timer("preprocess", i);
+        images[i] = process(images.at(i), options);
+    }
+}
+
+/**
+ * @brief 转换为8位灰度图
+ * @param image 原始图像
+ * @param level 使用的向量指令级别
+ * @return 8位灰度图
+ */
+QImage ImagePreprocessor::toGrayscale(const QImage &image, SimdLevel level)
+{
+    if (image.isNull() || image.format() == QImage::Format_Grayscale8) {
+        return image;
+    }
+    if (image.format() == QImage::Format_Grayscale16 || image.format() == QImage::Format_Mono
+        || image.format() == QImage::Format_MonoLSB) {
+        return image.convertToFormat(QImage::Format_Grayscale8);
+    }
+
+    // 统一为0xffRRGGBB格式；带透明通道的图像先合成到白色背景上，避免透明区域变成黑色
+    QImage rgb;
+    if (image.hasAlphaChannel()) {
+        rgb = QImage(image.size(), QImage::Format_RGB32);
+        rgb.fill(Qt::white);
+        QPainter painter(&rgb);
+        painter.drawImage(0, 0, image);
+    } else {
+        rgb = image.convertToFormat(QImage::Format_RGB32);
+    }
+
+    level = qMin(level, supportedSimdLevel());
+    QImage gray(rgb.size(), QImage::Format_Grayscale8);
+    for (int y = 0; y < rgb.height(); ++y) {
+        grayRow(level, reinterpret_cast<const quint32 *>(rgb.constScanLine(y)), gray.scanLine(y), rgb.width());
+    }
+    gray.setDotsPerMeterX(image.dotsPerMeterX());
+    gray.setDotsPerMeterY(image.dotsPerMeterY());
+    return gray;
+}
+
+/**
+ * @brief 计算灰度图的Otsu阈值
+ * @param gray 8位灰度图
+ * @return 阈值
+ */
+int ImagePreprocessor::otsuThreshold(const QImage &gray)
+{
+    quint64 histogram[256] = {};
+    for (int y = 0; y < gray.height(); ++y) {
+        const uchar *line = gray.constScanLine(y);
+        for (int x = 0; x < gray.width(); ++x) {
+            histogram[line[x]]++;
+        }
+    }
+
+    const double total = double(gray.width()) * gray.height();
+    double sumAll = 0.0;
+    for (int i = 0; i < 256; ++i) {
+        sumAll += double(i) * histogram[i];
+    }
+
+    // 逐个灰度级计算前景和背景的类间方差，取最大者
+    double sumBackground = 0.0;
+    double weightBackground = 0.0;
+    double bestVariance = -1.0;
+    int threshold = 127;
+    for (int t = 0; t < 256; ++t) {
+        weightBackground += histogram[t];
+        if (weightBackground == 0.0) {
+            continue;
+        }
+        const double weightForeground = total - weightBackground;
+        if (weightForeground == 0.0) {
+            break;
+        }
+
+        sumBackground += double(t) * histogram[t];
+        const double meanBackground = sumBackground / weightBackground;
+        const double meanForeground = (sumAll - sumBackground) / weightForeground;
+        const double variance = weightBackground * weightForeground
+                                * (meanBackground - meanForeground) * (meanBackground - meanForeground);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            threshold = t;
+        }
+    }
+    return threshold;
+}
+
+/**
+ * @brief 按全局阈值二值化
+ * @param gray 8位灰度图
+ * @param threshold 阈值
+ * @param bilevel 是否输出1位图像
+ * @param level 使用的向量指令级别
+ * @return 二值图像
+ */
+QImage ImagePreprocessor::binarizeGlobal(const QImage &gray, int threshold, bool bilevel, SimdLevel level)
+{
+    if (gray.isNull()) {
+        return QImage();
+    }
+
+    level = qMin(level, supportedSimdLevel());
+    threshold = qBound(0, threshold, 255);
+    QImage output = createOutputImage(gray, bilevel);
+    QVector<uchar> row(bilevel ? gray.width() : 0);
+    for (int y = 0; y < gray.height(); ++y) {
+        if (bilevel) {
+            thresholdRow(level, gray.constScanLine(y), row.data(), gray.width(), threshold);
+            packMonoRow(row.constData(), output.scanLine(y), gray.width());
+        } else {
+            thresholdRow(level, gray.constScanLine(y), output.scanLine(y), gray.width(), threshold);
+        }
+    }
+    return output;
+}
+
+/**
+ * @brief 按Sauvola局部自适应阈值二值化
+ * @param gray 8位灰度图
+ * @param windowSize 窗口边长
+ * @param k 灵敏度参数
+ * @param bilevel 是否输出1位图像
+ * @return 二值图像
+ */
+QImage ImagePreprocessor::binarizeSauvola(const QImage &gray, int windowSize, double k, bool bilevel)
+{
+    if (gray.isNull()) {
+        return QImage();
+    }
+
+    const int width = gray.width();
+    const int height = gray.height();
+    // 窗口上限保证逐列平方和不会超出32位
+    const int radius = qBound(1, windowSize / 2, 500);
+
+    // 逐列累计窗口内各行的和与平方和，每行只需加入新进入窗口的行并减去离开窗口的行
+    QVector<quint32> columnSum(width, 0);
+    QVector<quint32> columnSquares(width, 0);
+    auto accumulateRow = [&](int y, bool add) {
+        const uchar *line = gray.constScanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const quint32 value = line[x];
+            if (add) {
+                columnSum[x] += value;
+                columnSquares[x] += value * value;
+            } else {
+                columnSum[x] -= value;
+                columnSquares[x] -= value * value;
+            }
+        }
+    };
+    for (int y = 0; y <= qMin(radius, height - 1); ++y) {
+        accumulateRow(y, true);
+    }
+
+    QImage output = createOutputImage(gray, bilevel);
+    QVector<quint64> prefixSum(width + 1, 0);
+    QVector<quint64> prefixSquares(width + 1, 0);
+    QVector<uchar> row(width);
+    for (int y = 0; y < height; ++y) {
+        if (y > 0) {
+            if (y + radius < height) {
+                accumulateRow(y + radius, true);
+            }
+            if (y - radius - 1 >= 0) {
+                accumulateRow(y - radius - 1, false);
+            }
+        }
+
+        // 列和的前缀和，窗口和 = 两个前缀和之差
+        for (int x = 0; x < width; ++x) {
+            prefixSum[x + 1] = prefixSum[x] + columnSum[x];
+            prefixSquares[x + 1] = prefixSquares[x] + columnSquares[x];
+        }
+
+        const int rows = qMin(height - 1, y + radius) - qMax(0, y - radius) + 1;
+        const uchar *line = gray.constScanLine(y);
+        uchar *target = bilevel ? row.data() : output.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const int left = qMax(0, x - radius);
+            const int right = qMin(width - 1, x + radius);
+            const double count = double(right - left + 1) * rows;
+            const double mean = double(prefixSum[right + 1] - prefixSum[left]) / count;
+            const double variance = double(prefixSquares[right + 1] - prefixSquares[left]) / count - mean * mean;
+            const double deviation = std::sqrt(qMax(0.0, variance));
+            const double threshold = mean * (1.0 + k * (deviation / 128.0 - 1.0));
+            target[x] = line[x] > threshold ? 255 : 0;
+        }
+
+        if (bilevel) {
+            packMonoRow(row.constData(), output.scanLine(y), width);
+        }
+    }
+    return output;
+}
+
+/**
+ * @brief 判断页面是否为空白页
+ * @param image 页面图像
+ * @param options 检测选项
+ * @param inkCoverage 返回墨迹像素占比
+ * @return 是否为空白页
+ */
+bool ImagePreprocessor::isBlankPage(const QImage &image, const BlankPageOptions &options, double *inkCoverage)
+{
+    if (image.isNull()) {
+        return false;
+    }
+
+    // 32位像素直接按行转换灰度，其他格式先整体转换
+    QImage source = image;
+    if (source.hasAlphaChannel()) {
+        source = toGrayscale(source);
+    } else if (source.format() != QImage::Format_RGB32 && source.format() != QImage::Format_Grayscale8) {
+        source = source.isGrayscale() ? source.convertToFormat(QImage::Format_Grayscale8)
+                                      : source.convertToFormat(QImage::Format_RGB32);
+    }
+    const bool gray = source.format() == QImage::Format_Grayscale8;
+
+    const double margin = qBound(0.0, options.marginRatio, 0.4);
+    QRect content = source.rect().adjusted(qRound(source.width() * margin), qRound(source.height() * margin),
+                                           -qRound(source.width() * margin), -qRound(source.height() * margin));
+    if (content.isEmpty()) {
+        content = source.rect();
+    }
+
+    // 隔行采样：文字行高远大于两个像素，不会因采样而漏掉
+    const int step = content.height() >= 100 ? 2 : 1;
+    const int width = content.width();
+    const int sampledRows = (content.height() + step - 1) / step;
+    const SimdLevel level = supportedSimdLevel();
+
+    QVector<uchar> buffer(gray ? 0 : qsizetype(width) * sampledRows);
+    QVector<const uchar *> rows(sampledRows);
+    for (int i = 0; i < sampledRows; ++i) {
+        const int y = content.top() + i * step;
+        if (gray) {
+            rows[i] = source.constScanLine(y) + content.left();
+        } else {
+            uchar *target = buffer.data() + qsizetype(i) * width;
+            grayRow(level, reinterpret_cast<const quint32 *>(source.constScanLine(y)) + content.left(), target, width);
+            rows[i] = target;
+        }
+    }
+
+    // 背景取灰度中位数（直方图只用一半的采样行）
+    quint32 histogram[256] = {};
+    qint64 histogramPixels = 0;
+    for (int i = 0; i < sampledRows; i += 2) {
+        const uchar *line = rows.at(i);
+        for (int x = 0; x < width; ++x) {
+            histogram[line[x]]++;
+        }
+        histogramPixels += width;
+    }
+    int background = 0;
+    for (qint64 below = 0; background < 255; ++background) {
+        below += histogram[background];
+        if (below * 2 >= histogramPixels) {
+            break;
+        }
+    }
+
+    const int contrast = qBound(1, options.inkContrast, 254);
+    const int minRowInk = qMax(1, qRound(width * options.minRowInkRatio));
+    qint64 totalInk = 0;
+    int inkRows = 0;
+    for (int i = 0; i < sampledRows; ++i) {
+        const int ink = inkCount(level, rows.at(i), width, background, contrast);
+        totalInk += ink;
+        if (ink >= minRowInk) {
+            inkRows++;
+        }
+    }
+
+    if (inkCoverage) {
+        *inkCoverage = double(totalInk) / (double(width) * sampledRows);
+    }
+    return inkRows * step < options.minInkHeight;
+}
+
+/**
+ * @brief 估计页面文字的x高度
+ * @param gray 8位灰度图
+ * @return x高度（像素），无法估计时返回0
+ */
+double ImagePreprocessor::estimateXHeight(const QImage &gray)
+{
+    if (gray.isNull()) {
+        return 0.0;
+    }
+
+    // 大图缩小后再分析，连通域高度按比例换算回原图
+    const double maxAnalysisPixels = 4e6;
+    const double pixels = double(gray.width()) * gray.height();
+    QImage analysis = gray;
+    if (pixels > maxAnalysisPixels) {
+        const double ratio = std::sqrt(maxAnalysisPixels / pixels);
+        analysis = gray.scaled(qMax(1, qRound(gray.width() * ratio)), qMax(1, qRound(gray.height() * ratio)),
+                               Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                       .convertToFormat(QImage::Format_Grayscale8);
+    }
+    const double scale = double(analysis.height()) / gray.height();
+    const int width = analysis.width();
+    const int height = analysis.height();
+
+    // 暗像素超过一半时视为深色背景上的浅色文字（如深色主题的界面截图）
+    const int threshold = otsuThreshold(analysis);
+    qint64 darkPixels = 0;
+    for (int y = 0; y < height; ++y) {
+        const uchar *line = analysis.constScanLine(y);
+        for (int x = 0; x < width; ++x) {
+            darkPixels += line[x] <= threshold;
+        }
+    }
+    const bool lightText = darkPixels * 2 > qint64(width) * height;
+
+    // 按行提取前景游程，与上一行重叠或对角相邻的游程用并查集合并为同一连通域
+    struct Run {
+        int start;
+        int end;
+        int label;
+    };
+    struct Box {
+        int top;
+        int bottom;
+        int left;
+        int right;
+    };
+    QVector<int> parent;
+    QVector<Box> boxes;
+    auto findRoot = [&parent](int label) {
+        while (parent[label] != label) {
+            parent[label] = parent[parent[label]];
+            label = parent[label];
+        }
+        return label;
+    };
+
+    QVector<Run> previous;
+    QVector<Run> current;
+    for (int y = 0; y < height; ++y) {
+        const uchar *line = analysis.constScanLine(y);
+        current.clear();
+        int x = 0;
+        while (x < width) {
+            while (x < width && (line[x] <= threshold) == lightText) {
+                ++x;
+            }
+            if (x >= width) {
+                break;
+            }
+            const int start = x;
+            while (x < width && (line[x] <= threshold) != lightText) {
+                ++x;
+            }
+            const Run run = {start, x - 1, int(parent.size())};
+            parent.append(run.label);
+            boxes.append({y, y, start, x - 1});
+            current.append(run);
+        }
+
+        int first = 0;
+        for (const Run &run : std::as_const(current)) {
+            while (first < previous.size() && previous.at(first).end < run.start - 1) {
+                ++first;
+            }
+            for (int i = first; i < previous.size() && previous.at(i).start <= run.end + 1; ++i) {
+                const int a = findRoot(run.label);
+                const int b = findRoot(previous.at(i).label);
+                if (a != b) {
+                    parent[qMax(a, b)] = qMin(a, b);
+                }
+            }
+        }
+        previous.swap(current);
+    }
+
+    // 把各游程的边框合并到连通域的根上
+    for (int label = 0; label < parent.size(); ++label) {
+        const int root = findRoot(label);
+        if (root != label) {
+            Box &box = boxes[root];
+            const Box &part = boxes.at(label);
+            box.top = qMin(box.top, part.top);
+            box.bottom = qMax(box.bottom, part.bottom);
+            box.left = qMin(box.left, part.left);
+            box.right = qMax(box.right, part.right);
+        }
+    }
+
+    // 去掉噪点、横线（远宽于高）和图片等大块区域，剩下的视为字形
+    QVector<int> heights;
+    for (int label = 0; label < parent.size(); ++label) {
+        if (parent.at(label) != label) {
+            continue;
+        }
+        const Box &box = boxes.at(label);
+        const int boxHeight = box.bottom - box.top + 1;
+        const int boxWidth = box.right - box.left + 1;
+        if (boxHeight < 3 || boxHeight > height / 10 || boxWidth > boxHeight * 5) {
+            continue;
+        }
+        heights.append(boxHeight);
+    }
+
+    const int minGlyphs = 20;
+    if (heights.size() < minGlyphs) {
+        return 0.0;
+    }
+    auto median = heights.begin() + heights.size() / 2;
+    std::nth_element(heights.begin(), median, heights.end());
+    return *median / scale;
+}
+
+/**
+ * @brief 计算使文字达到目标x高度的缩放比例
+ * @param gray 8位灰度图
+ * @param targetXHeight 目标x高度
+ * @return 缩放比例
+ */
+double ImagePreprocessor::textScaleFactor(const QImage &gray, int targetXHeight)
+{
+    const double xHeight = estimateXHeight(gray);
+    if (xHeight <= 0.0 || targetXHeight <= 0) {
+        return 1.0;
+    }
+
+    // x高度在目标的0.7到1.6倍之间时识别效果和速度都已足够好
+    if (xHeight >= targetXHeight * 0.7 && xHeight <= targetXHeight * 1.6) {
+        return 1.0;
+    }
+
+    const double maxPixels = 64e6;
+    const double pixels = double(gray.width()) * gray.height();
+    double factor = qBound(0.2, targetXHeight / xHeight, 4.0);
+    factor = qMin(factor, std::sqrt(maxPixels / pixels));
+    return qMax(factor, 0.2);
+}
+
+/**
+ * @brief 按比例缩放图像，并相应调整分辨率信息
+ * @param image 原始图像
+ * @param factor 缩放比例
+ * @return 缩放后的图像
+ */
+QImage ImagePreprocessor::scaleImage(const QImage &image, double factor)
+{
+    if (image.isNull() || factor == 1.0) {
+        return image;
+    }
+
+    const QSize size(qMax(1, qRound(image.width() * factor)), qMax(1, qRound(image.height() * factor)));
+    QImage scaled = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    scaled.setDotsPerMeterX(qRound(image.dotsPerMeterX() * factor));
+    scaled.setDotsPerMeterY(qRound(image.dotsPerMeterY() * factor));
+    return scaled;
+}
+
+/**
+ * @brief 获取本机支持的最高向量指令级别
+ * @return 向量指令级别
+ */
+ImagePreprocessor::SimdLevel ImagePreprocessor::supportedSimdLevel()
+{
+    static const SimdLevel level = []() {
+#if defined(OCR_X86_SIMD) && defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = info[3] & (1 << 26);
+        // AVX2还需要操作系统保存YMM寄存器（OSXSAVE且XCR0的第1、2位均已设置）
+        const bool osxsave = info[2] & (1 << 27);
+        const bool avx = info[2] & (1 << 28);
+        if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5)) {
+                return SIMD_AVX2;
+            }
+        }
+        return sse2 ? SIMD_SSE2 : SIMD_NONE;
+#elif defined(OCR_X86_SIMD)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SIMD_AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return SIMD_SSE2;
+        }
+        return SIMD_NONE;
+#else
+        return SIMD_NONE;
+#endif
+    }();
+    return level;
+}
+
+/**
+ * @brief 向量指令级别的名称
+ * @param level 向量指令级别
+ * @return 名称
+ */
+QString ImagePreprocessor::simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SIMD_AVX2:
+        return "AVX2";
+    case SIMD_SSE2:
+        return "SSE2";
+    default:
+        return "标量";
+    }
+}
+
+/**
+ * @brief 根据名称解析预处理方式
+ * @param name 名称
+ * @param ok 返回名称是否有效
+ * @return 预处理方式
+ */
+ImagePreprocessor::Method ImagePreprocessor::methodFromName(const QString &name, bool *ok)
+{
+    const QString key = name.trimmed().toLower();
+    const int index = methodNames().indexOf(key);
+    if (ok) {
+        *ok = index >= 0;
+    }
+    return index >= 0 ? Method(index) : NONE;
+}
+
+/**
+ * @brief 获取预处理方式的名称
+ * @param method 预处理方式
+ * @return 名称
+ */
+QString ImagePreprocessor::methodName(Method method)
+{
+    return methodNames().value(int(method), "none");
+}
+
+/**
+ * @brief 获取所有预处理方式的名称（与Method枚举顺序一致）
+ * @return 名称列表
+ */
+QStringList ImagePreprocessor::methodNames()
+{
+    return {"none", "gray", "otsu", "sauvola"};
+}
+
+/**
+ * @brief 测量各预处理步骤每百万像素的耗时
+ * @param image 测试图像
+ * @param iterations 每项重复次数
+ * @return 各项测试结果
+ */
+QList<ImagePreprocessor::BenchmarkResult> ImagePreprocessor::benchmark(const QImage &image, int iterations)
+{
+    QList<BenchmarkResult> results;
+    if (image.isNull()) {
+        return results;
+    }
+
+    iterations = qMax(1, iterations);
+    const double megapixels = double(image.width()) * image.height() / 1e6;
+    auto measure = [&](const QString &name, const std::function<void()> &step, qint64 encodedBytes) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            step();
+        }
+        BenchmarkResult result;
+        result.name = name;
+        result.msPerMegapixel = timer.nsecsElapsed() / 1e6 / iterations / megapixels;
+        result.encodedBytes = encodedBytes;
+        results.append(result);
+    };
+
+    // 当前方式：原图直接编码为PNG交给tesseract
+    measure("PNG编码（原图）", [&]() { encodedPngSize(image); }, encodedPngSize(image));
+
+    for (int level = SIMD_NONE; level <= supportedSimdLevel(); ++level) {
+        measure(QString("灰度转换（%1）").arg(simdLevelName(SimdLevel(level))),
+                [&]() { toGrayscale(image, SimdLevel(level)); }, -1);
+    }
+
+    const QImage gray = toGrayscale(image);
+    const int threshold = otsuThreshold(gray);
+    measure("Otsu阈值计算", [&]() { otsuThreshold(gray); }, -1);
+    for (int level = SIMD_NONE; level <= supportedSimdLevel(); ++level) {
+        measure(QString("全局阈值二值化（%1）").arg(simdLevelName(SimdLevel(level))),
+                [&]() { binarizeGlobal(gray, threshold, false, SimdLevel(level)); }, -1);
+    }
+    const Options defaults;
+    measure("Sauvola二值化", [&]() { binarizeSauvola(gray, defaults.windowSize, defaults.k, false); }, -1);
+    measure("x高度估计", [&]() { estimateXHeight(gray); }, -1);
+    const BlankPageOptions blankPageOptions;
+    measure("空白页检测", [&]() { isBlankPage(image, blankPageOptions); }, -1);
+
+    // 预处理结果的编码耗时和大小
+    const QImage binary = binarizeGlobal(gray, threshold, false);
+    const QImage bilevel = binarizeGlobal(gray, threshold, true);
+    measure("PNG编码（灰度图）", [&]() { encodedPngSize(gray); }, encodedPngSize(gray));
+    measure("PNG编码（8位二值图）", [&]() { encodedPngSize(binary); }, encodedPngSize(binary));
+    measure("PNG编码（1位二值图）", [&]() { encodedPngSize(bilevel); }, encodedPngSize(bilevel));
+    return results;
+}
@@ -0,0 +1,231 @@
+#ifndef IMAGEPREPROCESSOR_H
+#define IMAGEPREPROCESSOR_H
+
+#include <QImage>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 识别前的图像预处理（文字尺寸归一化、灰度化和二值化）
+ *
+ * 位于文件加载和OCR引擎之间：把32位彩色页面转换为8位灰度图，并可用Otsu全局阈值或
+ * Sauvola局部自适应阈值二值化，输出8位（0/255）或1位图像。较小的输入图像可以减少
+ * PNG编码耗时、传给tesseract的数据量以及识别耗时，自适应阈值对光照不均的扫描件效果更好。
+ *
+ * 还可以按估计的文字x高度缩放页面，使字形落在tesseract最适合的尺寸范围内：
+ * 高分辨率扫描件缩小以节省识别时间，界面截图中的小字放大以提高识别率。
+ * 缩放后识别结果中的版面坐标对应缩放后的图像。
+ *
+ * 另外提供空白页检测，扫描批次中的空白分隔页和双面扫描的空白背面可以跳过识别。
+ *
+ * 灰度转换、阈值化和空白页检测中的墨迹统计在x86上使用SSE2/AVX2（运行时检测，不支持时使用标量实现），
+ * 各实现的输出逐字节相同。所有接口都是线程安全的。
+ */
+class ImagePreprocessor
+{
+public:
+    /**
+     * @brief 预处理方式
+     */
+    enum Method {
+        NONE,           // 不处理，保持原图
+        GRAYSCALE,      // 只转换为8位灰度图
+        OTSU,           // 灰度化后按Otsu全局阈值二值化
+        SAUVOLA         // 灰度化后按Sauvola局部自适应阈值二值化
+    };
+
+    /**
+     * @brief 向量指令级别
+     */
+    enum SimdLevel {
+        SIMD_NONE,      // 标量实现
+        SIMD_SSE2,      // SSE2（128位）
+        SIMD_AVX2       // AVX2（256位）
+    };
+
+    /**
+     * @brief 预处理选项
+     */
+    struct Options {
+        Method method;          // 预处理方式
+        bool bilevel;           // 二值化结果是否输出为1位图像（否则为8位0/255灰度图）
+        int windowSize;         // Sauvola窗口边长（像素，奇数）
+        double k;               // Sauvola灵敏度参数（越大阈值越低，笔画越细）
+        bool normalizeTextSize; // 是否按估计的文字x高度缩放页面
+        int targetXHeight;      // 缩放的目标x高度（像素）
+
+        Options() : method(NONE), bilevel(false), windowSize(31), k(0.34),
+                    normalizeTextSize(false), targetXHeight(22) {}
+    };
+
+    /**
+     * @brief 空白页检测选项
+     *
+     * 以页面灰度的中位数作为背景，与背景相差超过inkContrast的像素（深色或浅色）视为墨迹；
+     * 墨迹像素占比超过minRowInkRatio的行视为有墨迹的行，有墨迹的行累计高度低于minInkHeight时
+     * 视为空白页。零星的灰尘、扫描仪竖线和透印的背面文字都不会使页面被判为非空白，
+     * 而哪怕只有一行短文字的页面也会被识别。
+     */
+    struct BlankPageOptions {
+        bool enabled;           // 是否检测空白页
+        double marginRatio;     // 每边忽略的页边比例（扫描阴影、装订孔）
+        int inkContrast;        // 与背景灰度相差超过该值的像素视为墨迹
+        double minRowInkRatio;  // 一行中墨迹像素占比超过该值时视为有墨迹的行
+        int minInkHeight;       // 有墨迹的行累计高度（像素）低于该值时视为空白页
+
+        BlankPageOptions() : enabled(true), marginRatio(0.05), inkContrast(64),
+                             minRowInkRatio(0.004), minInkHeight(6) {}
+    };
+
+    /**
+     * @brief 单项基准测试结果
+     */
+    struct BenchmarkResult {
+        QString name;           // 测试项名称
+        double msPerMegapixel;  // 每百万像素耗时（毫秒）
+        qint64 encodedBytes;    // 输出图像编码为PNG后的大小（-1表示该项不产生图像）
+    };
+
+    /**
+     * @brief 按选项预处理图像
+     * @param image 原始图像
+     * @param options 预处理选项
+     * @return 处理后的图像（方式为NONE时返回原图）
+     */
+    static QImage process(const QImage &image, const Options &options);
+
+    /**
+     * @brief 按选项预处理一组页面图像（原地替换）
+     * @param images 页面图像列表
+     * @param options 预处理选项
+     */
+    static void processAll(QList<QImage> &images, const Options &options);
+
+    /**
+     * @brief 转换为8位灰度图（亮度 = (77R + 150G + 29B + 128) / 256，透明区域按白色背景合成）
+     * @param image 原始图像
+     * @param level 使用的向量指令级别（超过本机支持的级别时自动降级）
+     * @return 8位灰度图
+     */
+    static QImage toGrayscale(const QImage &image, SimdLevel level = SIMD_AVX2);
+
+    /**
+     * @brief 计算灰度图的Otsu阈值（类间方差最大的灰度级）
+     * @param gray 8位灰度图
+     * @return 阈值（灰度大于阈值的像素为背景）
+     */
+    static int otsuThreshold(const QImage &gray);
+
+    /**
+     * @brief 按全局阈值二值化
+     * @param gray 8位灰度图
+     * @param threshold 阈值（灰度大于阈值的像素为白色）
+     * @param bilevel 是否输出1位图像
+     * @param level 使用的向量指令级别
+     * @return 二值图像
+     */
+    static QImage binarizeGlobal(const QImage &gray, int threshold, bool bilevel,
+                                 SimdLevel level = SIMD_AVX2);
+
+    /**
+     * @brief 按Sauvola局部自适应阈值二值化
+     *
+     * 阈值 T = m * (1 + k * (s / 128 - 1))，m和s为窗口内灰度的均值和标准差。
+     * 窗口和通过逐列滑动累加计算，额外内存只与图像宽度有关。
+     * @param gray 8位灰度图
+     * @param windowSize 窗口边长（像素）
+     * @param k 灵敏度参数
+     * @param bilevel 是否输出1位图像
+     * @return 二值图像
+     */
+    static QImage binarizeSauvola(const QImage &gray, int windowSize, double k, bool bilevel);
+
+    /**
+     * @brief 判断页面是否为空白页
+     *
+     * 只检查页边以内的区域，并隔行采样；每百万像素耗时远小于1毫秒。
+     * @param image 页面图像
+     * @param options 检测选项
+     * @param inkCoverage 可选，返回墨迹像素占比
+     * @return 是否为空白页
+     */
+    static bool isBlankPage(const QImage &image, const BlankPageOptions &options, double *inkCoverage = nullptr);
+
+    /**
+     * @brief 估计页面文字的x高度
+     *
+     * 在Otsu二值化后的图像上按游程标记连通域（8连通），去掉噪点、表格线和大块图形后，
+     * 取连通域高度的中位数。拉丁文字中大多数字母高度等于x高度，中文取到的是字或部首的高度。
+     * 大图先缩小到约400万像素再分析。
+     * @param gray 8位灰度图
+     * @return x高度（像素），文字太少无法估计时返回0
+     */
+    static double estimateXHeight(const QImage &gray);
+
+    /**
+     * @brief 计算使文字达到目标x高度的缩放比例
+     *
+     * 估计值与目标相差不大时不缩放（避免无谓的重采样），缩放比例限制在0.2到4之间，
+     * 放大后的图像不超过6400万像素。
+     * @param gray 8位灰度图
+     * @param targetXHeight 目标x高度（像素）
+     * @return 缩放比例（1表示不缩放）
+     */
+    static double textScaleFactor(const QImage &gray, int targetXHeight);
+
+    /**
+     * @brief 按比例缩放图像，并相应调整分辨率信息
+     * @param image 原始图像
+     * @param factor 缩放比例
+     * @return 缩放后的图像
+     */
+    static QImage scaleImage(const QImage &image, double factor);
+
+    /**
+     * @brief 获取本机支持的最高向量指令级别
+     * @return 向量指令级别
+     */
+    static SimdLevel supportedSimdLevel();
+
+    /**
+     * @brief 向量指令级别的名称
+     * @param level 向量指令级别
+     * @return 名称（如"AVX2"）
+     */
+    static QString simdLevelName(SimdLevel level);
+
+    /**
+     * @brief 根据名称解析预处理方式
+     * @param name 名称（none、gray、otsu、sauvola）
+     * @param ok 返回名称是否有效
+     * @return 预处理方式
+     */
+    static Method methodFromName(const QString &name, bool *ok = nullptr);
+
+    /**
+     * @brief 获取预处理方式的名称
+     * @param method 预处理方式
+     * @return 名称
+     */
+    static QString methodName(Method method);
+
+    /**
+     * @brief 获取所有预处理方式的名称
+     * @return 名称列表
+     */
+    static QStringList methodNames();
+
+    /**
+     * @brief 测量各预处理步骤每百万像素的耗时，并与当前直接编码彩色图像的做法对比
+     *
+     * 依次测量：彩色图像PNG编码（当前交给tesseract的方式）、各向量指令级别的灰度转换、
+     * Otsu和Sauvola二值化、x高度估计、空白页检测，以及灰度图、8位二值图和1位二值图的PNG编码。
+     * @param image 测试图像
+     * @param iterations 每项重复次数（取平均）
+     * @return 各项测试结果
+     */
+    static QList<BenchmarkResult> benchmark(const QImage &image, int iterations = 5);
+};
+
+#endif // IMAGEPREPROCESSOR_H
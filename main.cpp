@@ -1,10 +1,18 @@
 #include "mainwindow.h"
+#include "startupprofiler.h"
+#include "ocrmetrics.h"
+#include "ocrtracer.h"
+#include "ocrcostmodel.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // 记录启动各阶段耗时（首次绘制时输出汇总）
+    StartupProfiler::start();
+
     QApplication a(argc, argv);
+    StartupProfiler::mark("创建QApplication");
 
     // 设置应用程序信息，用于QSettings存储位置
     a.setOrganizationName("ConvenientOCRApp");
@@ -12,7 +20,17 @@ int main(int argc, char *argv[])
     a.setApplicationName("ConvenientOCRApplication");
     a.setApplicationVersion("1.0");
 
+    // 按环境变量配置统计数据导出和时间线追踪
+    OCRMetrics::installExportersFromEnvironment();
+
     MainWindow w;
     w.show();
-    return a.exec();
+    StartupProfiler::mark("显示窗口");
+
+    int exitCode = a.exec();
+
+    // 写出最后一个任务之后的界面更新等时间段，以及尚未保存的耗时测量
+    OCRTracer::flush();
+    OCRCostModel::save();
+    return exitCode;
 }
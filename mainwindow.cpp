@@ -1,5 +1,9 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "startupprofiler.h"
+#include "ocrtracer.h"
+#include "imagepreprocessor.h"
+#include <QtConcurrent>
 
 // 静态成员变量定义
 const QMap<QString, QString> MainWindow::s_languageCodeMap = {
@@ -31,14 +35,25 @@ MainWindow::MainWindow(QWidget *parent)
     , m_fileProcessor(nullptr)
     , m_ocrEngine(nullptr)
     , m_tesseractEngine(nullptr)
+#ifdef HAVE_TESSERACT_LIB
+    , m_tesseractLibEngine(nullptr)
+#endif
+    , m_serviceEngine(nullptr)
+    , m_resultCache(nullptr)
+    , m_ocrWatcher(nullptr)
+    , m_partialResultTimer(nullptr)
+    , m_isBatchOCR(false)
     , m_currentPageIndex(0)
     , m_isProcessing(false)
+    , m_engineInitWatcher(nullptr)
+    , m_engineReady(false)
     , m_hasValidFile(false)
     , m_windowHiddenForCapture(false)
     , m_statusLabel(nullptr)
     , m_statusProgressBar(nullptr)
 {
     ui->setupUi(this);
+    StartupProfiler::mark("加载界面");
 
     // 初始化各个组件
     initUI();
@@ -47,6 +62,7 @@ MainWindow::MainWindow(QWidget *parent)
     connectSignalsAndSlots();
 
     updateUIState(false);
+    StartupProfiler::mark("初始化主窗口");
 }
 
 /**
@@ -55,10 +71,28 @@ MainWindow::MainWindow(QWidget *parent)
  */
 MainWindow::~MainWindow()
 {
+    // 取消仍在进行的识别任务，等待其结束后再释放引擎
+    if (m_ocrWatcher && m_ocrWatcher->isRunning()) {
+        m_ocrWatcher->cancel();
+        m_ocrWatcher->waitForFinished();
+    }
+    if (m_engineInitWatcher) {
+        m_engineInitWatcher->waitForFinished();
+    }
+
     // 清理OCR引擎
     if (m_tesseractEngine) {
         delete m_tesseractEngine;
     }
+#ifdef HAVE_TESSERACT_LIB
+    if (m_tesseractLibEngine) {
+        delete m_tesseractLibEngine;
+    }
+#endif
+    if (m_serviceEngine) {
+        delete m_serviceEngine;
+    }
+    delete m_resultCache;
 
     // 清理文件处理器
     if (m_fileProcessor) {
@@ -101,6 +135,15 @@ void MainWindow::initUI()
 
     // 禁用开始识别按钮（初始状态）
     ui->btnStartOCR->setEnabled(false);
+    m_startButtonText = ui->btnStartOCR->text();
+
+    // 异步识别任务监视器
+    m_ocrWatcher = new QFutureWatcher<OCREngine::OCRResult>(this);
+
+    // 每页完成都重建整个文本的代价随页数平方增长，批量识别中的刷新合并为每300毫秒一次
+    m_partialResultTimer = new QTimer(this);
+    m_partialResultTimer->setSingleShot(true);
+    m_partialResultTimer->setInterval(300);
 }
 
 /**
@@ -118,6 +161,13 @@ void MainWindow::connectSignalsAndSlots()
     connect(ui->btnSaveResult, &QPushButton::clicked, this, &MainWindow::onSaveResultClicked);
     connect(ui->btnClearResult, &QPushButton::clicked, this, &MainWindow::onClearResultClicked);
 
+    // 异步识别结果
+    connect(m_ocrWatcher, &QFutureWatcher<OCREngine::OCRResult>::resultReadyAt,
+            this, &MainWindow::onOCRPageReady);
+    connect(m_ocrWatcher, &QFutureWatcher<OCREngine::OCRResult>::finished,
+            this, &MainWindow::onOCRFutureFinished);
+    connect(m_partialResultTimer, &QTimer::timeout, this, &MainWindow::refreshPartialResult);
+
     // 组合框信号连接
     connect(ui->comboLanguage, &QComboBox::currentTextChanged, this, &MainWindow::onLanguageChanged);
     connect(ui->comboEngine, &QComboBox::currentTextChanged, this, &MainWindow::onEngineChanged);
@@ -151,30 +201,86 @@ void MainWindow::initOCREngine()
     connect(m_fileProcessor, &FileProcessor::errorOccurred,
             this, &MainWindow::onFileProcessError);
 
+    // 识别结果缓存：重复识别同一图像时直接返回上次的结果（磁盘缓存在后台启用）
+    m_resultCache = new OCRResultCache();
+
     // 创建Tesseract OCR引擎
     m_tesseractEngine = new TesseractOCREngine(this);
-
-    // 连接OCR引擎信号
-    connect(m_tesseractEngine, &TesseractOCREngine::progressUpdated,
-            this, &MainWindow::onOCRProgress);
-    connect(m_tesseractEngine, &TesseractOCREngine::batchProgressUpdated,
-            this, &MainWindow::onBatchOCRProgress);
-    connect(m_tesseractEngine, &TesseractOCREngine::ocrCompleted,
-            this, &MainWindow::onOCRCompleted);
-    connect(m_tesseractEngine, &TesseractOCREngine::batchOcrCompleted,
-            this, &MainWindow::onBatchOCRCompleted);
-    connect(m_tesseractEngine, &TesseractOCREngine::errorOccurred,
-            this, &MainWindow::onOCRError);
+    m_tesseractEngine->setResultCache(m_resultCache);
+    connectOCREngineSignals(m_tesseractEngine);
+    ui->comboEngine->setItemData(0, OCREngine::TESSERACT);
+
+#ifdef HAVE_TESSERACT_LIB
+    // 创建进程内Tesseract引擎（模型常驻内存，按需在引擎列表中选择）
+    m_tesseractLibEngine = new TesseractLibOCREngine(this);
+    m_tesseractLibEngine->setResultCache(m_resultCache);
+    connectOCREngineSignals(m_tesseractLibEngine);
+    ui->comboEngine->addItem(m_tesseractLibEngine->getEngineName(), OCREngine::TESSERACT_LIB);
+#endif
+
+    // 常驻OCR服务客户端（需先运行 ConvenientOCRCli --serve），选择时才检查服务是否在运行
+    m_serviceEngine = new RemoteOCREngine(QString(), this);
+    connectOCREngineSignals(m_serviceEngine);
+    ui->comboEngine->addItem(m_serviceEngine->getEngineName(), OCREngine::OCR_SERVICE);
 
     // 设置当前使用的OCR引擎
     m_ocrEngine = m_tesseractEngine;
 
-    // 初始化OCR引擎
-    if (!m_ocrEngine->initialize()) {
+    // 在后台检查外部工具并初始化OCR引擎，窗口无需等待；完成前"开始识别"按钮保持禁用
+    showStatusMessage("正在初始化OCR引擎...", 0);
+    m_engineInitWatcher = new QFutureWatcher<bool>(this);
+    connect(m_engineInitWatcher, &QFutureWatcher<bool>::finished,
+            this, &MainWindow::onEngineInitialized);
+
+    OCREngine *engine = m_ocrEngine;
+    OCRResultCache *resultCache = m_resultCache;
+    m_engineInitWatcher->setFuture(QtConcurrent::run([engine, resultCache]() {
+        resultCache->enableDiskCache();
+        return engine->initialize();
+    }));
+}
+
+/**
+ * @brief 后台OCR引擎初始化完成
+ */
+void MainWindow::onEngineInitialized()
+{
+    StartupProfiler::markBackground("初始化OCR引擎");
+
+    // 无论成功与否都允许开始识别：performOCR和submitBatch在未初始化时都会再次尝试初始化，失败时报告错误
+    m_engineReady = true;
+    updateUIState(m_hasValidFile);
+
+    if (!m_engineInitWatcher->result()) {
+        showStatusMessage("OCR引擎初始化失败");
         QMessageBox::warning(this, "警告",
                            "OCR引擎初始化失败。请确保已正确安装Tesseract OCR。\n\n"
                            "您可以从 https://github.com/tesseract-ocr/tesseract 下载安装。");
+        return;
     }
+
+    // 图像通过管道交给预先加载好模型的tesseract进程，避免临时文件读写
+    m_tesseractEngine->setUseWorkerPool(true);
+    m_tesseractEngine->prewarmWorkers(getCurrentLanguageCode());
+    showStatusMessage("OCR引擎已就绪");
+}
+
+/**
+ * @brief 连接OCR引擎信号到主窗口槽函数
+ * @param engine OCR引擎
+ */
+void MainWindow::connectOCREngineSignals(OCREngine *engine)
+{
+    connect(engine, &OCREngine::progressUpdated,
+            this, &MainWindow::onOCRProgress);
+    connect(engine, &OCREngine::batchProgressUpdated,
+            this, &MainWindow::onBatchOCRProgress);
+    connect(engine, &OCREngine::batchThroughputUpdated,
+            this, &MainWindow::onBatchOCRThroughput);
+    connect(engine, &OCREngine::errorOccurred,
+            this, &MainWindow::onOCRError);
+
+    // 识别结果通过异步任务的QFuture获取（见onOCRPageReady/onOCRFutureFinished）
 }
 
 /**
@@ -185,8 +291,10 @@ void MainWindow::updateUIState(bool hasFile)
 {
     m_hasValidFile = hasFile;
 
-    // 更新按钮状态
-    ui->btnStartOCR->setEnabled(hasFile && !m_isProcessing);
+    // 更新按钮状态（识别进行中时按钮用于取消识别）
+    bool ocrRunning = m_ocrWatcher && m_ocrWatcher->isRunning();
+    ui->btnStartOCR->setEnabled((hasFile && !m_isProcessing && m_engineReady) || ocrRunning);
+    ui->btnStartOCR->setText(ocrRunning ? "⏹ 取消识别" : m_startButtonText);
 
     // 更新菜单项状态
     ui->actionSaveResult->setEnabled(!m_currentOCRResult.isEmpty());
@@ -299,9 +407,12 @@ void MainWindow::onScreenCaptureFinished(const QString &imagePath)
     m_isProcessing = true;
     updateUIState(false);
 
-    // 异步处理截图文件
+    // 异步处理截图文件；截图的文字尺寸取决于屏幕缩放比例，按x高度归一化后再识别
     QTimer::singleShot(100, [this]() {
         FileProcessor::ProcessResult result = m_fileProcessor->processFile(m_currentFilePath);
+        ImagePreprocessor::Options preprocess;
+        preprocess.normalizeTextSize = true;
+        ImagePreprocessor::processAll(result.images, preprocess);
         onFileProcessCompleted(result);
     });
 }
@@ -311,6 +422,14 @@ void MainWindow::onScreenCaptureFinished(const QString &imagePath)
  */
 void MainWindow::onStartOCRClicked()
 {
+    // 识别进行中再次点击表示取消，引擎会立即终止正在运行的识别
+    if (m_ocrWatcher->isRunning()) {
+        m_ocrWatcher->cancel();
+        ui->lblProgressText->setText("正在取消识别...");
+        showStatusMessage("正在取消OCR识别...", 0);
+        return;
+    }
+
     if (m_loadedImages.isEmpty() || m_isProcessing) {
         return;
     }
@@ -318,53 +437,53 @@ void MainWindow::onStartOCRClicked()
     // 获取选择的语言
     QString languageCode = getCurrentLanguageCode();
 
+    // 检查是否为多页文档
+    m_isBatchOCR = m_loadedImages.size() > 1;
+    QImage currentImage = m_loadedImages[m_currentPageIndex];
+    if (!m_isBatchOCR && currentImage.isNull()) {
+        QMessageBox::warning(this, "错误", "当前图像无效");
+        return;
+    }
+
     // 显示处理进度
     ui->progressBar->setValue(0);
     m_statusProgressBar->setVisible(true);
     m_statusProgressBar->setValue(0);
 
     m_isProcessing = true;
-    updateUIState(m_hasValidFile);
 
     // 切换到结果标签页
     ui->tabWidget->setCurrentIndex(1);
 
-    // 检查是否为多页文档
-    if (m_loadedImages.size() > 1) {
+    // 在后台线程中识别，界面保持响应；每页完成后通过onOCRPageReady交付结果
+    m_pageResults.clear();
+    m_throughputText.clear();
+
+    // 空白页检测只用于多页文档；单张图像和截图中低对比度的界面文字不应被当作空白页跳过
+    ImagePreprocessor::BlankPageOptions blankPageOptions = m_ocrEngine->blankPageOptions();
+    blankPageOptions.enabled = m_isBatchOCR;
+    m_ocrEngine->setBlankPageOptions(blankPageOptions);
+
+    if (m_isBatchOCR) {
         // 多页文档：使用批量处理
         ui->lblProgressText->setText("正在批量识别所有页面...");
         showStatusMessage("开始批量OCR识别...", 0);
 
-        // 使用异步方式启动批量OCR
-        QTimer::singleShot(100, [this, languageCode]() {
-            OCREngine::BatchOCRResult result = m_ocrEngine->performBatchOCR(m_loadedImages,
-                                                                           m_imageNames,
-                                                                           languageCode);
-            onBatchOCRCompleted(result);
-        });
-    } else {
-        // 单页文档：使用原有的单页处理
-        QImage currentImage = m_loadedImages[m_currentPageIndex];
-        if (currentImage.isNull()) {
-            QMessageBox::warning(this, "错误", "当前图像无效");
-            m_isProcessing = false;
-            updateUIState(m_hasValidFile);
-            return;
+        for (int i = 0; i < m_loadedImages.size(); ++i) {
+            m_pageResults.append(OCREngine::OCRResult());
         }
-
+        m_ocrWatcher->setFuture(m_ocrEngine->submitDocument(m_loadedImages, m_extractedTexts, languageCode));
+    } else {
+        // 单页文档
         ui->lblProgressText->setText("正在识别文字...");
         showStatusMessage("开始OCR识别...", 0);
 
-        // 使用异步方式启动单页OCR
-        QTimer::singleShot(100, [this, currentImage, languageCode]() {
-            OCREngine::OCRResult result = m_ocrEngine->performOCR(currentImage, languageCode);
-            if (result.success) {
-                onOCRCompleted(result);
-            } else {
-                onOCRError(result.errorMessage);
-            }
-        });
+        m_pageResults.append(OCREngine::OCRResult());
+        m_ocrWatcher->setFuture(m_ocrEngine->submitDocument(QList<QImage>() << currentImage,
+                                                            m_extractedTexts, languageCode));
     }
+
+    updateUIState(m_hasValidFile);
 }
 
 /**
@@ -578,6 +697,7 @@ void MainWindow::onFileProcessCompleted(const FileProcessor::ProcessResult &resu
     if (result.success && !result.images.isEmpty()) {
         m_loadedImages = result.images;
         m_imageNames = result.pageNames;
+        m_extractedTexts = result.extractedTexts;
         m_currentPageIndex = 0;
 
         showCurrentPage();
@@ -689,6 +809,9 @@ void MainWindow::onBatchOCRProgress(int progress, int currentPage, int totalPage
                           .arg(currentPage)
                           .arg(totalPages)
                           .arg(progress);
+    if (!m_throughputText.isEmpty()) {
+        progressText += " " + m_throughputText;
+    }
     ui->lblProgressText->setText(progressText);
 
     QString statusMessage = QString("批量OCR进度: 第%1页 %2% (总体 %3%)")
@@ -698,6 +821,20 @@ void MainWindow::onBatchOCRProgress(int progress, int currentPage, int totalPage
     showStatusMessage(statusMessage, 0);
 }
 
+/**
+ * @brief 批量OCR吞吐量更新
+ * @param pagesPerSecond 每秒完成页数
+ * @param remainingSeconds 预计剩余时间（秒）
+ */
+void MainWindow::onBatchOCRThroughput(double pagesPerSecond, int remainingSeconds)
+{
+    m_throughputText = QString("%1 页/分钟，预计剩余 %2")
+                           .arg(pagesPerSecond * 60.0, 0, 'f', 1)
+                           .arg(remainingSeconds >= 60
+                                    ? QString("%1分%2秒").arg(remainingSeconds / 60).arg(remainingSeconds % 60)
+                                    : QString("%1秒").arg(remainingSeconds));
+}
+
 /**
  * @brief 批量OCR处理完成
  * @param result 批量OCR结果
@@ -722,6 +859,12 @@ void MainWindow::onBatchOCRCompleted(const OCREngine::BatchOCRResult &result)
                      .arg(result.processedPages)
                      .arg(result.totalPages);
         }
+        if (result.blankPages > 0) {
+            message += QString("（其中 %1 页为空白页）").arg(result.blankPages);
+        }
+        if (result.extractedPages > 0) {
+            message += QString("（其中 %1 页取自PDF文本层）").arg(result.extractedPages);
+        }
 
         ui->lblProgressText->setText(message);
         showStatusMessage(message);
@@ -737,6 +880,98 @@ void MainWindow::onBatchOCRCompleted(const OCREngine::BatchOCRResult &result)
     updateUIState(m_hasValidFile);
 }
 
+/**
+ * @brief 异步识别中某一页识别完成
+ * @param pageIndex 页面索引
+ */
+void MainWindow::onOCRPageReady(int pageIndex)
+{
+    if (pageIndex < 0 || pageIndex >= m_pageResults.size()) {
+        return;
+    }
+
+    OCRTracer::Span span("ui_update", pageIndex);
+
+    m_pageResults[pageIndex] = m_ocrWatcher->resultAt(pageIndex);
+
+    // 批量识别时显示已完成页面的文本；页面可能乱序完成，定时器到期时整体刷新一次
+    if (m_isBatchOCR && !m_partialResultTimer->isActive()) {
+        m_partialResultTimer->start();
+    }
+}
+
+/**
+ * @brief 刷新批量识别中已完成页面的文本
+ */
+void MainWindow::refreshPartialResult()
+{
+    if (!m_isBatchOCR || !m_ocrWatcher->isRunning()) {
+        return;
+    }
+
+    OCRTracer::Span span("ui_refresh");
+    OCREngine::BatchOCRResult partialResult;
+    partialResult.totalPages = m_pageResults.size();
+    OCREngine::finalizeBatchResult(partialResult, m_pageResults, m_imageNames);
+    ui->textEditResult->setPlainText(partialResult.combinedText);
+}
+
+/**
+ * @brief 异步识别任务结束（完成或取消）
+ */
+void MainWindow::onOCRFutureFinished()
+{
+    OCRTracer::Span span("ui_finish");
+    m_partialResultTimer->stop();
+    OCRResultCache::Statistics cacheStats = m_resultCache->statistics();
+    qDebug() << "OCR结果缓存: 内存命中" << cacheStats.memoryHits
+             << "磁盘命中" << cacheStats.diskHits
+             << "近似页面命中" << cacheStats.similarHits
+             << "未命中" << cacheStats.misses
+             << "条目" << cacheStats.memoryEntries;
+
+    // 补齐页面名称
+    QStringList pageNames = m_imageNames;
+    while (pageNames.size() < m_pageResults.size()) {
+        pageNames.append(QString("页面 %1").arg(pageNames.size() + 1));
+    }
+
+    if (m_ocrWatcher->isCanceled()) {
+        OCREngine::BatchOCRResult partialResult;
+        partialResult.totalPages = m_pageResults.size();
+        OCREngine::finalizeBatchResult(partialResult, m_pageResults, pageNames);
+
+        m_isProcessing = false;
+        m_statusProgressBar->setVisible(false);
+
+        // 保留已完成页面的结果
+        m_currentOCRResult = partialResult.combinedText;
+        ui->textEditResult->setPlainText(m_currentOCRResult);
+
+        QString message = QString("OCR识别已取消（已完成 %1/%2 页）")
+                         .arg(partialResult.processedPages)
+                         .arg(partialResult.totalPages);
+        ui->lblProgressText->setText(message);
+        showStatusMessage(message);
+        updateUIState(m_hasValidFile);
+        return;
+    }
+
+    if (m_isBatchOCR) {
+        OCREngine::BatchOCRResult result;
+        result.totalPages = m_pageResults.size();
+        OCREngine::finalizeBatchResult(result, m_pageResults, pageNames);
+        onBatchOCRCompleted(result);
+    } else {
+        const OCREngine::OCRResult result = m_pageResults.value(0);
+        if (result.success) {
+            onOCRCompleted(result);
+        } else {
+            onOCRError(result.errorMessage);
+        }
+    }
+}
+
 // 界面更新相关槽函数实现
 
 /**
@@ -748,6 +983,11 @@ void MainWindow::onLanguageChanged()
     QString languageCode = getCurrentLanguageCode();
     showStatusMessage("已选择语言: " + currentLanguage + " (" + languageCode + ")");
 
+    // 提前为新语言加载模型
+    if (m_tesseractEngine) {
+        m_tesseractEngine->prewarmWorkers(languageCode);
+    }
+
     // 保存用户的语言选择偏好
     saveLanguagePreference();
 }
@@ -758,6 +998,48 @@ void MainWindow::onLanguageChanged()
 void MainWindow::onEngineChanged()
 {
     QString engineName = ui->comboEngine->currentText();
+    int engineType = ui->comboEngine->currentData().toInt();
+
+    // 识别进行中或引擎仍在后台初始化时不允许切换引擎
+    if (m_ocrWatcher->isRunning() || !m_engineReady) {
+        int currentIndex = ui->comboEngine->findData(m_ocrEngine->getEngineType());
+        ui->comboEngine->blockSignals(true);
+        ui->comboEngine->setCurrentIndex(currentIndex);
+        ui->comboEngine->blockSignals(false);
+        showStatusMessage(m_engineReady ? "识别进行中，无法切换OCR引擎"
+                                        : "OCR引擎正在初始化，请稍候");
+        return;
+    }
+
+    OCREngine *selectedEngine = m_tesseractEngine;
+#ifdef HAVE_TESSERACT_LIB
+    if (engineType == OCREngine::TESSERACT_LIB) {
+        selectedEngine = m_tesseractLibEngine;
+    }
+#endif
+    if (engineType == OCREngine::OCR_SERVICE) {
+        selectedEngine = m_serviceEngine;
+    }
+
+    if (selectedEngine == m_ocrEngine) {
+        showStatusMessage("已选择OCR引擎: " + engineName);
+        return;
+    }
+
+    // 新引擎初始化失败时保持原引擎不变
+    if (!selectedEngine->initialize()) {
+        int previousIndex = ui->comboEngine->findData(m_ocrEngine->getEngineType());
+        ui->comboEngine->blockSignals(true);
+        ui->comboEngine->setCurrentIndex(previousIndex);
+        ui->comboEngine->blockSignals(false);
+
+        QMessageBox::warning(this, "警告",
+                           QString("%1 初始化失败，继续使用 %2。")
+                           .arg(engineName, m_ocrEngine->getEngineName()));
+        return;
+    }
+
+    m_ocrEngine = selectedEngine;
     showStatusMessage("已选择OCR引擎: " + engineName);
 }
 
@@ -826,6 +1108,12 @@ void MainWindow::updatePageNavigation()
 void MainWindow::showCurrentPage()
 {
     if (m_currentPageIndex >= 0 && m_currentPageIndex < m_loadedImages.size()) {
+        // 文本层页面加载时没有渲染，第一次显示时再渲染该页
+        if (m_loadedImages.at(m_currentPageIndex).isNull() && !m_extractedTexts.value(m_currentPageIndex).isEmpty()) {
+            const int page = m_currentPageIndex + 1;
+            m_loadedImages[m_currentPageIndex] =
+                m_fileProcessor->processPDFPages(m_currentFilePath, page, page).images.value(0);
+        }
         showImagePreview(m_loadedImages[m_currentPageIndex]);
         updatePageNavigation();
     }
@@ -917,20 +1205,9 @@ void MainWindow::startScreenCapture()
  */
 void MainWindow::saveLanguagePreference()
 {
-    QString selectedLanguage = ui->comboLanguage->currentText();
+    // QSettings在对象析构时写入磁盘，无需强制同步
     QSettings settings;
-
-    // 显示QSettings存储位置信息
-    qDebug() << "QSettings文件路径:" << settings.fileName() << Qt::endl;
-
-    settings.setValue("language/selectedLanguage", selectedLanguage);
-    settings.sync(); // 强制同步写入到磁盘
-
-    // 验证写入是否成功 - 重新读取确认
-    QString verifyRead = settings.value("language/selectedLanguage").toString();
-    qDebug() << "已保存语言设置:" << selectedLanguage << Qt::endl;
-    qDebug() << "验证读取结果:" << verifyRead << Qt::endl;
-    qDebug() << "写入验证:" << (selectedLanguage == verifyRead ? "成功" : "失败") << Qt::endl;
+    settings.setValue("language/selectedLanguage", ui->comboLanguage->currentText());
 }
 
 /**
@@ -951,6 +1228,18 @@ void MainWindow::loadLanguagePreference()
     }
 }
 
+/**
+ * @brief 窗口绘制事件处理
+ * @param event 绘制事件
+ */
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+
+    // 只有第一次绘制会被记录
+    StartupProfiler::firstPaint();
+}
+
 /**
  * @brief 窗口大小改变事件处理
  * @param event 大小改变事件
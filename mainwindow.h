@@ -13,10 +13,17 @@
 #include <QTimer>
 #include <QSettings>
 #include <QResizeEvent>
+#include <QPaintEvent>
+#include <QFutureWatcher>
 
 // 引入自定义类
 #include "ocrengine.h"
 #include "tesseractocrengine.h"
+#include "remoteocrengine.h"
+#include "ocrresultcache.h"
+#ifdef HAVE_TESSERACT_LIB
+#include "tesseractlibocrengine.h"
+#endif
 #include "fileprocessor.h"
 #include "screencapture.h"
 #include "licensedialog.h"
@@ -48,6 +55,12 @@ protected:
      */
     void resizeEvent(QResizeEvent *event) override;
 
+    /**
+     * @brief 窗口绘制事件处理（记录首次绘制的启动耗时）
+     * @param event 绘制事件
+     */
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     // UI事件处理槽函数
 
@@ -188,6 +201,13 @@ private slots:
      */
     void onBatchOCRProgress(int progress, int currentPage, int totalPages, int currentPageProgress);
 
+    /**
+     * @brief 批量OCR吞吐量更新
+     * @param pagesPerSecond 每秒完成页数
+     * @param remainingSeconds 预计剩余时间（秒）
+     */
+    void onBatchOCRThroughput(double pagesPerSecond, int remainingSeconds);
+
     /**
      * @brief OCR处理完成
      * @param result OCR结果
@@ -200,6 +220,22 @@ private slots:
      */
     void onBatchOCRCompleted(const OCREngine::BatchOCRResult &result);
 
+    /**
+     * @brief 异步识别中某一页识别完成
+     * @param pageIndex 页面索引
+     */
+    void onOCRPageReady(int pageIndex);
+
+    /**
+     * @brief 刷新批量识别中已完成页面的文本（由定时器节流调用）
+     */
+    void refreshPartialResult();
+
+    /**
+     * @brief 异步识别任务结束（完成或取消）
+     */
+    void onOCRFutureFinished();
+
     /**
      * @brief OCR处理错误
      * @param errorMessage 错误信息
@@ -218,6 +254,11 @@ private slots:
      */
     void onEngineChanged();
 
+    /**
+     * @brief 后台OCR引擎初始化完成
+     */
+    void onEngineInitialized();
+
 private:
     /**
      * @brief 初始化UI组件
@@ -234,6 +275,12 @@ private:
      */
     void initOCREngine();
 
+    /**
+     * @brief 连接OCR引擎信号到主窗口槽函数
+     * @param engine OCR引擎
+     */
+    void connectOCREngineSignals(OCREngine *engine);
+
     /**
      * @brief 更新UI状态
      * @param hasFile 是否已选择文件
@@ -306,16 +353,32 @@ private:
     FileProcessor *m_fileProcessor;            // 文件处理器
     OCREngine *m_ocrEngine;                   // OCR引擎（当前使用的）
     TesseractOCREngine *m_tesseractEngine;    // Tesseract OCR引擎
+#ifdef HAVE_TESSERACT_LIB
+    TesseractLibOCREngine *m_tesseractLibEngine; // 进程内Tesseract OCR引擎
+#endif
+    RemoteOCREngine *m_serviceEngine;         // 常驻OCR服务客户端
+    OCRResultCache *m_resultCache;            // 识别结果缓存（各引擎共享）
 
     // 数据存储
     QList<QImage> m_loadedImages;             // 加载的图像列表
     QStringList m_imageNames;                 // 图像名称列表
+    QStringList m_extractedTexts;             // 各页从PDF文本层提取的文本（为空的页面需要识别）
     QString m_currentFilePath;                // 当前文件路径
     QString m_currentOCRResult;               // 当前OCR识别结果
 
+    // 异步识别
+    QFutureWatcher<OCREngine::OCRResult> *m_ocrWatcher; // 当前识别任务监视器
+    QTimer *m_partialResultTimer;             // 批量识别中刷新已完成页面文本的节流定时器
+    QList<OCREngine::OCRResult> m_pageResults; // 已完成页面的识别结果（按页面索引）
+    bool m_isBatchOCR;                        // 当前任务是否为批量识别
+    QString m_startButtonText;                // 开始识别按钮的原始文字
+    QString m_throughputText;                 // 批量识别的速度和预计剩余时间
+
     // UI状态管理
     int m_currentPageIndex;                   // 当前页面索引
     bool m_isProcessing;                      // 是否正在处理
+    QFutureWatcher<bool> *m_engineInitWatcher; // 后台引擎初始化任务监视器
+    bool m_engineReady;                       // 后台引擎初始化是否已完成
     bool m_hasValidFile;                      // 是否有有效文件
     bool m_windowHiddenForCapture;            // 是否因截图而隐藏窗口
 
@@ -0,0 +1,106 @@
+# 识别核心：文件处理、OCR引擎、结果缓存和统计，由图形界面和命令行工具共用
+# 使用前需先设置TARGET（中间文件目录按目标区分，避免两个目标并行构建时互相覆盖）
+QT       += core gui concurrent network
+
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/ocrengine.cpp \
+    $$PWD/ocrresultcache.cpp \
+    $$PWD/pagehashindex.cpp \
+    $$PWD/ocrlayout.cpp \
+    $$PWD/ocrcostmodel.cpp \
+    $$PWD/ocrmetrics.cpp \
+    $$PWD/ocrtracer.cpp \
+    $$PWD/toolregistry.cpp \
+    $$PWD/tesseractocrengine.cpp \
+    $$PWD/tesseractworkerpool.cpp \
+    $$PWD/fileprocessor.cpp \
+    $$PWD/imagepreprocessor.cpp \
+    $$PWD/tiledrecognizer.cpp \
+    $$PWD/pdfstreamrecognizer.cpp \
+    $$PWD/ocrservice.cpp \
+    $$PWD/remoteocrengine.cpp
+
+HEADERS += \
+    $$PWD/ocrengine.h \
+    $$PWD/ocrresultcache.h \
+    $$PWD/pagehashindex.h \
+    $$PWD/ocrlayout.h \
+    $$PWD/ocrcostmodel.h \
+    $$PWD/ocrmetrics.h \
+    $$PWD/ocrtracer.h \
+    $$PWD/toolregistry.h \
+    $$PWD/tesseractocrengine.h \
+    $$PWD/tesseractworkerpool.h \
+    $$PWD/fileprocessor.h \
+    $$PWD/imagepreprocessor.h \
+    $$PWD/tiledrecognizer.h \
+    $$PWD/pdfstreamrecognizer.h \
+    $$PWD/ocrservice.h \
+    $$PWD/remoteocrengine.h
+
+# 进程内Tesseract引擎（可选，需要libtesseract和leptonica开发文件）
+# 启用方式: qmake "CONFIG+=tesseract_lib" [TESSERACT_SDK=<安装目录>]
+tesseract_lib {
+    DEFINES += HAVE_TESSERACT_LIB
+
+    SOURCES += $$PWD/tesseractlibocrengine.cpp
+    HEADERS += $$PWD/tesseractlibocrengine.h
+
+    !isEmpty(TESSERACT_SDK) {
+        INCLUDEPATH += $$TESSERACT_SDK/include
+        LIBS += -L$$TESSERACT_SDK/lib -ltesseract -lleptonica
+    } else: unix {
+        CONFIG += link_pkgconfig
+        PKGCONFIG += tesseract lept
+    } else {
+        LIBS += -ltesseract -lleptonica
+    }
+}
+
+# 进程内PDF渲染（可选，需要poppler-qt6开发文件；未启用时调用pdftoppm）
+# 启用方式: qmake "CONFIG+=poppler_qt" [POPPLER_SDK=<安装目录>]
+poppler_qt {
+    DEFINES += HAVE_POPPLER_QT
+
+    SOURCES += $$PWD/popplerrenderer.cpp
+    HEADERS += $$PWD/popplerrenderer.h
+
+    !isEmpty(POPPLER_SDK) {
+        INCLUDEPATH += $$POPPLER_SDK/include/poppler/qt6
+        LIBS += -L$$POPPLER_SDK/lib -lpoppler-qt6
+    } else: unix {
+        CONFIG += link_pkgconfig
+        PKGCONFIG += poppler-qt6
+    } else {
+        LIBS += -lpoppler-qt6
+    }
+}
+
+win32 {
+    # 统计峰值内存（GetProcessMemoryInfo）
+    LIBS += -lpsapi
+}
+
+# 调试和发布配置
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/build/debug
+    OBJECTS_DIR = $$PWD/build/debug/obj/$$TARGET
+    MOC_DIR = $$PWD/build/debug/moc/$$TARGET
+    RCC_DIR = $$PWD/build/debug/rcc/$$TARGET
+    UI_DIR = $$PWD/build/debug/ui/$$TARGET
+}
+
+CONFIG(release, debug|release) {
+    DESTDIR = $$PWD/build/release
+    OBJECTS_DIR = $$PWD/build/release/obj/$$TARGET
+    MOC_DIR = $$PWD/build/release/moc/$$TARGET
+    RCC_DIR = $$PWD/build/release/rcc/$$TARGET
+    UI_DIR = $$PWD/build/release/ui/$$TARGET
+
+    # 发布版本优化
+    DEFINES += QT_NO_DEBUG_OUTPUT
+}
@@ -0,0 +1,279 @@
+#include "ocrcostmodel.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+
+namespace {
+
+const double s_defaultMsPerMegapixel = 700.0; // 无测量数据时每种语言每百万像素的耗时
+const qint64 s_overheadPerLanguageMs = 400;   // 每种语言的进程启动和模型加载开销
+const double s_smoothing = 0.3;               // 指数加权平均中新样本的权重
+
+/**
+ * @brief 语言组合的测量记录
+ */
+struct CostRecord {
+    double msPerMegapixel;  // 每百万像素的识别耗时
+    int samples;            // 样本数
+    bool dirty;             // 是否有尚未写入QSettings的更新
+};
+
+QMutex s_costMutex;                     // 保护s_records和QSettings读写
+QHash<QString, CostRecord> s_records;   // 已加载的测量记录
+bool s_dirty = false;                   // 是否有记录需要写入QSettings
+
+/**
+ * @brief 语言组合中的语言数量
+ */
+int languageCount(const QString &language)
+{
+    return qMax(1, static_cast<int>(language.count('+')) + 1);
+}
+
+/**
+ * @brief 图像的百万像素数（过小的图像按0.01计，避免除零）
+ */
+double megapixels(const QSize &size)
+{
+    return qMax(0.01, static_cast<double>(size.width()) * size.height() / 1e6);
+}
+
+/**
+ * @brief 语言组合对应的QSettings键
+ */
+QString settingsKey(const QString &language)
+{
+    // 语言代码可能包含QSettings不允许的字符，统一转为十六进制
+    return "OCRCostModel/" + QString::fromLatin1(language.toUtf8().toHex());
+}
+
+/**
+ * @brief 查找语言组合的测量记录（先查内存，再查QSettings），调用方需持有锁
+ */
+CostRecord &recordFor(const QString &language)
+{
+    auto it = s_records.find(language);
+    if (it != s_records.end()) {
+        return it.value();
+    }
+
+    CostRecord record;
+    record.msPerMegapixel = s_defaultMsPerMegapixel * languageCount(language);
+    record.samples = 0;
+    record.dirty = false;
+
+    QSettings settings;
+    settings.beginGroup(settingsKey(language));
+    if (settings.contains("msPerMegapixel")) {
+        record.msPerMegapixel = settings.value("msPerMegapixel").toDouble();
+        record.samples = settings.value("samples").toInt();
+    }
+    settings.endGroup();
+
+    return s_records.insert(language, record).value();
+}
+
+} // namespace
+
+/**
+ * @brief 预测页面的识别耗时
+ * @param size 图像尺寸
+ * @param language 识别语言代码
+ * @return 预测耗时（毫秒）
+ */
+qint64 OCRCostModel::predictMs(const QSize &size, const QString &language)
+{
+    return overheadMs(language) + static_cast<qint64>(msPerMegapixel(language) * megapixels(size));
+}
+
+/**
+ * @brief 根据预测耗时计算页面超时时间
+ * @param size 图像尺寸
+ * @param language 识别语言代码
+ * @return 超时时间（毫秒）
+ */
+int OCRCostModel::timeoutMs(const QSize &size, const QString &language)
+{
+    const qint64 timeout = predictMs(size, language) * 4 + 10000;
+    return static_cast<int>(qBound<qint64>(30000, timeout, 600000));
+}
+
+/**
+ * @brief 记录一次成功识别的实际耗时
+ * @param size 图像尺寸
+ * @param language 识别语言代码
+ * @param elapsedMs 实际耗时（毫秒）
+ * @param includesStartup 耗时是否包含进程启动和模型加载
+ */
+void OCRCostModel::record(const QSize &size, const QString &language, qint64 elapsedMs, bool includesStartup)
+{
+    if (size.isEmpty() || elapsedMs <= 0) {
+        return;
+    }
+
+    const qint64 recognitionMs = includesStartup ? qMax<qint64>(0, elapsedMs - overheadMs(language)) : elapsedMs;
+    const double sample = recognitionMs / megapixels(size);
+
+    QMutexLocker locker(&s_costMutex);
+    CostRecord &record = recordFor(language);
+
+    // 第一个样本直接替换默认值，之后按指数加权平均逐步适应
+    if (record.samples == 0) {
+        record.msPerMegapixel = sample;
+    } else {
+        record.msPerMegapixel = (1.0 - s_smoothing) * record.msPerMegapixel + s_smoothing * sample;
+    }
+    record.samples++;
+
+    // 只更新内存，批量识别时不为每页重写一次设置文件
+    record.dirty = true;
+    s_dirty = true;
+}
+
+/**
+ * @brief 根据已用时间估算页面进度
+ * @param elapsedMs 已用时间（毫秒）
+ * @param predictedMs 预测耗时（毫秒）
+ * @param from 起始进度
+ * @param to 进度上限
+ * @return 进度百分比
+ */
+int OCRCostModel::estimateProgress(qint64 elapsedMs, qint64 predictedMs, int from, int to)
+{
+    if (predictedMs <= 0 || elapsedMs <= 0) {
+        return from;
+    }
+
+    // 预测耗时内线性增长到90%，超出后逐渐逼近上限
+    const double ratio = static_cast<double>(elapsedMs) / predictedMs;
+    const double fraction = ratio <= 1.0 ? ratio * 0.9 : 1.0 - 0.1 / ratio;
+    return from + static_cast<int>((to - from) * fraction);
+}
+
+/**
+ * @brief 把上次保存后更新过的测量记录写入QSettings
+ */
+void OCRCostModel::save()
+{
+    QMutexLocker locker(&s_costMutex);
+    if (!s_dirty) {
+        return;
+    }
+
+    QSettings settings;
+    for (auto it = s_records.begin(); it != s_records.end(); ++it) {
+        CostRecord &record = it.value();
+        if (!record.dirty) {
+            continue;
+        }
+        settings.beginGroup(settingsKey(it.key()));
+        settings.setValue("msPerMegapixel", record.msPerMegapixel);
+        settings.setValue("samples", record.samples);
+        settings.endGroup();
+        record.dirty = false;
+    }
+    s_dirty = false;
+}
+
+/**
+ * @brief 清除所有测量数据
+ */
+void OCRCostModel::reset()
+{
+    QMutexLocker locker(&s_costMutex);
+    s_records.clear();
+    s_dirty = false;
+
+    QSettings settings;
+    settings.remove("OCRCostModel");
+}
+
+/**
+ * @brief 获取语言组合每百万像素的识别耗时
+ * @param language 识别语言代码
+ * @return 毫秒每百万像素
+ */
+double OCRCostModel::msPerMegapixel(const QString &language)
+{
+    QMutexLocker locker(&s_costMutex);
+    return recordFor(language).msPerMegapixel;
+}
+
+/**
+ * @brief 语言组合的固定开销
+ * @param language 识别语言代码
+ * @return 毫秒
+ */
+qint64 OCRCostModel::overheadMs(const QString &language)
+{
+    return s_overheadPerLanguageMs * languageCount(language);
+}
+
+/**
+ * @brief 构造估算器并开始计时
+ * @param predictedMs 各页面的预测耗时（毫秒）
+ * @param parallelism 同时识别的页数
+ */
+OCRBatchEstimator::OCRBatchEstimator(const QList<qint64> &predictedMs, int parallelism)
+    : m_predictedMs(predictedMs)
+    , m_parallelism(qMax(1, parallelism))
+    , m_finishedPages(0)
+    , m_remainingPredictedMs(0)
+    , m_measuredPredictedMs(0)
+{
+    for (qint64 ms : m_predictedMs) {
+        m_finished.append(false);
+        m_remainingPredictedMs += ms;
+    }
+    m_timer.start();
+}
+
+/**
+ * @brief 标记页面完成
+ * @param pageIndex 页面索引
+ * @param measured 该页是否实际执行了识别
+ */
+void OCRBatchEstimator::pageFinished(int pageIndex, bool measured)
+{
+    if (pageIndex < 0 || pageIndex >= m_finished.size() || m_finished[pageIndex]) {
+        return;
+    }
+
+    m_finished[pageIndex] = true;
+    m_finishedPages++;
+    m_remainingPredictedMs -= m_predictedMs[pageIndex];
+    if (measured) {
+        m_measuredPredictedMs += m_predictedMs[pageIndex];
+    }
+}
+
+/**
+ * @brief 获取当前吞吐量
+ * @return 每秒完成页数
+ */
+double OCRBatchEstimator::pagesPerSecond() const
+{
+    const qint64 elapsed = m_timer.elapsed();
+    return elapsed > 0 ? m_finishedPages * 1000.0 / elapsed : 0.0;
+}
+
+/**
+ * @brief 获取预计剩余时间
+ * @return 剩余秒数
+ */
+int OCRBatchEstimator::remainingSeconds() const
+{
+    if (m_remainingPredictedMs <= 0) {
+        return 0;
+    }
+
+    // 实际耗时与预测耗时之比已包含并发的影响
+    double remainingMs;
+    if (m_measuredPredictedMs > 0) {
+        remainingMs = m_remainingPredictedMs * (static_cast<double>(m_timer.elapsed()) / m_measuredPredictedMs);
+    } else {
+        remainingMs = static_cast<double>(m_remainingPredictedMs) / m_parallelism;
+    }
+    return static_cast<int>((remainingMs + 999) / 1000);
+}
@@ -0,0 +1,133 @@
+#ifndef OCRCOSTMODEL_H
+#define OCRCOSTMODEL_H
+
+#include <QString>
+#include <QSize>
+#include <QList>
+#include <QElapsedTimer>
+
+/**
+ * @brief OCR耗时预测模型
+ *
+ * 按语言组合记录本机每百万像素的识别耗时（指数加权平均），用于预测页面识别时间。
+ * 预测结果用于设置单页超时、估算进度以及批量识别时优先调度耗时长的页面。
+ * 测量数据保存在QSettings中，程序重启后仍然有效；尚无测量数据时按语言数量给出
+ * 保守的默认值。每页的测量只更新内存中的记录，在任务结束和程序退出时由save()统一写入。
+ *
+ * 所有接口都是线程安全的。
+ */
+class OCRCostModel
+{
+public:
+    /**
+     * @brief 预测页面的识别耗时
+     * @param size 图像尺寸
+     * @param language 识别语言代码（如"chi_sim+eng"）
+     * @return 预测耗时（毫秒）
+     */
+    static qint64 predictMs(const QSize &size, const QString &language);
+
+    /**
+     * @brief 根据预测耗时计算页面超时时间
+     *
+     * 超时为预测耗时的数倍，且不少于30秒、不超过10分钟，高分辨率的密集页面不会被误杀。
+     * @param size 图像尺寸
+     * @param language 识别语言代码
+     * @return 超时时间（毫秒）
+     */
+    static int timeoutMs(const QSize &size, const QString &language);
+
+    /**
+     * @brief 记录一次成功识别的实际耗时
+     * @param size 图像尺寸
+     * @param language 识别语言代码
+     * @param elapsedMs 实际耗时（毫秒）
+     * @param includesStartup 耗时是否包含进程启动和模型加载（同一进程连续识别的后续页面不包含）
+     */
+    static void record(const QSize &size, const QString &language, qint64 elapsedMs,
+                       bool includesStartup = true);
+
+    /**
+     * @brief 根据已用时间估算页面进度
+     * @param elapsedMs 已用时间（毫秒）
+     * @param predictedMs 预测耗时（毫秒）
+     * @param from 起始进度
+     * @param to 进度上限（超出预测耗时后缓慢逼近但不超过该值）
+     * @return 进度百分比
+     */
+    static int estimateProgress(qint64 elapsedMs, qint64 predictedMs, int from, int to);
+
+    /**
+     * @brief 把上次保存后更新过的测量记录写入QSettings
+     *
+     * 没有更新时不访问QSettings。由最外层识别任务结束时和程序退出前调用。
+     */
+    static void save();
+
+    /**
+     * @brief 清除所有测量数据
+     */
+    static void reset();
+
+private:
+    /**
+     * @brief 获取语言组合每百万像素的识别耗时
+     * @param language 识别语言代码
+     * @return 毫秒每百万像素
+     */
+    static double msPerMegapixel(const QString &language);
+
+    /**
+     * @brief 语言组合的固定开销（进程启动和模型加载）
+     * @param language 识别语言代码
+     * @return 毫秒
+     */
+    static qint64 overheadMs(const QString &language);
+};
+
+/**
+ * @brief 批量识别的吞吐量与剩余时间估算
+ *
+ * 剩余时间为未完成页面的预测耗时之和，按已完成页面的实际耗时与预测耗时之比修正；
+ * 尚无页面完成时按并发数折算。
+ */
+class OCRBatchEstimator
+{
+public:
+    /**
+     * @brief 构造估算器并开始计时
+     * @param predictedMs 各页面的预测耗时（毫秒）
+     * @param parallelism 同时识别的页数
+     */
+    OCRBatchEstimator(const QList<qint64> &predictedMs, int parallelism);
+
+    /**
+     * @brief 标记页面完成
+     * @param pageIndex 页面索引
+     * @param measured 该页是否实际执行了识别（缓存命中或无效页面不计入修正）
+     */
+    void pageFinished(int pageIndex, bool measured = true);
+
+    /**
+     * @brief 获取当前吞吐量
+     * @return 每秒完成页数
+     */
+    double pagesPerSecond() const;
+
+    /**
+     * @brief 获取预计剩余时间
+     * @return 剩余秒数
+     */
+    int remainingSeconds() const;
+
+private:
+    QList<qint64> m_predictedMs;    // 各页面的预测耗时
+    QList<bool> m_finished;         // 各页面是否已完成
+    int m_parallelism;              // 同时识别的页数
+    int m_finishedPages;            // 已完成页数
+    qint64 m_remainingPredictedMs;  // 未完成页面的预测耗时之和
+    qint64 m_measuredPredictedMs;   // 实际识别完成页面的预测耗时之和
+    QElapsedTimer m_timer;          // 批量识别计时
+};
+
+#endif // OCRCOSTMODEL_H
@@ -1,4 +1,10 @@
 #include "ocrengine.h"
+#include "ocrresultcache.h"
+#include "ocrmetrics.h"
+#include <QtConcurrent>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QThreadPool>
 
 /**
  * @brief OCREngine构造函数
@@ -7,6 +13,360 @@
 OCREngine::OCREngine(QObject *parent)
     : QObject(parent)
     , m_initialized(false)
+    , m_resultCache(nullptr)
 {
     // 基类构造函数，初始化成员变量
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 根据逐页识别结果填充批量结果
+ * @param batchResult 待填充的批量结果
+ * @param pageResults 按页面顺序排列的单页识别结果
+ * @param pageNames 页面名称列表
+ */
+void OCREngine::finalizeBatchResult(BatchOCRResult &batchResult,
+                                    const QList<OCRResult> &pageResults,
+                                    const QStringList &pageNames)
+{
+    batchResult.texts.clear();
+    batchResult.confidences.clear();
+    batchResult.pageStatuses.clear();
+    batchResult.processedPages = 0;
+    batchResult.blankPages = 0;
+    batchResult.extractedPages = 0;
+    batchResult.pageNames = pageNames;
+
+    QStringList combinedParts;
+    for (int i = 0; i < pageResults.size(); ++i) {
+        const OCRResult &pageResult = pageResults[i];
+
+        if (pageResult.success) {
+            batchResult.texts.append(pageResult.text);
+            batchResult.confidences.append(pageResult.confidence);
+            batchResult.pageStatuses.append(pageResult.blankPage ? PAGE_BLANK
+                                            : pageResult.extracted ? PAGE_EXTRACTED : PAGE_RECOGNIZED);
+            batchResult.processedPages++;
+            if (pageResult.blankPage) {
+                batchResult.blankPages++;
+            }
+            if (pageResult.extracted) {
+                batchResult.extractedPages++;
+            }
+
+            if (!pageResult.text.isEmpty()) {
+                combinedParts.append(QString("=== %1 ===\n%2")
+                                    .arg(pageNames.value(i))
+                                    .arg(pageResult.text));
+            }
+        } else {
+            batchResult.texts.append(QString("错误: %1").arg(pageResult.errorMessage));
+            batchResult.confidences.append(0.0f);
+            batchResult.pageStatuses.append(PAGE_FAILED);
+        }
+    }
+
+    batchResult.combinedText = combinedParts.join("\n\n");
+    batchResult.success = batchResult.processedPages > 0;
+
+    if (batchResult.processedPages == 0) {
+        batchResult.errorMessage = "所有页面处理失败";
+    } else if (batchResult.processedPages < pageResults.size()) {
+        batchResult.errorMessage = QString("部分页面处理失败: 成功 %1/%2 页")
+                                  .arg(batchResult.processedPages)
+                                  .arg(pageResults.size());
+    }
+}
+
+/**
+ * @brief 异步执行OCR识别
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @return 包含一个识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> OCREngine::submitOCR(const QImage &image, const QString &language)
+{
+    return submitBatch(QList<QImage>() << image, language);
+}
+
+/**
+ * @brief 异步执行批量OCR识别（默认实现：在全局线程池中逐页调用recognizeForAsync）
+ * @param images 待识别的图像列表
+ * @param language 识别语言代码
+ * @return 按页面索引存放识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> OCREngine::submitBatch(const QList<QImage> &images, const QString &language)
+{
+    return QtConcurrent::run([this, images, language](QPromise<OCRResult> &promise) {
+        OCRMetrics::JobScope job;
+        const int totalPages = images.size();
+        promise.setProgressRange(0, totalPages);
+
+        for (int i = 0; i < totalPages; ++i) {
+            if (promise.isCanceled()) {
+                return;
+            }
+
+            emit batchProgressUpdated((i * 100) / totalPages, i + 1, totalPages, 0);
+
+            OCRResult pageResult;
+            if (images[i].isNull()) {
+                pageResult.errorMessage = QString("第%1页图像无效").arg(i + 1);
+            } else if (!detectBlankPage(images[i], pageResult)) {
+                QByteArray cacheKey = resultCacheKey(images[i], language);
+                if (!lookupCachedResult(cacheKey, pageResult)) {
+                    pageResult = recognizeForAsync(images[i], language, promise);
+                    storeCachedResult(cacheKey, pageResult);
+                }
+            }
+
+            promise.addResult(pageResult, i);
+            promise.setProgressValue(i + 1);
+            emit batchProgressUpdated(((i + 1) * 100) / totalPages, i + 1, totalPages, 100);
+        }
+    });
+}
+
+/**
+ * @brief 异步识别文档，已有文本层的页面跳过识别
+ * @param images 页面图像列表
+ * @param extractedTexts 各页从文本层提取的文本
+ * @param language 识别语言代码
+ * @return 按页面索引存放识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> OCREngine::submitDocument(const QList<QImage> &images,
+                                                        const QStringList &extractedTexts,
+                                                        const QString &language)
+{
+    if (extractedTexts.isEmpty()) {
+        return submitBatch(images, language);
+    }
+
+    return QtConcurrent::run([this, images, extractedTexts, language](QPromise<OCRResult> &promise) {
+        const int totalPages = images.size();
+        promise.setProgressRange(0, totalPages);
+
+        // 文本层页面的结果立即可用，其余页面作为一批识别后按原页面索引放回
+        QList<QImage> pendingImages;
+        QList<int> pendingIndexes;
+        int finishedPages = 0;
+        for (int i = 0; i < totalPages; ++i) {
+            const QString text = extractedTexts.value(i);
+            if (text.isEmpty()) {
+                pendingImages.append(images.at(i));
+                pendingIndexes.append(i);
+            } else {
+                promise.addResult(extractedResult(text), i);
+                finishedPages++;
+            }
+        }
+        promise.setProgressValue(finishedPages);
+
+        if (pendingImages.isEmpty()) {
+            return;
+        }
+
+        QFuture<OCRResult> future = submitBatch(pendingImages, language);
+        if (!waitForBatch(future, promise, [&](int progress) { promise.setProgressValue(finishedPages + progress); })) {
+            return;
+        }
+
+        for (int i = 0; i < pendingImages.size(); ++i) {
+            if (future.isResultReadyAt(i)) {
+                promise.addResult(future.resultAt(i), pendingIndexes.at(i));
+            }
+        }
+        promise.setProgressValue(finishedPages + pendingImages.size());
+    });
+}
+
+/**
+ * @brief 在线程池任务中等待嵌套提交的识别任务完成
+ * @param future 嵌套提交的识别任务
+ * @param promise 外层任务的QPromise
+ * @param progressChanged 嵌套任务进度变化时调用
+ * @return 外层任务是否未被取消
+ */
+bool OCREngine::waitForBatch(QFuture<OCRResult> future, QPromise<OCRResult> &promise,
+                             const std::function<void(int)> &progressChanged)
+{
+    if (!future.isFinished()) {
+        // 等待期间让出线程池名额，嵌套任务可能正排在本线程之后
+        QThreadPool::globalInstance()->releaseThread();
+
+        QEventLoop loop;
+        QFutureWatcher<OCRResult> batchWatcher;
+        QFutureWatcher<OCRResult> outerWatcher;
+        QObject::connect(&batchWatcher, &QFutureWatcher<OCRResult>::finished, &loop, &QEventLoop::quit);
+        if (progressChanged) {
+            QObject::connect(&batchWatcher, &QFutureWatcher<OCRResult>::progressValueChanged, &loop, progressChanged);
+        }
+        QObject::connect(&outerWatcher, &QFutureWatcher<OCRResult>::canceled, &loop, [&future]() { future.cancel(); });
+        batchWatcher.setFuture(future);
+        outerWatcher.setFuture(promise.future());
+        if (promise.isCanceled()) {
+            future.cancel();
+        }
+        if (!future.isFinished()) {
+            loop.exec();
+        }
+
+        QThreadPool::globalInstance()->reserveThread();
+    }
+
+    if (progressChanged) {
+        progressChanged(future.progressValue());
+    }
+    return !promise.isCanceled();
+}
+
+/**
+ * @brief 生成取自PDF文本层的页面结果
+ * @param text 页面文本
+ * @return 识别结果
+ */
+OCREngine::OCRResult OCREngine::extractedResult(const QString &text)
+{
+    OCRResult result;
+    result.text = text;
+    result.confidence = 1.0f;
+    result.success = true;
+    result.extracted = true;
+    return result;
+}
+
+/**
+ * @brief 异步批量识别中识别单页的默认实现
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @param promise 当前异步任务
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult OCREngine::recognizeForAsync(const QImage &image, const QString &language,
+                                                  const QPromise<OCRResult> &promise)
+{
+    Q_UNUSED(promise)
+    return performOCR(image, language);
+}
+
+/**
+ * @brief 设置识别结果缓存
+ * @param cache 结果缓存
+ */
+void OCREngine::setResultCache(OCRResultCache *cache)
+{
+    m_resultCache = cache;
+}
+
+/**
+ * @brief 获取识别结果缓存
+ * @return 结果缓存
+ */
+OCRResultCache *OCREngine::resultCache() const
+{
+    return m_resultCache;
+}
+
+/**
+ * @brief 设置空白页检测选项
+ * @param options 检测选项
+ */
+void OCREngine::setBlankPageOptions(const ImagePreprocessor::BlankPageOptions &options)
+{
+    m_blankPageOptions = options;
+}
+
+/**
+ * @brief 获取空白页检测选项
+ * @return 检测选项
+ */
+ImagePreprocessor::BlankPageOptions OCREngine::blankPageOptions() const
+{
+    return m_blankPageOptions;
+}
+
+/**
+ * @brief 识别前检查空白页
+ * @param image 待识别的图像
+ * @param result 是空白页时写入的结果
+ * @return 是否为空白页
+ */
+bool OCREngine::detectBlankPage(const QImage &image, OCRResult &result) const
+{
+    if (!m_blankPageOptions.enabled || image.isNull()) {
+        return false;
+    }
+
+    bool blank = false;
+    {
+        OCRMetrics::ScopedTimer timer("blank_check");
+        blank = ImagePreprocessor::isBlankPage(image, m_blankPageOptions);
+    }
+    if (!blank) {
+        return false;
+    }
+
+    OCRMetrics::increment("blank_pages");
+    result = OCRResult();
+    result.success = true;
+    result.confidence = 1.0f;
+    result.blankPage = true;
+    return true;
+}
+
+/**
+ * @brief 获取影响识别结果的上下文描述
+ * @param language 识别语言代码
+ * @return 上下文字符串
+ */
+QString OCREngine::cacheContext(const QString &language) const
+{
+    return getEngineName() + "|" + language;
+}
+
+/**
+ * @brief 计算图像的缓存键
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @return 缓存键
+ */
+QByteArray OCREngine::resultCacheKey(const QImage &image, const QString &language) const
+{
+    if (!m_resultCache || image.isNull()) {
+        return QByteArray();
+    }
+
+    // 登记页面图像，精确查找未命中时再查找近似重复的页面
+    const QString context = cacheContext(language);
+    const QByteArray key = OCRResultCache::makeKey(image, context);
+    m_resultCache->notePage(key, image, context);
+    return key;
+}
+
+/**
+ * @brief 查找缓存的识别结果
+ * @param key 缓存键
+ * @param result 命中时写入的识别结果
+ * @return 是否命中
+ */
+bool OCREngine::lookupCachedResult(const QByteArray &key, OCRResult &result) const
+{
+    if (!m_resultCache) {
+        return false;
+    }
+
+    bool hit = m_resultCache->lookup(key, result);
+    OCRMetrics::increment(hit ? "cache_hits" : "cache_misses");
+    return hit;
+}
+
+/**
+ * @brief 缓存识别结果
+ * @param key 缓存键
+ * @param result 识别结果
+ */
+void OCREngine::storeCachedResult(const QByteArray &key, const OCRResult &result)
+{
+    if (m_resultCache) {
+        m_resultCache->insert(key, result);
+    }
+}
@@ -4,6 +4,13 @@
 #include <QString>
 #include <QImage>
 #include <QObject>
+#include <QFuture>
+#include <QPromise>
+#include <functional>
+#include "ocrlayout.h"
+#include "imagepreprocessor.h"
+
+class OCRResultCache;
 
 /**
  * @brief OCR引擎抽象基类
@@ -21,11 +28,23 @@ public:
      */
     enum EngineType {
         TESSERACT,          // Tesseract OCR引擎
+        TESSERACT_LIB,      // Tesseract OCR引擎（进程内libtesseract）
+        OCR_SERVICE,        // 常驻OCR服务的客户端
         PADDLE_OCR,         // PaddleOCR引擎（预留）
         EASY_OCR,           // EasyOCR引擎（预留）
         CUSTOM              // 自定义引擎（预留）
     };
 
+    /**
+     * @brief 批量识别中单页的处理状态
+     */
+    enum PageStatus {
+        PAGE_RECOGNIZED,    // 已识别
+        PAGE_BLANK,         // 空白页，未经识别
+        PAGE_EXTRACTED,     // 文本取自PDF文本层，未经识别
+        PAGE_FAILED         // 识别失败
+    };
+
     /**
      * @brief OCR识别结果结构体
      */
@@ -34,8 +53,11 @@ public:
         float confidence;       // 置信度（0.0-1.0）
         bool success;          // 是否识别成功
         QString errorMessage;   // 错误信息（如果失败）
+        OCRLayout layout;       // 版面结构（文本块、行、单词及其边框和置信度）
+        bool blankPage;         // 是否为空白页（跳过识别，success为true且文本为空）
+        bool extracted;         // 文本是否取自PDF文本层（跳过识别，没有版面结构）
 
-        OCRResult() : confidence(0.0), success(false) {}
+        OCRResult() : confidence(0.0), success(false), blankPage(false), extracted(false) {}
     };
 
     /**
@@ -48,10 +70,13 @@ public:
         QString combinedText;       // 合并后的全部文本
         bool success;              // 是否处理成功
         QString errorMessage;       // 错误信息（如果失败）
-        int processedPages;         // 成功处理的页面数
+        int processedPages;         // 成功处理的页面数（含空白页和取自文本层的页面）
         int totalPages;             // 总页面数
+        QList<PageStatus> pageStatuses; // 每页的处理状态
+        int blankPages;             // 跳过识别的空白页数
+        int extractedPages;         // 取自PDF文本层的页数
 
-        BatchOCRResult() : success(false), processedPages(0), totalPages(0) {}
+        BatchOCRResult() : success(false), processedPages(0), totalPages(0), blankPages(0), extractedPages(0) {}
     };
 
     explicit OCREngine(QObject *parent = nullptr);
@@ -106,6 +131,106 @@ public:
      */
     virtual QStringList getSupportedLanguages() const = 0;
 
+    /**
+     * @brief 异步执行OCR识别
+     *
+     * 识别在后台线程中进行，不阻塞调用线程。对返回的QFuture调用cancel()可取消识别。
+     * @param image 待识别的图像
+     * @param language 识别语言代码
+     * @return 包含一个识别结果的QFuture
+     */
+    virtual QFuture<OCRResult> submitOCR(const QImage &image, const QString &language = "chi_sim+eng");
+
+    /**
+     * @brief 异步执行批量OCR识别
+     *
+     * 每页完成后立即以页面索引为下标写入结果（可通过QFutureWatcher::resultReadyAt逐页获取），
+     * 进度值为已完成的页数。对返回的QFuture调用cancel()会尽快停止正在进行的识别。
+     * @param images 待识别的图像列表
+     * @param language 识别语言代码
+     * @return 按页面索引存放识别结果的QFuture
+     */
+    virtual QFuture<OCRResult> submitBatch(const QList<QImage> &images, const QString &language = "chi_sim+eng");
+
+    /**
+     * @brief 异步识别文档：已有文本层的页面直接使用提取的文本，其余页面交给submitBatch
+     *
+     * 结果按页面索引存放，进度最大值为总页数，与submitBatch相同。
+     * extractedTexts为空时等同于submitBatch。
+     * @param images 页面图像列表
+     * @param extractedTexts 各页从文本层提取的文本（为空的页面需要识别）
+     * @param language 识别语言代码
+     * @return 按页面索引存放识别结果的QFuture
+     */
+    QFuture<OCRResult> submitDocument(const QList<QImage> &images, const QStringList &extractedTexts,
+                                      const QString &language = "chi_sim+eng");
+
+    /**
+     * @brief 生成取自PDF文本层的页面结果
+     * @param text 页面文本
+     * @return 识别结果（success为true，置信度为1）
+     */
+    static OCRResult extractedResult(const QString &text);
+
+    /**
+     * @brief 在线程池任务中等待嵌套提交的识别任务完成
+     *
+     * submitDocument、流式PDF识别和分块识别都在全局线程池的任务中再调用submitBatch，
+     * 而多数引擎的submitBatch同样在全局线程池中运行。等待期间先释放本线程占用的名额
+     * （QThreadPool::releaseThread），线程池可以另起线程执行嵌套任务，所有线程都在等待时也不会死锁；
+     * 等待不轮询，由QFutureWatcher在本线程的事件循环中通知完成、进度和外层取消。
+     * @param future 嵌套提交的识别任务
+     * @param promise 外层任务的QPromise（被取消时同时取消嵌套任务）
+     * @param progressChanged 嵌套任务进度变化时调用（可为空）
+     * @return 外层任务未被取消时返回true；返回时嵌套任务都已结束
+     */
+    static bool waitForBatch(QFuture<OCRResult> future, QPromise<OCRResult> &promise,
+                             const std::function<void(int)> &progressChanged = nullptr);
+
+    /**
+     * @brief 根据逐页识别结果填充批量结果
+     *
+     * 按页面顺序生成texts、confidences、pageStatuses、combinedText以及成功页数、空白页数、文本层页数和错误信息，
+     * 供各引擎的批量识别实现和异步调用方共用。
+     * @param batchResult 待填充的批量结果（totalPages需已设置）
+     * @param pageResults 按页面顺序排列的单页识别结果
+     * @param pageNames 页面名称列表（与pageResults一一对应）
+     */
+    static void finalizeBatchResult(BatchOCRResult &batchResult,
+                                    const QList<OCRResult> &pageResults,
+                                    const QStringList &pageNames);
+
+    /**
+     * @brief 设置识别结果缓存
+     *
+     * 设置后，相同图像在相同识别参数下的结果直接从缓存返回。
+     * 缓存对象由调用方管理，可在多个引擎之间共享。
+     * @param cache 结果缓存（为空表示不使用缓存）
+     */
+    void setResultCache(OCRResultCache *cache);
+
+    /**
+     * @brief 获取识别结果缓存
+     * @return 结果缓存，未设置时返回nullptr
+     */
+    OCRResultCache *resultCache() const;
+
+    /**
+     * @brief 设置空白页检测选项
+     *
+     * 默认启用，只作用于批量和文档识别（submitBatch、submitDocument、performBatchOCR）：
+     * 判定为空白的页面不交给识别器，直接返回标记为空白页的空结果。
+     * 单张图像的performOCR不做检测。
+     * @param options 检测选项（enabled为false时关闭检测）
+     */
+    void setBlankPageOptions(const ImagePreprocessor::BlankPageOptions &options);
+
+    /**
+     * @brief 获取空白页检测选项
+     * @return 检测选项
+     */
+    ImagePreprocessor::BlankPageOptions blankPageOptions() const;
+
 signals:
     /**
      * @brief OCR处理进度信号
@@ -122,6 +247,13 @@ signals:
      */
     void batchProgressUpdated(int progress, int currentPage, int totalPages, int currentPageProgress);
 
+    /**
+     * @brief 批量OCR吞吐量信号（每完成一页发送一次，紧随batchProgressUpdated之后）
+     * @param pagesPerSecond 当前吞吐量（每秒完成页数）
+     * @param remainingSeconds 预计剩余时间（秒）
+     */
+    void batchThroughputUpdated(double pagesPerSecond, int remainingSeconds);
+
     /**
      * @brief OCR处理完成信号
      * @param result 识别结果
@@ -140,9 +272,73 @@ signals:
      */
     void errorOccurred(const QString &errorMessage);
 
+protected:
+    /**
+     * @brief 异步批量识别中识别单页的默认实现
+     *
+     * 默认直接调用performOCR，只能在页与页之间响应取消；
+     * 子类可重写以在识别过程中检查promise.isCanceled()。
+     * @param image 待识别的图像
+     * @param language 识别语言代码
+     * @param promise 当前异步任务（用于检查取消状态）
+     * @return OCR识别结果
+     */
+    virtual OCRResult recognizeForAsync(const QImage &image, const QString &language,
+                                        const QPromise<OCRResult> &promise);
+
+    /**
+     * @brief 识别前检查空白页
+     *
+     * 各引擎的批量和文档识别路径在查找缓存之前调用；空白页的结果不写入缓存。
+     * @param image 待识别的图像
+     * @param result 是空白页时写入的结果
+     * @return 是否为空白页
+     */
+    bool detectBlankPage(const QImage &image, OCRResult &result) const;
+
+    /**
+     * @brief 获取影响识别结果的上下文描述，用于生成缓存键
+     *
+     * 默认包含引擎名称和语言；子类应追加引擎版本、引擎模式、页面分割模式
+     * 以及语言模型指纹等会改变识别结果的参数。
+     * @param language 识别语言代码
+     * @return 上下文字符串
+     */
+    virtual QString cacheContext(const QString &language) const;
+
+    /**
+     * @brief 计算图像的缓存键
+     *
+     * 同时向缓存登记该页面，精确查找未命中时用于查找近似重复的页面。
+     * @param image 待识别的图像
+     * @param language 识别语言代码
+     * @return 缓存键，未设置缓存时返回空
+     */
+    QByteArray resultCacheKey(const QImage &image, const QString &language) const;
+
+    /**
+     * @brief 查找缓存的识别结果
+     * @param key 缓存键
+     * @param result 命中时写入的识别结果
+     * @return 是否命中
+     */
+    bool lookupCachedResult(const QByteArray &key, OCRResult &result) const;
+
+    /**
+     * @brief 缓存识别结果（只缓存识别成功的结果）
+     * @param key 缓存键
+     * @param result 识别结果
+     */
+    void storeCachedResult(const QByteArray &key, const OCRResult &result);
+
 protected:
     bool m_initialized;     // 引擎是否已初始化
     QString m_lastError;    // 最后的错误信息
+    OCRResultCache *m_resultCache;  // 识别结果缓存（不拥有）
+    ImagePreprocessor::BlankPageOptions m_blankPageOptions; // 空白页检测选项
 };
 
+Q_DECLARE_METATYPE(OCREngine::OCRResult)
+Q_DECLARE_METATYPE(OCREngine::BatchOCRResult)
+
 #endif // OCRENGINE_H
\ No newline at end of file
@@ -0,0 +1,655 @@
+#include "ocrlayout.h"
+#include <QJsonArray>
+#include <algorithm>
+#include <cstring>
+
+// TSV列：level page_num block_num par_num line_num word_num left top width height conf text
+static const int TSV_COLUMN_COUNT = 12;
+
+/**
+ * @brief 解析[begin, end)区间内的十进制整数
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @param ok 返回是否解析成功
+ * @return 整数值
+ */
+static int parseInt(const char *begin, const char *end, bool *ok)
+{
+    bool negative = false;
+    if (begin < end && *begin == '-') {
+        negative = true;
+        ++begin;
+    }
+
+    *ok = begin < end;
+    int value = 0;
+    for (; begin < end; ++begin) {
+        if (*begin < '0' || *begin > '9') {
+            *ok = false;
+            return 0;
+        }
+        value = value * 10 + (*begin - '0');
+    }
+    return negative ? -value : value;
+}
+
+/**
+ * @brief 解析[begin, end)区间内的小数（不受系统区域设置的小数点影响）
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @param ok 返回是否解析成功
+ * @return 数值
+ */
+static float parseFloat(const char *begin, const char *end, bool *ok)
+{
+    bool negative = false;
+    if (begin < end && *begin == '-') {
+        negative = true;
+        ++begin;
+    }
+
+    *ok = begin < end;
+    double value = 0.0;
+    double scale = 0.0;
+    for (; begin < end; ++begin) {
+        if (*begin == '.' && scale == 0.0) {
+            scale = 1.0;
+        } else if (*begin >= '0' && *begin <= '9') {
+            value = value * 10.0 + (*begin - '0');
+            scale *= 10.0;
+        } else {
+            *ok = false;
+            return 0.0f;
+        }
+    }
+    if (scale > 1.0) {
+        value /= scale;
+    }
+    return float(negative ? -value : value);
+}
+
+/**
+ * @brief 计算UTF-8字节序列对应的UTF-16长度
+ * @param begin 起始位置
+ * @param end 结束位置
+ * @return UTF-16代码单元数
+ */
+static int utf16Length(const char *begin, const char *end)
+{
+    int length = 0;
+    for (; begin < end; ++begin) {
+        const uchar c = uchar(*begin);
+        if ((c & 0xC0) != 0x80) {
+            length++;           // 每个字符的首字节
+        }
+        if ((c & 0xF8) == 0xF0) {
+            length++;           // 四字节序列在UTF-16中为代理对
+        }
+    }
+    return length;
+}
+
+/**
+ * @brief 从tesseract的TSV输出构建版面结构
+ * @param tsvData TSV格式数据
+ * @param ok 返回数据格式是否有效
+ * @return 版面结构
+ */
+OCRLayout OCRLayout::fromTSV(const QByteArray &tsvData, bool *ok)
+{
+    OCRLayout layout;
+    bool validData = false;
+
+    // 文本先以UTF-8累积，最后一次性转换；同时累计UTF-16偏移作为单词位置
+    QByteArray utf8Text;
+    utf8Text.reserve(tsvData.size() / 4);
+    int textPosition = 0;
+
+    int lastPage = -1, lastBlock = -1, lastParagraph = -1, lastLine = -1;
+
+    const char *cursor = tsvData.constData();
+    const char *dataEnd = cursor + tsvData.size();
+
+    while (cursor < dataEnd) {
+        const char *rowEnd = static_cast<const char *>(memchr(cursor, '\n', dataEnd - cursor));
+        if (!rowEnd) {
+            rowEnd = dataEnd;
+        }
+        const char *rowBegin = cursor;
+        cursor = rowEnd + 1;
+
+        if (rowEnd > rowBegin && rowEnd[-1] == '\r') {
+            --rowEnd;
+        }
+
+        // 定位各列，最后一列（文本）延伸到行尾
+        const char *columnBegin[TSV_COLUMN_COUNT];
+        const char *columnEnd[TSV_COLUMN_COUNT];
+        int columnCount = 0;
+        const char *p = rowBegin;
+        while (columnCount < TSV_COLUMN_COUNT) {
+            columnBegin[columnCount] = p;
+            const char *tab = columnCount < TSV_COLUMN_COUNT - 1
+                ? static_cast<const char *>(memchr(p, '\t', rowEnd - p))
+                : nullptr;
+            columnEnd[columnCount] = tab ? tab : rowEnd;
+            columnCount++;
+            if (!tab) {
+                break;
+            }
+            p = tab + 1;
+        }
+
+        if (columnCount < TSV_COLUMN_COUNT) {
+            continue;
+        }
+
+        bool numberOk = false;
+        int level = parseInt(columnBegin[0], columnEnd[0], &numberOk);
+        if (!numberOk) {
+            // 表头行
+            validData = validData || (columnEnd[0] - columnBegin[0] == 5 &&
+                                      memcmp(columnBegin[0], "level", 5) == 0);
+            continue;
+        }
+        validData = true;
+
+        if (level != 5) {
+            continue;
+        }
+
+        // 去掉单词文本首尾的空白
+        const char *wordBegin = columnBegin[11];
+        const char *wordEnd = columnEnd[11];
+        while (wordBegin < wordEnd && (*wordBegin == ' ' || *wordBegin == '\t')) {
+            ++wordBegin;
+        }
+        while (wordEnd > wordBegin && (wordEnd[-1] == ' ' || wordEnd[-1] == '\t')) {
+            --wordEnd;
+        }
+        if (wordBegin == wordEnd) {
+            continue;
+        }
+
+        int values[10];
+        bool rowOk = true;
+        for (int column = 1; column <= 9 && rowOk; ++column) {
+            values[column] = parseInt(columnBegin[column], columnEnd[column], &rowOk);
+        }
+        if (!rowOk) {
+            continue;
+        }
+
+        const int page = values[1];
+        const int block = values[2];
+        const int paragraph = values[3];
+        const int line = values[4];
+
+        // 换块、换段或换行
+        if (layout.m_words.isEmpty() || page != lastPage || block != lastBlock ||
+            paragraph != lastParagraph || line != lastLine) {
+            const bool newBlock = layout.m_blocks.isEmpty() || page != lastPage || block != lastBlock;
+
+            if (!layout.m_words.isEmpty()) {
+                if (newBlock || paragraph != lastParagraph) {
+                    utf8Text.append("\n\n", 2);
+                    textPosition += 2;
+                } else {
+                    utf8Text.append('\n');
+                    textPosition += 1;
+                }
+            }
+
+            if (newBlock) {
+                Block newBlockEntry;
+                newBlockEntry.firstLine = layout.m_lines.size();
+                newBlockEntry.lineCount = 0;
+                layout.m_blocks.append(newBlockEntry);
+            }
+
+            Line newLine;
+            newLine.firstWord = layout.m_words.size();
+            newLine.wordCount = 0;
+            newLine.blockIndex = layout.m_blocks.size() - 1;
+            newLine.paragraph = paragraph;
+            layout.m_lines.append(newLine);
+            layout.m_blocks.last().lineCount++;
+
+            lastPage = page;
+            lastBlock = block;
+            lastParagraph = paragraph;
+            lastLine = line;
+        } else {
+            utf8Text.append(' ');
+            textPosition += 1;
+        }
+
+        bool confidenceOk = false;
+        float confidence = parseFloat(columnBegin[10], columnEnd[10], &confidenceOk);
+
+        Word word;
+        word.box = QRect(values[6], values[7], values[8], values[9]);
+        word.confidence = confidenceOk && confidence >= 0 ? confidence / 100.0f : -1.0f;
+        word.textStart = textPosition;
+        word.textLength = utf16Length(wordBegin, wordEnd);
+        word.lineIndex = layout.m_lines.size() - 1;
+        layout.m_words.append(word);
+
+        utf8Text.append(wordBegin, wordEnd - wordBegin);
+        textPosition += word.textLength;
+
+        Line &currentLine = layout.m_lines.last();
+        currentLine.wordCount++;
+        currentLine.box = currentLine.box.united(word.box);
+        Block &currentBlock = layout.m_blocks.last();
+        currentBlock.box = currentBlock.box.united(word.box);
+    }
+
+    layout.m_text = QString::fromUtf8(utf8Text);
+
+    if (ok) {
+        *ok = validData;
+    }
+    return layout;
+}
+
+namespace {
+
+// 拼接时的一个行片段：某个分块中一行里落在该分块负责区域内的单词
+struct StitchFragment {
+    int part;               // 分块下标
+    int block;              // 分块内的文本块下标
+    int paragraph;          // 段落编号
+    QRect box;              // 片段边框（整页坐标）
+    QList<int> words;       // 分块内的单词下标
+    QList<QRect> boxes;     // 对应单词的整页边框
+};
+
+// 拼接输出中的一行：单列时就是一个片段，多列时是同一分块行中垂直方向重叠的若干片段
+struct StitchLine {
+    QRect box;
+    QList<StitchFragment> fragments;
+};
+
+/**
+ * @brief 判断两个边框在垂直方向上是否属于同一行（重叠部分不少于较矮者高度的一半）
+ */
+bool sameTextLine(const QRect &a, const QRect &b)
+{
+    const int overlap = qMin(a.bottom(), b.bottom()) - qMax(a.top(), b.top()) + 1;
+    return overlap * 2 >= qMin(a.height(), b.height());
+}
+
+} // namespace
+
+/**
+ * @brief 拼接分块识别的版面结构
+ *
+ * 分块按行优先排列，同一分块行中各分块的负责区域上边界相同。
+ * 一个分块行只有一列时按分块内的原顺序输出；有多列时，跨越垂直接缝的文本行
+ * 被各分块分别识别成几段，因此把该分块行中垂直方向重叠的行片段合并为一行，
+ * 行按y排序、行内单词按x排序后再重建文本。
+ * @param parts 各分块的版面结构
+ * @param offsets 各分块左上角在整页中的位置
+ * @param ownedRegions 各分块负责的整页区域
+ * @return 整页版面结构
+ */
+OCRLayout OCRLayout::stitch(const QList<OCRLayout> &parts, const QList<QPoint> &offsets,
+                            const QList<QRect> &ownedRegions)
+{
+    OCRLayout layout;
+    qint64 lastBlockKey = -1;
+    qint64 lastParagraphKey = -1;
+
+    int rowStart = 0;
+    while (rowStart < parts.size()) {
+        // 找出与rowStart同一分块行的分块
+        const int rowTop = ownedRegions.value(rowStart).top();
+        int rowEnd = rowStart + 1;
+        while (rowEnd < parts.size() && ownedRegions.value(rowEnd).top() == rowTop) {
+            rowEnd++;
+        }
+        const bool multiColumn = rowEnd - rowStart > 1;
+
+        // 收集该分块行中保留的行片段
+        QList<StitchFragment> fragments;
+        for (int part = rowStart; part < rowEnd; ++part) {
+            const OCRLayout &source = parts.at(part);
+            const QPoint offset = offsets.value(part);
+            const QRect owned = ownedRegions.value(part);
+
+            for (int blockIndex = 0; blockIndex < source.m_blocks.size(); ++blockIndex) {
+                const Block &sourceBlock = source.m_blocks.at(blockIndex);
+                for (int lineIndex = sourceBlock.firstLine;
+                     lineIndex < sourceBlock.firstLine + sourceBlock.lineCount; ++lineIndex) {
+                    const Line &sourceLine = source.m_lines.at(lineIndex);
+                    StitchFragment fragment;
+                    fragment.part = part;
+                    fragment.block = blockIndex;
+                    fragment.paragraph = sourceLine.paragraph;
+
+                    for (int wordIndex = sourceLine.firstWord;
+                         wordIndex < sourceLine.firstWord + sourceLine.wordCount; ++wordIndex) {
+                        const QRect box = source.m_words.at(wordIndex).box.translated(offset);
+                        if (!owned.contains(box.center())) {
+                            continue;
+                        }
+                        fragment.words.append(wordIndex);
+                        fragment.boxes.append(box);
+                        fragment.box = fragment.box.united(box);
+                    }
+                    if (!fragment.words.isEmpty()) {
+                        fragments.append(fragment);
+                    }
+                }
+            }
+        }
+
+        QList<StitchLine> lines;
+        if (!multiColumn) {
+            for (const StitchFragment &fragment : std::as_const(fragments)) {
+                lines.append(StitchLine{fragment.box, {fragment}});
+            }
+        } else {
+            // 按上边界依次归入垂直方向重叠的行，再按y、x排序
+            std::stable_sort(fragments.begin(), fragments.end(),
+                             [](const StitchFragment &a, const StitchFragment &b) {
+                                 return a.box.top() < b.box.top();
+                             });
+            for (const StitchFragment &fragment : std::as_const(fragments)) {
+                auto it = std::find_if(lines.begin(), lines.end(), [&](const StitchLine &line) {
+                    return sameTextLine(line.box, fragment.box);
+                });
+                if (it == lines.end()) {
+                    lines.append(StitchLine{fragment.box, {fragment}});
+                } else {
+                    it->box = it->box.united(fragment.box);
+                    it->fragments.append(fragment);
+                }
+            }
+            for (StitchLine &line : lines) {
+                std::stable_sort(line.fragments.begin(), line.fragments.end(),
+                                 [](const StitchFragment &a, const StitchFragment &b) {
+                                     return a.box.left() < b.box.left();
+                                 });
+            }
+            std::stable_sort(lines.begin(), lines.end(), [](const StitchLine &a, const StitchLine &b) {
+                return a.box.top() != b.box.top() ? a.box.top() < b.box.top() : a.box.left() < b.box.left();
+            });
+        }
+
+        for (const StitchLine &stitchLine : std::as_const(lines)) {
+            // 单列时按分块内的文本块分块；多列时一个分块行是一个文本块，段落按行首片段区分
+            const StitchFragment &first = stitchLine.fragments.first();
+            const qint64 blockKey = multiColumn ? (qint64(1) << 62) | rowStart
+                                                : (qint64(first.part) << 32) | first.block;
+            const qint64 paragraphKey = multiColumn
+                ? (qint64(first.part) << 40) | (qint64(first.block) << 20) | first.paragraph
+                : first.paragraph;
+            const bool newBlock = blockKey != lastBlockKey;
+
+            // 与fromTSV相同的分隔规则：换块或换段空一行，换行换行，同一行的单词以空格分隔
+            if (!layout.m_words.isEmpty()) {
+                layout.m_text.append(newBlock || paragraphKey != lastParagraphKey
+                                         ? QStringLiteral("\n\n") : QStringLiteral("\n"));
+            }
+            if (newBlock) {
+                Block block;
+                block.firstLine = layout.m_lines.size();
+                block.lineCount = 0;
+                layout.m_blocks.append(block);
+            }
+            lastBlockKey = blockKey;
+            lastParagraphKey = paragraphKey;
+
+            Line line;
+            line.firstWord = layout.m_words.size();
+            line.wordCount = 0;
+            line.blockIndex = layout.m_blocks.size() - 1;
+            line.paragraph = first.paragraph;
+            layout.m_lines.append(line);
+            layout.m_blocks.last().lineCount++;
+
+            for (const StitchFragment &fragment : stitchLine.fragments) {
+                const OCRLayout &source = parts.at(fragment.part);
+                for (int i = 0; i < fragment.words.size(); ++i) {
+                    if (layout.m_lines.last().wordCount > 0) {
+                        layout.m_text.append(QLatin1Char(' '));
+                    }
+
+                    Word word = source.m_words.at(fragment.words.at(i));
+                    word.box = fragment.boxes.at(i);
+                    word.textStart = layout.m_text.size();
+                    word.lineIndex = layout.m_lines.size() - 1;
+                    layout.m_text.append(source.wordText(fragment.words.at(i)));
+                    layout.m_words.append(word);
+
+                    Line &currentLine = layout.m_lines.last();
+                    currentLine.wordCount++;
+                    currentLine.box = currentLine.box.united(word.box);
+                    Block &currentBlock = layout.m_blocks.last();
+                    currentBlock.box = currentBlock.box.united(word.box);
+                }
+            }
+        }
+
+        rowStart = rowEnd;
+    }
+
+    return layout;
+}
+
+/**
+ * @brief 把所有边框从一个区域线性换算到另一个区域
+ * @param from 原页面中的区域
+ * @param to 新页面中的对应区域
+ * @return 换算后的版面结构
+ */
+OCRLayout OCRLayout::mapped(const QRect &from, const QRect &to) const
+{
+    if (from.isEmpty() || to.isEmpty() || from == to) {
+        return *this;
+    }
+
+    const double scaleX = double(to.width()) / from.width();
+    const double scaleY = double(to.height()) / from.height();
+    auto mapBox = [&](const QRect &box) {
+        const int left = to.left() + qRound((box.left() - from.left()) * scaleX);
+        const int top = to.top() + qRound((box.top() - from.top()) * scaleY);
+        const int right = to.left() + qRound((box.right() + 1 - from.left()) * scaleX);
+        const int bottom = to.top() + qRound((box.bottom() + 1 - from.top()) * scaleY);
+        return QRect(left, top, qMax(1, right - left), qMax(1, bottom - top));
+    };
+
+    OCRLayout layout = *this;
+    for (Word &word : layout.m_words) {
+        word.box = mapBox(word.box);
+    }
+    for (Line &line : layout.m_lines) {
+        line.box = mapBox(line.box);
+    }
+    for (Block &block : layout.m_blocks) {
+        block.box = mapBox(block.box);
+    }
+    return layout;
+}
+
+/**
+ * @brief 获取单词文本
+ * @param index 单词下标
+ * @return 单词文本
+ */
+QStringView OCRLayout::wordText(int index) const
+{
+    const Word &word = m_words.at(index);
+    return QStringView(m_text).mid(word.textStart, word.textLength);
+}
+
+/**
+ * @brief 获取一行的文本
+ * @param index 行下标
+ * @return 行文本
+ */
+QStringView OCRLayout::lineText(int index) const
+{
+    const Line &line = m_lines.at(index);
+    if (line.wordCount == 0) {
+        return QStringView();
+    }
+
+    const Word &first = m_words.at(line.firstWord);
+    const Word &last = m_words.at(line.firstWord + line.wordCount - 1);
+    return QStringView(m_text).mid(first.textStart, last.textStart + last.textLength - first.textStart);
+}
+
+/**
+ * @brief 计算所有单词的平均置信度
+ * @param defaultValue 没有单词时返回的值
+ * @return 平均置信度
+ */
+float OCRLayout::meanConfidence(float defaultValue) const
+{
+    float total = 0.0f;
+    int count = 0;
+    for (const Word &word : m_words) {
+        if (word.confidence >= 0) {
+            total += word.confidence;
+            count++;
+        }
+    }
+    return count > 0 ? total / count : defaultValue;
+}
+
+/**
+ * @brief 估算版面结构占用的内存
+ * @return 字节数
+ */
+qint64 OCRLayout::memoryUsage() const
+{
+    return qint64(sizeof(OCRLayout))
+         + m_text.size() * qint64(sizeof(QChar))
+         + m_blocks.size() * qint64(sizeof(Block))
+         + m_lines.size() * qint64(sizeof(Line))
+         + m_words.size() * qint64(sizeof(Word));
+}
+
+/**
+ * @brief 将矩形转换为[x, y, width, height]数组
+ */
+static QJsonArray boxToJson(const QRect &box)
+{
+    return QJsonArray{box.x(), box.y(), box.width(), box.height()};
+}
+
+/**
+ * @brief 转换为JSON对象
+ * @return JSON对象
+ */
+QJsonObject OCRLayout::toJson() const
+{
+    QJsonArray blocks;
+    for (const Block &block : m_blocks) {
+        QJsonArray lines;
+        for (int lineIndex = block.firstLine; lineIndex < block.firstLine + block.lineCount; ++lineIndex) {
+            const Line &line = m_lines.at(lineIndex);
+
+            QJsonArray words;
+            for (int wordIndex = line.firstWord; wordIndex < line.firstWord + line.wordCount; ++wordIndex) {
+                const Word &word = m_words.at(wordIndex);
+                QJsonObject wordObject;
+                wordObject.insert("box", boxToJson(word.box));
+                wordObject.insert("text", wordText(wordIndex).toString());
+                wordObject.insert("confidence", double(word.confidence));
+                words.append(wordObject);
+            }
+
+            QJsonObject lineObject;
+            lineObject.insert("box", boxToJson(line.box));
+            lineObject.insert("text", lineText(lineIndex).toString());
+            lineObject.insert("words", words);
+            lines.append(lineObject);
+        }
+
+        QJsonObject blockObject;
+        blockObject.insert("box", boxToJson(block.box));
+        blockObject.insert("lines", lines);
+        blocks.append(blockObject);
+    }
+
+    QJsonObject object;
+    object.insert("blocks", blocks);
+    return object;
+}
+
+/**
+ * @brief 序列化版面结构
+ */
+QDataStream &operator<<(QDataStream &stream, const OCRLayout &layout)
+{
+    stream << layout.m_text << qint32(layout.m_blocks.size())
+           << qint32(layout.m_lines.size()) << qint32(layout.m_words.size());
+
+    for (const OCRLayout::Block &block : layout.m_blocks) {
+        stream << block.box << qint32(block.firstLine) << qint32(block.lineCount);
+    }
+    for (const OCRLayout::Line &line : layout.m_lines) {
+        stream << line.box << qint32(line.firstWord) << qint32(line.wordCount)
+               << qint32(line.blockIndex) << qint32(line.paragraph);
+    }
+    for (const OCRLayout::Word &word : layout.m_words) {
+        stream << word.box << word.confidence << qint32(word.textStart)
+               << qint32(word.textLength) << qint32(word.lineIndex);
+    }
+    return stream;
+}
+
+/**
+ * @brief 反序列化版面结构
+ */
+QDataStream &operator>>(QDataStream &stream, OCRLayout &layout)
+{
+    qint32 blockCount = 0, lineCount = 0, wordCount = 0;
+    stream >> layout.m_text >> blockCount >> lineCount >> wordCount;
+
+    layout.m_blocks.clear();
+    layout.m_lines.clear();
+    layout.m_words.clear();
+    if (stream.status() != QDataStream::Ok || blockCount < 0 || lineCount < 0 || wordCount < 0) {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return stream;
+    }
+
+    layout.m_blocks.reserve(blockCount);
+    for (qint32 i = 0; i < blockCount && stream.status() == QDataStream::Ok; ++i) {
+        OCRLayout::Block block;
+        qint32 firstLine = 0, count = 0;
+        stream >> block.box >> firstLine >> count;
+        block.firstLine = firstLine;
+        block.lineCount = count;
+        layout.m_blocks.append(block);
+    }
+
+    layout.m_lines.reserve(lineCount);
+    for (qint32 i = 0; i < lineCount && stream.status() == QDataStream::Ok; ++i) {
+        OCRLayout::Line line;
+        qint32 firstWord = 0, count = 0, blockIndex = 0, paragraph = 0;
+        stream >> line.box >> firstWord >> count >> blockIndex >> paragraph;
+        line.firstWord = firstWord;
+        line.wordCount = count;
+        line.blockIndex = blockIndex;
+        line.paragraph = paragraph;
+        layout.m_lines.append(line);
+    }
+
+    layout.m_words.reserve(wordCount);
+    for (qint32 i = 0; i < wordCount && stream.status() == QDataStream::Ok; ++i) {
+        OCRLayout::Word word;
+        qint32 textStart = 0, textLength = 0, lineIndex = 0;
+        stream >> word.box >> word.confidence >> textStart >> textLength >> lineIndex;
+        word.textStart = textStart;
+        word.textLength = textLength;
+        word.lineIndex = lineIndex;
+        layout.m_words.append(word);
+    }
+    return stream;
+}
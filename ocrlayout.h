@@ -0,0 +1,167 @@
+#ifndef OCRLAYOUT_H
+#define OCRLAYOUT_H
+
+#include <QString>
+#include <QList>
+#include <QRect>
+#include <QPoint>
+#include <QByteArray>
+#include <QDataStream>
+#include <QJsonObject>
+
+/**
+ * @brief OCR版面结构（文本块、文本行、单词）
+ *
+ * 所有单词、行、块分别存放在三个连续的数组中，彼此通过下标引用；
+ * 单词文本不单独分配字符串，而是以偏移量指向重建后的整页纯文本。
+ * 纯文本的格式与tesseract的txt输出一致：同一行的单词以空格连接，
+ * 行之间换行，段落或文本块之间空一行。
+ */
+class OCRLayout
+{
+public:
+    /**
+     * @brief 单词
+     */
+    struct Word {
+        QRect box;          // 单词在页面图像中的边框
+        float confidence;   // 置信度（0.0-1.0）
+        int textStart;      // 在纯文本中的起始位置
+        int textLength;     // 在纯文本中的长度
+        int lineIndex;      // 所属行的下标
+    };
+
+    /**
+     * @brief 文本行
+     */
+    struct Line {
+        QRect box;          // 行边框（所含单词边框的并集）
+        int firstWord;      // 第一个单词的下标
+        int wordCount;      // 单词数
+        int blockIndex;     // 所属文本块的下标
+        int paragraph;      // 段落编号（tesseract的par_num）
+    };
+
+    /**
+     * @brief 文本块
+     */
+    struct Block {
+        QRect box;          // 块边框（所含行边框的并集）
+        int firstLine;      // 第一行的下标
+        int lineCount;      // 行数
+    };
+
+    OCRLayout() = default;
+
+    /**
+     * @brief 从tesseract的TSV输出构建版面结构
+     *
+     * 单次顺序扫描TSV数据，不拆分出中间字符串列表；只使用单词级别（level=5）
+     * 且文本非空的记录，行和块在遇到其第一个单词时创建。
+     * 有无表头行（TessBaseAPI::GetTSVText的输出没有表头）均可解析。
+     * @param tsvData TSV格式数据（UTF-8）
+     * @param ok 可选，返回数据格式是否有效
+     * @return 版面结构
+     */
+    static OCRLayout fromTSV(const QByteArray &tsvData, bool *ok = nullptr);
+
+    /**
+     * @brief 拼接分块识别的版面结构
+     *
+     * 各分块的坐标平移到整页坐标后拼接；重叠区域中的单词只保留在
+     * 其边框中心所在的分块中（每个分块负责一个互不重叠的区域），从而去掉重复识别的单词。
+     * 分块按行优先排列：只有一列时按分块顺序拼接；有多列时同一分块行中垂直方向重叠的
+     * 行（跨越接缝被拆开的行）合并为一行，行按y、行内按x排序。
+     * 没有保留单词的行和块被丢弃，行和块的边框按保留的单词重新计算。
+     * @param parts 各分块的版面结构
+     * @param offsets 各分块左上角在整页中的位置
+     * @param ownedRegions 各分块负责的整页区域（互不重叠且覆盖整页）
+     * @return 整页版面结构
+     */
+    static OCRLayout stitch(const QList<OCRLayout> &parts, const QList<QPoint> &offsets,
+                            const QList<QRect> &ownedRegions);
+
+    /**
+     * @brief 把所有边框从一个区域线性换算到另一个区域
+     *
+     * 用于复用近似重复页面的识别结果：两页的内容区域位置和大小不同（平移、缩放）时，
+     * 把原页面内容区域中的坐标换算到新页面的内容区域中。
+     * @param from 原页面中的区域
+     * @param to 新页面中的对应区域
+     * @return 换算后的版面结构（文本不变）
+     */
+    OCRLayout mapped(const QRect &from, const QRect &to) const;
+
+    /**
+     * @brief 获取重建的整页纯文本
+     * @return 纯文本
+     */
+    const QString &text() const { return m_text; }
+
+    /**
+     * @brief 是否没有识别出任何单词
+     * @return 是否为空
+     */
+    bool isEmpty() const { return m_words.isEmpty(); }
+
+    const QList<Block> &blocks() const { return m_blocks; }
+    const QList<Line> &lines() const { return m_lines; }
+    const QList<Word> &words() const { return m_words; }
+
+    /**
+     * @brief 获取单词文本
+     * @param index 单词下标
+     * @return 单词文本（引用纯文本中的片段）
+     */
+    QStringView wordText(int index) const;
+
+    /**
+     * @brief 获取一行的文本
+     * @param index 行下标
+     * @return 行文本（引用纯文本中的片段）
+     */
+    QStringView lineText(int index) const;
+
+    /**
+     * @brief 计算所有单词的平均置信度
+     * @param defaultValue 没有单词时返回的值
+     * @return 平均置信度（0.0-1.0）
+     */
+    float meanConfidence(float defaultValue = 0.8f) const;
+
+    /**
+     * @brief 估算版面结构占用的内存
+     * @return 字节数
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief 转换为JSON对象
+     *
+     * 格式为{"blocks":[{"box":[x,y,w,h],"lines":[{"box":...,"text":...,
+     * "words":[{"box":...,"text":...,"confidence":...}]}]}]}，置信度范围0.0-1.0。
+     * @return JSON对象
+     */
+    QJsonObject toJson() const;
+
+    friend QDataStream &operator<<(QDataStream &stream, const OCRLayout &layout);
+    friend QDataStream &operator>>(QDataStream &stream, OCRLayout &layout);
+
+private:
+    QString m_text;             // 重建的整页纯文本
+    QList<Block> m_blocks;      // 文本块
+    QList<Line> m_lines;        // 文本行
+    QList<Word> m_words;        // 单词
+};
+
+/**
+ * @brief 序列化版面结构（用于磁盘缓存）
+ */
+QDataStream &operator<<(QDataStream &stream, const OCRLayout &layout);
+
+/**
+ * @brief 反序列化版面结构
+ */
+QDataStream &operator>>(QDataStream &stream, OCRLayout &layout);
+
+#endif // OCRLAYOUT_H
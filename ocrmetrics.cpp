@@ -0,0 +1,492 @@
+#include "ocrmetrics.h"
+#include "ocrtracer.h"
+#include "ocrcostmodel.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QFile>
+#include <QSaveFile>
+#include <QLocalSocket>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 运行中的阶段统计（各桶为累计次数）
+ */
+struct StageStats {
+    QList<qint64> bucketCounts;
+    qint64 count = 0;
+    qint64 sumNs = 0;
+};
+
+// 直方图各桶上限（毫秒），覆盖从TSV解析到整批识别的范围
+const double s_bucketBoundsMs[] = {1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000};
+const int s_bucketCount = sizeof(s_bucketBoundsMs) / sizeof(s_bucketBoundsMs[0]);
+
+QMutex s_metricsMutex;                      // 保护统计数据
+QHash<QByteArray, StageStats> s_stages;     // 阶段名 -> 统计
+QHash<QByteArray, qint64> s_counters;       // 计数器
+QHash<QByteArray, qint64> s_gauges;         // 当前值指标
+
+QMutex s_exporterMutex;                                     // 保护s_exporters
+QList<std::shared_ptr<OCRMetrics::Exporter>> s_exporters;   // 已安装的导出器
+
+QAtomicInt s_activeJobs;                    // 正在运行的识别任务数
+thread_local int s_jobDepth = 0;            // 当前线程的任务嵌套深度
+
+/**
+ * @brief 以字符串常量构造查找键（不复制数据）
+ */
+inline QByteArray metricKey(const char *name)
+{
+    return QByteArray::fromRawData(name, static_cast<qsizetype>(std::strlen(name)));
+}
+
+/**
+ * @brief Prometheus指标名只允许字母、数字和下划线
+ */
+QByteArray prometheusName(const QString &name)
+{
+    QByteArray result = "convenient_ocr_";
+    for (QChar ch : name) {
+        result += (ch.isLetterOrNumber() && ch.unicode() < 128) ? static_cast<char>(ch.unicode()) : '_';
+    }
+    return result;
+}
+
+} // namespace
+
+/**
+ * @brief 构造作用域计时器并开始计时
+ * @param stage 阶段名称（字符串常量）
+ * @param pageIndex 页面索引
+ */
+OCRMetrics::ScopedTimer::ScopedTimer(const char *stage, int pageIndex)
+    : m_stage(stage)
+    , m_pageIndex(pageIndex)
+    , m_traceStartUs(OCRTracer::isEnabled() ? OCRTracer::nowUs() : -1)
+{
+    m_timer.start();
+}
+
+OCRMetrics::ScopedTimer::~ScopedTimer()
+{
+    const qint64 elapsedNs = m_timer.nsecsElapsed();
+    observe(m_stage, elapsedNs);
+    if (m_traceStartUs >= 0) {
+        OCRTracer::complete(m_stage, m_traceStartUs, elapsedNs / 1000, m_pageIndex);
+    }
+}
+
+/**
+ * @brief 开始识别任务，最外层任务重置峰值内存记录
+ */
+OCRMetrics::JobScope::JobScope()
+    : m_outermost(s_jobDepth++ == 0)
+{
+    if (!m_outermost) {
+        return;
+    }
+
+    // 没有其他任务并发运行时才重置，避免影响其他任务的峰值
+    if (s_activeJobs.fetchAndAddRelaxed(1) == 0) {
+        resetPeakResident();
+    }
+    m_timer.start();
+}
+
+/**
+ * @brief 结束识别任务，记录耗时和峰值内存并导出
+ */
+OCRMetrics::JobScope::~JobScope()
+{
+    s_jobDepth--;
+    if (!m_outermost) {
+        return;
+    }
+
+    const qint64 elapsedNs = m_timer.nsecsElapsed();
+    observe("job", elapsedNs);
+    increment("jobs");
+    setGauge("job_peak_rss_bytes", peakResidentBytes());
+    setGauge("child_peak_rss_bytes", peakChildResidentBytes());
+    const bool lastActiveJob = s_activeJobs.fetchAndSubRelaxed(1) == 1;
+
+    exportNow();
+    // 并发的任务都结束后才把本轮测量的耗时写入设置
+    if (lastActiveJob) {
+        OCRCostModel::save();
+    }
+    if (OCRTracer::isEnabled()) {
+        OCRTracer::complete("job", OCRTracer::nowUs() - elapsedNs / 1000, elapsedNs / 1000);
+    }
+}
+
+/**
+ * @brief 记录一次阶段耗时
+ * @param stage 阶段名称（字符串常量）
+ * @param elapsedNs 耗时（纳秒）
+ */
+void OCRMetrics::observe(const char *stage, qint64 elapsedNs)
+{
+    const double elapsedMs = elapsedNs / 1e6;
+
+    QMutexLocker locker(&s_metricsMutex);
+    StageStats &stats = s_stages[metricKey(stage)];
+    if (stats.bucketCounts.isEmpty()) {
+        stats.bucketCounts.fill(0, s_bucketCount);
+    }
+
+    // 桶按上限递增排列，从第一个能容纳该耗时的桶开始累计
+    for (int i = s_bucketCount - 1; i >= 0 && elapsedMs <= s_bucketBoundsMs[i]; --i) {
+        stats.bucketCounts[i]++;
+    }
+    stats.count++;
+    stats.sumNs += elapsedNs;
+}
+
+/**
+ * @brief 增加计数器
+ * @param counter 计数器名称（字符串常量）
+ * @param delta 增量
+ */
+void OCRMetrics::increment(const char *counter, qint64 delta)
+{
+    QMutexLocker locker(&s_metricsMutex);
+    s_counters[metricKey(counter)] += delta;
+}
+
+/**
+ * @brief 设置指标的当前值
+ * @param gauge 指标名称（字符串常量）
+ * @param value 当前值
+ */
+void OCRMetrics::setGauge(const char *gauge, qint64 value)
+{
+    QMutexLocker locker(&s_metricsMutex);
+    s_gauges[metricKey(gauge)] = value;
+}
+
+/**
+ * @brief 获取当前统计快照
+ * @return 统计快照
+ */
+OCRMetrics::Snapshot OCRMetrics::snapshot()
+{
+    Snapshot result;
+
+    QMutexLocker locker(&s_metricsMutex);
+    for (auto it = s_stages.cbegin(); it != s_stages.cend(); ++it) {
+        Histogram histogram;
+        histogram.bucketCounts = it.value().bucketCounts;
+        histogram.count = it.value().count;
+        histogram.sumMs = it.value().sumNs / 1e6;
+        result.stages.insert(QString::fromLatin1(it.key()), histogram);
+    }
+    for (auto it = s_counters.cbegin(); it != s_counters.cend(); ++it) {
+        result.counters.insert(QString::fromLatin1(it.key()), it.value());
+    }
+    for (auto it = s_gauges.cbegin(); it != s_gauges.cend(); ++it) {
+        result.gauges.insert(QString::fromLatin1(it.key()), it.value());
+    }
+
+    return result;
+}
+
+/**
+ * @brief 清除所有统计数据
+ */
+void OCRMetrics::reset()
+{
+    QMutexLocker locker(&s_metricsMutex);
+    s_stages.clear();
+    s_counters.clear();
+    s_gauges.clear();
+}
+
+/**
+ * @brief 直方图各桶的上限（毫秒）
+ * @return 上限列表
+ */
+QList<double> OCRMetrics::bucketBoundsMs()
+{
+    return QList<double>(s_bucketBoundsMs, s_bucketBoundsMs + s_bucketCount);
+}
+
+/**
+ * @brief 将快照格式化为指定格式
+ * @param snapshot 统计快照
+ * @param format 导出格式
+ * @return 格式化后的数据
+ */
+QByteArray OCRMetrics::format(const Snapshot &snapshot, Format format)
+{
+    const QList<double> bounds = bucketBoundsMs();
+
+    if (format == Format::Json) {
+        QJsonObject stages;
+        for (auto it = snapshot.stages.cbegin(); it != snapshot.stages.cend(); ++it) {
+            QJsonArray buckets;
+            for (int i = 0; i < bounds.size() && i < it.value().bucketCounts.size(); ++i) {
+                QJsonObject bucket;
+                bucket.insert("leMs", bounds[i]);
+                bucket.insert("count", it.value().bucketCounts[i]);
+                buckets.append(bucket);
+            }
+
+            QJsonObject stage;
+            stage.insert("count", it.value().count);
+            stage.insert("sumMs", it.value().sumMs);
+            stage.insert("buckets", buckets);
+            stages.insert(it.key(), stage);
+        }
+
+        QJsonObject counters;
+        for (auto it = snapshot.counters.cbegin(); it != snapshot.counters.cend(); ++it) {
+            counters.insert(it.key(), it.value());
+        }
+
+        QJsonObject gauges;
+        for (auto it = snapshot.gauges.cbegin(); it != snapshot.gauges.cend(); ++it) {
+            gauges.insert(it.key(), it.value());
+        }
+
+        QJsonObject root;
+        root.insert("stages", stages);
+        root.insert("counters", counters);
+        root.insert("gauges", gauges);
+        return QJsonDocument(root).toJson();
+    }
+
+    // Prometheus文本格式：阶段耗时合并为一个带stage标签的直方图，单位为秒
+    QByteArray text;
+    if (!snapshot.stages.isEmpty()) {
+        const QByteArray name = "convenient_ocr_stage_duration_seconds";
+        text += "# HELP " + name + " Duration of OCR pipeline stages.\n";
+        text += "# TYPE " + name + " histogram\n";
+        for (auto it = snapshot.stages.cbegin(); it != snapshot.stages.cend(); ++it) {
+            const QByteArray label = "stage=\"" + it.key().toUtf8() + "\"";
+            for (int i = 0; i < bounds.size() && i < it.value().bucketCounts.size(); ++i) {
+                text += name + "_bucket{" + label + ",le=\"" + QByteArray::number(bounds[i] / 1000.0) + "\"} "
+                        + QByteArray::number(it.value().bucketCounts[i]) + "\n";
+            }
+            text += name + "_bucket{" + label + ",le=\"+Inf\"} " + QByteArray::number(it.value().count) + "\n";
+            text += name + "_sum{" + label + "} " + QByteArray::number(it.value().sumMs / 1000.0, 'g', 12) + "\n";
+            text += name + "_count{" + label + "} " + QByteArray::number(it.value().count) + "\n";
+        }
+    }
+
+    for (auto it = snapshot.counters.cbegin(); it != snapshot.counters.cend(); ++it) {
+        const QByteArray name = prometheusName(it.key()) + "_total";
+        text += "# TYPE " + name + " counter\n";
+        text += name + " " + QByteArray::number(it.value()) + "\n";
+    }
+
+    for (auto it = snapshot.gauges.cbegin(); it != snapshot.gauges.cend(); ++it) {
+        const QByteArray name = prometheusName(it.key());
+        text += "# TYPE " + name + " gauge\n";
+        text += name + " " + QByteArray::number(it.value()) + "\n";
+    }
+
+    return text;
+}
+
+/**
+ * @brief 添加导出器
+ * @param exporter 导出器
+ */
+void OCRMetrics::addExporter(const std::shared_ptr<Exporter> &exporter)
+{
+    if (!exporter) {
+        return;
+    }
+
+    QMutexLocker locker(&s_exporterMutex);
+    s_exporters.append(exporter);
+}
+
+/**
+ * @brief 移除所有导出器
+ */
+void OCRMetrics::clearExporters()
+{
+    QMutexLocker locker(&s_exporterMutex);
+    s_exporters.clear();
+}
+
+/**
+ * @brief 根据环境变量安装文件和套接字导出器
+ */
+void OCRMetrics::installExportersFromEnvironment()
+{
+    const QString filePath = qEnvironmentVariable("CONVENIENT_OCR_METRICS_FILE");
+    if (!filePath.isEmpty()) {
+        Format fileFormat = filePath.endsWith(".prom", Qt::CaseInsensitive) ? Format::Prometheus : Format::Json;
+        addExporter(std::make_shared<OCRMetricsFileExporter>(filePath, fileFormat));
+    }
+
+    const QString serverName = qEnvironmentVariable("CONVENIENT_OCR_METRICS_SOCKET");
+    if (!serverName.isEmpty()) {
+        addExporter(std::make_shared<OCRMetricsSocketExporter>(serverName, Format::Prometheus));
+    }
+}
+
+/**
+ * @brief 立即将当前快照交给所有导出器
+ */
+void OCRMetrics::exportNow()
+{
+    QList<std::shared_ptr<Exporter>> exporters;
+    {
+        QMutexLocker locker(&s_exporterMutex);
+        exporters = s_exporters;
+    }
+
+    if (exporters.isEmpty()) {
+        return;
+    }
+
+    // 导出可能涉及磁盘或套接字，不持有锁
+    const Snapshot current = snapshot();
+    for (const auto &exporter : exporters) {
+        exporter->exportSnapshot(current);
+    }
+}
+
+/**
+ * @brief 获取当前进程的峰值常驻内存
+ * @return 字节数，无法获取时返回0
+ */
+qint64 OCRMetrics::peakResidentBytes()
+{
+#if defined(Q_OS_LINUX)
+    // VmHWM可以通过clear_refs重置，能反映单个任务的峰值
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> lines = status.readAll().split('\n');
+        for (const QByteArray &line : lines) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+            }
+        }
+    }
+    return 0;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<qint64>(usage.ru_maxrss); // macOS以字节为单位
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief 获取已结束子进程中最大的峰值常驻内存
+ * @return 字节数，无法获取时返回0
+ */
+qint64 OCRMetrics::peakChildResidentBytes()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_CHILDREN, &usage) != 0) {
+        return 0;
+    }
+#if defined(Q_OS_MACOS)
+    return static_cast<qint64>(usage.ru_maxrss);
+#else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief 重置当前进程的峰值内存记录（仅Linux支持）
+ */
+void OCRMetrics::resetPeakResident()
+{
+#if defined(Q_OS_LINUX)
+    QFile clearRefs("/proc/self/clear_refs");
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+#endif
+}
+
+/**
+ * @brief 构造文件导出器
+ * @param filePath 导出文件路径
+ * @param format 导出格式
+ */
+OCRMetricsFileExporter::OCRMetricsFileExporter(const QString &filePath, OCRMetrics::Format format)
+    : m_filePath(filePath)
+    , m_format(format)
+{
+}
+
+/**
+ * @brief 将快照写入文件
+ * @param snapshot 统计快照
+ * @return 是否成功
+ */
+bool OCRMetricsFileExporter::exportSnapshot(const OCRMetrics::Snapshot &snapshot)
+{
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(OCRMetrics::format(snapshot, m_format));
+    return file.commit();
+}
+
+/**
+ * @brief 构造套接字导出器
+ * @param serverName 本地套接字名称
+ * @param format 导出格式
+ */
+OCRMetricsSocketExporter::OCRMetricsSocketExporter(const QString &serverName, OCRMetrics::Format format)
+    : m_serverName(serverName)
+    , m_format(format)
+{
+}
+
+/**
+ * @brief 连接本地套接字并发送快照
+ * @param snapshot 统计快照
+ * @return 是否成功
+ */
+bool OCRMetricsSocketExporter::exportSnapshot(const OCRMetrics::Snapshot &snapshot)
+{
+    // 每次导出使用新连接，导出器可以在任意线程中调用
+    QLocalSocket socket;
+    socket.connectToServer(m_serverName);
+    if (!socket.waitForConnected(1000)) {
+        return false;
+    }
+
+    socket.write(OCRMetrics::format(snapshot, m_format));
+    bool written = socket.waitForBytesWritten(1000);
+    socket.disconnectFromServer();
+    return written;
+}
@@ -0,0 +1,224 @@
+#ifndef OCRMETRICS_H
+#define OCRMETRICS_H
+
+#include <QString>
+#include <QMap>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <memory>
+
+/**
+ * @brief 识别流水线的耗时与资源统计
+ *
+ * 记录各处理阶段（图像编码、进程启动、识别、结果读取、TSV解析、PDF光栅化等）的耗时直方图，
+ * 页数、字节数、缓存命中、进程启动次数等计数器，以及每个识别任务的峰值内存。
+ * 统计数据可通过导出器以JSON或Prometheus文本格式写入本地文件或本地套接字。
+ *
+ * 设置以下环境变量时，程序启动后自动安装对应的导出器，每个识别任务结束时导出一次：
+ * - CONVENIENT_OCR_METRICS_FILE：导出文件路径（扩展名为.prom时使用Prometheus格式，否则为JSON）
+ * - CONVENIENT_OCR_METRICS_SOCKET：本地套接字名称（Prometheus格式）
+ *
+ * 所有接口都是线程安全的。
+ */
+class OCRMetrics
+{
+public:
+    /**
+     * @brief 导出格式
+     */
+    enum class Format {
+        Json,           // JSON快照
+        Prometheus      // Prometheus文本格式
+    };
+
+    /**
+     * @brief 单个阶段的耗时直方图
+     */
+    struct Histogram {
+        QList<qint64> bucketCounts; // 各桶（耗时<=上限）的累计次数，与bucketBoundsMs()一一对应
+        qint64 count;               // 总次数
+        double sumMs;               // 总耗时（毫秒）
+
+        Histogram() : count(0), sumMs(0.0) {}
+    };
+
+    /**
+     * @brief 某一时刻的统计快照
+     */
+    struct Snapshot {
+        QMap<QString, Histogram> stages;    // 阶段名 -> 耗时直方图
+        QMap<QString, qint64> counters;     // 计数器名 -> 累计值
+        QMap<QString, qint64> gauges;       // 指标名 -> 当前值（如峰值内存）
+    };
+
+    /**
+     * @brief 导出器接口
+     */
+    class Exporter
+    {
+    public:
+        virtual ~Exporter() = default;
+
+        /**
+         * @brief 导出快照
+         * @param snapshot 统计快照
+         * @return 是否成功
+         */
+        virtual bool exportSnapshot(const Snapshot &snapshot) = 0;
+    };
+
+    /**
+     * @brief 作用域计时器，析构时把经过的时间记录到指定阶段
+     *
+     * 启用OCRTracer时同时在时间线上记录该阶段。
+     */
+    class ScopedTimer
+    {
+    public:
+        /**
+         * @brief 开始计时
+         * @param stage 阶段名称（字符串常量）
+         * @param pageIndex 页面索引（仅用于时间线），-1表示与具体页面无关
+         */
+        explicit ScopedTimer(const char *stage, int pageIndex = -1);
+        ~ScopedTimer();
+
+    private:
+        const char *m_stage;
+        int m_pageIndex;
+        qint64 m_traceStartUs;      // 时间线上的开始时间（-1表示未启用追踪）
+        QElapsedTimer m_timer;
+    };
+
+    /**
+     * @brief 识别任务作用域
+     *
+     * 记录任务耗时和任务期间的峰值内存，结束时调用所有导出器并写出时间线。嵌套时只有最外层有效。
+     */
+    class JobScope
+    {
+    public:
+        JobScope();
+        ~JobScope();
+
+    private:
+        bool m_outermost;
+        QElapsedTimer m_timer;
+    };
+
+    /**
+     * @brief 记录一次阶段耗时
+     * @param stage 阶段名称
+     * @param elapsedNs 耗时（纳秒）
+     */
+    static void observe(const char *stage, qint64 elapsedNs);
+
+    /**
+     * @brief 增加计数器
+     * @param counter 计数器名称
+     * @param delta 增量
+     */
+    static void increment(const char *counter, qint64 delta = 1);
+
+    /**
+     * @brief 设置指标的当前值
+     * @param gauge 指标名称
+     * @param value 当前值
+     */
+    static void setGauge(const char *gauge, qint64 value);
+
+    /**
+     * @brief 获取当前统计快照
+     * @return 统计快照
+     */
+    static Snapshot snapshot();
+
+    /**
+     * @brief 清除所有统计数据
+     */
+    static void reset();
+
+    /**
+     * @brief 直方图各桶的上限（毫秒），最后一个桶之外还隐含一个无穷大桶
+     * @return 上限列表
+     */
+    static QList<double> bucketBoundsMs();
+
+    /**
+     * @brief 将快照格式化为指定格式
+     * @param snapshot 统计快照
+     * @param format 导出格式
+     * @return 格式化后的数据
+     */
+    static QByteArray format(const Snapshot &snapshot, Format format);
+
+    /**
+     * @brief 添加导出器
+     * @param exporter 导出器
+     */
+    static void addExporter(const std::shared_ptr<Exporter> &exporter);
+
+    /**
+     * @brief 移除所有导出器
+     */
+    static void clearExporters();
+
+    /**
+     * @brief 根据环境变量安装文件和套接字导出器
+     */
+    static void installExportersFromEnvironment();
+
+    /**
+     * @brief 立即将当前快照交给所有导出器
+     */
+    static void exportNow();
+
+    /**
+     * @brief 获取当前进程自上次重置以来的峰值常驻内存
+     * @return 字节数，无法获取时返回0
+     */
+    static qint64 peakResidentBytes();
+
+    /**
+     * @brief 获取已结束子进程（tesseract、pdftoppm）中最大的峰值常驻内存
+     * @return 字节数，无法获取时返回0
+     */
+    static qint64 peakChildResidentBytes();
+
+private:
+    /**
+     * @brief 重置当前进程的峰值内存记录（仅Linux支持）
+     */
+    static void resetPeakResident();
+};
+
+/**
+ * @brief 将快照写入本地文件的导出器（先写临时文件再替换，读取方不会看到写了一半的内容）
+ */
+class OCRMetricsFileExporter : public OCRMetrics::Exporter
+{
+public:
+    OCRMetricsFileExporter(const QString &filePath, OCRMetrics::Format format);
+    bool exportSnapshot(const OCRMetrics::Snapshot &snapshot) override;
+
+private:
+    QString m_filePath;
+    OCRMetrics::Format m_format;
+};
+
+/**
+ * @brief 将快照发送到本地套接字（QLocalServer）的导出器
+ */
+class OCRMetricsSocketExporter : public OCRMetrics::Exporter
+{
+public:
+    OCRMetricsSocketExporter(const QString &serverName, OCRMetrics::Format format);
+    bool exportSnapshot(const OCRMetrics::Snapshot &snapshot) override;
+
+private:
+    QString m_serverName;
+    OCRMetrics::Format m_format;
+};
+
+#endif // OCRMETRICS_H
@@ -0,0 +1,585 @@
+#include "ocrresultcache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+// 缓存条目格式版本，条目内容增加字段时递增，使旧条目不再命中
+static const int s_entryFormatVersion = 2;
+
+// 已登记但尚未写入结果的页面上限（被取消的页面不会写入，超过上限时整体丢弃）
+static const int s_maxPendingPages = 1024;
+
+// 内存中参考掩码的上限（每个约450KB）
+static const qint64 s_maxReferenceMaskBytes = 64 * 1024 * 1024;
+
+/**
+ * @brief OCRResultCache构造函数
+ * @param maxMemoryBytes 内存缓存上限（字节）
+ */
+OCRResultCache::OCRResultCache(qint64 maxMemoryBytes)
+    : m_maxDiskBytes(0)
+    , m_diskBytes(0)
+    , m_similarMatching(false)
+{
+    m_memoryCache.setMaxCost(qMax<qint64>(0, maxMemoryBytes));
+    m_referenceMasks.setMaxCost(s_maxReferenceMaskBytes);
+}
+
+/**
+ * @brief OCRResultCache析构函数
+ */
+OCRResultCache::~OCRResultCache()
+{
+    if (!m_diskDirectory.isEmpty()) {
+        m_pageIndex.save(pageIndexPath(m_diskDirectory));
+    }
+}
+
+/**
+ * @brief 根据图像内容和识别上下文生成缓存键
+ * @param image 待识别的图像
+ * @param context 识别上下文
+ * @return 缓存键
+ */
+QByteArray OCRResultCache::makeKey(const QImage &image, const QString &context)
+{
+    // 两路不同种子的逐行哈希，只覆盖有效像素字节，行尾填充不参与计算
+    const size_t lineBytes = (size_t(image.width()) * image.depth() + 7) / 8;
+    size_t primary = 0x9e3779b9u;
+    size_t secondary = 0x85ebca6bu;
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *line = image.constScanLine(y);
+        primary = qHashBits(line, lineBytes, primary);
+        secondary = qHashBits(line, lineBytes, secondary);
+    }
+
+    // 像素哈希与尺寸、格式和上下文一起组成最终的键
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream << quint64(primary) << quint64(secondary)
+           << qint32(image.width()) << qint32(image.height())
+           << qint32(image.format()) << context << QString(qVersion())
+           << qint32(s_entryFormatVersion);
+
+    return QCryptographicHash::hash(header, QCryptographicHash::Sha1).toHex();
+}
+
+/**
+ * @brief 生成tessdata语言模型文件的指纹
+ * @param tessDataDir tessdata目录
+ * @param language 识别语言代码
+ * @return 指纹字符串
+ */
+QString OCRResultCache::tessDataFingerprint(const QString &tessDataDir, const QString &language)
+{
+    if (tessDataDir.isEmpty()) {
+        return QString();
+    }
+
+    QStringList parts;
+    const QStringList languages = language.split('+', Qt::SkipEmptyParts);
+    for (const QString &lang : languages) {
+        QFileInfo modelFile(QDir(tessDataDir).filePath(lang + ".traineddata"));
+        parts << QString("%1:%2:%3")
+                     .arg(lang)
+                     .arg(modelFile.size())
+                     .arg(modelFile.lastModified().toMSecsSinceEpoch());
+    }
+    return parts.join(',');
+}
+
+/**
+ * @brief 登记即将查找的页面图像
+ * @param key 缓存键
+ * @param image 页面图像
+ * @param context 识别上下文
+ */
+void OCRResultCache::notePage(const QByteArray &key, const QImage &image, const QString &context)
+{
+    if (key.isEmpty() || image.isNull()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_similarMatching) {
+        return;
+    }
+    if (m_pendingPages.size() >= s_maxPendingPages) {
+        m_pendingPages.clear();
+    }
+    PendingPage &pending = m_pendingPages[key];
+    pending.image = image;
+    pending.context = context;
+}
+
+/**
+ * @brief 查找缓存的识别结果
+ * @param key 缓存键
+ * @param result 命中时写入的识别结果
+ * @return 是否命中
+ */
+bool OCRResultCache::lookup(const QByteArray &key, OCREngine::OCRResult &result)
+{
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    PendingPage pending;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        bool fromDisk = false;
+        if (findEntry(key, result, &fromDisk)) {
+            if (fromDisk) {
+                m_statistics.diskHits++;
+            } else {
+                m_statistics.memoryHits++;
+            }
+            m_pendingPages.remove(key);
+            return true;
+        }
+
+        if (!m_similarMatching || !m_pendingPages.contains(key)) {
+            m_statistics.misses++;
+            return false;
+        }
+        pending = m_pendingPages.value(key);
+    }
+
+    // 计算签名、参考掩码和查找索引较慢，不持有锁
+    pending.signature = PageHashIndex::computeSignature(pending.image);
+    if (pending.signature.isValid()) {
+        pending.mask = PageHashIndex::referenceMask(pending.image, pending.signature.content);
+    }
+    PageHashIndex::Match match;
+    bool similar = m_pageIndex.findSimilar(pending.context, pending.signature, &match);
+
+    // 签名相近只说明版面相似，逐像素确认内容一致后才复用；没有参考掩码的候选页面不复用
+    if (similar) {
+        QImage candidateMask;
+        {
+            QMutexLocker locker(&m_mutex);
+            candidateMask = findReferenceMask(match.key);
+        }
+        similar = PageHashIndex::confirmMatch(pending.mask, candidateMask);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    OCREngine::OCRResult similarResult;
+    bool fromDisk = false;
+    if (similar && findEntry(match.key, similarResult, &fromDisk)) {
+        // 版面坐标从原页面的内容区域换算到本页的内容区域；结果只放入内存，不另写磁盘
+        similarResult.layout = similarResult.layout.mapped(match.content, pending.signature.content);
+        result = similarResult;
+        m_memoryCache.insert(key, new OCREngine::OCRResult(result), entryCost(result));
+        m_pendingPages.remove(key);
+        m_statistics.similarHits++;
+        return true;
+    }
+
+    // 未命中：保留签名和参考掩码，识别结果写入时加入索引
+    auto it = m_pendingPages.find(key);
+    if (it != m_pendingPages.end()) {
+        it->image = QImage();
+        it->signature = pending.signature;
+        it->mask = pending.mask;
+    }
+    m_statistics.misses++;
+    return false;
+}
+
+/**
+ * @brief 写入识别结果
+ * @param key 缓存键
+ * @param result 识别结果
+ */
+void OCRResultCache::insert(const QByteArray &key, const OCREngine::OCRResult &result)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const PendingPage pending = m_pendingPages.take(key);
+    if (!result.success) {
+        return;
+    }
+
+    m_memoryCache.insert(key, new OCREngine::OCRResult(result), entryCost(result));
+    m_statistics.insertions++;
+
+    if (!m_diskDirectory.isEmpty()) {
+        writeDiskEntry(key, result);
+    }
+    if (m_similarMatching && pending.signature.isValid() && !pending.mask.isNull()) {
+        storeReferenceMask(key, pending.mask);
+        m_pageIndex.insert(key, pending.context, pending.signature);
+    }
+}
+
+/**
+ * @brief 设置近似重复页面匹配
+ * @param enabled 是否启用
+ * @param minSimilarity 最低相似度
+ */
+void OCRResultCache::setSimilarPageMatching(bool enabled, double minSimilarity)
+{
+    m_pageIndex.setMinSimilarity(minSimilarity);
+
+    QMutexLocker locker(&m_mutex);
+    m_similarMatching = enabled;
+    if (!enabled) {
+        m_pendingPages.clear();
+    }
+}
+
+/**
+ * @brief 近似重复页面匹配是否已启用
+ * @return 是否启用
+ */
+bool OCRResultCache::isSimilarPageMatchingEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_similarMatching;
+}
+
+/**
+ * @brief 设置内存缓存上限
+ * @param bytes 上限（字节）
+ */
+void OCRResultCache::setMaxMemoryBytes(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_memoryCache.setMaxCost(qMax<qint64>(0, bytes));
+}
+
+/**
+ * @brief 启用磁盘缓存
+ * @param directory 缓存目录
+ * @param maxDiskBytes 磁盘缓存上限（字节）
+ * @return 目录是否可用
+ */
+bool OCRResultCache::enableDiskCache(const QString &directory, qint64 maxDiskBytes)
+{
+    QString path = directory;
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/ocr-results";
+    }
+
+    if (!QDir().mkpath(path)) {
+        qDebug() << "无法创建OCR结果缓存目录:" << path;
+        return false;
+    }
+
+    // 统计已有缓存文件和参考掩码的大小
+    qint64 existingBytes = 0;
+    const QFileInfoList entries = QDir(path).entryInfoList(QStringList() << "*.json" << "*.mask.png", QDir::Files);
+    for (const QFileInfo &entry : entries) {
+        existingBytes += entry.size();
+    }
+
+    // 近似重复页面索引与结果保存在同一目录中
+    m_pageIndex.load(pageIndexPath(path));
+
+    QMutexLocker locker(&m_mutex);
+    m_diskDirectory = path;
+    m_maxDiskBytes = maxDiskBytes;
+    m_diskBytes = existingBytes;
+    pruneDiskCache();
+    return true;
+}
+
+/**
+ * @brief 关闭磁盘缓存
+ */
+void OCRResultCache::disableDiskCache()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_diskDirectory.isEmpty()) {
+        m_pageIndex.save(pageIndexPath(m_diskDirectory));
+    }
+    m_diskDirectory.clear();
+    m_diskBytes = 0;
+}
+
+/**
+ * @brief 磁盘缓存是否已启用
+ * @return 是否启用
+ */
+bool OCRResultCache::isDiskCacheEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_diskDirectory.isEmpty();
+}
+
+/**
+ * @brief 清空内存和磁盘中的全部缓存结果
+ */
+void OCRResultCache::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    m_memoryCache.clear();
+    m_pendingPages.clear();
+    m_referenceMasks.clear();
+    m_pageIndex.clear();
+
+    if (!m_diskDirectory.isEmpty()) {
+        QDir dir(m_diskDirectory);
+        dir.remove(QFileInfo(pageIndexPath(m_diskDirectory)).fileName());
+        const QStringList files = dir.entryList(QStringList() << "*.json" << "*.mask.png", QDir::Files);
+        for (const QString &file : files) {
+            dir.remove(file);
+        }
+        m_diskBytes = 0;
+    }
+}
+
+/**
+ * @brief 获取缓存统计信息
+ * @return 统计信息
+ */
+OCRResultCache::Statistics OCRResultCache::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    Statistics stats = m_statistics;
+    stats.memoryEntries = m_memoryCache.count();
+    stats.memoryBytes = m_memoryCache.totalCost();
+    stats.diskBytes = m_diskBytes;
+    return stats;
+}
+
+/**
+ * @brief 重置命中/未命中计数
+ */
+void OCRResultCache::resetStatistics()
+{
+    QMutexLocker locker(&m_mutex);
+    m_statistics = Statistics();
+}
+
+/**
+ * @brief 先查内存再查磁盘
+ * @param key 缓存键
+ * @param result 命中时写入的识别结果
+ * @param fromDisk 返回是否从磁盘读取
+ * @return 是否命中
+ */
+bool OCRResultCache::findEntry(const QByteArray &key, OCREngine::OCRResult &result, bool *fromDisk)
+{
+    if (const OCREngine::OCRResult *cached = m_memoryCache.object(key)) {
+        result = *cached;
+        *fromDisk = false;
+        return true;
+    }
+
+    if (!m_diskDirectory.isEmpty() && readDiskEntry(key, result)) {
+        // 磁盘命中的结果提升到内存中
+        m_memoryCache.insert(key, new OCREngine::OCRResult(result), entryCost(result));
+        *fromDisk = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 获取近似重复页面索引文件路径
+ * @param directory 磁盘缓存目录
+ * @return 文件路径
+ */
+QString OCRResultCache::pageIndexPath(const QString &directory)
+{
+    return directory + "/page-index.dat";
+}
+
+/**
+ * @brief 获取键对应的磁盘缓存文件路径
+ * @param key 缓存键
+ * @return 文件路径
+ */
+QString OCRResultCache::diskEntryPath(const QByteArray &key) const
+{
+    return m_diskDirectory + "/" + QString::fromLatin1(key) + ".json";
+}
+
+/**
+ * @brief 获取键对应的参考掩码文件路径
+ * @param key 缓存键
+ * @return 文件路径
+ */
+QString OCRResultCache::diskMaskPath(const QByteArray &key) const
+{
+    return m_diskDirectory + "/" + QString::fromLatin1(key) + ".mask.png";
+}
+
+/**
+ * @brief 获取已识别页面的参考掩码
+ * @param key 缓存键
+ * @return 参考掩码
+ */
+QImage OCRResultCache::findReferenceMask(const QByteArray &key)
+{
+    if (const QImage *cached = m_referenceMasks.object(key)) {
+        return *cached;
+    }
+    if (m_diskDirectory.isEmpty()) {
+        return QImage();
+    }
+
+    QImage mask(diskMaskPath(key), "PNG");
+    if (mask.isNull()) {
+        return QImage();
+    }
+    // PNG读回的单色图像可能是调色板或灰度格式，统一为墨迹为1的单色格式
+    if (mask.format() != QImage::Format_Mono || mask.color(1) != qRgb(0, 0, 0)) {
+        mask = mask.convertToFormat(QImage::Format_Mono, QList<QRgb>() << qRgb(255, 255, 255) << qRgb(0, 0, 0));
+    }
+    m_referenceMasks.insert(key, new QImage(mask), mask.sizeInBytes());
+    return mask;
+}
+
+/**
+ * @brief 保存已识别页面的参考掩码
+ * @param key 缓存键
+ * @param mask 参考掩码
+ */
+void OCRResultCache::storeReferenceMask(const QByteArray &key, const QImage &mask)
+{
+    m_referenceMasks.insert(key, new QImage(mask), mask.sizeInBytes());
+    if (m_diskDirectory.isEmpty()) {
+        return;
+    }
+
+    const QString path = diskMaskPath(key);
+    const qint64 previousSize = QFileInfo(path).size();
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || !mask.save(&file, "PNG") || !file.commit()) {
+        qDebug() << "无法写入参考掩码:" << path;
+        return;
+    }
+    m_diskBytes += QFileInfo(path).size() - previousSize;
+    pruneDiskCache();
+}
+
+/**
+ * @brief 从磁盘读取缓存结果
+ * @param key 缓存键
+ * @param result 读取到的识别结果
+ * @return 是否读取成功
+ */
+bool OCRResultCache::readDiskEntry(const QByteArray &key, OCREngine::OCRResult &result)
+{
+    QFile file(diskEntryPath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    if (!document.isObject()) {
+        return false;
+    }
+
+    QJsonObject entry = document.object();
+    result.text = entry.value("text").toString();
+    result.confidence = float(entry.value("confidence").toDouble());
+    result.success = true;
+    result.errorMessage.clear();
+
+    // 版面结构以二进制序列化后Base64编码保存
+    result.layout = OCRLayout();
+    QByteArray layoutData = QByteArray::fromBase64(entry.value("layout").toString().toLatin1());
+    if (!layoutData.isEmpty()) {
+        QDataStream stream(layoutData);
+        stream >> result.layout;
+        if (stream.status() != QDataStream::Ok) {
+            result.layout = OCRLayout();
+        }
+    }
+
+    // 更新修改时间，磁盘淘汰按最近使用时间进行
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+/**
+ * @brief 将结果写入磁盘
+ * @param key 缓存键
+ * @param result 识别结果
+ */
+void OCRResultCache::writeDiskEntry(const QByteArray &key, const OCREngine::OCRResult &result)
+{
+    QJsonObject entry;
+    entry.insert("text", result.text);
+    entry.insert("confidence", double(result.confidence));
+    if (!result.layout.isEmpty()) {
+        QByteArray layoutData;
+        QDataStream stream(&layoutData, QIODevice::WriteOnly);
+        stream << result.layout;
+        entry.insert("layout", QString::fromLatin1(layoutData.toBase64()));
+    }
+    QByteArray data = QJsonDocument(entry).toJson(QJsonDocument::Compact);
+
+    const QString path = diskEntryPath(key);
+    qint64 previousSize = QFileInfo(path).size();
+
+    // 先写临时文件再替换，避免中断时留下不完整的条目
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qDebug() << "无法写入OCR结果缓存:" << path;
+        return;
+    }
+
+    m_diskBytes += data.size() - previousSize;
+    pruneDiskCache();
+}
+
+/**
+ * @brief 磁盘缓存超出上限时删除最久未使用的条目
+ */
+void OCRResultCache::pruneDiskCache()
+{
+    if (m_maxDiskBytes <= 0 || m_diskBytes <= m_maxDiskBytes) {
+        return;
+    }
+
+    // 一次清理到上限的90%，避免每次写入都扫描目录
+    const qint64 targetBytes = m_maxDiskBytes * 9 / 10;
+    QDir dir(m_diskDirectory);
+    const QFileInfoList entries = dir.entryInfoList(QStringList() << "*.json", QDir::Files,
+                                                    QDir::Time | QDir::Reversed);
+    for (const QFileInfo &entry : entries) {
+        if (m_diskBytes <= targetBytes) {
+            break;
+        }
+        if (dir.remove(entry.fileName())) {
+            m_diskBytes -= entry.size();
+        }
+        // 参考掩码随结果一起删除
+        const QFileInfo mask(dir.filePath(entry.completeBaseName() + ".mask.png"));
+        if (mask.exists() && dir.remove(mask.fileName())) {
+            m_diskBytes -= mask.size();
+        }
+    }
+}
+
+/**
+ * @brief 估算一条结果在内存中的占用
+ * @param result 识别结果
+ * @return 占用字节数
+ */
+qint64 OCRResultCache::entryCost(const OCREngine::OCRResult &result)
+{
+    // 纯文本通常与版面结构中的文本共享同一份数据
+    if (!result.layout.isEmpty()) {
+        return qint64(sizeof(OCREngine::OCRResult)) + result.layout.memoryUsage();
+    }
+    return qint64(sizeof(OCREngine::OCRResult)) + result.text.size() * qint64(sizeof(QChar));
+}
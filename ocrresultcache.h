@@ -0,0 +1,265 @@
+#ifndef OCRRESULTCACHE_H
+#define OCRRESULTCACHE_H
+
+#include "ocrengine.h"
+#include "pagehashindex.h"
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QByteArray>
+
+/**
+ * @brief OCR识别结果缓存
+ *
+ * 以图像像素内容的哈希值加上识别上下文（语言、引擎版本、引擎模式、
+ * 页面分割模式、tessdata指纹等）作为键，缓存识别成功的OCRResult。
+ * 内存中为按文本大小计费的LRU缓存；可选的磁盘缓存以JSON文件保存结果，
+ * 程序重启后仍可命中。所有接口都是线程安全的。
+ *
+ * tessdata模型文件变化时其指纹随之改变，旧结果自然不再命中并逐渐被淘汰；
+ * 也可以调用invalidate()立即清空。
+ *
+ * 重新扫描的页面像素从不逐字节相同。近似重复页面匹配默认关闭，启用后精确查找未命中的页面
+ * 还会在PageHashIndex中查找相同上下文下的相似页面；候选页面还要与其参考掩码逐像素比对一致，
+ * 才复用其结果（版面坐标按两页的内容区域换算），套用同一模板的不同单据不会互相命中。
+ * 启用磁盘缓存时索引和参考掩码随之保存，跨进程和跨批次都可以命中。
+ */
+class OCRResultCache
+{
+public:
+    /**
+     * @brief 缓存统计信息
+     */
+    struct Statistics {
+        quint64 memoryHits;     // 内存缓存命中次数
+        quint64 diskHits;       // 磁盘缓存命中次数
+        quint64 similarHits;    // 近似重复页面命中次数
+        quint64 misses;         // 未命中次数
+        quint64 insertions;     // 写入次数
+        int memoryEntries;      // 内存中的条目数
+        qint64 memoryBytes;     // 内存缓存占用（估算）
+        qint64 diskBytes;       // 磁盘缓存占用
+
+        Statistics() : memoryHits(0), diskHits(0), similarHits(0), misses(0), insertions(0),
+                       memoryEntries(0), memoryBytes(0), diskBytes(0) {}
+
+        /**
+         * @brief 计算总命中率
+         * @return 命中率（0.0-1.0）
+         */
+        double hitRate() const
+        {
+            quint64 hits = memoryHits + diskHits + similarHits;
+            quint64 lookups = hits + misses;
+            return lookups > 0 ? double(hits) / lookups : 0.0;
+        }
+    };
+
+    /**
+     * @brief 构造函数
+     * @param maxMemoryBytes 内存缓存上限（字节）
+     */
+    explicit OCRResultCache(qint64 maxMemoryBytes = 64 * 1024 * 1024);
+
+    /**
+     * @brief 析构函数（启用了磁盘缓存时保存近似重复页面索引）
+     */
+    ~OCRResultCache();
+
+    /**
+     * @brief 根据图像内容和识别上下文生成缓存键
+     *
+     * 逐行对有效像素字节做两路不同种子的哈希（忽略行尾填充字节），
+     * 再与图像尺寸、像素格式和上下文字符串组合为128位键。
+     * @param image 待识别的图像
+     * @param context 识别上下文（见OCREngine::cacheContext）
+     * @return 缓存键（十六进制字符串）
+     */
+    static QByteArray makeKey(const QImage &image, const QString &context);
+
+    /**
+     * @brief 生成tessdata语言模型文件的指纹
+     *
+     * 由语言组合中每个traineddata文件的大小和修改时间组成，
+     * 模型文件被替换或更新后指纹随之改变。
+     * @param tessDataDir tessdata目录（为空时返回空字符串）
+     * @param language 识别语言代码（如"chi_sim+eng"）
+     * @return 指纹字符串
+     */
+    static QString tessDataFingerprint(const QString &tessDataDir, const QString &language);
+
+    /**
+     * @brief 登记即将查找的页面图像，供精确查找未命中时进行近似重复页面匹配
+     *
+     * 由OCREngine在生成缓存键后调用；签名只在精确查找未命中时才计算。
+     * @param key 缓存键
+     * @param image 页面图像
+     * @param context 识别上下文
+     */
+    void notePage(const QByteArray &key, const QImage &image, const QString &context);
+
+    /**
+     * @brief 查找缓存的识别结果（先查内存，再查磁盘，最后查找近似重复页面）
+     * @param key 缓存键
+     * @param result 命中时写入的识别结果
+     * @return 是否命中
+     */
+    bool lookup(const QByteArray &key, OCREngine::OCRResult &result);
+
+    /**
+     * @brief 写入识别结果（只缓存识别成功的结果，并把登记过的页面加入近似重复页面索引）
+     * @param key 缓存键
+     * @param result 识别结果
+     */
+    void insert(const QByteArray &key, const OCREngine::OCRResult &result);
+
+    /**
+     * @brief 设置近似重复页面匹配（默认关闭）
+     * @param enabled 是否启用
+     * @param minSimilarity 判定为近似重复的最低相似度（0.0-1.0，越高越严格）
+     */
+    void setSimilarPageMatching(bool enabled, double minSimilarity = 0.95);
+
+    /**
+     * @brief 近似重复页面匹配是否已启用
+     * @return 是否启用
+     */
+    bool isSimilarPageMatchingEnabled() const;
+
+    /**
+     * @brief 设置内存缓存上限
+     * @param bytes 上限（字节）
+     */
+    void setMaxMemoryBytes(qint64 bytes);
+
+    /**
+     * @brief 启用磁盘缓存
+     * @param directory 缓存目录（为空时使用系统缓存目录下的ocr-results）
+     * @param maxDiskBytes 磁盘缓存上限（字节），超出时删除最久未使用的条目
+     * @return 目录是否可用
+     */
+    bool enableDiskCache(const QString &directory = QString(), qint64 maxDiskBytes = 256 * 1024 * 1024);
+
+    /**
+     * @brief 关闭磁盘缓存（不删除已有文件）
+     */
+    void disableDiskCache();
+
+    /**
+     * @brief 磁盘缓存是否已启用
+     * @return 是否启用
+     */
+    bool isDiskCacheEnabled() const;
+
+    /**
+     * @brief 清空内存和磁盘中的全部缓存结果以及近似重复页面索引
+     */
+    void invalidate();
+
+    /**
+     * @brief 获取缓存统计信息
+     * @return 统计信息
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief 重置命中/未命中计数
+     */
+    void resetStatistics();
+
+private:
+    /**
+     * @brief 登记的待识别页面
+     */
+    struct PendingPage {
+        QImage image;                       // 页面图像（计算签名后释放）
+        QString context;                    // 识别上下文
+        PageHashIndex::Signature signature; // 页面签名（精确查找未命中时计算）
+        QImage mask;                        // 参考掩码（与签名一起计算）
+    };
+
+    /**
+     * @brief 先查内存再查磁盘（调用方必须持有m_mutex）
+     * @param key 缓存键
+     * @param result 命中时写入的识别结果
+     * @param fromDisk 返回是否从磁盘读取
+     * @return 是否命中
+     */
+    bool findEntry(const QByteArray &key, OCREngine::OCRResult &result, bool *fromDisk);
+
+    /**
+     * @brief 获取近似重复页面索引文件路径
+     * @param directory 磁盘缓存目录
+     * @return 文件路径
+     */
+    static QString pageIndexPath(const QString &directory);
+
+    /**
+     * @brief 获取键对应的磁盘缓存文件路径
+     * @param key 缓存键
+     * @return 文件路径
+     */
+    QString diskEntryPath(const QByteArray &key) const;
+
+    /**
+     * @brief 获取键对应的参考掩码文件路径
+     * @param key 缓存键
+     * @return 文件路径
+     */
+    QString diskMaskPath(const QByteArray &key) const;
+
+    /**
+     * @brief 获取已识别页面的参考掩码，先查内存再查磁盘（调用方必须持有m_mutex）
+     * @param key 缓存键
+     * @return 参考掩码，没有时为空图像
+     */
+    QImage findReferenceMask(const QByteArray &key);
+
+    /**
+     * @brief 保存已识别页面的参考掩码（调用方必须持有m_mutex）
+     * @param key 缓存键
+     * @param mask 参考掩码
+     */
+    void storeReferenceMask(const QByteArray &key, const QImage &mask);
+
+    /**
+     * @brief 从磁盘读取缓存结果（调用方必须持有m_mutex）
+     * @param key 缓存键
+     * @param result 读取到的识别结果
+     * @return 是否读取成功
+     */
+    bool readDiskEntry(const QByteArray &key, OCREngine::OCRResult &result);
+
+    /**
+     * @brief 将结果写入磁盘（调用方必须持有m_mutex）
+     * @param key 缓存键
+     * @param result 识别结果
+     */
+    void writeDiskEntry(const QByteArray &key, const OCREngine::OCRResult &result);
+
+    /**
+     * @brief 磁盘缓存超出上限时删除最久未使用的条目（调用方必须持有m_mutex）
+     */
+    void pruneDiskCache();
+
+    /**
+     * @brief 估算一条结果在内存中的占用
+     * @param result 识别结果
+     * @return 占用字节数
+     */
+    static qint64 entryCost(const OCREngine::OCRResult &result);
+
+private:
+    mutable QMutex m_mutex;                         // 保护以下所有成员
+    QCache<QByteArray, OCREngine::OCRResult> m_memoryCache; // 内存LRU缓存
+    QString m_diskDirectory;                        // 磁盘缓存目录（为空表示未启用）
+    qint64 m_maxDiskBytes;                          // 磁盘缓存上限
+    qint64 m_diskBytes;                             // 磁盘缓存当前占用
+    Statistics m_statistics;                        // 命中统计
+    bool m_similarMatching;                         // 是否启用近似重复页面匹配
+    QHash<QByteArray, PendingPage> m_pendingPages;  // 已登记、尚未写入结果的页面
+    QCache<QByteArray, QImage> m_referenceMasks;    // 已识别页面的参考掩码（按字节计费）
+    PageHashIndex m_pageIndex;                      // 近似重复页面索引（自带锁）
+};
+
+#endif // OCRRESULTCACHE_H
@@ -0,0 +1,619 @@
+#include "ocrservice.h"
+#include "tesseractocrengine.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDataStream>
+#include <QtConcurrent>
+#include <algorithm>
+
+const qint64 OCRService::s_maxRequestBytes = 512LL * 1024 * 1024;
+
+/**
+ * @brief OCRService构造函数
+ * @param engines 已初始化的OCR引擎，每个引擎同时处理一个请求
+ * @param parent 父对象指针
+ */
+OCRService::OCRService(const QList<OCREngine *> &engines, QObject *parent)
+    : QObject(parent)
+    , m_localServer(new QLocalServer(this))
+    , m_tcpServer(nullptr)
+    , m_nextSequence(0)
+    , m_completedJobs(0)
+    , m_failedJobs(0)
+{
+    for (OCREngine *engine : engines) {
+        Slot *slot = new Slot;
+        slot->engine = engine;
+        slot->job = nullptr;
+        slot->pageCount = 0;
+        slot->loadWatcher = new QFutureWatcher<FileProcessor::ProcessResult>(this);
+        slot->ocrWatcher = new QFutureWatcher<OCREngine::OCRResult>(this);
+
+        connect(slot->loadWatcher, &QFutureWatcher<FileProcessor::ProcessResult>::finished,
+                this, [this, slot]() { onJobLoaded(slot); });
+        connect(slot->ocrWatcher, &QFutureWatcher<OCREngine::OCRResult>::finished,
+                this, [this, slot]() { onJobRecognized(slot); });
+
+        m_slots.append(slot);
+    }
+
+    connect(m_localServer, &QLocalServer::newConnection, this, [this]() {
+        while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+            connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { removeClient(socket); });
+            addClient(socket);
+        }
+    });
+}
+
+/**
+ * @brief OCRService析构函数，取消并等待进行中的请求
+ */
+OCRService::~OCRService()
+{
+    for (Slot *slot : m_slots) {
+        slot->loadWatcher->waitForFinished();
+        slot->ocrWatcher->cancel();
+        slot->ocrWatcher->waitForFinished();
+        delete slot->job;
+        delete slot;
+    }
+    qDeleteAll(m_queue);
+}
+
+/**
+ * @brief 默认的本地套接字名称
+ * @return 套接字名称
+ */
+QString OCRService::defaultServerName()
+{
+    return "ConvenientOCRService";
+}
+
+/**
+ * @brief 开始监听
+ * @param serverName 本地套接字名称
+ * @param tcpPort 回环TCP端口（0表示不监听TCP）
+ * @param defaultLanguage 预热工作进程使用的语言
+ * @return 是否成功
+ */
+bool OCRService::listen(const QString &serverName, quint16 tcpPort, const QString &defaultLanguage)
+{
+    // 清理上次异常退出遗留的套接字文件；只允许当前用户连接
+    QLocalServer::removeServer(serverName);
+    m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_localServer->listen(serverName)) {
+        m_errorString = QString("无法监听本地套接字 %1: %2").arg(serverName, m_localServer->errorString());
+        return false;
+    }
+
+    if (tcpPort > 0) {
+        m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+                socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+                connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { removeClient(socket); });
+                addClient(socket);
+            }
+        });
+
+        // 只监听回环地址，不对外提供服务
+        if (!m_tcpServer->listen(QHostAddress::LocalHost, tcpPort)) {
+            m_errorString = QString("无法监听TCP端口 %1: %2").arg(tcpPort).arg(m_tcpServer->errorString());
+            m_localServer->close();
+            return false;
+        }
+    }
+
+    // 预先启动加载好语言模型的tesseract进程，第一个请求也无需等待模型加载
+    for (Slot *slot : m_slots) {
+        if (TesseractOCREngine *tesseract = qobject_cast<TesseractOCREngine *>(slot->engine)) {
+            tesseract->setUseWorkerPool(true);
+            tesseract->prewarmWorkers(defaultLanguage);
+        }
+    }
+
+    m_uptime.start();
+    return true;
+}
+
+/**
+ * @brief 获取最后的错误信息
+ * @return 错误信息
+ */
+QString OCRService::errorString() const
+{
+    return m_errorString;
+}
+
+/**
+ * @brief 接受新连接
+ * @param socket 连接
+ */
+void OCRService::addClient(QIODevice *socket)
+{
+    m_buffers.insert(socket, QByteArray());
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() { readClient(socket); });
+}
+
+/**
+ * @brief 读取连接上的完整请求行
+ * @param socket 连接
+ */
+void OCRService::readClient(QIODevice *socket)
+{
+    auto it = m_buffers.find(socket);
+    if (it == m_buffers.end()) {
+        return;
+    }
+    it->append(socket->readAll());
+
+    qsizetype lineStart = 0;
+    qsizetype lineEnd;
+    while ((lineEnd = it->indexOf('\n', lineStart)) >= 0) {
+        QByteArrayView line = QByteArrayView(*it).sliced(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(line.toByteArray(), &parseError);
+        if (!document.isObject()) {
+            QJsonObject reply;
+            reply.insert("type", "error");
+            reply.insert("error", QString("无效的请求: %1").arg(parseError.errorString()));
+            sendReply(socket, reply);
+            continue;
+        }
+
+        handleRequest(socket, document.object());
+
+        // 处理请求时连接可能已被关闭
+        it = m_buffers.find(socket);
+        if (it == m_buffers.end()) {
+            return;
+        }
+    }
+    it->remove(0, lineStart);
+
+    if (it->size() > s_maxRequestBytes) {
+        QJsonObject reply;
+        reply.insert("type", "error");
+        reply.insert("error", "请求数据过大");
+        sendReply(socket, reply);
+        m_buffers.erase(it);
+        socket->close();
+    }
+}
+
+/**
+ * @brief 处理一条请求
+ * @param socket 连接
+ * @param request 请求对象
+ */
+void OCRService::handleRequest(QIODevice *socket, const QJsonObject &request)
+{
+    const QString type = request.value("type").toString("recognize");
+    const QJsonValue id = request.value("id");
+
+    if (type == "status") {
+        QJsonObject reply = statusObject();
+        reply.insert("id", id);
+        sendReply(socket, reply);
+        return;
+    }
+
+    if (type == "cancel") {
+        const QJsonValue target = request.value("target");
+        bool found = false;
+
+        for (int i = 0; i < m_queue.size(); ++i) {
+            Job *job = m_queue.at(i);
+            if (job->client == socket && job->id == target) {
+                m_queue.removeAt(i);
+                failJob(job, "请求已取消");
+                delete job;
+                found = true;
+                break;
+            }
+        }
+        for (Slot *slot : m_slots) {
+            if (!found && slot->job && slot->job->client == socket && slot->job->id == target) {
+                // 识别中的请求取消后按已完成的页面应答
+                slot->job->canceled = true;
+                slot->ocrWatcher->cancel();
+                found = true;
+            }
+        }
+
+        QJsonObject reply;
+        reply.insert("type", "cancel");
+        reply.insert("id", id);
+        reply.insert("found", found);
+        sendReply(socket, reply);
+        return;
+    }
+
+    if (type != "recognize") {
+        QJsonObject reply;
+        reply.insert("type", "error");
+        reply.insert("id", id);
+        reply.insert("error", QString("未知的请求类型: %1").arg(type));
+        sendReply(socket, reply);
+        return;
+    }
+
+    // 回环TCP端口任何本机用户都能连接，不能代为读取只有服务账户可读的文件；本地套接字只允许当前用户连接
+    if (request.contains("path") && qobject_cast<QTcpSocket *>(socket)) {
+        QJsonObject reply;
+        reply.insert("type", "error");
+        reply.insert("id", id);
+        reply.insert("error", "TCP连接只接受内嵌图像，文件路径请求请通过本地套接字发送");
+        sendReply(socket, reply);
+        return;
+    }
+
+    Job *job = new Job;
+    job->sequence = m_nextSequence++;
+    job->priority = request.value("priority").toInt(0);
+    job->client = socket;
+    job->id = id;
+    job->path = request.value("path").toString();
+    job->language = request.value("language").toString("chi_sim+eng");
+    job->layoutMode = request.value("layout").toString("json");
+    job->maxWidth = qMax(0, request.value("maxWidth").toInt(0));
+    job->maxHeight = qMax(0, request.value("maxHeight").toInt(0));
+    job->preprocess.method = ImagePreprocessor::methodFromName(request.value("preprocess").toString("none"));
+    job->preprocess.bilevel = request.value("bilevel").toBool(false);
+    job->preprocess.normalizeTextSize = request.value("normalizeTextSize").toBool(false);
+    job->preprocess.targetXHeight = qBound(8, request.value("xHeight").toInt(job->preprocess.targetXHeight), 200);
+    job->queuedMs = 0;
+    job->canceled = false;
+    job->queuedTimer.start();
+
+    const QJsonArray images = request.value("images").toArray();
+    for (const QJsonValue &image : images) {
+        job->encodedImages.append(QByteArray::fromBase64(image.toString().toLatin1()));
+    }
+
+    if (job->encodedImages.isEmpty() && job->path.isEmpty()) {
+        QJsonObject reply;
+        reply.insert("type", "error");
+        reply.insert("id", id);
+        reply.insert("error", "请求中没有图像或文件路径");
+        sendReply(socket, reply);
+        delete job;
+        return;
+    }
+
+    QJsonObject reply;
+    reply.insert("type", "accepted");
+    reply.insert("id", id);
+    reply.insert("queuePosition", enqueue(job));
+    sendReply(socket, reply);
+
+    dispatch();
+}
+
+/**
+ * @brief 连接断开：丢弃排队中的请求，取消进行中的请求
+ * @param socket 连接
+ */
+void OCRService::removeClient(QIODevice *socket)
+{
+    m_buffers.remove(socket);
+
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (m_queue.at(i)->client == socket) {
+            delete m_queue.takeAt(i);
+        }
+    }
+    for (Slot *slot : m_slots) {
+        if (slot->job && slot->job->client == socket) {
+            slot->job->canceled = true;
+            slot->ocrWatcher->cancel();
+        }
+    }
+
+    socket->deleteLater();
+}
+
+/**
+ * @brief 按优先级插入请求队列
+ * @param job 请求
+ * @return 在队列中的位置
+ */
+int OCRService::enqueue(Job *job)
+{
+    auto position = std::upper_bound(m_queue.begin(), m_queue.end(), job,
+                                     [](const Job *a, const Job *b) {
+        if (a->priority != b->priority) {
+            return a->priority > b->priority;
+        }
+        return a->sequence < b->sequence;
+    });
+    const int index = int(position - m_queue.begin());
+    m_queue.insert(index, job);
+    return index;
+}
+
+/**
+ * @brief 为所有空闲槽位分配请求
+ */
+void OCRService::dispatch()
+{
+    for (Slot *slot : m_slots) {
+        if (slot->job) {
+            continue;
+        }
+
+        // 跳过连接已断开的请求
+        Job *job = nullptr;
+        while (!m_queue.isEmpty() && !job) {
+            job = m_queue.takeFirst();
+            if (!job->client) {
+                delete job;
+                job = nullptr;
+            }
+        }
+        if (!job) {
+            return;
+        }
+
+        job->queuedMs = job->queuedTimer.elapsed();
+        slot->job = job;
+        slot->pageCount = 0;
+        slot->timer.start();
+
+        // 在后台解码图像或加载文件（PDF需要调用pdftoppm）
+        const QList<QByteArray> encodedImages = job->encodedImages;
+        const QString path = job->path;
+        const int maxWidth = job->maxWidth;
+        const int maxHeight = job->maxHeight;
+        const ImagePreprocessor::Options preprocess = job->preprocess;
+        job->encodedImages.clear();
+
+        slot->loadWatcher->setFuture(QtConcurrent::run([encodedImages, path, maxWidth, maxHeight, preprocess]() {
+            if (encodedImages.isEmpty()) {
+                FileProcessor processor;
+                FileProcessor::ProcessResult result = processor.processFile(path, maxWidth, maxHeight);
+                ImagePreprocessor::processAll(result.images, preprocess);
+                return result;
+            }
+
+            FileProcessor::ProcessResult result;
+            for (int i = 0; i < encodedImages.size(); ++i) {
+                QImage image = QImage::fromData(encodedImages.at(i));
+                if (image.isNull()) {
+                    result.errorMessage = QString("第%1张图像无法解码").arg(i + 1);
+                    return result;
+                }
+                if (maxWidth > 0 || maxHeight > 0) {
+                    image = FileProcessor::resizeImage(image, maxWidth, maxHeight);
+                }
+                result.images.append(image);
+                result.pageNames.append(QString("图像 %1").arg(i + 1));
+            }
+            ImagePreprocessor::processAll(result.images, preprocess);
+            result.pageCount = result.images.size();
+            result.success = true;
+            return result;
+        }));
+    }
+}
+
+/**
+ * @brief 加载完成，提交识别
+ * @param slot 槽位
+ */
+void OCRService::onJobLoaded(Slot *slot)
+{
+    Job *job = slot->job;
+    const FileProcessor::ProcessResult loaded = slot->loadWatcher->result();
+    slot->loadWatcher->setFuture(QFuture<FileProcessor::ProcessResult>());
+
+    if (job->canceled || !job->client || !loaded.success || loaded.images.isEmpty()) {
+        if (job->canceled) {
+            failJob(job, "请求已取消");
+        } else if (!loaded.success || loaded.images.isEmpty()) {
+            failJob(job, loaded.errorMessage.isEmpty() ? "没有可识别的页面" : loaded.errorMessage);
+        }
+        delete job;
+        slot->job = nullptr;
+        dispatch();
+        return;
+    }
+
+    slot->pageCount = loaded.images.size();
+    slot->pageNames = loaded.pageNames;
+    slot->ocrWatcher->setFuture(slot->engine->submitDocument(loaded.images, loaded.extractedTexts, job->language));
+}
+
+/**
+ * @brief 识别完成，发送结果
+ * @param slot 槽位
+ */
+void OCRService::onJobRecognized(Slot *slot)
+{
+    Job *job = slot->job;
+    QFuture<OCREngine::OCRResult> future = slot->ocrWatcher->future();
+    slot->ocrWatcher->setFuture(QFuture<OCREngine::OCRResult>());
+    const QStringList pageNames = slot->pageNames;
+    const qint64 elapsedMs = slot->timer.elapsed();
+
+    QJsonArray pages;
+    QString errorMessage;
+    int failedPages = 0;
+    for (int i = 0; i < slot->pageCount; ++i) {
+        OCREngine::OCRResult pageResult;
+        if (future.isValid() && future.isResultReadyAt(i)) {
+            pageResult = future.resultAt(i);
+        } else {
+            pageResult.errorMessage = "识别未完成";
+        }
+        if (!pageResult.success) {
+            failedPages++;
+            if (errorMessage.isEmpty()) {
+                errorMessage = pageResult.errorMessage;
+            }
+        }
+
+        QJsonObject page = resultToJson(pageResult, job->layoutMode);
+        page.insert("name", pageNames.value(i));
+        pages.append(page);
+    }
+
+    const bool success = failedPages == 0;
+    if (success) {
+        m_completedJobs++;
+    } else {
+        m_failedJobs++;
+    }
+
+    QJsonObject reply;
+    reply.insert("type", "result");
+    reply.insert("id", job->id);
+    reply.insert("success", success);
+    if (!success) {
+        reply.insert("error", errorMessage);
+    }
+    reply.insert("pages", pages);
+    reply.insert("queuedMs", job->queuedMs);
+    reply.insert("elapsedMs", elapsedMs);
+    sendReply(job->client, reply);
+
+    emit jobFinished(success, slot->pageCount, job->queuedMs, elapsedMs);
+
+    delete job;
+    slot->job = nullptr;
+    slot->pageCount = 0;
+    slot->pageNames.clear();
+    dispatch();
+}
+
+/**
+ * @brief 发送失败结果
+ * @param job 请求
+ * @param errorMessage 错误信息
+ */
+void OCRService::failJob(Job *job, const QString &errorMessage)
+{
+    m_failedJobs++;
+
+    QJsonObject reply;
+    reply.insert("type", "result");
+    reply.insert("id", job->id);
+    reply.insert("success", false);
+    reply.insert("error", errorMessage);
+    reply.insert("pages", QJsonArray());
+    reply.insert("queuedMs", job->queuedMs);
+    reply.insert("elapsedMs", 0);
+    sendReply(job->client, reply);
+
+    emit jobFinished(false, 0, job->queuedMs, 0);
+}
+
+/**
+ * @brief 向连接发送一行JSON应答
+ * @param socket 连接
+ * @param reply 应答对象
+ */
+void OCRService::sendReply(QIODevice *socket, const QJsonObject &reply)
+{
+    if (!socket || !socket->isOpen()) {
+        return;
+    }
+    socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+    socket->write("\n", 1);
+}
+
+/**
+ * @brief 生成状态应答
+ * @return 状态对象
+ */
+QJsonObject OCRService::statusObject() const
+{
+    int running = 0;
+    for (const Slot *slot : m_slots) {
+        if (slot->job) {
+            running++;
+        }
+    }
+
+    QJsonObject status;
+    status.insert("type", "status");
+    status.insert("engine", m_slots.isEmpty() ? QString() : m_slots.first()->engine->getEngineName());
+    status.insert("engines", m_slots.size());
+    status.insert("queued", m_queue.size());
+    status.insert("running", running);
+    status.insert("completed", m_completedJobs);
+    status.insert("failed", m_failedJobs);
+    status.insert("uptimeSeconds", m_uptime.isValid() ? m_uptime.elapsed() / 1000 : 0);
+    status.insert("languages", QJsonArray::fromStringList(
+        m_slots.isEmpty() ? QStringList() : m_slots.first()->engine->getSupportedLanguages()));
+    return status;
+}
+
+/**
+ * @brief 将单页识别结果转换为JSON
+ * @param result 识别结果
+ * @param layoutMode 版面结构的表示方式
+ * @return JSON对象
+ */
+QJsonObject OCRService::resultToJson(const OCREngine::OCRResult &result, const QString &layoutMode)
+{
+    QJsonObject object;
+    object.insert("success", result.success);
+    if (!result.success) {
+        object.insert("error", result.errorMessage);
+        return object;
+    }
+
+    object.insert("text", result.text);
+    object.insert("confidence", double(result.confidence));
+    if (result.blankPage) {
+        object.insert("blank", true);
+    }
+    if (result.extracted) {
+        object.insert("extracted", true);
+    }
+    if (layoutMode == "json") {
+        object.insert("layout", result.layout.toJson());
+    } else if (layoutMode == "binary") {
+        QByteArray layoutData;
+        QDataStream stream(&layoutData, QIODevice::WriteOnly);
+        stream << result.layout;
+        object.insert("layoutData", QString::fromLatin1(layoutData.toBase64()));
+    }
+    return object;
+}
+
+/**
+ * @brief 从JSON还原单页识别结果
+ * @param object JSON对象
+ * @return 识别结果
+ */
+OCREngine::OCRResult OCRService::resultFromJson(const QJsonObject &object)
+{
+    OCREngine::OCRResult result;
+    result.success = object.value("success").toBool();
+    result.errorMessage = object.value("error").toString();
+    result.text = object.value("text").toString();
+    result.confidence = float(object.value("confidence").toDouble());
+    result.blankPage = object.value("blank").toBool();
+    result.extracted = object.value("extracted").toBool();
+
+    const QString layoutData = object.value("layoutData").toString();
+    if (!layoutData.isEmpty()) {
+        QDataStream stream(QByteArray::fromBase64(layoutData.toLatin1()));
+        stream >> result.layout;
+        if (stream.status() != QDataStream::Ok) {
+            result.layout = OCRLayout();
+        }
+    }
+    return result;
+}
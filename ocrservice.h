@@ -0,0 +1,222 @@
+#ifndef OCRSERVICE_H
+#define OCRSERVICE_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include "ocrengine.h"
+#include "fileprocessor.h"
+#include "imagepreprocessor.h"
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+/**
+ * @brief 常驻的本地OCR服务
+ *
+ * 启动时初始化并预热OCR引擎（语言模型、预热的tesseract进程和结果缓存常驻），
+ * 通过本地套接字（QLocalServer）和可选的回环TCP端口接受识别请求，
+ * 避免每个请求都重新初始化引擎和加载模型。
+ *
+ * 协议为换行分隔的JSON（每行一个UTF-8 JSON对象）。请求：
+ * - {"type":"recognize","id":…,"images":[base64图像文件…] 或 "path":"文件路径"（只接受来自本地套接字的请求）,
+ *    "language":"chi_sim+eng","priority":0,"maxWidth":0,"maxHeight":0,"layout":"json|binary|none",
+ *    "preprocess":"none|gray|otsu|sauvola","bilevel":false,"normalizeTextSize":false,"xHeight":22}
+ * - {"type":"status","id":…}
+ * - {"type":"cancel","id":…,"target":要取消的请求id}
+ *
+ * 应答均带有请求的id：识别请求先应答{"type":"accepted","queuePosition":n}，
+ * 完成后应答{"type":"result","success":…,"error":…,"pages":[…],"queuedMs":…,"elapsedMs":…}；
+ * 状态请求应答{"type":"status",…}；无效请求应答{"type":"error","error":…}。
+ *
+ * 本地套接字只允许当前用户连接；回环TCP端口本机任何用户都能连接，因此TCP请求只能内嵌图像，
+ * 带"path"的请求被拒绝，服务不会替其他用户读取只有服务账户可读的文件。
+ *
+ * 请求按优先级（大者优先）和到达顺序排队，每个引擎同时处理一个请求，
+ * 请求内的多页由引擎自身并发识别。客户端断开时其排队中的请求被丢弃，进行中的请求被取消。
+ */
+class OCRService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造服务
+     * @param engines 已初始化的OCR引擎，每个引擎同时处理一个请求（不拥有）
+     * @param parent 父对象指针
+     */
+    explicit OCRService(const QList<OCREngine *> &engines, QObject *parent = nullptr);
+    ~OCRService();
+
+    /**
+     * @brief 默认的本地套接字名称
+     * @return 套接字名称
+     */
+    static QString defaultServerName();
+
+    /**
+     * @brief 开始监听
+     * @param serverName 本地套接字名称
+     * @param tcpPort 回环TCP端口（0表示不监听TCP）
+     * @param defaultLanguage 预热工作进程使用的语言
+     * @return 是否成功
+     */
+    bool listen(const QString &serverName, quint16 tcpPort = 0,
+                const QString &defaultLanguage = "chi_sim+eng");
+
+    /**
+     * @brief 获取最后的错误信息
+     * @return 错误信息
+     */
+    QString errorString() const;
+
+    /**
+     * @brief 将单页识别结果转换为JSON（服务端和客户端共用）
+     * @param result 识别结果
+     * @param layoutMode 版面结构的表示方式："json"、"binary"（QDataStream序列化后base64编码）或"none"
+     * @return JSON对象
+     */
+    static QJsonObject resultToJson(const OCREngine::OCRResult &result, const QString &layoutMode);
+
+    /**
+     * @brief 从JSON还原单页识别结果（版面结构只从"binary"表示还原）
+     * @param object JSON对象
+     * @return 识别结果
+     */
+    static OCREngine::OCRResult resultFromJson(const QJsonObject &object);
+
+signals:
+    /**
+     * @brief 请求处理完成信号
+     * @param success 是否成功
+     * @param pageCount 页数
+     * @param queuedMs 排队时间
+     * @param elapsedMs 处理时间（不含排队）
+     */
+    void jobFinished(bool success, int pageCount, qint64 queuedMs, qint64 elapsedMs);
+
+private:
+    /**
+     * @brief 排队中或进行中的识别请求
+     */
+    struct Job {
+        quint64 sequence;               // 到达顺序
+        int priority;                   // 优先级（大者优先）
+        QPointer<QIODevice> client;     // 发起请求的连接
+        QJsonValue id;                  // 请求id
+        QList<QByteArray> encodedImages; // 客户端发送的图像文件数据
+        QString path;                   // 服务端读取的文件路径
+        QString language;               // 识别语言
+        QString layoutMode;             // 版面结构表示方式
+        int maxWidth;                   // 页面图像最大宽度
+        int maxHeight;                  // 页面图像最大高度
+        ImagePreprocessor::Options preprocess; // 识别前的图像预处理
+        QElapsedTimer queuedTimer;      // 到达计时
+        qint64 queuedMs;                // 排队时间
+        bool canceled;                  // 客户端已取消或已断开
+    };
+
+    /**
+     * @brief 处理槽位（每个引擎一个）
+     */
+    struct Slot {
+        OCREngine *engine;                                          // 该槽位专用的引擎
+        QFutureWatcher<FileProcessor::ProcessResult> *loadWatcher;  // 图像解码或文件加载任务
+        QFutureWatcher<OCREngine::OCRResult> *ocrWatcher;           // 识别任务
+        Job *job;                                                   // 进行中的请求（空表示空闲）
+        int pageCount;                                              // 进行中请求的页数
+        QStringList pageNames;                                      // 进行中请求的页面名称
+        QElapsedTimer timer;                                        // 处理计时
+    };
+
+    /**
+     * @brief 接受新连接
+     * @param socket 连接（本地或TCP）
+     */
+    void addClient(QIODevice *socket);
+
+    /**
+     * @brief 读取连接上的完整请求行
+     * @param socket 连接
+     */
+    void readClient(QIODevice *socket);
+
+    /**
+     * @brief 处理一条请求
+     * @param socket 连接
+     * @param request 请求对象
+     */
+    void handleRequest(QIODevice *socket, const QJsonObject &request);
+
+    /**
+     * @brief 连接断开：丢弃排队中的请求，取消进行中的请求
+     * @param socket 连接
+     */
+    void removeClient(QIODevice *socket);
+
+    /**
+     * @brief 按优先级插入请求队列
+     * @param job 请求
+     * @return 在队列中的位置（从0开始）
+     */
+    int enqueue(Job *job);
+
+    /**
+     * @brief 为所有空闲槽位分配请求
+     */
+    void dispatch();
+
+    /**
+     * @brief 加载完成，提交识别
+     * @param slot 槽位
+     */
+    void onJobLoaded(Slot *slot);
+
+    /**
+     * @brief 识别完成，发送结果
+     * @param slot 槽位
+     */
+    void onJobRecognized(Slot *slot);
+
+    /**
+     * @brief 发送失败结果并结束请求
+     * @param job 请求
+     * @param errorMessage 错误信息
+     */
+    void failJob(Job *job, const QString &errorMessage);
+
+    /**
+     * @brief 向连接发送一行JSON应答
+     * @param socket 连接（已断开时忽略）
+     * @param reply 应答对象
+     */
+    void sendReply(QIODevice *socket, const QJsonObject &reply);
+
+    /**
+     * @brief 生成状态应答
+     * @return 状态对象
+     */
+    QJsonObject statusObject() const;
+
+private:
+    QLocalServer *m_localServer;            // 本地套接字服务
+    QTcpServer *m_tcpServer;                // 回环TCP服务（可选）
+    QList<Slot *> m_slots;                  // 处理槽位
+    QList<Job *> m_queue;                   // 排队中的请求（按优先级和到达顺序排列）
+    QHash<QIODevice *, QByteArray> m_buffers; // 连接 -> 未读完的请求数据
+    quint64 m_nextSequence;                 // 下一个请求的到达顺序
+    qint64 m_completedJobs;                 // 已完成的请求数
+    qint64 m_failedJobs;                    // 失败的请求数
+    QElapsedTimer m_uptime;                 // 服务运行时间
+    QString m_errorString;                  // 最后的错误信息
+
+    static const qint64 s_maxRequestBytes;  // 单条请求的最大字节数
+};
+
+#endif // OCRSERVICE_H
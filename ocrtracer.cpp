@@ -0,0 +1,275 @@
+#include "ocrtracer.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+/**
+ * @brief 一条追踪事件
+ */
+struct TraceEvent {
+    const char *name;   // 阶段名称
+    char phase;         // 'X'为线程上的完整时间段，'b'/'e'为异步时间段的开始和结束
+    qint64 timestampUs; // 开始时间
+    qint64 durationUs;  // 持续时间（仅'X'）
+    int threadId;       // 线程编号
+    int pageIndex;      // 页面索引（-1表示无）
+    int asyncId;        // 异步时间段编号（仅'b'/'e'）
+};
+
+const int s_maxEvents = 1000000;    // 事件数上限，超出后丢弃新事件，避免长时间运行占用过多内存
+
+QMutex s_traceMutex;                // 保护以下数据
+QList<TraceEvent> s_events;         // 已记录的事件
+QHash<int, QString> s_threadNames;  // 线程编号 -> 线程名称
+qint64 s_droppedEvents = 0;         // 超出上限被丢弃的事件数
+
+QAtomicInt s_nextThreadId(1);       // 下一个线程编号
+QAtomicInt s_nextAsyncId(1);        // 下一个异步时间段编号
+thread_local int s_threadId = 0;    // 当前线程的编号（0表示尚未分配）
+
+/**
+ * @brief 追踪文件路径（为空表示未启用）
+ */
+const QString &tracePath()
+{
+    static const QString path = qEnvironmentVariable("CONVENIENT_OCR_TRACE");
+    return path;
+}
+
+/**
+ * @brief 追踪时钟（第一次使用时开始计时）
+ */
+const QElapsedTimer &traceClock()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock;
+}
+
+/**
+ * @brief 获取当前线程的编号，第一次调用时登记线程名称
+ */
+int currentThreadId()
+{
+    if (s_threadId != 0) {
+        return s_threadId;
+    }
+
+    s_threadId = s_nextThreadId.fetchAndAddRelaxed(1);
+
+    QThread *thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        name = "主线程";
+    } else if (name.isEmpty()) {
+        name = QString("工作线程 %1").arg(s_threadId);
+    }
+
+    QMutexLocker locker(&s_traceMutex);
+    s_threadNames.insert(s_threadId, name);
+    return s_threadId;
+}
+
+/**
+ * @brief 添加事件（调用方需持有锁）
+ */
+void appendEvent(const TraceEvent &event)
+{
+    if (s_events.size() >= s_maxEvents) {
+        s_droppedEvents++;
+        return;
+    }
+    s_events.append(event);
+}
+
+} // namespace
+
+/**
+ * @brief 开始时间段
+ * @param name 阶段名称
+ * @param pageIndex 页面索引
+ */
+OCRTracer::Span::Span(const char *name, int pageIndex)
+    : m_name(name)
+    , m_pageIndex(pageIndex)
+    , m_startUs(isEnabled() ? nowUs() : -1)
+{
+}
+
+OCRTracer::Span::~Span()
+{
+    if (m_startUs >= 0) {
+        complete(m_name, m_startUs, nowUs() - m_startUs, m_pageIndex);
+    }
+}
+
+/**
+ * @brief 是否已启用追踪
+ * @return 是否启用
+ */
+bool OCRTracer::isEnabled()
+{
+    static const bool enabled = !tracePath().isEmpty();
+    return enabled;
+}
+
+/**
+ * @brief 获取追踪时钟的当前时间
+ * @return 微秒数
+ */
+qint64 OCRTracer::nowUs()
+{
+    return traceClock().nsecsElapsed() / 1000;
+}
+
+/**
+ * @brief 记录当前线程上已结束的时间段
+ * @param name 阶段名称
+ * @param startUs 开始时间
+ * @param durationUs 持续时间
+ * @param pageIndex 页面索引
+ */
+void OCRTracer::complete(const char *name, qint64 startUs, qint64 durationUs, int pageIndex)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    TraceEvent event;
+    event.name = name;
+    event.phase = 'X';
+    event.timestampUs = startUs;
+    event.durationUs = durationUs;
+    event.threadId = currentThreadId();
+    event.pageIndex = pageIndex;
+    event.asyncId = 0;
+
+    QMutexLocker locker(&s_traceMutex);
+    appendEvent(event);
+}
+
+/**
+ * @brief 记录不占用当前线程的时间段
+ * @param name 阶段名称
+ * @param startUs 开始时间
+ * @param durationUs 持续时间
+ * @param pageIndex 页面索引
+ */
+void OCRTracer::asyncSpan(const char *name, qint64 startUs, qint64 durationUs, int pageIndex)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    TraceEvent begin;
+    begin.name = name;
+    begin.phase = 'b';
+    begin.timestampUs = startUs;
+    begin.durationUs = 0;
+    begin.threadId = currentThreadId();
+    begin.pageIndex = pageIndex;
+    begin.asyncId = s_nextAsyncId.fetchAndAddRelaxed(1);
+
+    TraceEvent end = begin;
+    end.phase = 'e';
+    end.timestampUs = startUs + durationUs;
+
+    QMutexLocker locker(&s_traceMutex);
+    appendEvent(begin);
+    appendEvent(end);
+}
+
+/**
+ * @brief 将已记录的事件写入追踪文件
+ * @return 是否成功
+ */
+bool OCRTracer::flush()
+{
+    if (!isEnabled()) {
+        return false;
+    }
+
+    const qint64 processId = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    qint64 droppedEvents = 0;
+
+    {
+        QMutexLocker locker(&s_traceMutex);
+        droppedEvents = s_droppedEvents;
+
+        // 线程名称元数据，使时间线按线程名显示
+        for (auto it = s_threadNames.cbegin(); it != s_threadNames.cend(); ++it) {
+            QJsonObject args;
+            args.insert("name", it.value());
+
+            QJsonObject metadata;
+            metadata.insert("name", "thread_name");
+            metadata.insert("ph", "M");
+            metadata.insert("pid", processId);
+            metadata.insert("tid", it.key());
+            metadata.insert("args", args);
+            traceEvents.append(metadata);
+        }
+
+        for (const TraceEvent &event : s_events) {
+            QJsonObject object;
+            object.insert("name", QString::fromLatin1(event.name));
+            object.insert("cat", event.phase == 'X' ? "ocr" : "process");
+            object.insert("ph", QString(QChar::fromLatin1(event.phase)));
+            object.insert("ts", event.timestampUs);
+            object.insert("pid", processId);
+            object.insert("tid", event.threadId);
+            if (event.phase == 'X') {
+                object.insert("dur", event.durationUs);
+            } else {
+                object.insert("id", event.asyncId);
+            }
+            if (event.pageIndex >= 0) {
+                QJsonObject args;
+                args.insert("page", event.pageIndex + 1);
+                object.insert("args", args);
+            }
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", "ms");
+    if (droppedEvents > 0) {
+        QJsonObject otherData;
+        otherData.insert("droppedEvents", droppedEvents);
+        root.insert("otherData", otherData);
+    }
+
+    QSaveFile file(tracePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+/**
+ * @brief 清除已记录的事件
+ */
+void OCRTracer::clear()
+{
+    QMutexLocker locker(&s_traceMutex);
+    s_events.clear();
+    s_droppedEvents = 0;
+}
@@ -0,0 +1,83 @@
+#ifndef OCRTRACER_H
+#define OCRTRACER_H
+
+#include <QString>
+
+/**
+ * @brief 识别流水线的时间线追踪
+ *
+ * 设置环境变量CONVENIENT_OCR_TRACE为文件路径时启用，记录文件加载、PDF渲染、图像编码、
+ * 进程启动、识别、TSV解析和界面更新等阶段的时间段，每段带有线程和页面索引。
+ * 事件只记录在内存中（有数量上限），程序退出时以Chrome trace-event JSON格式写入该文件，
+ * 可直接在Perfetto（ui.perfetto.dev）或chrome://tracing中打开。
+ *
+ * 未启用时所有接口只做一次布尔判断。所有接口都是线程安全的。
+ */
+class OCRTracer
+{
+public:
+    /**
+     * @brief 作用域时间段，析构时记录到当前线程
+     */
+    class Span
+    {
+    public:
+        /**
+         * @brief 开始时间段
+         * @param name 阶段名称（字符串常量）
+         * @param pageIndex 页面索引，-1表示与具体页面无关
+         */
+        explicit Span(const char *name, int pageIndex = -1);
+        ~Span();
+
+    private:
+        const char *m_name;
+        int m_pageIndex;
+        qint64 m_startUs;
+    };
+
+    /**
+     * @brief 是否已启用追踪
+     * @return 是否启用
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief 获取追踪时钟的当前时间
+     * @return 自追踪开始以来的微秒数
+     */
+    static qint64 nowUs();
+
+    /**
+     * @brief 记录当前线程上已结束的时间段
+     * @param name 阶段名称（字符串常量）
+     * @param startUs 开始时间（nowUs()的返回值）
+     * @param durationUs 持续时间（微秒）
+     * @param pageIndex 页面索引，-1表示与具体页面无关
+     */
+    static void complete(const char *name, qint64 startUs, qint64 durationUs, int pageIndex = -1);
+
+    /**
+     * @brief 记录不占用当前线程的时间段（如外部tesseract进程的识别过程）
+     *
+     * 多个页面的进程并发运行时时间段互相重叠，因此作为异步事件单独显示在各自的轨道上。
+     * @param name 阶段名称（字符串常量）
+     * @param startUs 开始时间（nowUs()的返回值）
+     * @param durationUs 持续时间（微秒）
+     * @param pageIndex 页面索引，-1表示与具体页面无关
+     */
+    static void asyncSpan(const char *name, qint64 startUs, qint64 durationUs, int pageIndex = -1);
+
+    /**
+     * @brief 将已记录的事件写入CONVENIENT_OCR_TRACE指定的文件
+     * @return 是否成功（未启用时返回false）
+     */
+    static bool flush();
+
+    /**
+     * @brief 清除已记录的事件
+     */
+    static void clear();
+};
+
+#endif // OCRTRACER_H
@@ -0,0 +1,591 @@
+#include "pagehashindex.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QVector>
+#include <QtMath>
+
+// 计算签名时预览图的宽度
+static const int PREVIEW_WIDTH = 256;
+
+// 预览图中与背景灰度相差超过该值的像素视为墨迹
+static const int INK_CONTRAST = 24;
+
+// 墨迹像素少于该值的页面没有签名
+static const int MIN_INK_PIXELS = 32;
+
+// 内容区域在预览图中的宽或高小于该值时没有签名（只有一两行字的页面放大到缩略图后难以区分）
+static const int MIN_CONTENT_SIZE = 24;
+
+// dHash汉明距离超过该值的候选页面不再计算相似度
+static const int MAX_HASH_DISTANCE = 20;
+
+// 逐像素确认时内容区域缩放到的宽度（300 DPI的A4页面内容区域约2000像素宽）
+static const int REFERENCE_WIDTH = 1600;
+
+// 参考掩码中与背景灰度相差超过该值的像素视为墨迹（全分辨率下笔画对比度高于预览图）
+static const int REFERENCE_CONTRAST = 64;
+
+// 逐像素确认时两页之间允许的最大平移（像素）
+static const int REFERENCE_SHIFT = 2;
+
+// 逐像素确认时的分块边长，任何一块中不一致的墨迹像素超过MAX_BLOCK_MISMATCH即判定为不同页面
+static const int REFERENCE_BLOCK = 32;
+static const int MAX_BLOCK_MISMATCH = 16;
+
+// 索引文件格式
+static const quint32 s_fileMagic = 0x50484958;   // "PHIX"
+static const quint32 s_fileVersion = 1;
+
+/**
+ * @brief 在墨迹投影中去掉两端各0.5%的墨迹，得到内容范围
+ * @param profile 每行（或每列）的墨迹像素数
+ * @param total 墨迹像素总数
+ * @param first 返回起始位置
+ * @param last 返回结束位置（含）
+ */
+static void inkRange(const QVector<int> &profile, qint64 total, int *first, int *last)
+{
+    const qint64 trim = total / 200;
+    qint64 sum = 0;
+    *first = 0;
+    for (int i = 0; i < profile.size(); ++i) {
+        sum += profile.at(i);
+        if (sum > trim) {
+            *first = i;
+            break;
+        }
+    }
+
+    sum = 0;
+    *last = int(profile.size()) - 1;
+    for (int i = int(profile.size()) - 1; i >= 0; --i) {
+        sum += profile.at(i);
+        if (sum > trim) {
+            *last = i;
+            break;
+        }
+    }
+    *last = qMax(*first, *last);
+}
+
+/**
+ * @brief 以灰度中位数作为背景灰度
+ * @param gray 灰度图像
+ * @return 背景灰度
+ */
+static int backgroundLevel(const QImage &gray)
+{
+    quint32 histogram[256] = {};
+    for (int y = 0; y < gray.height(); ++y) {
+        const uchar *line = gray.constScanLine(y);
+        for (int x = 0; x < gray.width(); ++x) {
+            histogram[line[x]]++;
+        }
+    }
+    const qint64 pixels = qint64(gray.width()) * gray.height();
+    int background = 0;
+    for (qint64 below = 0; background < 255; ++background) {
+        below += histogram[background];
+        if (below * 2 >= pixels) {
+            break;
+        }
+    }
+    return background;
+}
+
+/**
+ * @brief 把单色掩码展开为每像素一个字节
+ * @param mask 单色掩码
+ * @param height 展开的行数
+ * @return 墨迹像素为1，其余为0
+ */
+static QVector<uchar> unpackMask(const QImage &mask, int height)
+{
+    const int width = mask.width();
+    QVector<uchar> pixels(qsizetype(width) * height, 0);
+    for (int y = 0; y < height; ++y) {
+        const uchar *line = mask.constScanLine(y);
+        uchar *target = pixels.data() + qsizetype(y) * width;
+        for (int x = 0; x < width; ++x) {
+            target[x] = (line[x >> 3] >> (7 - (x & 7))) & 1;
+        }
+    }
+    return pixels;
+}
+
+/**
+ * @brief 3x3膨胀，容许笔画粗细和亚像素位置的差异
+ * @param pixels 展开的掩码
+ * @param width 宽度
+ * @param height 高度
+ * @return 膨胀后的掩码
+ */
+static QVector<uchar> dilateMask(const QVector<uchar> &pixels, int width, int height)
+{
+    QVector<uchar> dilated(pixels.size(), 0);
+    for (int y = 0; y < height; ++y) {
+        const uchar *line = pixels.constData() + qsizetype(y) * width;
+        for (int x = 0; x < width; ++x) {
+            if (!line[x]) {
+                continue;
+            }
+            for (int ny = qMax(0, y - 1); ny <= qMin(height - 1, y + 1); ++ny) {
+                uchar *target = dilated.data() + qsizetype(ny) * width;
+                for (int nx = qMax(0, x - 1); nx <= qMin(width - 1, x + 1); ++nx) {
+                    target[nx] = 1;
+                }
+            }
+        }
+    }
+    return dilated;
+}
+
+/**
+ * @brief PageHashIndex构造函数
+ * @param maxEntries 条目上限
+ */
+PageHashIndex::PageHashIndex(int maxEntries)
+    : m_maxEntries(qMax(1, maxEntries))
+    , m_minSimilarity(0.95)
+{
+}
+
+/**
+ * @brief 计算页面签名
+ * @param image 页面图像
+ * @return 页面签名
+ */
+PageHashIndex::Signature PageHashIndex::computeSignature(const QImage &image)
+{
+    Signature signature;
+    if (image.isNull()) {
+        return signature;
+    }
+
+    // 平滑缩小相当于区域平均，同时滤掉扫描噪点
+    const int previewWidth = qMin(PREVIEW_WIDTH, image.width());
+    const int previewHeight = qMax(1, qRound(double(image.height()) * previewWidth / image.width()));
+    const QImage preview = image.scaled(previewWidth, previewHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                               .convertToFormat(QImage::Format_Grayscale8);
+
+    // 背景取灰度中位数
+    const int background = backgroundLevel(preview);
+
+    // 行列墨迹投影
+    QVector<int> rowInk(preview.height(), 0);
+    QVector<int> columnInk(preview.width(), 0);
+    qint64 totalInk = 0;
+    for (int y = 0; y < preview.height(); ++y) {
+        const uchar *line = preview.constScanLine(y);
+        for (int x = 0; x < preview.width(); ++x) {
+            if (qAbs(int(line[x]) - background) > INK_CONTRAST) {
+                rowInk[y]++;
+                columnInk[x]++;
+                totalInk++;
+            }
+        }
+    }
+    if (totalInk < MIN_INK_PIXELS) {
+        return signature;
+    }
+
+    int left = 0;
+    int right = 0;
+    int top = 0;
+    int bottom = 0;
+    inkRange(columnInk, totalInk, &left, &right);
+    inkRange(rowInk, totalInk, &top, &bottom);
+    const QRect previewContent(QPoint(left, top), QPoint(right, bottom));
+    if (previewContent.width() < MIN_CONTENT_SIZE || previewContent.height() < MIN_CONTENT_SIZE) {
+        return signature;
+    }
+
+    const QImage thumbnail = preview.copy(previewContent)
+                                 .scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                                 .convertToFormat(QImage::Format_Grayscale8);
+    signature.thumbnail.resize(THUMBNAIL_SIZE * THUMBNAIL_SIZE);
+    for (int y = 0; y < THUMBNAIL_SIZE; ++y) {
+        memcpy(signature.thumbnail.data() + y * THUMBNAIL_SIZE, thumbnail.constScanLine(y), THUMBNAIL_SIZE);
+    }
+
+    // dHash：9x8缩略图中每个像素与右侧相邻像素比较
+    const QImage hashImage = thumbnail.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                                 .convertToFormat(QImage::Format_Grayscale8);
+    for (int y = 0; y < 8; ++y) {
+        const uchar *line = hashImage.constScanLine(y);
+        for (int x = 0; x < 8; ++x) {
+            signature.hash = (signature.hash << 1) | (line[x] > line[x + 1] ? 1 : 0);
+        }
+    }
+
+    // 内容区域换算回页面坐标
+    const double scaleX = double(image.width()) / previewWidth;
+    const double scaleY = double(image.height()) / previewHeight;
+    signature.content = QRect(QPoint(qFloor(left * scaleX), qFloor(top * scaleY)),
+                              QPoint(qCeil((right + 1) * scaleX) - 1, qCeil((bottom + 1) * scaleY) - 1))
+                        & image.rect();
+    return signature;
+}
+
+/**
+ * @brief 计算两个签名的相似度
+ * @param a 签名
+ * @param b 签名
+ * @return 相似度
+ */
+double PageHashIndex::similarity(const Signature &a, const Signature &b)
+{
+    if (!a.isValid() || !b.isValid() || a.thumbnail.size() != b.thumbnail.size()
+        || a.content.isEmpty() || b.content.isEmpty()) {
+        return 0.0;
+    }
+
+    // 缩略图不保留宽高比，需单独比较
+    const double aspectA = double(a.content.width()) / a.content.height();
+    const double aspectB = double(b.content.width()) / b.content.height();
+    if (qAbs(aspectA / aspectB - 1.0) > 0.1) {
+        return 0.0;
+    }
+
+    double sumA = 0.0;
+    double sumB = 0.0;
+    double sumAA = 0.0;
+    double sumBB = 0.0;
+    double sumAB = 0.0;
+    const int count = int(a.thumbnail.size());
+    const uchar *pixelsA = reinterpret_cast<const uchar *>(a.thumbnail.constData());
+    const uchar *pixelsB = reinterpret_cast<const uchar *>(b.thumbnail.constData());
+    for (int i = 0; i < count; ++i) {
+        const double valueA = pixelsA[i];
+        const double valueB = pixelsB[i];
+        sumA += valueA;
+        sumB += valueB;
+        sumAA += valueA * valueA;
+        sumBB += valueB * valueB;
+        sumAB += valueA * valueB;
+    }
+
+    const double varianceA = sumAA - sumA * sumA / count;
+    const double varianceB = sumBB - sumB * sumB / count;
+    if (varianceA <= 0.0 || varianceB <= 0.0) {
+        return 0.0;
+    }
+    return (sumAB - sumA * sumB / count) / std::sqrt(varianceA * varianceB);
+}
+
+/**
+ * @brief 生成内容区域的参考掩码
+ * @param image 页面图像
+ * @param content 内容区域
+ * @return 单色掩码
+ */
+QImage PageHashIndex::referenceMask(const QImage &image, const QRect &content)
+{
+    const QRect region = content & image.rect();
+    if (region.isEmpty()) {
+        return QImage();
+    }
+
+    // 缩放到固定宽度，不同分辨率扫描的同一页面得到同样大小的掩码
+    const int height = qMax(1, qRound(double(region.height()) * REFERENCE_WIDTH / region.width()));
+    const QImage gray = image.copy(region)
+                            .scaled(REFERENCE_WIDTH, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                            .convertToFormat(QImage::Format_Grayscale8);
+    const int background = backgroundLevel(gray);
+
+    QImage mask(REFERENCE_WIDTH, height, QImage::Format_Mono);
+    mask.setColor(0, qRgb(255, 255, 255));
+    mask.setColor(1, qRgb(0, 0, 0));
+    mask.fill(0);
+    for (int y = 0; y < height; ++y) {
+        const uchar *source = gray.constScanLine(y);
+        uchar *target = mask.scanLine(y);
+        for (int x = 0; x < REFERENCE_WIDTH; ++x) {
+            if (qAbs(int(source[x]) - background) > REFERENCE_CONTRAST) {
+                target[x >> 3] |= uchar(0x80 >> (x & 7));
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief 逐像素确认两页内容一致
+ * @param a 参考掩码
+ * @param b 参考掩码
+ * @return 是否一致
+ */
+bool PageHashIndex::confirmMatch(const QImage &a, const QImage &b)
+{
+    if (a.isNull() || b.isNull() || a.width() != b.width()
+        || a.format() != QImage::Format_Mono || b.format() != QImage::Format_Mono
+        || qAbs(double(a.height()) / b.height() - 1.0) > 0.03) {
+        return false;
+    }
+
+    const int width = a.width();
+    const int height = qMin(a.height(), b.height());
+    const QVector<uchar> inkA = unpackMask(a, height);
+    const QVector<uchar> inkB = unpackMask(b, height);
+    const QVector<uchar> nearA = dilateMask(inkA, width, height);
+    const QVector<uchar> nearB = dilateMask(inkB, width, height);
+
+    qint64 totalInk = 0;
+    for (qsizetype i = 0; i < inkA.size(); ++i) {
+        totalInk += inkA.at(i) + inkB.at(i);
+    }
+    if (totalInk == 0) {
+        return false;
+    }
+    const qint64 maxMismatch = totalInk / 100;
+
+    // 一侧有墨迹而另一侧平移后1像素范围内都没有墨迹的像素数；超过limit时提前结束
+    const int blocksX = (width + REFERENCE_BLOCK - 1) / REFERENCE_BLOCK;
+    const int blocksY = (height + REFERENCE_BLOCK - 1) / REFERENCE_BLOCK;
+    auto countMismatch = [&](int dx, int dy, qint64 limit, QVector<int> *blocks) {
+        qint64 mismatch = 0;
+        for (int y = qMax(0, -dy); y < qMin(height, height - dy); ++y) {
+            const uchar *lineA = inkA.constData() + qsizetype(y) * width;
+            const uchar *lineNearA = nearA.constData() + qsizetype(y) * width;
+            const uchar *lineB = inkB.constData() + qsizetype(y + dy) * width + dx;
+            const uchar *lineNearB = nearB.constData() + qsizetype(y + dy) * width + dx;
+            for (int x = qMax(0, -dx); x < qMin(width, width - dx); ++x) {
+                if ((lineA[x] && !lineNearB[x]) || (lineB[x] && !lineNearA[x])) {
+                    ++mismatch;
+                    if (blocks) {
+                        (*blocks)[(y / REFERENCE_BLOCK) * blocksX + x / REFERENCE_BLOCK]++;
+                    }
+                }
+            }
+            if (mismatch > limit) {
+                break;
+            }
+        }
+        return mismatch;
+    };
+
+    // 内容区域的定位可能相差一两个像素，取不一致最少的平移
+    int bestDx = 0;
+    int bestDy = 0;
+    qint64 bestMismatch = countMismatch(0, 0, maxMismatch, nullptr);
+    for (int dy = -REFERENCE_SHIFT; dy <= REFERENCE_SHIFT; ++dy) {
+        for (int dx = -REFERENCE_SHIFT; dx <= REFERENCE_SHIFT; ++dx) {
+            if (dx == 0 && dy == 0) {
+                continue;
+            }
+            const qint64 mismatch = countMismatch(dx, dy, qMin(bestMismatch, maxMismatch), nullptr);
+            if (mismatch < bestMismatch) {
+                bestMismatch = mismatch;
+                bestDx = dx;
+                bestDy = dy;
+            }
+        }
+    }
+    if (bestMismatch > maxMismatch) {
+        return false;
+    }
+
+    // 整页不一致很少时仍可能只差几个字（日期、金额、编号），按块检查局部差异
+    QVector<int> blocks(blocksX * blocksY, 0);
+    countMismatch(bestDx, bestDy, maxMismatch, &blocks);
+    for (int count : std::as_const(blocks)) {
+        if (count > MAX_BLOCK_MISMATCH) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 设置最低相似度
+ * @param minSimilarity 最低相似度
+ */
+void PageHashIndex::setMinSimilarity(double minSimilarity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_minSimilarity = qBound(0.0, minSimilarity, 1.0);
+}
+
+/**
+ * @brief 获取最低相似度
+ * @return 最低相似度
+ */
+double PageHashIndex::minSimilarity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_minSimilarity;
+}
+
+/**
+ * @brief 加入一个已识别页面
+ * @param key 结果缓存键
+ * @param context 识别上下文
+ * @param signature 页面签名
+ */
+void PageHashIndex::insert(const QByteArray &key, const QString &context, const Signature &signature)
+{
+    if (key.isEmpty() || !signature.isValid()) {
+        return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.contextHash = contextHash(context);
+    entry.signature = signature;
+
+    QMutexLocker locker(&m_mutex);
+    for (const Entry &existing : std::as_const(m_entries)) {
+        if (existing.key == key) {
+            return;
+        }
+    }
+    m_entries.append(entry);
+    while (m_entries.size() > m_maxEntries) {
+        m_entries.removeFirst();
+    }
+}
+
+/**
+ * @brief 查找最相似的页面
+ * @param context 识别上下文
+ * @param signature 页面签名
+ * @param match 匹配结果
+ * @return 是否找到
+ */
+bool PageHashIndex::findSimilar(const QString &context, const Signature &signature, Match *match) const
+{
+    if (!signature.isValid()) {
+        return false;
+    }
+
+    const quint64 hash = contextHash(context);
+    QMutexLocker locker(&m_mutex);
+
+    // 从最新的条目开始，相似度相同时优先较新的结果
+    int bestIndex = -1;
+    double bestSimilarity = m_minSimilarity;
+    for (int i = int(m_entries.size()) - 1; i >= 0; --i) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.contextHash != hash
+            || qPopulationCount(entry.signature.hash ^ signature.hash) > MAX_HASH_DISTANCE) {
+            continue;
+        }
+        const double value = similarity(entry.signature, signature);
+        if (value > bestSimilarity || (bestIndex < 0 && value >= bestSimilarity)) {
+            bestIndex = i;
+            bestSimilarity = value;
+        }
+    }
+
+    if (bestIndex < 0) {
+        return false;
+    }
+    match->key = m_entries.at(bestIndex).key;
+    match->content = m_entries.at(bestIndex).signature.content;
+    match->similarity = bestSimilarity;
+    return true;
+}
+
+/**
+ * @brief 清空索引
+ */
+void PageHashIndex::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+/**
+ * @brief 获取条目数
+ * @return 条目数
+ */
+int PageHashIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_entries.size());
+}
+
+/**
+ * @brief 保存索引到文件
+ * @param filePath 文件路径
+ * @return 是否保存成功
+ */
+bool PageHashIndex::save(const QString &filePath) const
+{
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << s_fileMagic << s_fileVersion << qint32(m_entries.size());
+        for (const Entry &entry : m_entries) {
+            stream << entry.key << entry.contextHash << entry.signature.hash
+                   << entry.signature.thumbnail << entry.signature.content;
+        }
+    }
+
+    QSaveFile file(filePath);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit();
+}
+
+/**
+ * @brief 从文件加载索引
+ * @param filePath 文件路径
+ * @return 是否加载成功
+ */
+bool PageHashIndex::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        clear();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != s_fileMagic || version != s_fileVersion || count < 0) {
+        clear();
+        return false;
+    }
+
+    QList<Entry> entries;
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        stream >> entry.key >> entry.contextHash >> entry.signature.hash
+               >> entry.signature.thumbnail >> entry.signature.content;
+        if (entry.signature.thumbnail.size() == THUMBNAIL_SIZE * THUMBNAIL_SIZE) {
+            entries.append(entry);
+        }
+    }
+    if (stream.status() != QDataStream::Ok) {
+        clear();
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_entries = entries;
+    while (m_entries.size() > m_maxEntries) {
+        m_entries.removeFirst();
+    }
+    return true;
+}
+
+/**
+ * @brief 计算识别上下文的哈希
+ * @param context 识别上下文
+ * @return 哈希值
+ */
+quint64 PageHashIndex::contextHash(const QString &context)
+{
+    const QByteArray digest = QCryptographicHash::hash(context.toUtf8(), QCryptographicHash::Sha1);
+    quint64 hash = 0;
+    for (int i = 0; i < 8; ++i) {
+        hash = (hash << 8) | quint8(digest.at(i));
+    }
+    return hash;
+}
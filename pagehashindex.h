@@ -0,0 +1,186 @@
+#ifndef PAGEHASHINDEX_H
+#define PAGEHASHINDEX_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QRect>
+#include <QString>
+
+/**
+ * @brief 页面感知哈希索引（近似重复页面检测）
+ *
+ * 传真、重复的封面以及重新扫描的文档内容相同，但像素从不逐字节相同，按像素哈希的结果缓存无法命中。
+ * 该索引为每个已识别的页面保存一个签名：先定位页面的内容区域（去掉空白页边），
+ * 把内容区域缩小为32x32的灰度缩略图，并由缩略图计算64位dHash。
+ * 查找时先用dHash的汉明距离快速筛选候选页面，再以缩略图的相关系数作为相似度确认。
+ * 内容区域的定位使签名不受平移和页边裁切的影响，缩放到固定尺寸使其不受分辨率影响，
+ * 区域平均则滤掉了扫描噪点。
+ *
+ * 签名只能说明两页版面相似，套用同一模板的不同单据签名同样接近。复用结果前必须再用
+ * referenceMask()/confirmMatch()在接近原分辨率下逐像素确认内容一致。
+ *
+ * 条目只在相同识别上下文（语言、引擎参数等）之间匹配，超过容量时淘汰最早的条目。
+ * 所有接口都是线程安全的。
+ */
+class PageHashIndex
+{
+public:
+    /**
+     * @brief 页面签名
+     */
+    struct Signature {
+        quint64 hash;           // 缩略图的64位dHash（用于快速筛选）
+        QByteArray thumbnail;   // 内容区域的灰度缩略图（THUMBNAIL_SIZE x THUMBNAIL_SIZE）
+        QRect content;          // 内容区域在页面图像中的位置
+
+        Signature() : hash(0) {}
+
+        /**
+         * @brief 签名是否有效（内容太少的页面没有签名，不参与匹配）
+         * @return 是否有效
+         */
+        bool isValid() const { return !thumbnail.isEmpty(); }
+    };
+
+    /**
+     * @brief 匹配结果
+     */
+    struct Match {
+        QByteArray key;         // 匹配页面的结果缓存键
+        QRect content;          // 匹配页面的内容区域（用于换算版面坐标）
+        double similarity;      // 相似度（-1.0至1.0）
+
+        Match() : similarity(0.0) {}
+    };
+
+    // 缩略图边长
+    static const int THUMBNAIL_SIZE = 32;
+
+    /**
+     * @brief 构造函数
+     * @param maxEntries 条目上限
+     */
+    explicit PageHashIndex(int maxEntries = 10000);
+
+    /**
+     * @brief 计算页面签名
+     *
+     * 页面先平滑缩小为宽256像素的灰度预览图，在预览图上按与背景灰度的差异统计行列墨迹，
+     * 两端各去掉0.5%的墨迹后得到内容区域。内容太少或区域太小（如只有一行字）的页面没有签名。
+     * @param image 页面图像
+     * @return 页面签名（内容太少时无效）
+     */
+    static Signature computeSignature(const QImage &image);
+
+    /**
+     * @brief 计算两个签名的相似度
+     *
+     * 内容区域宽高比相差超过10%时视为不相似，否则为两个缩略图灰度的相关系数。
+     * @param a 签名
+     * @param b 签名
+     * @return 相似度（-1.0至1.0，1.0表示完全一致）
+     */
+    static double similarity(const Signature &a, const Signature &b);
+
+    /**
+     * @brief 生成内容区域的参考掩码（用于逐像素确认）
+     *
+     * 内容区域缩放到宽1600像素（接近300 DPI扫描的原分辨率）后按与背景灰度的差异二值化。
+     * @param image 页面图像
+     * @param content 内容区域（通常为签名中的content）
+     * @return 单色掩码（墨迹为1），区域为空时为空图像
+     */
+    static QImage referenceMask(const QImage &image, const QRect &content);
+
+    /**
+     * @brief 逐像素确认两个参考掩码的内容一致
+     *
+     * 在±2像素内寻找最佳平移，并容许1像素的笔画差异。不一致的墨迹像素超过总墨迹的1%，
+     * 或任何一个32x32的块中超过16个（只差一个日期或金额的两张单据）时判定为不同页面。
+     * @param a 参考掩码
+     * @param b 参考掩码
+     * @return 是否为同一内容
+     */
+    static bool confirmMatch(const QImage &a, const QImage &b);
+
+    /**
+     * @brief 设置判定为近似重复页面的最低相似度
+     * @param minSimilarity 最低相似度（0.0-1.0）
+     */
+    void setMinSimilarity(double minSimilarity);
+
+    /**
+     * @brief 获取判定为近似重复页面的最低相似度
+     * @return 最低相似度
+     */
+    double minSimilarity() const;
+
+    /**
+     * @brief 加入一个已识别页面
+     * @param key 该页面的结果缓存键
+     * @param context 识别上下文
+     * @param signature 页面签名（无效时忽略）
+     */
+    void insert(const QByteArray &key, const QString &context, const Signature &signature);
+
+    /**
+     * @brief 查找相同识别上下文中最相似的页面
+     * @param context 识别上下文
+     * @param signature 页面签名
+     * @param match 找到时写入匹配结果
+     * @return 是否找到相似度不低于下限的页面
+     */
+    bool findSimilar(const QString &context, const Signature &signature, Match *match) const;
+
+    /**
+     * @brief 清空索引
+     */
+    void clear();
+
+    /**
+     * @brief 获取条目数
+     * @return 条目数
+     */
+    int size() const;
+
+    /**
+     * @brief 保存索引到文件
+     * @param filePath 文件路径
+     * @return 是否保存成功
+     */
+    bool save(const QString &filePath) const;
+
+    /**
+     * @brief 从文件加载索引（替换现有条目）
+     * @param filePath 文件路径
+     * @return 是否加载成功（文件不存在或格式不符时返回false，索引保持为空）
+     */
+    bool load(const QString &filePath);
+
+private:
+    /**
+     * @brief 索引条目
+     */
+    struct Entry {
+        QByteArray key;         // 结果缓存键
+        quint64 contextHash;    // 识别上下文的哈希
+        Signature signature;    // 页面签名
+    };
+
+    /**
+     * @brief 计算识别上下文的哈希（跨进程稳定，可保存到磁盘）
+     * @param context 识别上下文
+     * @return 哈希值
+     */
+    static quint64 contextHash(const QString &context);
+
+private:
+    mutable QMutex m_mutex;     // 保护以下所有成员
+    QList<Entry> m_entries;     // 条目（按加入顺序）
+    int m_maxEntries;           // 条目上限
+    double m_minSimilarity;     // 最低相似度
+};
+
+#endif // PAGEHASHINDEX_H
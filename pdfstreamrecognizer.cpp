@@ -0,0 +1,323 @@
+#include "pdfstreamrecognizer.h"
+#include "fileprocessor.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtConcurrent>
+#include <memory>
+
+namespace {
+
+/**
+ * @brief 已渲染的页面
+ */
+struct RenderedPage {
+    int pageIndex;          // 页面索引（从0开始）
+    QImage image;           // 页面图像（渲染失败时为空）
+    QString errorMessage;   // 渲染失败的原因
+};
+
+/**
+ * @brief 渲染线程与识别端之间的有界页面队列
+ */
+class PageQueue
+{
+public:
+    explicit PageQueue(int capacity)
+        : m_capacity(qMax(1, capacity))
+        , m_finished(false)
+        , m_stopped(false)
+        , m_totalPages(0)
+    {
+    }
+
+    /**
+     * @brief 放入一页，队列满时等待
+     * @param page 页面
+     * @return 识别端已停止时返回false
+     */
+    bool push(const RenderedPage &page)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_stopped && m_pages.size() >= m_capacity) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_stopped) {
+            return false;
+        }
+        m_pages.enqueue(page);
+        m_notEmpty.wakeAll();
+        return true;
+    }
+
+    /**
+     * @brief 渲染结束
+     * @param totalPages 实际页数
+     */
+    void finish(int totalPages)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finished = true;
+        m_totalPages = totalPages;
+        m_notEmpty.wakeAll();
+    }
+
+    /**
+     * @brief 识别端停止（取消），唤醒等待中的渲染线程
+     */
+    void stop()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopped = true;
+        m_notFull.wakeAll();
+    }
+
+    /**
+     * @brief 识别端是否已停止
+     * @return 是否停止
+     */
+    bool isStopped() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_stopped;
+    }
+
+    /**
+     * @brief 取出队列中的全部页面，队列为空时最多等待timeoutMs毫秒
+     * @param timeoutMs 等待时间
+     * @param finished 返回是否已取完全部页面
+     * @param totalPages 返回实际页数（渲染结束后有效）
+     * @return 页面列表
+     */
+    QList<RenderedPage> takeAll(int timeoutMs, bool *finished, int *totalPages)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pages.isEmpty() && !m_finished) {
+            m_notEmpty.wait(&m_mutex, timeoutMs);
+        }
+
+        QList<RenderedPage> pages;
+        while (!m_pages.isEmpty()) {
+            pages.append(m_pages.dequeue());
+        }
+        m_notFull.wakeAll();
+
+        *finished = m_finished;
+        *totalPages = m_totalPages;
+        return pages;
+    }
+
+private:
+    mutable QMutex m_mutex;         // 保护以下所有成员
+    QWaitCondition m_notEmpty;      // 有新页面或渲染结束
+    QWaitCondition m_notFull;       // 队列有空位或识别端停止
+    QQueue<RenderedPage> m_pages;   // 等待识别的页面
+    int m_capacity;                 // 队列容量
+    bool m_finished;                // 渲染是否结束
+    bool m_stopped;                 // 识别端是否停止
+    int m_totalPages;               // 实际页数
+};
+
+/**
+ * @brief 渲染线程：逐段渲染页面并放入队列
+ * @param filePath PDF文件路径
+ * @param info 文档信息（页数为-1表示未知）
+ * @param extractedTexts 各页从文本层提取的文本（这些页面不渲染）
+ * @param options 流式识别选项
+ * @param chunkPages 每段页数
+ * @param queue 页面队列
+ */
+void renderPages(const QString &filePath, const FileProcessor::PdfInfo &info, const QStringList &extractedTexts,
+                 const PdfStreamRecognizer::Options &options, int chunkPages, PageQueue *queue)
+{
+    FileProcessor processor;
+    const int pageCount = info.pageCount;
+    int renderedPages = 0;
+    int firstPage = 1;
+    int chunk = 1;      // 第一段只渲染一页，尽快开始识别
+
+    auto pushFailed = [&](int fromPage, int toPage, const QString &errorMessage) {
+        for (int page = fromPage; page <= toPage; ++page) {
+            if (!queue->push({page - 1, QImage(), errorMessage})) {
+                return false;
+            }
+        }
+        renderedPages = toPage;
+        return true;
+    };
+
+    auto hasTextLayer = [&](int page) { return !extractedTexts.value(page - 1).isEmpty(); };
+
+    while (!queue->isStopped() && (pageCount < 0 || firstPage <= pageCount)) {
+        // 跳过已有文本层的页面，每段在下一个有文本层的页面之前结束
+        while (hasTextLayer(firstPage)) {
+            firstPage++;
+        }
+        if (pageCount > 0 && firstPage > pageCount) {
+            break;
+        }
+        int lastPage = pageCount > 0 ? qMin(firstPage + chunk - 1, pageCount) : firstPage + chunk - 1;
+        for (int page = firstPage + 1; page <= lastPage; ++page) {
+            if (hasTextLayer(page)) {
+                lastPage = page - 1;
+                break;
+            }
+        }
+        FileProcessor::ProcessResult rendered =
+            processor.processPDFPages(filePath, firstPage, lastPage, options.maxWidth, options.maxHeight, info);
+
+        if (!rendered.success) {
+            // 不知道页数时，起始页码超出文档同样会失败，视为到达末尾
+            if (pageCount < 0 && firstPage > 1) {
+                break;
+            }
+            if (!pushFailed(firstPage, lastPage, rendered.errorMessage) || pageCount < 0) {
+                break;
+            }
+        } else {
+            ImagePreprocessor::processAll(rendered.images, options.preprocess);
+            bool stopped = false;
+            for (int i = 0; i < rendered.images.size() && !stopped; ++i) {
+                stopped = !queue->push({firstPage - 1 + i, rendered.images.at(i), QString()});
+            }
+            if (stopped) {
+                return;
+            }
+            renderedPages = firstPage - 1 + int(rendered.images.size());
+
+            // 少于请求的页数：不知道页数时说明到达末尾，否则其余页面按失败处理
+            if (renderedPages < lastPage) {
+                if (pageCount < 0) {
+                    break;
+                }
+                if (!pushFailed(renderedPages + 1, lastPage, QString("无法加载PDF文件的第%1页").arg(renderedPages + 1))) {
+                    return;
+                }
+            }
+        }
+
+        firstPage = lastPage + 1;
+        chunk = chunkPages;
+    }
+
+    // 页数已知时末尾可能是只有文本层、未经渲染的页面
+    queue->finish(pageCount > 0 ? pageCount : renderedPages);
+}
+
+} // namespace
+
+/**
+ * @brief 异步流式识别PDF文件
+ * @param engine OCR引擎
+ * @param filePath PDF文件路径
+ * @param language 识别语言代码
+ * @param options 流式识别选项
+ * @return 按页面索引存放识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> PdfStreamRecognizer::submitFile(OCREngine *engine, const QString &filePath,
+                                                              const QString &language, const Options &options)
+{
+    return QtConcurrent::run([engine, filePath, language, options](QPromise<OCREngine::OCRResult> &promise) {
+        OCREngine::OCRResult failedResult;
+
+        FileProcessor processor;
+        FileProcessor::PdfInfo info = processor.readPdfInfo(filePath);
+        const QStringList extractedTexts = processor.extractTextLayer(filePath);
+        if (info.pageCount < 0 && !extractedTexts.isEmpty()) {
+            info.pageCount = extractedTexts.size();     // pdfinfo不可用时以文本层的页数为准
+        }
+        // 文本层页数与文档不符时不使用，全部页面渲染识别
+        const QStringList usableTexts = extractedTexts.size() == info.pageCount ? extractedTexts : QStringList();
+        const int pageCount = info.pageCount;
+        if (pageCount == 0) {
+            failedResult.errorMessage = "PDF文件中没有页面";
+            promise.setProgressRange(0, 1);
+            promise.addResult(failedResult, 0);
+            return;
+        }
+        if (pageCount > 0) {
+            promise.setProgressRange(0, pageCount);
+        }
+
+        // 渲染线程不占用全局线程池，避免与加载和识别任务互相等待
+        const int chunkPages = options.chunkPages > 0 ? options.chunkPages : qMax(1, QThread::idealThreadCount());
+        PageQueue queue(options.maxQueuedPages > 0 ? options.maxQueuedPages : chunkPages * 2);
+        std::unique_ptr<QThread> renderer(QThread::create(renderPages, filePath, info, usableTexts, options, chunkPages, &queue));
+        renderer->start();
+
+        auto stopRenderer = [&]() {
+            queue.stop();
+            renderer->wait();
+        };
+
+        // 有文本层的页面不经渲染和识别，直接给出结果
+        int finishedPages = 0;
+        for (int i = 0; i < usableTexts.size(); ++i) {
+            if (!usableTexts.at(i).isEmpty()) {
+                promise.addResult(OCREngine::extractedResult(usableTexts.at(i)), i);
+                finishedPages++;
+            }
+        }
+        promise.setProgressValue(finishedPages);
+
+        int totalPages = 0;
+        bool finished = false;
+        while (!finished) {
+            if (promise.isCanceled()) {
+                stopRenderer();
+                return;
+            }
+
+            // 渲染失败的页面直接记为失败，其余已渲染的页面作为一批交给引擎
+            const QList<RenderedPage> pages = queue.takeAll(100, &finished, &totalPages);
+            QList<QImage> images;
+            QList<int> pageIndexes;
+            for (const RenderedPage &page : pages) {
+                if (page.image.isNull()) {
+                    failedResult.errorMessage = page.errorMessage;
+                    promise.addResult(failedResult, page.pageIndex);
+                    finishedPages++;
+                } else {
+                    images.append(page.image);
+                    pageIndexes.append(page.pageIndex);
+                }
+            }
+
+            if (!images.isEmpty()) {
+                QFuture<OCREngine::OCRResult> future = engine->submitBatch(images, language);
+                if (!OCREngine::waitForBatch(future, promise)) {
+                    stopRenderer();
+                    return;
+                }
+
+                for (int i = 0; i < images.size(); ++i) {
+                    OCREngine::OCRResult pageResult;
+                    if (future.isResultReadyAt(i)) {
+                        pageResult = future.resultAt(i);
+                    } else {
+                        pageResult.errorMessage = "识别未完成";
+                    }
+                    promise.addResult(pageResult, pageIndexes.at(i));
+                }
+                finishedPages += images.size();
+            }
+
+            if (pageCount < 0) {
+                promise.setProgressRange(0, finishedPages);
+            }
+            promise.setProgressValue(finishedPages);
+        }
+        renderer->wait();
+
+        if (totalPages <= 0) {
+            failedResult.errorMessage = "无法转换PDF文件";
+            promise.setProgressRange(0, 1);
+            promise.addResult(failedResult, 0);
+            return;
+        }
+        promise.setProgressRange(0, totalPages);
+        promise.setProgressValue(finishedPages);
+    });
+}
@@ -0,0 +1,55 @@
+#ifndef PDFSTREAMRECOGNIZER_H
+#define PDFSTREAMRECOGNIZER_H
+
+#include <QString>
+#include <QFuture>
+#include "ocrengine.h"
+#include "imagepreprocessor.h"
+
+/**
+ * @brief PDF文件的流式识别：边渲染边识别
+ *
+ * 整体处理PDF时需要等pdftoppm渲染完所有页面、再解码全部PNG之后才能开始识别，
+ * 几百页的合同要等很久才能看到第一页文字，渲染期间识别进程也一直空闲。
+ * 流式识别先用pdfinfo读取页数，由单独的渲染线程用pdftoppm的-f/-l参数逐段渲染页面，
+ * 解码和预处理后放入有界队列；识别端每当引擎空闲就把队列中已有的页面作为一批提交，
+ * 渲染和识别因此重叠进行。第一段只渲染一页，使第一页尽快开始识别。
+ * 队列满时渲染线程暂停，内存中驻留的页面数有上限。
+ *
+ * 文本层可以直接使用的页面（见FileProcessor::extractTextLayer）在开始时就给出结果，不渲染也不识别。
+ *
+ * pdfinfo不可用时不预先知道页数，逐段渲染直到页码超出文档为止。
+ */
+class PdfStreamRecognizer
+{
+public:
+    /**
+     * @brief 流式识别选项
+     */
+    struct Options {
+        bool enabled;           // 是否对PDF文件流式识别
+        int chunkPages;         // 每次调用pdftoppm渲染的页数（0表示按CPU核数）
+        int maxQueuedPages;     // 已渲染、等待识别的页面上限（0表示每段页数的两倍）
+        int maxWidth;           // 页面图像最大宽度（0表示不限制）
+        int maxHeight;          // 页面图像最大高度（0表示不限制）
+        ImagePreprocessor::Options preprocess;  // 识别前的图像预处理
+
+        Options() : enabled(true), chunkPages(0), maxQueuedPages(0), maxWidth(0), maxHeight(0) {}
+    };
+
+    /**
+     * @brief 异步流式识别PDF文件
+     *
+     * 结果按页面索引存放（与submitBatch相同），进度最大值在得知页数后设置为总页数，
+     * 识别结束时等于实际页数。对返回的QFuture调用cancel()会停止渲染和识别。
+     * @param engine 已初始化的OCR引擎（识别期间不可释放）
+     * @param filePath PDF文件路径
+     * @param language 识别语言代码
+     * @param options 流式识别选项
+     * @return 按页面索引存放识别结果的QFuture
+     */
+    static QFuture<OCREngine::OCRResult> submitFile(OCREngine *engine, const QString &filePath,
+                                                    const QString &language, const Options &options);
+};
+
+#endif // PDFSTREAMRECOGNIZER_H
@@ -0,0 +1,327 @@
+#include "persistentjobqueue.h"
+#include "ocrservice.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QJsonDocument>
+
+/**
+ * @brief 生成任务的"add"记录
+ */
+static QJsonObject addRecord(const PersistentJobQueue::Job &job)
+{
+    QJsonObject record;
+    record.insert("op", "add");
+    record.insert("id", QString::number(job.id));
+    record.insert("path", job.filePath);
+    record.insert("relativePath", job.relativePath);
+    record.insert("size", job.size);
+    record.insert("mtime", job.modifiedMs);
+    record.insert("attempts", job.attempts);
+    return record;
+}
+
+/**
+ * @brief 生成某页的"page"记录（版面结构以二进制形式保存，可完整还原）
+ */
+static QJsonObject pageRecord(quint64 id, int pageIndex, const OCREngine::OCRResult &result)
+{
+    QJsonObject record;
+    record.insert("op", "page");
+    record.insert("id", QString::number(id));
+    record.insert("page", pageIndex);
+    record.insert("result", OCRService::resultToJson(result, "binary"));
+    return record;
+}
+
+/**
+ * @brief PersistentJobQueue构造函数
+ */
+PersistentJobQueue::PersistentJobQueue()
+    : m_nextId(1)
+{
+}
+
+PersistentJobQueue::~PersistentJobQueue()
+{
+    m_journal.close();
+}
+
+/**
+ * @brief 打开队列目录并恢复未完成的任务
+ * @param directory 队列目录
+ * @param errorMessage 失败时返回错误信息
+ * @return 是否成功
+ */
+bool PersistentJobQueue::open(const QString &directory, QString *errorMessage)
+{
+    if (!QDir().mkpath(directory)) {
+        *errorMessage = QString("无法创建队列目录: %1").arg(directory);
+        return false;
+    }
+
+    m_journalPath = QDir(directory).absoluteFilePath("journal.ndjson");
+    m_journal.close();
+    m_jobs.clear();
+    m_pathIndex.clear();
+    m_nextId = 1;
+
+    replay(m_journalPath);
+
+    // 输入文件在程序停止期间被删除或修改的任务不再有效（已识别的页面也不再对应）
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        QFileInfo info(it->filePath);
+        if (!info.exists() || info.size() != it->size
+            || info.lastModified().toMSecsSinceEpoch() != it->modifiedMs) {
+            m_pathIndex.remove(it->filePath);
+            it = m_jobs.erase(it);
+        } else {
+            it->running = false;
+            ++it;
+        }
+    }
+
+    return compact(errorMessage);
+}
+
+/**
+ * @brief 重放日志文件
+ * @param journalPath 日志文件路径
+ */
+void PersistentJobQueue::replay(const QString &journalPath)
+{
+    QFile file(journalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    // 最后一行可能因程序中断而不完整，无法解析的行直接跳过
+    while (!file.atEnd()) {
+        const QJsonObject record = QJsonDocument::fromJson(file.readLine()).object();
+        const QString op = record.value("op").toString();
+        const quint64 id = record.value("id").toString().toULongLong();
+        if (id == 0) {
+            continue;
+        }
+
+        if (op == "add") {
+            Job job;
+            job.id = id;
+            job.filePath = record.value("path").toString();
+            job.relativePath = record.value("relativePath").toString();
+            job.size = record.value("size").toInteger();
+            job.modifiedMs = record.value("mtime").toInteger();
+            job.attempts = record.value("attempts").toInt();
+            m_jobs.insert(id, job);
+            m_pathIndex.insert(job.filePath, id);
+            m_nextId = qMax(m_nextId, id + 1);
+        } else if (op == "start") {
+            auto it = m_jobs.find(id);
+            if (it != m_jobs.end()) {
+                it->attempts++;
+            }
+        } else if (op == "page") {
+            auto it = m_jobs.find(id);
+            if (it != m_jobs.end()) {
+                it->finishedPages.insert(record.value("page").toInt(),
+                                         OCRService::resultFromJson(record.value("result").toObject()));
+            }
+        } else if (op == "done") {
+            auto it = m_jobs.find(id);
+            if (it != m_jobs.end()) {
+                m_pathIndex.remove(it->filePath);
+                m_jobs.erase(it);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 重写日志，只保留未完成的任务
+ * @param errorMessage 失败时返回错误信息
+ * @return 是否成功
+ */
+bool PersistentJobQueue::compact(QString *errorMessage)
+{
+    m_journal.close();
+
+    QSaveFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *errorMessage = QString("无法写入队列日志: %1").arg(file.errorString());
+        return false;
+    }
+    for (const Job &job : std::as_const(m_jobs)) {
+        file.write(QJsonDocument(addRecord(job)).toJson(QJsonDocument::Compact));
+        file.write("\n");
+        for (auto page = job.finishedPages.cbegin(); page != job.finishedPages.cend(); ++page) {
+            file.write(QJsonDocument(pageRecord(job.id, page.key(), page.value())).toJson(QJsonDocument::Compact));
+            file.write("\n");
+        }
+    }
+    if (!file.commit()) {
+        *errorMessage = QString("无法写入队列日志: %1").arg(file.errorString());
+        return false;
+    }
+
+    m_journal.setFileName(m_journalPath);
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        *errorMessage = QString("无法打开队列日志: %1").arg(m_journal.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 追加一条日志记录并刷新到磁盘
+ * @param record 记录
+ */
+void PersistentJobQueue::appendRecord(const QJsonObject &record)
+{
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    m_journal.write(line);
+    m_journal.flush();
+}
+
+/**
+ * @brief 文件是否已在队列中
+ * @param filePath 文件绝对路径
+ * @return 是否在队列中
+ */
+bool PersistentJobQueue::contains(const QString &filePath) const
+{
+    return m_pathIndex.contains(filePath);
+}
+
+/**
+ * @brief 加入任务
+ * @param filePath 文件绝对路径
+ * @param relativePath 输出目录中使用的相对路径
+ * @param size 文件大小
+ * @param modifiedMs 修改时间
+ * @return 任务编号
+ */
+quint64 PersistentJobQueue::enqueue(const QString &filePath, const QString &relativePath,
+                                    qint64 size, qint64 modifiedMs)
+{
+    Job job;
+    job.id = m_nextId++;
+    job.filePath = filePath;
+    job.relativePath = relativePath;
+    job.size = size;
+    job.modifiedMs = modifiedMs;
+
+    m_jobs.insert(job.id, job);
+    m_pathIndex.insert(filePath, job.id);
+    appendRecord(addRecord(job));
+    return job.id;
+}
+
+/**
+ * @brief 取出下一个等待处理的任务并标记为处理中
+ * @param job 返回任务
+ * @return 是否有等待处理的任务
+ */
+bool PersistentJobQueue::takeNext(Job *job)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+        if (it->running || it->retryAfterMs > now) {
+            continue;
+        }
+
+        it->running = true;
+        it->attempts++;
+
+        QJsonObject record;
+        record.insert("op", "start");
+        record.insert("id", QString::number(it->id));
+        appendRecord(record);
+
+        *job = *it;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 记录某页识别成功
+ * @param id 任务编号
+ * @param pageIndex 页面索引
+ * @param result 识别结果
+ */
+void PersistentJobQueue::recordPage(quint64 id, int pageIndex, const OCREngine::OCRResult &result)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || !result.success) {
+        return;
+    }
+
+    it->finishedPages.insert(pageIndex, result);
+    appendRecord(pageRecord(id, pageIndex, result));
+}
+
+/**
+ * @brief 放回处理中的任务
+ * @param id 任务编号
+ * @param delayMs 重新处理前等待的时间（毫秒）
+ */
+void PersistentJobQueue::release(quint64 id, int delayMs)
+{
+    auto it = m_jobs.find(id);
+    if (it != m_jobs.end()) {
+        it->running = false;
+        it->retryAfterMs = delayMs > 0 ? QDateTime::currentMSecsSinceEpoch() + delayMs : 0;
+    }
+}
+
+/**
+ * @brief 结束任务
+ * @param id 任务编号
+ */
+void PersistentJobQueue::complete(quint64 id)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end()) {
+        return;
+    }
+
+    m_pathIndex.remove(it->filePath);
+    m_jobs.erase(it);
+
+    QJsonObject record;
+    record.insert("op", "done");
+    record.insert("id", QString::number(id));
+    appendRecord(record);
+
+    // 队列清空时截断日志，避免长时间运行后日志无限增长
+    if (m_jobs.isEmpty()) {
+        QString errorMessage;
+        compact(&errorMessage);
+    }
+}
+
+/**
+ * @brief 获取等待处理的任务数
+ * @return 任务数
+ */
+int PersistentJobQueue::pendingCount() const
+{
+    int count = 0;
+    for (const Job &job : m_jobs) {
+        if (!job.running) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 获取队列中的任务总数
+ * @return 任务数
+ */
+int PersistentJobQueue::size() const
+{
+    return m_jobs.size();
+}
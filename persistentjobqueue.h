@@ -0,0 +1,142 @@
+#ifndef PERSISTENTJOBQUEUE_H
+#define PERSISTENTJOBQUEUE_H
+
+#include <QString>
+#include <QMap>
+#include <QHash>
+#include <QFile>
+#include <QJsonObject>
+#include "ocrengine.h"
+
+/**
+ * @brief 持久化的文件识别任务队列
+ *
+ * 队列状态以追加写入的日志文件（每行一个JSON记录）保存在磁盘上：
+ * - {"op":"add","id":…,"path":…,"relativePath":…,"size":…,"mtime":…,"attempts":…} 加入任务
+ * - {"op":"start","id":…} 开始处理（用于统计尝试次数）
+ * - {"op":"page","id":…,"page":…,"result":{…}} 某页识别成功
+ * - {"op":"done","id":…} 任务结束
+ *
+ * 每条记录写入后立即刷新，程序重启后重放日志即可恢复未完成的任务及其已识别的页面，
+ * 不会重复识别已完成的页面。打开时以及队列清空时会重写日志，只保留未完成的任务。
+ * 该类不是线程安全的。
+ */
+class PersistentJobQueue
+{
+public:
+    /**
+     * @brief 队列中的任务
+     */
+    struct Job {
+        quint64 id;                                     // 任务编号（按加入顺序递增）
+        QString filePath;                               // 输入文件绝对路径
+        QString relativePath;                           // 输出目录中使用的相对路径
+        qint64 size;                                    // 加入时的文件大小
+        qint64 modifiedMs;                              // 加入时的修改时间（毫秒）
+        int attempts;                                   // 已开始处理的次数
+        bool running;                                   // 是否正在处理
+        qint64 retryAfterMs;                            // 放回后在此时刻（毫秒）之前不再取出（不持久化）
+        QMap<int, OCREngine::OCRResult> finishedPages;  // 已识别成功的页面
+
+        Job() : id(0), size(0), modifiedMs(0), attempts(0), running(false), retryAfterMs(0) {}
+    };
+
+    PersistentJobQueue();
+    ~PersistentJobQueue();
+
+    /**
+     * @brief 打开（或创建）队列目录并恢复未完成的任务
+     *
+     * 恢复时丢弃输入文件已被删除或修改过的任务，上次处理到一半的任务重新排队。
+     * @param directory 队列目录
+     * @param errorMessage 失败时返回错误信息
+     * @return 是否成功
+     */
+    bool open(const QString &directory, QString *errorMessage);
+
+    /**
+     * @brief 文件是否已在队列中
+     * @param filePath 文件绝对路径
+     * @return 是否在队列中
+     */
+    bool contains(const QString &filePath) const;
+
+    /**
+     * @brief 加入任务
+     * @param filePath 文件绝对路径
+     * @param relativePath 输出目录中使用的相对路径
+     * @param size 文件大小
+     * @param modifiedMs 修改时间（毫秒）
+     * @return 任务编号
+     */
+    quint64 enqueue(const QString &filePath, const QString &relativePath, qint64 size, qint64 modifiedMs);
+
+    /**
+     * @brief 取出下一个等待处理的任务并标记为处理中（跳过仍在重试等待期内的任务）
+     * @param job 返回任务
+     * @return 是否有可以处理的任务
+     */
+    bool takeNext(Job *job);
+
+    /**
+     * @brief 记录某页识别成功
+     * @param id 任务编号
+     * @param pageIndex 页面索引
+     * @param result 识别结果
+     */
+    void recordPage(quint64 id, int pageIndex, const OCREngine::OCRResult &result);
+
+    /**
+     * @brief 放回处理中的任务，稍后重新处理（已识别的页面保留）
+     * @param id 任务编号
+     * @param delayMs 重新处理前等待的时间（毫秒），期间先处理其他任务
+     */
+    void release(quint64 id, int delayMs = 0);
+
+    /**
+     * @brief 结束任务（无论成功与否都从队列中移除）
+     * @param id 任务编号
+     */
+    void complete(quint64 id);
+
+    /**
+     * @brief 获取等待处理的任务数
+     * @return 任务数
+     */
+    int pendingCount() const;
+
+    /**
+     * @brief 获取队列中的任务总数（包括处理中的任务）
+     * @return 任务数
+     */
+    int size() const;
+
+private:
+    /**
+     * @brief 追加一条日志记录并刷新到磁盘
+     * @param record 记录
+     */
+    void appendRecord(const QJsonObject &record);
+
+    /**
+     * @brief 重放日志文件
+     * @param journalPath 日志文件路径
+     */
+    void replay(const QString &journalPath);
+
+    /**
+     * @brief 重写日志，只保留未完成的任务
+     * @param errorMessage 失败时返回错误信息
+     * @return 是否成功
+     */
+    bool compact(QString *errorMessage);
+
+private:
+    QString m_journalPath;                  // 日志文件路径
+    QFile m_journal;                        // 以追加方式打开的日志文件
+    QMap<quint64, Job> m_jobs;              // 任务编号 -> 任务（按加入顺序排列）
+    QHash<QString, quint64> m_pathIndex;    // 文件路径 -> 任务编号
+    quint64 m_nextId;                       // 下一个任务编号
+};
+
+#endif // PERSISTENTJOBQUEUE_H
@@ -0,0 +1,125 @@
+#include "popplerrenderer.h"
+#include <poppler-qt6.h>
+#include <QDebug>
+
+/**
+ * @brief 打开PDF文件
+ * @param filePath PDF文件路径
+ */
+PopplerRenderer::PopplerRenderer(const QString &filePath)
+    : m_document(Poppler::Document::load(filePath))
+{
+    if (!m_document) {
+        m_errorMessage = "无法打开PDF文件: " + filePath;
+        return;
+    }
+    if (m_document->isLocked()) {
+        m_errorMessage = "PDF文件已加密: " + filePath;
+        m_document.reset();
+        return;
+    }
+
+    // 与pdftoppm的"-aa yes -aaVector yes"一致
+    m_document->setRenderBackend(Poppler::Document::SplashBackend);
+    m_document->setRenderHint(Poppler::Document::Antialiasing, true);
+    m_document->setRenderHint(Poppler::Document::TextAntialiasing, true);
+}
+
+PopplerRenderer::~PopplerRenderer() = default;
+
+/**
+ * @brief 文件是否成功打开
+ * @return 是否可以渲染
+ */
+bool PopplerRenderer::isValid() const
+{
+    return m_document != nullptr;
+}
+
+/**
+ * @brief 获取打开失败的原因
+ * @return 错误信息
+ */
+QString PopplerRenderer::errorMessage() const
+{
+    return m_errorMessage;
+}
+
+/**
+ * @brief 获取页数
+ * @return 页数
+ */
+int PopplerRenderer::pageCount() const
+{
+    return m_document ? m_document->numPages() : 0;
+}
+
+/**
+ * @brief 获取页面尺寸
+ * @param pageIndex 页面索引
+ * @return 页面尺寸（point）
+ */
+QSizeF PopplerRenderer::pageSize(int pageIndex) const
+{
+    if (!m_document || pageIndex < 0 || pageIndex >= m_document->numPages()) {
+        return QSizeF();
+    }
+    std::unique_ptr<Poppler::Page> page = m_document->page(pageIndex);
+    return page ? page->pageSizeF() : QSizeF();
+}
+
+/**
+ * @brief 渲染一页
+ * @param pageIndex 页面索引
+ * @param dpi 渲染分辨率
+ * @param grayscale 是否输出灰度图像
+ * @param maxWidth 最大宽度
+ * @param maxHeight 最大高度
+ * @return 页面图像
+ */
+QImage PopplerRenderer::renderPage(int pageIndex, int dpi, bool grayscale, int maxWidth, int maxHeight) const
+{
+    if (!m_document || pageIndex < 0 || pageIndex >= m_document->numPages()) {
+        return QImage();
+    }
+    std::unique_ptr<Poppler::Page> page = m_document->page(pageIndex);
+    if (!page) {
+        return QImage();
+    }
+
+    // 按页计算分辨率：超出最大尺寸的页面直接以较低分辨率渲染
+    double resolution = dpi;
+    const QSizeF size = page->pageSizeF();
+    if (maxWidth > 0 && size.width() > 0) {
+        resolution = qMin(resolution, maxWidth * 72.0 / size.width());
+    }
+    if (maxHeight > 0 && size.height() > 0) {
+        resolution = qMin(resolution, maxHeight * 72.0 / size.height());
+    }
+
+    QImage image = page->renderToImage(resolution, resolution);
+    if (image.isNull()) {
+        qDebug() << "Poppler渲染第" << pageIndex + 1 << "页失败";
+        return image;
+    }
+
+    // Splash输出32位图像；灰度识别时立即转换，页面驻留内存只占四分之一
+    if (grayscale) {
+        image = image.convertToFormat(QImage::Format_Grayscale8);
+    }
+    return image;
+}
+
+/**
+ * @brief 获取页面文本层中的文本
+ * @param pageIndex 页面索引
+ * @return 页面文本
+ */
+QString PopplerRenderer::pageText(int pageIndex) const
+{
+    if (!m_document || pageIndex < 0 || pageIndex >= m_document->numPages()) {
+        return QString();
+    }
+    std::unique_ptr<Poppler::Page> page = m_document->page(pageIndex);
+    return page ? page->text(QRectF()) : QString();
+}
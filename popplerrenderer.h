@@ -0,0 +1,82 @@
+#ifndef POPPLERRENDERER_H
+#define POPPLERRENDERER_H
+
+#include <QImage>
+#include <QSizeF>
+#include <QString>
+#include <memory>
+
+namespace Poppler {
+class Document;
+}
+
+/**
+ * @brief 基于poppler-qt6的进程内PDF渲染器
+ *
+ * 与调用pdftoppm相比，页面直接渲染到QImage内存中：不需要临时目录，
+ * 省去了每页一次PNG编码和一次PNG解码。分辨率按页计算，限制了最大尺寸时
+ * 直接以恰好放得下的分辨率渲染，不必先按固定DPI渲染再缩小。
+ *
+ * Poppler::Document不能在线程间共享，并行渲染时每个线程各自打开一个渲染器。
+ */
+class PopplerRenderer
+{
+public:
+    /**
+     * @brief 打开PDF文件
+     * @param filePath PDF文件路径
+     */
+    explicit PopplerRenderer(const QString &filePath);
+    ~PopplerRenderer();
+
+    /**
+     * @brief 文件是否成功打开
+     * @return 是否可以渲染
+     */
+    bool isValid() const;
+
+    /**
+     * @brief 获取打开失败的原因
+     * @return 错误信息
+     */
+    QString errorMessage() const;
+
+    /**
+     * @brief 获取页数
+     * @return 页数（打开失败时为0）
+     */
+    int pageCount() const;
+
+    /**
+     * @brief 获取页面尺寸（已考虑页面旋转）
+     * @param pageIndex 页面索引（从0开始）
+     * @return 页面尺寸（单位为point，页面不存在时为空）
+     */
+    QSizeF pageSize(int pageIndex) const;
+
+    /**
+     * @brief 渲染一页
+     * @param pageIndex 页面索引（从0开始）
+     * @param dpi 渲染分辨率
+     * @param grayscale 是否输出8位灰度图像
+     * @param maxWidth 最大宽度（0表示不限制，超出时降低该页的分辨率）
+     * @param maxHeight 最大高度（0表示不限制）
+     * @return 页面图像，失败时为空
+     */
+    QImage renderPage(int pageIndex, int dpi, bool grayscale, int maxWidth = 0, int maxHeight = 0) const;
+
+    /**
+     * @brief 获取页面文本层中的文本
+     * @param pageIndex 页面索引（从0开始）
+     * @return 页面文本（没有文本层时为空）
+     */
+    QString pageText(int pageIndex) const;
+
+private:
+    Q_DISABLE_COPY(PopplerRenderer)
+
+    std::unique_ptr<Poppler::Document> m_document;  // 已打开的文档
+    QString m_errorMessage;                         // 打开失败的原因
+};
+
+#endif // POPPLERRENDERER_H
@@ -0,0 +1,432 @@
+#include "remoteocrengine.h"
+#include "ocrservice.h"
+#include "ocrcostmodel.h"
+#include "ocrmetrics.h"
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QAtomicInteger>
+#include <QtConcurrent>
+
+namespace {
+
+const int CONNECT_TIMEOUT_MS = 3000;    // 连接服务和等待请求被接受的超时时间
+const int POLL_INTERVAL_MS = 100;       // 等待应答时检查取消状态的间隔
+
+QAtomicInteger<quint64> s_nextRequestId(1);
+
+/**
+ * @brief 连接是否仍然有效
+ */
+bool isConnected(QIODevice *socket)
+{
+    if (QLocalSocket *localSocket = qobject_cast<QLocalSocket *>(socket)) {
+        return localSocket->state() == QLocalSocket::ConnectedState;
+    }
+    if (QTcpSocket *tcpSocket = qobject_cast<QTcpSocket *>(socket)) {
+        return tcpSocket->state() == QAbstractSocket::ConnectedState;
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief RemoteOCREngine构造函数
+ * @param serviceAddress 服务地址
+ * @param parent 父对象指针
+ */
+RemoteOCREngine::RemoteOCREngine(const QString &serviceAddress, QObject *parent)
+    : OCREngine(parent)
+    , m_serviceAddress(serviceAddress.isEmpty() ? OCRService::defaultServerName() : serviceAddress)
+{
+}
+
+/**
+ * @brief 获取引擎类型
+ * @return 引擎类型
+ */
+OCREngine::EngineType RemoteOCREngine::getEngineType() const
+{
+    return OCR_SERVICE;
+}
+
+/**
+ * @brief 获取引擎名称
+ * @return 引擎名称
+ */
+QString RemoteOCREngine::getEngineName() const
+{
+    return "OCR服务 (常驻进程)";
+}
+
+/**
+ * @brief 初始化：确认服务正在运行并获取支持的语言
+ * @return 是否成功
+ */
+bool RemoteOCREngine::initialize()
+{
+    QString errorMessage;
+    QJsonObject status = queryStatus(&errorMessage);
+    if (status.isEmpty()) {
+        m_initialized = false;
+        m_lastError = QString("无法连接OCR服务: %1").arg(errorMessage);
+        emit errorOccurred(m_lastError);
+        return false;
+    }
+
+    QStringList languages;
+    for (const QJsonValue &language : status.value("languages").toArray()) {
+        languages.append(language.toString());
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_languages = languages;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+/**
+ * @brief 执行OCR识别
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @return 识别结果
+ */
+OCREngine::OCRResult RemoteOCREngine::performOCR(const QImage &image, const QString &language)
+{
+    OCRResult result;
+    if (image.isNull()) {
+        result.errorMessage = "图像无效";
+        return result;
+    }
+
+    emit progressUpdated(10);
+
+    QString errorMessage;
+    QList<OCRResult> results = requestRecognition(QList<QImage>() << image, language,
+                                                  std::function<bool()>(), &errorMessage);
+    if (results.isEmpty()) {
+        result.errorMessage = errorMessage;
+        emit errorOccurred(errorMessage);
+        return result;
+    }
+
+    result = results.first();
+    emit progressUpdated(100);
+    emit ocrCompleted(result);
+    return result;
+}
+
+/**
+ * @brief 执行批量OCR识别
+ * @param images 待识别的图像列表
+ * @param pageNames 页面名称列表
+ * @param language 识别语言代码
+ * @return 批量识别结果
+ */
+OCREngine::BatchOCRResult RemoteOCREngine::performBatchOCR(const QList<QImage> &images,
+                                                           const QStringList &pageNames,
+                                                           const QString &language)
+{
+    BatchOCRResult batchResult;
+    batchResult.totalPages = images.size();
+
+    QString errorMessage;
+    QList<OCRResult> results = requestRecognition(images, language, std::function<bool()>(), &errorMessage);
+    if (results.isEmpty()) {
+        batchResult.errorMessage = errorMessage;
+        emit errorOccurred(errorMessage);
+        return batchResult;
+    }
+
+    finalizeBatchResult(batchResult, results, pageNames);
+    emit batchProgressUpdated(100, images.size(), images.size(), 100);
+    emit batchOcrCompleted(batchResult);
+    return batchResult;
+}
+
+/**
+ * @brief 检查引擎是否可用
+ * @return 最近一次初始化是否成功
+ */
+bool RemoteOCREngine::isAvailable() const
+{
+    return m_initialized;
+}
+
+/**
+ * @brief 获取支持的语言列表（服务端引擎的语言）
+ * @return 语言代码列表
+ */
+QStringList RemoteOCREngine::getSupportedLanguages() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_languages;
+}
+
+/**
+ * @brief 异步批量识别
+ * @param images 待识别的图像列表
+ * @param language 识别语言代码
+ * @return 按页面索引存放识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> RemoteOCREngine::submitBatch(const QList<QImage> &images, const QString &language)
+{
+    return QtConcurrent::run([this, images, language](QPromise<OCRResult> &promise) {
+        const int totalPages = images.size();
+        promise.setProgressRange(0, totalPages);
+        emit batchProgressUpdated(0, 1, totalPages, 0);
+
+        QString errorMessage;
+        QList<OCRResult> results = requestRecognition(images, language,
+                                                      [&promise]() { return promise.isCanceled(); },
+                                                      &errorMessage);
+        if (promise.isCanceled()) {
+            return;
+        }
+
+        for (int i = 0; i < totalPages; ++i) {
+            OCRResult pageResult = results.value(i);
+            if (results.isEmpty()) {
+                pageResult.errorMessage = errorMessage;
+            }
+            promise.addResult(pageResult, i);
+            promise.setProgressValue(i + 1);
+        }
+        emit batchProgressUpdated(100, totalPages, totalPages, 100);
+    });
+}
+
+/**
+ * @brief 设置服务地址
+ * @param address 服务地址
+ */
+void RemoteOCREngine::setServiceAddress(const QString &address)
+{
+    m_serviceAddress = address.isEmpty() ? OCRService::defaultServerName() : address;
+    m_initialized = false;
+}
+
+/**
+ * @brief 获取服务地址
+ * @return 服务地址
+ */
+QString RemoteOCREngine::serviceAddress() const
+{
+    return m_serviceAddress;
+}
+
+/**
+ * @brief 查询服务状态
+ * @param errorMessage 失败时返回错误信息
+ * @return 状态对象，失败时为空
+ */
+QJsonObject RemoteOCREngine::queryStatus(QString *errorMessage) const
+{
+    QString error;
+    std::unique_ptr<QIODevice> socket = connectToService(&error);
+
+    QJsonObject request;
+    request.insert("type", "status");
+    request.insert("id", QString::number(s_nextRequestId.fetchAndAddRelaxed(1)));
+
+    QByteArray buffer;
+    QJsonObject reply;
+    if (socket && writeRequest(socket.get(), request)
+        && readReply(socket.get(), buffer, CONNECT_TIMEOUT_MS, std::function<bool()>(), &reply, &error)
+        && reply.value("type").toString() == "status") {
+        return reply;
+    }
+
+    if (errorMessage) {
+        *errorMessage = error.isEmpty() ? QString("服务应答无效") : error;
+    }
+    return QJsonObject();
+}
+
+/**
+ * @brief 发送识别请求并等待结果
+ * @param images 待识别的图像列表
+ * @param language 识别语言代码
+ * @param isCanceled 返回调用方是否已取消
+ * @param errorMessage 请求失败时返回错误信息
+ * @return 按页面顺序排列的识别结果，请求失败时为空
+ */
+QList<OCREngine::OCRResult> RemoteOCREngine::requestRecognition(const QList<QImage> &images,
+                                                                const QString &language,
+                                                                const std::function<bool()> &isCanceled,
+                                                                QString *errorMessage) const
+{
+    std::unique_ptr<QIODevice> socket = connectToService(errorMessage);
+    if (!socket) {
+        return QList<OCRResult>();
+    }
+
+    // 图像以不压缩的PNG发送：本机传输不在意体积，压缩耗时反而和识别本身相当
+    QJsonArray encodedImages;
+    int resultTimeoutMs = 0;
+    {
+        OCRMetrics::ScopedTimer timer("encode_image");
+        for (const QImage &image : images) {
+            QByteArray data;
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::WriteOnly);
+            if (!image.save(&buffer, "PNG", 100)) {
+                *errorMessage = "图像编码失败";
+                return QList<OCRResult>();
+            }
+            encodedImages.append(QString::fromLatin1(data.toBase64()));
+            resultTimeoutMs += OCRCostModel::timeoutMs(image.size(), language);
+        }
+    }
+
+    const QString requestId = QString::number(s_nextRequestId.fetchAndAddRelaxed(1));
+    QJsonObject request;
+    request.insert("type", "recognize");
+    request.insert("id", requestId);
+    request.insert("language", language);
+    request.insert("images", encodedImages);
+    request.insert("layout", "binary");
+
+    if (!writeRequest(socket.get(), request)) {
+        *errorMessage = "发送识别请求失败";
+        return QList<OCRResult>();
+    }
+
+    // 等待请求被接受，排在前面的请求越多，等待结果的时间越长
+    QByteArray buffer;
+    QJsonObject reply;
+    if (!readReply(socket.get(), buffer, CONNECT_TIMEOUT_MS, isCanceled, &reply, errorMessage)) {
+        return QList<OCRResult>();
+    }
+    if (reply.value("type").toString() != "accepted") {
+        *errorMessage = reply.value("error").toString("服务拒绝了识别请求");
+        return QList<OCRResult>();
+    }
+    resultTimeoutMs *= reply.value("queuePosition").toInt() + 1;
+
+    if (!readReply(socket.get(), buffer, resultTimeoutMs, isCanceled, &reply, errorMessage)) {
+        if (isCanceled && isCanceled()) {
+            QJsonObject cancel;
+            cancel.insert("type", "cancel");
+            cancel.insert("target", requestId);
+            writeRequest(socket.get(), cancel);
+        }
+        return QList<OCRResult>();
+    }
+
+    QList<OCRResult> results;
+    for (const QJsonValue &page : reply.value("pages").toArray()) {
+        results.append(OCRService::resultFromJson(page.toObject()));
+    }
+    if (results.size() != images.size()) {
+        *errorMessage = reply.value("error").toString("服务返回的页数不正确");
+        return QList<OCRResult>();
+    }
+    return results;
+}
+
+/**
+ * @brief 连接服务
+ * @param errorMessage 失败时返回错误信息
+ * @return 已连接的套接字，失败时为空
+ */
+std::unique_ptr<QIODevice> RemoteOCREngine::connectToService(QString *errorMessage) const
+{
+    if (m_serviceAddress.startsWith("tcp://")) {
+        const QString hostPort = m_serviceAddress.mid(6);
+        const int colon = hostPort.lastIndexOf(':');
+        const QString host = hostPort.left(colon);
+        const quint16 port = hostPort.mid(colon + 1).toUShort();
+
+        std::unique_ptr<QTcpSocket> socket(new QTcpSocket);
+        socket->connectToHost(host, port);
+        if (colon <= 0 || port == 0 || !socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+            *errorMessage = colon <= 0 || port == 0 ? QString("服务地址无效: %1").arg(m_serviceAddress)
+                                                    : socket->errorString();
+            return nullptr;
+        }
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        return socket;
+    }
+
+    std::unique_ptr<QLocalSocket> socket(new QLocalSocket);
+    socket->connectToServer(m_serviceAddress);
+    if (!socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+        *errorMessage = socket->errorString();
+        return nullptr;
+    }
+    return socket;
+}
+
+/**
+ * @brief 发送一行JSON请求
+ * @param socket 连接
+ * @param request 请求对象
+ * @return 是否发送成功
+ */
+bool RemoteOCREngine::writeRequest(QIODevice *socket, const QJsonObject &request)
+{
+    QByteArray line = QJsonDocument(request).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    if (socket->write(line) != line.size()) {
+        return false;
+    }
+
+    while (socket->bytesToWrite() > 0) {
+        if (!socket->waitForBytesWritten(CONNECT_TIMEOUT_MS)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 读取一行JSON应答
+ * @param socket 连接
+ * @param buffer 未处理的已接收数据
+ * @param timeoutMs 超时时间
+ * @param isCanceled 返回调用方是否已取消
+ * @param reply 返回应答对象
+ * @param errorMessage 失败时返回错误信息
+ * @return 是否读取成功
+ */
+bool RemoteOCREngine::readReply(QIODevice *socket, QByteArray &buffer, int timeoutMs,
+                                const std::function<bool()> &isCanceled,
+                                QJsonObject *reply, QString *errorMessage)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    qsizetype lineEnd;
+    while ((lineEnd = buffer.indexOf('\n')) < 0) {
+        if (isCanceled && isCanceled()) {
+            *errorMessage = "识别已取消";
+            return false;
+        }
+        if (timer.elapsed() > timeoutMs) {
+            *errorMessage = "等待OCR服务应答超时";
+            return false;
+        }
+        if (socket->waitForReadyRead(POLL_INTERVAL_MS)) {
+            buffer.append(socket->readAll());
+        } else if (!isConnected(socket)) {
+            *errorMessage = "与OCR服务的连接已断开";
+            return false;
+        }
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson(buffer.left(lineEnd));
+    buffer.remove(0, lineEnd + 1);
+    if (!document.isObject()) {
+        *errorMessage = "服务应答无效";
+        return false;
+    }
+    *reply = document.object();
+    return true;
+}
@@ -0,0 +1,117 @@
+#ifndef REMOTEOCRENGINE_H
+#define REMOTEOCRENGINE_H
+
+#include "ocrengine.h"
+#include <QJsonObject>
+#include <QMutex>
+#include <functional>
+#include <memory>
+
+class QIODevice;
+
+/**
+ * @brief 通过常驻OCR服务（OCRService）识别的客户端引擎
+ *
+ * 图像编码后发送给已预热引擎的服务进程，本进程不需要初始化tesseract或加载语言模型，
+ * 适合大量小截图等引擎初始化耗时远大于识别耗时的场景。
+ * 每次识别使用独立的连接，可以在任意线程中调用。
+ */
+class RemoteOCREngine : public OCREngine
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造客户端引擎
+     * @param serviceAddress 服务地址（本地套接字名称，或"tcp://127.0.0.1:端口"；为空使用默认名称）
+     * @param parent 父对象指针
+     */
+    explicit RemoteOCREngine(const QString &serviceAddress = QString(), QObject *parent = nullptr);
+
+    // 重写基类的虚函数
+    EngineType getEngineType() const override;
+    QString getEngineName() const override;
+    bool initialize() override;
+    OCRResult performOCR(const QImage &image, const QString &language = "chi_sim+eng") override;
+    BatchOCRResult performBatchOCR(const QList<QImage> &images,
+                                   const QStringList &pageNames,
+                                   const QString &language = "chi_sim+eng") override;
+    bool isAvailable() const override;
+    QStringList getSupportedLanguages() const override;
+
+    /**
+     * @brief 异步批量识别：所有页面在一个请求中发送，由服务端并发识别
+     * @param images 待识别的图像列表
+     * @param language 识别语言代码
+     * @return 按页面索引存放识别结果的QFuture
+     */
+    QFuture<OCRResult> submitBatch(const QList<QImage> &images, const QString &language = "chi_sim+eng") override;
+
+    /**
+     * @brief 设置服务地址
+     * @param address 本地套接字名称，或"tcp://127.0.0.1:端口"
+     */
+    void setServiceAddress(const QString &address);
+
+    /**
+     * @brief 获取服务地址
+     * @return 服务地址
+     */
+    QString serviceAddress() const;
+
+    /**
+     * @brief 查询服务状态
+     * @param errorMessage 失败时返回错误信息
+     * @return 状态对象（队列长度、运行中的请求数、支持的语言等），失败时为空
+     */
+    QJsonObject queryStatus(QString *errorMessage = nullptr) const;
+
+private:
+    /**
+     * @brief 发送识别请求并等待结果
+     * @param images 待识别的图像列表
+     * @param language 识别语言代码
+     * @param isCanceled 返回调用方是否已取消（可为空）
+     * @param errorMessage 请求失败时返回错误信息
+     * @return 按页面顺序排列的识别结果，请求失败时为空
+     */
+    QList<OCRResult> requestRecognition(const QList<QImage> &images, const QString &language,
+                                        const std::function<bool()> &isCanceled,
+                                        QString *errorMessage) const;
+
+    /**
+     * @brief 连接服务
+     * @param errorMessage 失败时返回错误信息
+     * @return 已连接的套接字，失败时为空
+     */
+    std::unique_ptr<QIODevice> connectToService(QString *errorMessage) const;
+
+    /**
+     * @brief 发送一行JSON请求
+     * @param socket 连接
+     * @param request 请求对象
+     * @return 是否发送成功
+     */
+    static bool writeRequest(QIODevice *socket, const QJsonObject &request);
+
+    /**
+     * @brief 读取一行JSON应答
+     * @param socket 连接
+     * @param buffer 未处理的已接收数据
+     * @param timeoutMs 超时时间
+     * @param isCanceled 返回调用方是否已取消（可为空）
+     * @param reply 返回应答对象
+     * @param errorMessage 失败时返回错误信息
+     * @return 是否读取成功
+     */
+    static bool readReply(QIODevice *socket, QByteArray &buffer, int timeoutMs,
+                          const std::function<bool()> &isCanceled,
+                          QJsonObject *reply, QString *errorMessage);
+
+private:
+    QString m_serviceAddress;           // 服务地址
+    mutable QMutex m_mutex;             // 保护m_languages
+    QStringList m_languages;            // 服务端支持的语言（初始化时获取）
+};
+
+#endif // REMOTEOCRENGINE_H
@@ -0,0 +1,153 @@
+#include "startupprofiler.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QDebug>
+
+namespace {
+
+QElapsedTimer s_timer;                          // 从main()开始的计时器
+QList<QPair<QString, qint64>> s_phases;         // 首次绘制前的阶段
+QList<QPair<QString, qint64>> s_backgroundPhases; // 首次绘制后完成的后台阶段
+qint64 s_firstPaintMs = -1;                     // 首次绘制耗时（-1表示尚未绘制）
+
+} // namespace
+
+/**
+ * @brief 开始计时
+ */
+void StartupProfiler::start()
+{
+    s_timer.start();
+    s_phases.clear();
+    s_backgroundPhases.clear();
+    s_firstPaintMs = -1;
+}
+
+/**
+ * @brief 记录一个启动阶段完成
+ * @param phase 阶段名称
+ */
+void StartupProfiler::mark(const QString &phase)
+{
+    if (!s_timer.isValid() || s_firstPaintMs >= 0) {
+        return;
+    }
+    s_phases.append(qMakePair(phase, s_timer.elapsed()));
+}
+
+/**
+ * @brief 首次绘制完成，输出汇总并检查预算
+ */
+void StartupProfiler::firstPaint()
+{
+    if (!s_timer.isValid() || s_firstPaintMs >= 0) {
+        return;
+    }
+
+    s_firstPaintMs = s_timer.elapsed();
+    s_phases.append(qMakePair(QString("首次绘制"), s_firstPaintMs));
+
+    // 汇总各阶段自身的耗时
+    QStringList parts;
+    qint64 previous = 0;
+    for (const auto &phase : s_phases) {
+        parts << QString("%1 %2ms").arg(phase.first).arg(phase.second - previous);
+        previous = phase.second;
+    }
+
+    const qint64 budget = budgetMs();
+    if (s_firstPaintMs > budget) {
+        qWarning() << "启动时间超出预算:" << s_firstPaintMs << "ms >" << budget << "ms |" << parts.join(", ");
+    } else {
+        qDebug() << "启动耗时:" << s_firstPaintMs << "ms (预算" << budget << "ms) |" << parts.join(", ");
+    }
+
+    writeReport();
+}
+
+/**
+ * @brief 记录启动后的后台阶段
+ * @param phase 阶段名称
+ */
+void StartupProfiler::markBackground(const QString &phase)
+{
+    if (!s_timer.isValid()) {
+        return;
+    }
+
+    qint64 elapsed = s_timer.elapsed();
+    s_backgroundPhases.append(qMakePair(phase, elapsed));
+    qDebug() << "启动后台阶段完成:" << phase << elapsed << "ms";
+
+    // 首次绘制后完成的阶段追加到报告中
+    if (s_firstPaintMs >= 0) {
+        writeReport();
+    }
+}
+
+/**
+ * @brief 获取从开始计时到现在的毫秒数
+ * @return 毫秒数
+ */
+qint64 StartupProfiler::elapsedMs()
+{
+    return s_timer.isValid() ? s_timer.elapsed() : 0;
+}
+
+/**
+ * @brief 获取冷启动预算
+ * @return 预算（毫秒）
+ */
+qint64 StartupProfiler::budgetMs()
+{
+    bool ok = false;
+    int budget = qEnvironmentVariableIntValue("CONVENIENT_OCR_STARTUP_BUDGET_MS", &ok);
+    return ok && budget > 0 ? budget : 300;
+}
+
+/**
+ * @brief 获取已记录的阶段及其累计耗时
+ * @return 阶段列表
+ */
+QList<QPair<QString, qint64>> StartupProfiler::phases()
+{
+    return s_phases + s_backgroundPhases;
+}
+
+/**
+ * @brief 将汇总写入CONVENIENT_OCR_STARTUP_REPORT指定的文件
+ */
+void StartupProfiler::writeReport()
+{
+    const QString reportPath = qEnvironmentVariable("CONVENIENT_OCR_STARTUP_REPORT");
+    if (reportPath.isEmpty()) {
+        return;
+    }
+
+    auto toJson = [](const QList<QPair<QString, qint64>> &phaseList) {
+        QJsonArray array;
+        for (const auto &phase : phaseList) {
+            QJsonObject entry;
+            entry.insert("phase", phase.first);
+            entry.insert("elapsedMs", phase.second);
+            array.append(entry);
+        }
+        return array;
+    };
+
+    QJsonObject report;
+    report.insert("firstPaintMs", s_firstPaintMs);
+    report.insert("budgetMs", budgetMs());
+    report.insert("withinBudget", s_firstPaintMs <= budgetMs());
+    report.insert("phases", toJson(s_phases));
+    report.insert("backgroundPhases", toJson(s_backgroundPhases));
+
+    QFile file(reportPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(report).toJson());
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+
+/**
+ * @brief 启动阶段耗时记录
+ *
+ * 从main()开始计时，记录各启动阶段完成时的累计耗时。首次绘制完成后输出汇总，
+ * 并与冷启动预算（默认300毫秒，可通过环境变量CONVENIENT_OCR_STARTUP_BUDGET_MS修改）比较，
+ * 超出预算时输出警告。设置环境变量CONVENIENT_OCR_STARTUP_REPORT为文件路径时，
+ * 汇总还会以JSON格式写入该文件，便于自动化测试检查启动时间。
+ *
+ * 只应在主线程中使用。
+ */
+class StartupProfiler
+{
+public:
+    /**
+     * @brief 开始计时（在main()的第一行调用）
+     */
+    static void start();
+
+    /**
+     * @brief 记录一个启动阶段完成
+     * @param phase 阶段名称
+     */
+    static void mark(const QString &phase);
+
+    /**
+     * @brief 首次绘制完成，输出汇总并检查预算（只有第一次调用有效）
+     */
+    static void firstPaint();
+
+    /**
+     * @brief 记录启动后的后台阶段（如引擎初始化完成），不计入首次绘制预算
+     * @param phase 阶段名称
+     */
+    static void markBackground(const QString &phase);
+
+    /**
+     * @brief 获取从开始计时到现在的毫秒数
+     * @return 毫秒数
+     */
+    static qint64 elapsedMs();
+
+    /**
+     * @brief 获取冷启动预算
+     * @return 预算（毫秒）
+     */
+    static qint64 budgetMs();
+
+    /**
+     * @brief 获取已记录的阶段及其累计耗时（毫秒）
+     * @return 阶段列表
+     */
+    static QList<QPair<QString, qint64>> phases();
+
+private:
+    /**
+     * @brief 将汇总写入CONVENIENT_OCR_STARTUP_REPORT指定的文件
+     */
+    static void writeReport();
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,487 @@
+#include "tesseractlibocrengine.h"
+#include "ocrresultcache.h"
+#include "ocrmetrics.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <tesseract/baseapi.h>
+#include <tesseract/ocrclass.h>
+
+/**
+ * @brief tesseract识别过程中的取消回调
+ * @param cancelThis 指向当前异步任务的QPromise
+ * @param words 已识别的单词数（未使用）
+ * @return 是否取消识别
+ */
+static bool cancelRecognition(void *cancelThis, int words)
+{
+    Q_UNUSED(words)
+    return static_cast<const QPromise<OCREngine::OCRResult> *>(cancelThis)->isCanceled();
+}
+
+/**
+ * @brief TesseractLibOCREngine构造函数
+ * @param parent 父对象指针
+ */
+TesseractLibOCREngine::TesseractLibOCREngine(QObject *parent)
+    : OCREngine(parent)
+    , m_api(new tesseract::TessBaseAPI())
+    , m_tessDataPath("")            // 默认使用TESSDATA_PREFIX或编译时路径
+    , m_loadedEngineMode(-1)
+    , m_ocrEngineMode(3)            // 默认OCR引擎模式
+    , m_pageSegmentationMode(3)     // 默认页面分割模式
+{
+    // 与TesseractOCREngine保持一致：优先使用随程序分发的tessdata目录
+    QString appDir = QCoreApplication::applicationDirPath();
+    QStringList possiblePaths = {
+        appDir + "/tesseract/tessdata",
+        appDir + "/../tesseract/tessdata",
+        appDir + "/../../tesseract/tessdata",
+        "./tesseract/tessdata",
+        "tesseract/tessdata"
+    };
+
+    for (const QString &path : possiblePaths) {
+        if (QDir(path).exists()) {
+            m_tessDataPath = QFileInfo(path).absoluteFilePath();
+            break;
+        }
+    }
+}
+
+/**
+ * @brief TesseractLibOCREngine析构函数
+ */
+TesseractLibOCREngine::~TesseractLibOCREngine()
+{
+    QMutexLocker locker(&m_apiMutex);
+    m_api->End();
+    delete m_api;
+    m_api = nullptr;
+}
+
+/**
+ * @brief 获取引擎类型
+ * @return TESSERACT_LIB引擎类型
+ */
+OCREngine::EngineType TesseractLibOCREngine::getEngineType() const
+{
+    return TESSERACT_LIB;
+}
+
+/**
+ * @brief 获取引擎名称
+ * @return 引擎显示名称
+ */
+QString TesseractLibOCREngine::getEngineName() const
+{
+    return "Tesseract OCR (内置库)";
+}
+
+/**
+ * @brief 初始化引擎
+ *
+ * 预先加载默认语言模型，使第一次识别不再承担模型加载开销。
+ * @return 是否初始化成功
+ */
+bool TesseractLibOCREngine::initialize()
+{
+    if (m_initialized) {
+        return true;
+    }
+
+    bool loaded = false;
+    {
+        QMutexLocker locker(&m_apiMutex);
+        loaded = ensureLanguageLoaded("chi_sim+eng") || ensureLanguageLoaded("eng");
+    }
+
+    if (!loaded) {
+        emit errorOccurred(m_lastError);
+        return false;
+    }
+
+    qDebug() << "Tesseract库初始化成功，版本:" << tesseract::TessBaseAPI::Version()
+             << "已加载语言:" << m_loadedLanguage;
+    m_initialized = true;
+    return true;
+}
+
+/**
+ * @brief 执行OCR识别
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractLibOCREngine::performOCR(const QImage &image, const QString &language)
+{
+    OCRMetrics::JobScope job;
+    OCRResult result;
+
+    if (!m_initialized) {
+        if (!initialize()) {
+            result.success = false;
+            result.errorMessage = m_lastError;
+            return result;
+        }
+    }
+
+    if (image.isNull()) {
+        result.success = false;
+        result.errorMessage = "输入图像为空";
+        return result;
+    }
+
+    // 相同图像和识别参数的结果直接从缓存返回；单张图像（如截图）不做空白页检测，
+    // 低对比度的界面文字不会被当作空白页静默跳过，空白页检测只用于批量和文档识别
+    QByteArray cacheKey = resultCacheKey(image, language);
+    if (lookupCachedResult(cacheKey, result)) {
+        emit progressUpdated(100);
+        emit ocrCompleted(result);
+        return result;
+    }
+
+    emit progressUpdated(10);
+
+    {
+        QMutexLocker locker(&m_apiMutex);
+        if (!ensureLanguageLoaded(language)) {
+            result.success = false;
+            result.errorMessage = m_lastError;
+            return result;
+        }
+
+        emit progressUpdated(30);
+        result = recognizeImage(image);
+    }
+
+    if (!result.success) {
+        return result;
+    }
+
+    storeCachedResult(cacheKey, result);
+
+    emit progressUpdated(100);
+    emit ocrCompleted(result);
+    return result;
+}
+
+/**
+ * @brief 执行批量OCR识别
+ *
+ * 所有页面共用同一份已加载的模型，逐页识别。
+ * @param images 待识别的图像列表
+ * @param pageNames 页面名称列表
+ * @param language 识别语言代码
+ * @return 批量OCR识别结果
+ */
+OCREngine::BatchOCRResult TesseractLibOCREngine::performBatchOCR(const QList<QImage> &images,
+                                                                 const QStringList &pageNames,
+                                                                 const QString &language)
+{
+    OCRMetrics::JobScope job;
+    BatchOCRResult batchResult;
+    batchResult.totalPages = images.size();
+
+    if (!m_initialized) {
+        if (!initialize()) {
+            batchResult.success = false;
+            batchResult.errorMessage = m_lastError;
+            return batchResult;
+        }
+    }
+
+    if (images.isEmpty()) {
+        batchResult.success = false;
+        batchResult.errorMessage = "输入图像列表为空";
+        return batchResult;
+    }
+
+    // 为每个页面准备名称
+    QStringList actualPageNames = pageNames;
+    while (actualPageNames.size() < images.size()) {
+        actualPageNames.append(QString("页面 %1").arg(actualPageNames.size() + 1));
+    }
+
+    {
+        QMutexLocker locker(&m_apiMutex);
+        if (!ensureLanguageLoaded(language)) {
+            batchResult.success = false;
+            batchResult.errorMessage = m_lastError;
+            return batchResult;
+        }
+    }
+
+    QList<OCRResult> pageResults;
+
+    for (int i = 0; i < images.size(); ++i) {
+        const QImage &image = images[i];
+
+        if (image.isNull()) {
+            OCRResult invalidResult;
+            invalidResult.errorMessage = QString("第%1页图像无效").arg(i + 1);
+            pageResults.append(invalidResult);
+
+            int overallProgress = ((i + 1) * 100) / images.size();
+            emit batchProgressUpdated(overallProgress, i + 1, images.size(), 100);
+            continue;
+        }
+
+        int baseProgress = (i * 100) / images.size();
+        emit batchProgressUpdated(baseProgress, i + 1, images.size(), 0);
+
+        OCRResult pageResult;
+        if (!detectBlankPage(image, pageResult)) {
+            QByteArray cacheKey = resultCacheKey(image, language);
+            if (!lookupCachedResult(cacheKey, pageResult)) {
+                QMutexLocker locker(&m_apiMutex);
+                pageResult = recognizeImage(image);
+                storeCachedResult(cacheKey, pageResult);
+            }
+        }
+        pageResults.append(pageResult);
+
+        int overallProgress = ((i + 1) * 100) / images.size();
+        emit batchProgressUpdated(overallProgress, i + 1, images.size(), 100);
+    }
+
+    finalizeBatchResult(batchResult, pageResults, actualPageNames);
+
+    emit batchOcrCompleted(batchResult);
+    return batchResult;
+}
+
+/**
+ * @brief 检查引擎是否可用
+ *
+ * 只检查tessdata目录中是否存在语言模型，不会触发模型加载。
+ * @return 是否可用
+ */
+bool TesseractLibOCREngine::isAvailable() const
+{
+    return m_initialized || !listTessDataLanguages().isEmpty();
+}
+
+/**
+ * @brief 获取支持的语言列表
+ * @return 支持的语言代码列表
+ */
+QStringList TesseractLibOCREngine::getSupportedLanguages() const
+{
+    return listTessDataLanguages();
+}
+
+/**
+ * @brief 设置tessdata目录路径
+ * @param path tessdata目录路径
+ */
+void TesseractLibOCREngine::setTessDataPath(const QString &path)
+{
+    QMutexLocker locker(&m_apiMutex);
+    m_tessDataPath = path;
+    m_loadedLanguage.clear(); // 下次识别时重新加载模型
+    m_initialized = false;
+}
+
+/**
+ * @brief 设置OCR引擎模式
+ * @param mode 引擎模式 (0-3)
+ */
+void TesseractLibOCREngine::setOCREngineMode(int mode)
+{
+    m_ocrEngineMode = qBound(0, mode, 3);
+}
+
+/**
+ * @brief 设置页面分割模式
+ * @param mode 分割模式 (0-13)
+ */
+void TesseractLibOCREngine::setPageSegmentationMode(int mode)
+{
+    m_pageSegmentationMode = qBound(0, mode, 13);
+}
+
+/**
+ * @brief 异步识别单页
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @param promise 当前异步任务（取消时中止识别）
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractLibOCREngine::recognizeForAsync(const QImage &image, const QString &language,
+                                                              const QPromise<OCRResult> &promise)
+{
+    OCRResult result;
+
+    QMutexLocker locker(&m_apiMutex);
+    if (!ensureLanguageLoaded(language)) {
+        result.errorMessage = m_lastError;
+        return result;
+    }
+
+    tesseract::ETEXT_DESC monitor;
+    monitor.cancel = cancelRecognition;
+    monitor.cancel_this = const_cast<QPromise<OCRResult> *>(&promise);
+
+    result = recognizeImage(image, &monitor);
+    if (promise.isCanceled()) {
+        result.success = false;
+        result.errorMessage = "识别已取消";
+    }
+    return result;
+}
+
+/**
+ * @brief 获取影响识别结果的上下文描述
+ * @param language 识别语言代码
+ * @return 上下文字符串
+ */
+QString TesseractLibOCREngine::cacheContext(const QString &language) const
+{
+    return QString("%1|%2|oem=%3|psm=%4|%5")
+        .arg(OCREngine::cacheContext(language), QString::fromLatin1(tesseract::TessBaseAPI::Version()))
+        .arg(m_ocrEngineMode)
+        .arg(m_pageSegmentationMode)
+        .arg(OCRResultCache::tessDataFingerprint(tessDataDirectory(), language));
+}
+
+/**
+ * @brief 确保TessBaseAPI已按指定语言加载模型
+ * @param language 识别语言代码
+ * @return 是否加载成功
+ */
+bool TesseractLibOCREngine::ensureLanguageLoaded(const QString &language)
+{
+    if (language == m_loadedLanguage && m_ocrEngineMode == m_loadedEngineMode) {
+        return true;
+    }
+
+    QByteArray dataPath = m_tessDataPath.toUtf8();
+    QByteArray languageBytes = language.toUtf8();
+
+    int ret = m_api->Init(dataPath.isEmpty() ? nullptr : dataPath.constData(),
+                          languageBytes.constData(),
+                          static_cast<tesseract::OcrEngineMode>(m_ocrEngineMode));
+    if (ret != 0) {
+        m_loadedLanguage.clear();
+        m_loadedEngineMode = -1;
+        m_lastError = QString("无法加载Tesseract语言模型: %1").arg(language);
+        return false;
+    }
+
+    m_loadedLanguage = language;
+    m_loadedEngineMode = m_ocrEngineMode;
+    return true;
+}
+
+/**
+ * @brief 对单张图像执行识别
+ * @param image 待识别的图像
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractLibOCREngine::recognizeImage(const QImage &image, tesseract::ETEXT_DESC *monitor)
+{
+    OCRResult result;
+
+    // 灰度图直接按8位传入，其余格式统一转换为RGB888（tesseract要求R、G、B字节顺序）
+    QImage input;
+    int bytesPerPixel = 0;
+    {
+        OCRMetrics::ScopedTimer convertTimer("convert_image");
+        if (image.format() == QImage::Format_Grayscale8 ||
+            image.format() == QImage::Format_Grayscale16 ||
+            image.format() == QImage::Format_Mono ||
+            image.format() == QImage::Format_MonoLSB) {
+            input = image.convertToFormat(QImage::Format_Grayscale8);
+            bytesPerPixel = 1;
+        } else {
+            input = image.convertToFormat(QImage::Format_RGB888);
+            bytesPerPixel = 3;
+        }
+    }
+
+    m_api->SetPageSegMode(static_cast<tesseract::PageSegMode>(m_pageSegmentationMode));
+    m_api->SetImage(input.constBits(), input.width(), input.height(),
+                    bytesPerPixel, static_cast<int>(input.bytesPerLine()));
+
+    // 没有有效分辨率信息时按300 DPI处理，避免tesseract自行猜测
+    int dpi = qRound(input.dotsPerMeterX() * 0.0254);
+    m_api->SetSourceResolution(dpi >= 70 ? dpi : 300);
+
+    int recognizeStatus;
+    {
+        OCRMetrics::ScopedTimer recognizeTimer("recognize");
+        recognizeStatus = m_api->Recognize(monitor);
+    }
+    if (recognizeStatus != 0) {
+        m_api->Clear();
+        result.success = false;
+        result.errorMessage = "Tesseract识别失败";
+        return result;
+    }
+
+    // 与命令行引擎一致：从TSV构建版面结构，纯文本和置信度都由其得出
+    char *tsvText = m_api->GetTSVText(0);
+    if (tsvText) {
+        OCRMetrics::ScopedTimer parseTimer("parse_tsv");
+        result.layout = OCRLayout::fromTSV(QByteArray::fromRawData(tsvText, qstrlen(tsvText)));
+        delete[] tsvText;
+    }
+    OCRMetrics::increment("pages_recognized");
+
+    result.text = result.layout.text();
+    result.confidence = result.layout.meanConfidence();
+    result.success = true;
+
+    // 释放本页识别数据，但保留已加载的模型
+    m_api->Clear();
+    return result;
+}
+
+/**
+ * @brief 获取tessdata目录中可用的语言列表
+ * @return 语言代码列表
+ */
+QStringList TesseractLibOCREngine::listTessDataLanguages() const
+{
+    QString dataPath = tessDataDirectory();
+    if (dataPath.isEmpty()) {
+        return QStringList();
+    }
+
+    QDir dir(dataPath);
+    QStringList languages;
+    const QStringList files = dir.entryList(QStringList() << "*.traineddata", QDir::Files, QDir::Name);
+    for (const QString &file : files) {
+        QString lang = QFileInfo(file).completeBaseName();
+        if (lang != "osd") {
+            languages << lang;
+        }
+    }
+    return languages;
+}
+
+/**
+ * @brief 获取实际使用的tessdata目录
+ * @return tessdata目录
+ */
+QString TesseractLibOCREngine::tessDataDirectory() const
+{
+    QString dataPath = m_tessDataPath;
+    if (dataPath.isEmpty()) {
+        dataPath = qEnvironmentVariable("TESSDATA_PREFIX");
+    }
+    if (dataPath.isEmpty()) {
+        return QString();
+    }
+
+    // TESSDATA_PREFIX既可能指向tessdata本身，也可能指向其父目录
+    QDir dir(dataPath);
+    if (!dir.exists("eng.traineddata") && dir.exists("tessdata")) {
+        dir.cd("tessdata");
+    }
+    return dir.absolutePath();
+}
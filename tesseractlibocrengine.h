@@ -0,0 +1,109 @@
+#ifndef TESSERACTLIBOCRENGINE_H
+#define TESSERACTLIBOCRENGINE_H
+
+#include "ocrengine.h"
+#include <QMutex>
+
+namespace tesseract {
+class TessBaseAPI;
+class ETEXT_DESC;
+}
+
+/**
+ * @brief 基于libtesseract的进程内OCR引擎实现类
+ *
+ * 与TesseractOCREngine每页启动一次tesseract进程不同，该类直接调用
+ * TessBaseAPI：语言模型只在首次使用（或语言/模式改变）时加载一次，
+ * 图像像素直接从QImage内存传入，无需临时文件。
+ */
+class TesseractLibOCREngine : public OCREngine
+{
+    Q_OBJECT
+
+public:
+    explicit TesseractLibOCREngine(QObject *parent = nullptr);
+    ~TesseractLibOCREngine() override;
+
+    // 重写基类的虚函数
+    EngineType getEngineType() const override;
+    QString getEngineName() const override;
+    bool initialize() override;
+    OCRResult performOCR(const QImage &image, const QString &language = "chi_sim+eng") override;
+    BatchOCRResult performBatchOCR(const QList<QImage> &images,
+                                   const QStringList &pageNames,
+                                   const QString &language = "chi_sim+eng") override;
+    bool isAvailable() const override;
+    QStringList getSupportedLanguages() const override;
+
+    /**
+     * @brief 设置Tesseract数据目录
+     * @param path tessdata目录路径
+     */
+    void setTessDataPath(const QString &path);
+
+    /**
+     * @brief 设置OCR引擎模式
+     * @param mode OCR引擎模式 (0-3)
+     */
+    void setOCREngineMode(int mode);
+
+    /**
+     * @brief 设置页面分割模式
+     * @param mode 页面分割模式 (0-13)
+     */
+    void setPageSegmentationMode(int mode);
+
+protected:
+    /**
+     * @brief 异步识别单页，取消时通过tesseract的取消回调立即中止识别
+     */
+    OCRResult recognizeForAsync(const QImage &image, const QString &language,
+                                const QPromise<OCRResult> &promise) override;
+
+    /**
+     * @brief 缓存上下文：追加libtesseract版本、引擎模式、页面分割模式和语言模型指纹
+     */
+    QString cacheContext(const QString &language) const override;
+
+private:
+    /**
+     * @brief 确保TessBaseAPI已按指定语言加载模型
+     *
+     * 只有在语言、引擎模式或数据目录发生变化时才会重新加载模型。
+     * 调用方必须持有m_apiMutex。
+     * @param language 识别语言代码
+     * @return 是否加载成功
+     */
+    bool ensureLanguageLoaded(const QString &language);
+
+    /**
+     * @brief 对单张图像执行识别（调用方必须持有m_apiMutex）
+     * @param image 待识别的图像
+     * @param monitor 识别进度监视器（可为空，用于取消识别）
+     * @return OCR识别结果
+     */
+    OCRResult recognizeImage(const QImage &image, tesseract::ETEXT_DESC *monitor = nullptr);
+
+    /**
+     * @brief 获取tessdata目录中可用的语言列表
+     * @return 语言代码列表
+     */
+    QStringList listTessDataLanguages() const;
+
+    /**
+     * @brief 获取实际使用的tessdata目录
+     * @return tessdata目录，无法确定时返回空字符串
+     */
+    QString tessDataDirectory() const;
+
+private:
+    tesseract::TessBaseAPI *m_api;  // Tesseract API对象（模型常驻内存）
+    QMutex m_apiMutex;              // TessBaseAPI不可重入，串行化访问
+    QString m_tessDataPath;         // tessdata数据目录路径
+    QString m_loadedLanguage;       // 当前已加载的语言
+    int m_loadedEngineMode;         // 当前已加载模型对应的引擎模式
+    int m_ocrEngineMode;            // OCR引擎模式
+    int m_pageSegmentationMode;     // 页面分割模式
+};
+
+#endif // TESSERACTLIBOCRENGINE_H
@@ -1,12 +1,91 @@
 #include "tesseractocrengine.h"
+#include "ocrresultcache.h"
+#include "toolregistry.h"
+#include "ocrcostmodel.h"
+#include "ocrmetrics.h"
+#include "ocrtracer.h"
 #include <QStandardPaths>
 #include <QFileInfo>
-#include <QTextStream>
 #include <QDebug>
-#include <QApplication>
+#include <QCoreApplication>
 #include <QProcessEnvironment>
 #include <QDateTime>
 #include <QFile>
+#include <QThread>
+#include <QAtomicInteger>
+#include <QBuffer>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 预测每个页面的识别耗时
+ * @param images 页面图像
+ * @param language 识别语言代码
+ * @return 各页面的预测耗时（毫秒），无效页面为0
+ */
+QList<qint64> predictPageCosts(const QList<QImage> &images, const QString &language)
+{
+    QList<qint64> costs;
+    costs.reserve(images.size());
+    for (const QImage &image : images) {
+        costs.append(image.isNull() ? 0 : OCRCostModel::predictMs(image.size(), language));
+    }
+    return costs;
+}
+
+/**
+ * @brief 启动tesseract进程并记录启动耗时
+ * @param process 待启动的进程
+ * @param program 可执行文件
+ * @param arguments 命令行参数
+ * @param pageIndex 页面索引（仅用于时间线），-1表示单页识别或多页列表
+ * @return 是否在5秒内启动成功
+ */
+bool startTesseractProcess(QProcess *process, const QString &program, const QStringList &arguments,
+                           int pageIndex = -1)
+{
+    OCRMetrics::ScopedTimer spawnTimer("process_spawn", pageIndex);
+    OCRMetrics::increment("process_spawns");
+    process->start(program, arguments);
+    return process->waitForStarted(5000);
+}
+
+/**
+ * @brief 将图像编码为PNG文件并记录编码耗时和字节数
+ * @param image 图像
+ * @param filePath 文件路径
+ * @param quality PNG质量参数（-1为默认压缩，100为不压缩）
+ * @param pageIndex 页面索引（仅用于时间线）
+ * @return 是否成功
+ */
+bool encodeImageFile(const QImage &image, const QString &filePath, int quality = -1, int pageIndex = -1)
+{
+    OCRMetrics::ScopedTimer encodeTimer("encode_image", pageIndex);
+    if (!image.save(filePath, "PNG", quality)) {
+        return false;
+    }
+    OCRMetrics::increment("bytes_encoded", QFileInfo(filePath).size());
+    return true;
+}
+
+/**
+ * @brief 记录tesseract进程识别一页的耗时
+ *
+ * 识别在外部进程中进行，时间线上作为异步时间段显示，并发页面各占一条轨道。
+ * @param elapsedNs 耗时（纳秒）
+ * @param pageIndex 页面索引
+ */
+void recordRecognize(qint64 elapsedNs, int pageIndex)
+{
+    OCRMetrics::observe("recognize", elapsedNs);
+    if (OCRTracer::isEnabled()) {
+        OCRTracer::asyncSpan("recognize", OCRTracer::nowUs() - elapsedNs / 1000, elapsedNs / 1000, pageIndex);
+    }
+}
+
+} // namespace
 
 // 常用语言代码映射表
 const QMap<QString, QString> TesseractOCREngine::s_languageMap = {
@@ -28,10 +107,18 @@ TesseractOCREngine::TesseractOCREngine(QObject *parent)
     , m_ocrEngineMode(3)            // 默认OCR引擎模式
     , m_pageSegmentationMode(3)     // 默认页面分割模式
     , m_tesseractProcess(nullptr)
-    , m_processingAsync(false)
+    , m_maxConcurrentPages(QThread::idealThreadCount())
+    , m_imageListMinPages(8)
+    , m_workerPool(nullptr)
+    , m_useWorkerPool(false)
+    , m_asyncThreadPool(nullptr)
+    , m_asyncWorkerPool(nullptr)
+    , m_asyncWorkerPoolGeneration(-1)
+    , m_workerPoolGeneration(0)
+    , m_asyncShutdown(0)
 {
     // 检测bundled版本的Tesseract（支持Enigma Virtual Box）
-    QString appDir = QApplication::applicationDirPath();
+    QString appDir = QCoreApplication::applicationDirPath();
 
     // 多种路径尝试（适应不同的虚拟化环境）
     QStringList possiblePaths = {
@@ -68,10 +155,17 @@ TesseractOCREngine::TesseractOCREngine(QObject *parent)
     m_tesseractProcess = new QProcess(this);
 
     // 连接信号和槽
-    connect(m_tesseractProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &TesseractOCREngine::onTesseractFinished);
     connect(m_tesseractProcess, &QProcess::errorOccurred,
             this, &TesseractOCREngine::onTesseractError);
+
+    // 预热工作进程池（仅在启用后才会启动进程）
+    m_workerPool = new TesseractWorkerPool(this);
+    updateWorkerPoolConfiguration(m_workerPool);
+
+    // 异步任务固定在同一个常驻线程中执行，使该线程的预热进程可以跨任务复用
+    m_asyncThreadPool = new QThreadPool(this);
+    m_asyncThreadPool->setMaxThreadCount(1);
+    m_asyncThreadPool->setExpiryTimeout(-1);
 }
 
 /**
@@ -79,6 +173,14 @@ TesseractOCREngine::TesseractOCREngine(QObject *parent)
  */
 TesseractOCREngine::~TesseractOCREngine()
 {
+    // 停止异步任务，并在异步线程中释放其工作进程
+    m_asyncShutdown.storeRelaxed(1);
+    m_asyncThreadPool->start([this]() {
+        delete m_asyncWorkerPool;
+        m_asyncWorkerPool = nullptr;
+    });
+    m_asyncThreadPool->waitForDone();
+
     // 清理临时文件
     cleanupTempFiles();
 
@@ -119,21 +221,25 @@ bool TesseractOCREngine::initialize()
         return true;
     }
 
-    // 检查Tesseract是否已安装
-    if (!checkTesseractInstallation()) {
+    // 检查Tesseract是否已安装（探测结果有缓存，通常不需要启动进程）
+    ToolRegistry::ToolInfo info = toolInfo();
+    if (!info.available) {
         m_lastError = "Tesseract OCR 未安装或无法找到可执行文件";
         emit errorOccurred(m_lastError);
         return false;
     }
 
     // 获取版本信息
-    QString version = getTesseractVersion();
+    QString version = info.version;
     if (version.isEmpty()) {
         m_lastError = "无法获取Tesseract版本信息";
         emit errorOccurred(m_lastError);
         return false;
     }
 
+    m_tesseractVersion = version;
+    m_resolvedTessDataPath = info.tessDataDir;
+
     qDebug() << "Tesseract OCR 初始化成功，版本:" << version;
     m_initialized = true;
     return true;
@@ -147,6 +253,7 @@ bool TesseractOCREngine::initialize()
  */
 OCREngine::OCRResult TesseractOCREngine::performOCR(const QImage &image, const QString &language)
 {
+    OCRMetrics::JobScope job;
     OCRResult result;
 
     if (!m_initialized) {
@@ -163,6 +270,26 @@ OCREngine::OCRResult TesseractOCREngine::performOCR(const QImage &image, const Q
         return result;
     }
 
+    // 相同图像和识别参数的结果直接从缓存返回；单张图像（如截图）不做空白页检测，
+    // 低对比度的界面文字不会被当作空白页静默跳过，空白页检测只用于批量和文档识别
+    QByteArray cacheKey = resultCacheKey(image, language);
+    if (lookupCachedResult(cacheKey, result)) {
+        emit progressUpdated(100);
+        emit ocrCompleted(result);
+        return result;
+    }
+
+    // 通过预热进程识别，不经过临时文件
+    if (m_useWorkerPool) {
+        result = performPooledOCR(image, language, -1, 0);
+        if (result.success) {
+            storeCachedResult(cacheKey, result);
+            emit progressUpdated(100);
+            emit ocrCompleted(result);
+        }
+        return result;
+    }
+
     // 保存图像到临时文件
     QString tempImagePath = saveImageToTempFile(image);
     if (tempImagePath.isEmpty()) {
@@ -171,51 +298,20 @@ OCREngine::OCRResult TesseractOCREngine::performOCR(const QImage &image, const Q
         return result;
     }
 
-    // 准备输出文件路径
-    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    QString outputBaseName = tempDir + "/ocr_result_" + QString::number(QDateTime::currentMSecsSinceEpoch());
-    QString outputPath = outputBaseName + ".txt";
-    QString tsvOutputPath = outputBaseName + ".tsv";
-
-    // 准备Tesseract命令参数
-    QStringList arguments;
-    arguments << tempImagePath;                                    // 输入图像文件
-    arguments << outputBaseName;                                   // 输出文件基名（不含扩展名）
-    arguments << "-l" << language;                                 // 语言参数
-    arguments << "--oem" << QString::number(m_ocrEngineMode);      // OCR引擎模式
-    arguments << "--psm" << QString::number(m_pageSegmentationMode); // 页面分割模式
-    arguments << "txt" << "tsv";                                   // 同时输出txt和tsv格式
-
-    // 如果指定了tessdata路径，添加到参数中
-    if (!m_tessDataPath.isEmpty()) {
-        arguments << "--tessdata-dir" << m_tessDataPath;
-    }
-
-    // 设置bundled版本的工作目录和环境变量（支持虚拟化环境）
-    if (m_tesseractPath.contains("tesseract") && m_tesseractPath.contains("tesseract.exe")) {
-        QFileInfo tesseractFile(m_tesseractPath);
-        QString tesseractDir = tesseractFile.absolutePath();
-
-        // 确保目录存在
-        if (QDir(tesseractDir).exists()) {
-            m_tesseractProcess->setWorkingDirectory(tesseractDir);
-        }
-
-        // 清除可能干扰的环境变量并添加DLL搜索路径
-        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-        env.remove("TESSDATA_PREFIX");
+    // 准备输出文件路径及命令参数
+    QString outputBaseName = createTempBaseName("ocr_result");
+    QStringList arguments = buildTesseractArguments(tempImagePath, outputBaseName, language);
+    configureTesseractProcess(m_tesseractProcess, false);
 
-        // 添加tesseract目录到PATH，确保DLL能被找到
-        QString currentPath = env.value("PATH");
-        env.insert("PATH", tesseractDir + ";" + currentPath);
-        m_tesseractProcess->setProcessEnvironment(env);
-    }
+    // 超时和进度按本机测得的识别速度预测
+    const qint64 predictedMs = OCRCostModel::predictMs(image.size(), language);
+    const int maxWaitTime = OCRCostModel::timeoutMs(image.size(), language);
+    QElapsedTimer timer;
+    timer.start();
 
     // 启动Tesseract进程
     emit progressUpdated(10);
-    m_tesseractProcess->start(m_tesseractPath, arguments);
-
-    if (!m_tesseractProcess->waitForStarted(5000)) {
+    if (!startTesseractProcess(m_tesseractProcess, m_tesseractPath, arguments)) {
         result.success = false;
         result.errorMessage = "无法启动Tesseract进程: " + m_tesseractProcess->errorString();
         cleanupTempFiles();
@@ -225,18 +321,15 @@ OCREngine::OCRResult TesseractOCREngine::performOCR(const QImage &image, const Q
     emit progressUpdated(20);
 
     // 等待进程完成，期间定期更新进度
-    int elapsedTime = 0;
-    const int maxWaitTime = 30000; // 30秒超时
     const int updateInterval = 500; // 每500毫秒更新一次进度
 
-    while (m_tesseractProcess->state() == QProcess::Running && elapsedTime < maxWaitTime) {
+    while (m_tesseractProcess->state() == QProcess::Running && timer.elapsed() < maxWaitTime) {
         m_tesseractProcess->waitForFinished(updateInterval);
-        elapsedTime += updateInterval;
 
-        // 计算进度: 20% -> 75% 根据已用时间
-        int currentProgress = 20 + (55 * elapsedTime) / maxWaitTime;
-        emit progressUpdated(currentProgress);
+        // 计算进度: 20% -> 75% 根据已用时间与预测耗时之比
+        emit progressUpdated(OCRCostModel::estimateProgress(timer.elapsed(), predictedMs, 20, 75));
     }
+    recordRecognize(timer.nsecsElapsed(), -1);
 
     // 检查是否超时
     if (m_tesseractProcess->state() == QProcess::Running) {
@@ -260,30 +353,17 @@ OCREngine::OCRResult TesseractOCREngine::performOCR(const QImage &image, const Q
         return result;
     }
 
-    // 读取OCR结果
-    QString ocrText = readOCRResultFromFile(outputPath);
-    if (ocrText.isEmpty()) {
-        result.success = false;
-        result.errorMessage = "无法读取OCR结果文件";
-        cleanupTempFiles();
+    // 读取OCR结果（文本及从TSV解析的置信度），并清理输出文件
+    result = collectOutputFiles(outputBaseName);
+    cleanupTempFiles();
+    if (!result.success) {
         return result;
     }
 
-    // 从TSV文件解析置信度
-    float confidence = parseConfidenceFromTSV(tsvOutputPath);
-
-    // 清理临时文件
-    QFile::remove(tempImagePath);
-    QFile::remove(outputPath);
-    QFile::remove(tsvOutputPath);
-
+    OCRCostModel::record(image.size(), language, timer.elapsed());
+    storeCachedResult(cacheKey, result);
     emit progressUpdated(100);
 
-    // 设置结果
-    result.success = true;
-    result.text = ocrText.trimmed();
-    result.confidence = confidence; // 使用从TSV解析的真实置信度
-
     emit ocrCompleted(result);
     return result;
 }
@@ -299,6 +379,7 @@ OCREngine::BatchOCRResult TesseractOCREngine::performBatchOCR(const QList<QImage
                                                               const QStringList &pageNames,
                                                               const QString &language)
 {
+    OCRMetrics::JobScope job;
     BatchOCRResult batchResult;
     batchResult.totalPages = images.size();
 
@@ -322,22 +403,38 @@ OCREngine::BatchOCRResult TesseractOCREngine::performBatchOCR(const QList<QImage
         actualPageNames.append(QString("页面 %1").arg(actualPageNames.size() + 1));
     }
 
-    QStringList allTexts;
-    QList<float> allConfidences;
+    // 页数较多时每个进程通过图像列表识别多页，只加载一次语言模型
+    if (shouldUseImageList(images.size())) {
+        batchResult = performImageListBatchOCR(images, actualPageNames, language, m_maxConcurrentPages);
+        emit batchOcrCompleted(batchResult);
+        return batchResult;
+    }
+
+    // 多页且允许并发时，同时运行多个tesseract进程
+    if (m_maxConcurrentPages > 1 && images.size() > 1) {
+        batchResult = performConcurrentBatchOCR(images, actualPageNames, language, m_maxConcurrentPages);
+        emit batchOcrCompleted(batchResult);
+        return batchResult;
+    }
+
+    QList<OCRResult> pageResults;
+    OCRBatchEstimator estimator(predictPageCosts(images, language), 1);
 
     // 逐页处理OCR
     for (int i = 0; i < images.size(); ++i) {
         const QImage &image = images[i];
-        const QString &pageName = actualPageNames[i];
 
         if (image.isNull()) {
             // 跳过空图像但记录错误
-            allTexts.append(QString("错误: 第%1页图像无效").arg(i + 1));
-            allConfidences.append(0.0f);
+            OCRResult invalidResult;
+            invalidResult.errorMessage = QString("第%1页图像无效").arg(i + 1);
+            pageResults.append(invalidResult);
 
             // 页面完成进度
             int overallProgress = ((i + 1) * 100) / images.size();
             emit batchProgressUpdated(overallProgress, i + 1, images.size(), 100);
+            estimator.pageFinished(i, false);
+            emit batchThroughputUpdated(estimator.pagesPerSecond(), estimator.remainingSeconds());
             continue;
         }
 
@@ -346,46 +443,17 @@ OCREngine::BatchOCRResult TesseractOCREngine::performBatchOCR(const QList<QImage
         emit batchProgressUpdated(baseProgress, i + 1, images.size(), 0);
 
         // 使用专门的批量OCR方法来处理单页，包含进度更新
-        OCRResult singleResult = performSinglePageOCRWithBatchProgress(image, language, i, images.size());
-
-        if (singleResult.success) {
-            allTexts.append(singleResult.text);
-            allConfidences.append(singleResult.confidence);
-            batchResult.processedPages++;
-        } else {
-            allTexts.append(QString("错误: %1").arg(singleResult.errorMessage));
-            allConfidences.append(0.0f);
-        }
+        pageResults.append(performSinglePageOCRWithBatchProgress(image, language, i, images.size()));
 
         // 页面完成进度
         int overallProgress = ((i + 1) * 100) / images.size();
         emit batchProgressUpdated(overallProgress, i + 1, images.size(), 100);
+        estimator.pageFinished(i);
+        emit batchThroughputUpdated(estimator.pagesPerSecond(), estimator.remainingSeconds());
     }
 
     // 设置批量结果
-    batchResult.texts = allTexts;
-    batchResult.pageNames = actualPageNames;
-    batchResult.confidences = allConfidences;
-    batchResult.success = batchResult.processedPages > 0;
-
-    // 组合所有文本
-    QStringList combinedParts;
-    for (int i = 0; i < allTexts.size(); ++i) {
-        if (!allTexts[i].isEmpty() && !allTexts[i].startsWith("错误:")) {
-            combinedParts.append(QString("=== %1 ===\n%2")
-                                .arg(actualPageNames[i])
-                                .arg(allTexts[i]));
-        }
-    }
-    batchResult.combinedText = combinedParts.join("\n\n");
-
-    if (batchResult.processedPages == 0) {
-        batchResult.errorMessage = "所有页面处理失败";
-    } else if (batchResult.processedPages < images.size()) {
-        batchResult.errorMessage = QString("部分页面处理失败: 成功 %1/%2 页")
-                                  .arg(batchResult.processedPages)
-                                  .arg(images.size());
-    }
+    finalizeBatchResult(batchResult, pageResults, actualPageNames);
 
     // 发送批量完成信号
     emit batchOcrCompleted(batchResult);
@@ -407,26 +475,11 @@ bool TesseractOCREngine::isAvailable() const
  */
 QStringList TesseractOCREngine::getSupportedLanguages() const
 {
-    QStringList languages;
-
-    // 通过tesseract --list-langs命令获取支持的语言
-    QProcess process;
-    process.start(m_tesseractPath, QStringList() << "--list-langs");
+    // 语言列表来自缓存的探测结果，只有tesseract或tessdata变化时才会重新执行--list-langs
+    QStringList languages = toolInfo().languages;
 
-    if (process.waitForFinished(5000)) {
-        QByteArray output = process.readAllStandardOutput();
-        QString outputStr = QString::fromUtf8(output);
-        QStringList lines = outputStr.split('\n', Qt::SkipEmptyParts);
-
-        // 跳过第一行（通常是"List of available languages (X):"）
-        for (int i = 1; i < lines.size(); ++i) {
-            QString lang = lines[i].trimmed();
-            if (!lang.isEmpty()) {
-                languages << lang;
-            }
-        }
-    } else {
-        // 如果无法获取，返回默认支持的语言
+    // 如果无法获取，返回默认支持的语言
+    if (languages.isEmpty()) {
         languages = s_languageMap.values();
     }
 
@@ -441,6 +494,7 @@ void TesseractOCREngine::setTesseractPath(const QString &path)
 {
     m_tesseractPath = path;
     m_initialized = false; // 重置初始化状态
+    invalidateWorkerPools();
 }
 
 /**
@@ -450,6 +504,7 @@ void TesseractOCREngine::setTesseractPath(const QString &path)
 void TesseractOCREngine::setTessDataPath(const QString &path)
 {
     m_tessDataPath = path;
+    invalidateWorkerPools(); // 预热进程使用的是旧的数据目录
 }
 
 /**
@@ -459,6 +514,7 @@ void TesseractOCREngine::setTessDataPath(const QString &path)
 void TesseractOCREngine::setOCREngineMode(int mode)
 {
     m_ocrEngineMode = qBound(0, mode, 13);
+    invalidateWorkerPools();
 }
 
 /**
@@ -468,21 +524,133 @@ void TesseractOCREngine::setOCREngineMode(int mode)
 void TesseractOCREngine::setPageSegmentationMode(int mode)
 {
     m_pageSegmentationMode = qBound(0, mode, 13);
+    invalidateWorkerPools();
+}
+
+/**
+ * @brief 设置批量识别时同时运行的最大页数
+ * @param count 并发页数，<=0表示按CPU核心数自动选择
+ */
+void TesseractOCREngine::setMaxConcurrentPages(int count)
+{
+    m_maxConcurrentPages = count > 0 ? count : QThread::idealThreadCount();
+    invalidateWorkerPools();
+}
+
+/**
+ * @brief 获取批量识别时同时运行的最大页数
+ * @return 并发页数
+ */
+int TesseractOCREngine::maxConcurrentPages() const
+{
+    return m_maxConcurrentPages;
+}
+
+/**
+ * @brief 设置使用图像列表模式的最少页数
+ * @param pages 最少页数，<=0表示禁用
+ */
+void TesseractOCREngine::setImageListMinPages(int pages)
+{
+    m_imageListMinPages = qMax(0, pages);
+}
+
+/**
+ * @brief 获取使用图像列表模式的最少页数
+ * @return 最少页数，0表示禁用
+ */
+int TesseractOCREngine::imageListMinPages() const
+{
+    return m_imageListMinPages;
 }
 
 /**
- * @brief 处理Tesseract进程完成信号（异步模式用）
+ * @brief 设置是否通过预热的工作进程池进行识别
+ * @param enabled 是否启用
  */
-void TesseractOCREngine::onTesseractFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void TesseractOCREngine::setUseWorkerPool(bool enabled)
 {
-    Q_UNUSED(exitCode)
-    Q_UNUSED(exitStatus)
+    m_useWorkerPool = enabled;
+    if (!enabled) {
+        invalidateWorkerPools();
+    }
+}
 
-    // 异步处理完成的逻辑可以在这里实现
-    if (m_processingAsync) {
-        m_processingAsync = false;
-        // 处理异步结果...
+/**
+ * @brief 为指定语言预先启动工作进程
+ * @param language 识别语言代码
+ */
+void TesseractOCREngine::prewarmWorkers(const QString &language)
+{
+    if (!m_useWorkerPool) {
+        return;
     }
+
+    // 预热异步任务线程中的进程池（界面通过异步接口识别）
+    QStringList arguments = buildTesseractArguments("stdin", "stdout", language);
+    m_asyncThreadPool->start([this, arguments]() {
+        currentWorkerPool()->prewarm(arguments);
+    });
+}
+
+/**
+ * @brief 是否通过预热的工作进程池进行识别
+ * @return 是否启用
+ */
+bool TesseractOCREngine::useWorkerPool() const
+{
+    return m_useWorkerPool;
+}
+
+/**
+ * @brief 异步执行批量OCR识别
+ * @param images 待识别的图像列表
+ * @param language 识别语言代码
+ * @return 按页面索引存放识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> TesseractOCREngine::submitBatch(const QList<QImage> &images,
+                                                              const QString &language)
+{
+    return QtConcurrent::run(m_asyncThreadPool, [this, images, language](QPromise<OCRResult> &promise) {
+        OCRMetrics::JobScope job;
+        promise.setProgressRange(0, images.size());
+
+        // 与performOCR相同：未初始化时先尝试初始化，失败时（initialize已发出errorOccurred）每页都报告原因
+        if (!m_initialized && !initialize()) {
+            OCRResult failedResult;
+            failedResult.errorMessage = m_lastError;
+            for (int i = 0; i < images.size(); ++i) {
+                promise.addResult(failedResult, i);
+            }
+            return;
+        }
+
+        QStringList pageNames;
+        for (int i = 0; i < images.size(); ++i) {
+            pageNames.append(QString("页面 %1").arg(i + 1));
+        }
+
+        if (shouldUseImageList(images.size())) {
+            performImageListBatchOCR(images, pageNames, language, m_maxConcurrentPages, &promise);
+        } else {
+            performConcurrentBatchOCR(images, pageNames, language, m_maxConcurrentPages, &promise);
+        }
+    });
+}
+
+/**
+ * @brief 获取影响识别结果的上下文描述
+ * @param language 识别语言代码
+ * @return 上下文字符串
+ */
+QString TesseractOCREngine::cacheContext(const QString &language) const
+{
+    QString tessDataDir = m_tessDataPath.isEmpty() ? m_resolvedTessDataPath : m_tessDataPath;
+    return QString("%1|%2|oem=%3|psm=%4|%5")
+        .arg(OCREngine::cacheContext(language), m_tesseractVersion)
+        .arg(m_ocrEngineMode)
+        .arg(m_pageSegmentationMode)
+        .arg(OCRResultCache::tessDataFingerprint(tessDataDir, language));
 }
 
 /**
@@ -522,28 +690,7 @@ void TesseractOCREngine::onTesseractError(QProcess::ProcessError error)
  */
 bool TesseractOCREngine::checkTesseractInstallation() const
 {
-    QProcess testProcess;
-
-    // 如果是bundled版本，设置正确的工作目录和环境
-    if (m_tesseractPath.contains("tesseract") && m_tesseractPath.contains("tesseract.exe")) {
-        QFileInfo tesseractFile(m_tesseractPath);
-        QString tesseractDir = tesseractFile.absolutePath();
-
-        // 设置工作目录（重要：DLL搜索路径）
-        testProcess.setWorkingDirectory(tesseractDir);
-
-        // 设置环境变量（清除可能冲突的系统配置）
-        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-        env.remove("TESSDATA_PREFIX");
-
-        // 添加当前目录到PATH，确保DLL能被找到
-        QString currentPath = env.value("PATH");
-        env.insert("PATH", tesseractDir + ";" + currentPath);
-        testProcess.setProcessEnvironment(env);
-    }
-
-    testProcess.start(m_tesseractPath, QStringList() << "--version");
-    return testProcess.waitForFinished(5000) && testProcess.exitCode() == 0;
+    return toolInfo().available;
 }
 
 /**
@@ -552,54 +699,31 @@ bool TesseractOCREngine::checkTesseractInstallation() const
  */
 QString TesseractOCREngine::getTesseractVersion()
 {
-    QProcess versionProcess;
-
-    // 如果是bundled版本，设置正确的工作目录和环境
-    if (m_tesseractPath.contains("tesseract") && m_tesseractPath.contains("tesseract.exe")) {
-        QFileInfo tesseractFile(m_tesseractPath);
-        QString tesseractDir = tesseractFile.absolutePath();
-
-        // 设置工作目录（重要：DLL搜索路径）
-        versionProcess.setWorkingDirectory(tesseractDir);
-
-        // 设置环境变量（清除可能冲突的系统配置）
-        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-        env.remove("TESSDATA_PREFIX");
-
-        // 添加当前目录到PATH，确保DLL能被找到
-        QString currentPath = env.value("PATH");
-        env.insert("PATH", tesseractDir + ";" + currentPath);
-        versionProcess.setProcessEnvironment(env);
-    }
-
-    versionProcess.start(m_tesseractPath, QStringList() << "--version");
-
-    if (versionProcess.waitForFinished(5000)) {
-        QByteArray output = versionProcess.readAllStandardOutput();
-        QString versionStr = QString::fromUtf8(output);
-
-        // 提取版本号（通常在第一行）
-        QStringList lines = versionStr.split('\n');
-        if (!lines.isEmpty()) {
-            return lines.first().trimmed();
-        }
-    }
+    return toolInfo().version;
+}
 
-    return QString();
+/**
+ * @brief 获取tesseract的探测信息
+ * @return 探测信息
+ */
+ToolRegistry::ToolInfo TesseractOCREngine::toolInfo() const
+{
+    return ToolRegistry::tesseract(m_tesseractPath, m_tessDataPath, [this](QProcess *process) {
+        configureTesseractProcess(process, false);
+    });
 }
 
 /**
  * @brief 保存图像到临时文件
  * @param image 要保存的图像
+ * @param pageIndex 页面索引
  * @return 临时文件路径
  */
-QString TesseractOCREngine::saveImageToTempFile(const QImage &image)
+QString TesseractOCREngine::saveImageToTempFile(const QImage &image, int pageIndex)
 {
-    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    QString tempFilePath = tempDir + "/ocr_temp_" +
-                          QString::number(QDateTime::currentMSecsSinceEpoch()) + ".png";
+    QString tempFilePath = createTempBaseName("ocr_temp") + ".png";
 
-    if (image.save(tempFilePath, "PNG")) {
+    if (encodeImageFile(image, tempFilePath, -1, pageIndex)) {
         m_tempFiles << tempFilePath;
         return tempFilePath;
     }
@@ -607,23 +731,6 @@ QString TesseractOCREngine::saveImageToTempFile(const QImage &image)
     return QString();
 }
 
-/**
- * @brief 从文件读取OCR结果
- * @param filePath 结果文件路径
- * @return 读取到的文本内容
- */
-QString TesseractOCREngine::readOCRResultFromFile(const QString &filePath)
-{
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return QString();
-    }
-
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Utf8);
-    return in.readAll();
-}
-
 /**
  * @brief 清理临时文件
  */
@@ -635,52 +742,6 @@ void TesseractOCREngine::cleanupTempFiles()
     m_tempFiles.clear();
 }
 
-float TesseractOCREngine::parseConfidenceFromTSV(const QString &tsvFilePath)
-{
-    QFile file(tsvFilePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return 0.8f; // 如果无法读取TSV文件，返回默认值
-    }
-
-    QTextStream in(&file);
-    QStringList lines = in.readAll().split('\n', Qt::SkipEmptyParts);
-
-    if (lines.size() <= 1) {
-        return 0.8f; // 没有数据行，返回默认值
-    }
-
-    // TSV格式：level page_num block_num par_num line_num word_num left top width height conf text
-    // 置信度在第11列（索引10）
-    float totalConfidence = 0.0f;
-    int wordCount = 0;
-
-    // 跳过第一行（标题行）
-    for (int i = 1; i < lines.size(); ++i) {
-        QStringList columns = lines[i].split('\t');
-
-        // 确保有足够的列且不是空行
-        if (columns.size() >= 11) {
-            bool ok;
-            float conf = columns[10].toFloat(&ok);
-
-            // 只处理有效的单词级别数据（level=5）且置信度>=0
-            if (ok && conf >= 0 && columns.size() > 11 && !columns[11].trimmed().isEmpty()) {
-                totalConfidence += conf;
-                wordCount++;
-            }
-        }
-    }
-
-    file.close();
-
-    if (wordCount > 0) {
-        // 返回平均置信度，转换为0-1范围
-        return totalConfidence / (wordCount * 100.0f);
-    }
-
-    return 0.8f; // 没有有效数据，返回默认值
-}
-
 /**
  * @brief 执行单页OCR识别（专用于批量处理，包含批量进度更新）
  * @param image 待识别的图像
@@ -710,57 +771,44 @@ OCREngine::OCRResult TesseractOCREngine::performSinglePageOCRWithBatchProgress(c
         return result;
     }
 
+    if (detectBlankPage(image, result)) {
+        return result;
+    }
+    QByteArray cacheKey = resultCacheKey(image, language);
+    if (lookupCachedResult(cacheKey, result)) {
+        return result;
+    }
+
+    // 通过预热进程识别，不经过临时文件
+    if (m_useWorkerPool) {
+        result = performPooledOCR(image, language, pageIndex, totalPages);
+        storeCachedResult(cacheKey, result);
+        return result;
+    }
+
     // 保存图像到临时文件
-    QString tempImagePath = saveImageToTempFile(image);
+    QString tempImagePath = saveImageToTempFile(image, pageIndex);
     if (tempImagePath.isEmpty()) {
         result.success = false;
         result.errorMessage = "无法保存临时图像文件";
         return result;
     }
 
-    // 准备输出文件路径
-    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    QString outputBaseName = tempDir + "/ocr_result_" + QString::number(QDateTime::currentMSecsSinceEpoch());
-    QString outputPath = outputBaseName + ".txt";
-    QString tsvOutputPath = outputBaseName + ".tsv";
-
-    // 准备Tesseract命令参数
-    QStringList arguments;
-    arguments << tempImagePath;                                    // 输入图像文件
-    arguments << outputBaseName;                                   // 输出文件基名（不含扩展名）
-    arguments << "-l" << language;                                 // 语言参数
-    arguments << "--oem" << QString::number(m_ocrEngineMode);      // OCR引擎模式
-    arguments << "--psm" << QString::number(m_pageSegmentationMode); // 页面分割模式
-    arguments << "txt" << "tsv";                                   // 同时输出txt和tsv格式
-
-    // 如果指定了tessdata路径，添加到参数中
-    if (!m_tessDataPath.isEmpty()) {
-        arguments << "--tessdata-dir" << m_tessDataPath;
-    }
-
-    // 设置bundled版本的工作目录和环境变量（用于DLL搜索）
-    if (m_tesseractPath.contains("tesseract") && m_tesseractPath.contains("tesseract.exe")) {
-        QString tesseractDir = QFileInfo(m_tesseractPath).absolutePath();
-        m_tesseractProcess->setWorkingDirectory(tesseractDir);
-
-        // 设置环境变量，确保DLL能被找到
-        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-        env.remove("TESSDATA_PREFIX");
-        QString currentPath = env.value("PATH");
-        env.insert("PATH", tesseractDir + ";" + currentPath);
-        m_tesseractProcess->setProcessEnvironment(env);
+    // 准备输出文件路径及命令参数
+    QString outputBaseName = createTempBaseName("ocr_result");
+    QStringList arguments = buildTesseractArguments(tempImagePath, outputBaseName, language);
+    configureTesseractProcess(m_tesseractProcess, false);
 
-        qDebug() << "设置Tesseract工作目录:" << tesseractDir;
-        qDebug() << "使用Tesseract路径:" << m_tesseractPath;
-    }
+    const qint64 predictedMs = OCRCostModel::predictMs(image.size(), language);
+    const int maxWaitTime = OCRCostModel::timeoutMs(image.size(), language);
+    QElapsedTimer timer;
+    timer.start();
 
     // 启动Tesseract进程并发送批量进度信号
     int currentProgress = (pageIndex * 100 + 10) / totalPages; // 10% 为启动进度
     emit batchProgressUpdated(currentProgress, pageIndex + 1, totalPages, 10);
 
-    m_tesseractProcess->start(m_tesseractPath, arguments);
-
-    if (!m_tesseractProcess->waitForStarted(5000)) {
+    if (!startTesseractProcess(m_tesseractProcess, m_tesseractPath, arguments, pageIndex)) {
         result.success = false;
         result.errorMessage = "无法启动Tesseract进程: " + m_tesseractProcess->errorString();
         cleanupTempFiles();
@@ -771,19 +819,17 @@ OCREngine::OCRResult TesseractOCREngine::performSinglePageOCRWithBatchProgress(c
     emit batchProgressUpdated(currentProgress, pageIndex + 1, totalPages, 20);
 
     // 等待进程完成，期间定期更新批量进度
-    int elapsedTime = 0;
-    const int maxWaitTime = 30000; // 30秒超时
     const int updateInterval = 500; // 每500毫秒更新一次进度
 
-    while (m_tesseractProcess->state() == QProcess::Running && elapsedTime < maxWaitTime) {
+    while (m_tesseractProcess->state() == QProcess::Running && timer.elapsed() < maxWaitTime) {
         m_tesseractProcess->waitForFinished(updateInterval);
-        elapsedTime += updateInterval;
 
         // 计算当前页面进度: 20% -> 75%
-        int pageProgress = 20 + (55 * elapsedTime) / maxWaitTime;
+        int pageProgress = OCRCostModel::estimateProgress(timer.elapsed(), predictedMs, 20, 75);
         currentProgress = (pageIndex * 100 + pageProgress) / totalPages;
         emit batchProgressUpdated(currentProgress, pageIndex + 1, totalPages, pageProgress);
     }
+    recordRecognize(timer.nsecsElapsed(), pageIndex);
 
     // 检查是否超时
     if (m_tesseractProcess->state() == QProcess::Running) {
@@ -808,30 +854,930 @@ OCREngine::OCRResult TesseractOCREngine::performSinglePageOCRWithBatchProgress(c
         return result;
     }
 
-    // 读取OCR结果
-    QString ocrText = readOCRResultFromFile(outputPath);
-    if (ocrText.isEmpty()) {
-        result.success = false;
-        result.errorMessage = "无法读取OCR结果文件";
-        cleanupTempFiles();
+    // 读取OCR结果（文本及从TSV解析的置信度），并清理输出文件
+    result = collectOutputFiles(outputBaseName, pageIndex);
+    cleanupTempFiles();
+    if (!result.success) {
         return result;
     }
 
-    // 从TSV文件解析置信度
-    float confidence = parseConfidenceFromTSV(tsvOutputPath);
-
-    // 清理临时文件
-    QFile::remove(tempImagePath);
-    QFile::remove(outputPath);
-    QFile::remove(tsvOutputPath);
+    OCRCostModel::record(image.size(), language, timer.elapsed());
+    storeCachedResult(cacheKey, result);
 
     currentProgress = (pageIndex * 100 + 100) / totalPages; // 100% 为完全完成
     emit batchProgressUpdated(currentProgress, pageIndex + 1, totalPages, 100);
 
-    // 设置结果
-    result.success = true;
-    result.text = ocrText.trimmed();
-    result.confidence = confidence;
-
     return result;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 多进程并发执行批量识别
+ *
+ * 每个页面使用独立的tesseract进程和唯一的临时文件名，最多同时运行
+ * m_maxConcurrentPages个进程。并发时按预测耗时从大到小启动页面，避免耗时长的页面
+ * 最后才开始而拖长整批时间。页面完成顺序不确定，但结果按页面索引存放，
+ * 最终仍按页面顺序返回。
+ * @param images 待识别的图像列表
+ * @param pageNames 页面名称列表（已补齐）
+ * @param language 识别语言代码
+ * @return 批量OCR识别结果
+ */
+OCREngine::BatchOCRResult TesseractOCREngine::performConcurrentBatchOCR(const QList<QImage> &images,
+                                                                        const QStringList &pageNames,
+                                                                        const QString &language,
+                                                                        int concurrency,
+                                                                        QPromise<OCRResult> *promise)
+{
+    BatchOCRResult batchResult;
+    batchResult.totalPages = images.size();
+
+    const int totalPages = images.size();
+    concurrency = qBound(1, concurrency, qMax(1, totalPages));
+    const int pollInterval = 100;   // 每轮轮询所有运行中进程的总等待时间
+
+    // 并发时耗时长的页面优先启动（最长处理时间优先），缩短整批完成时间
+    const QList<qint64> predictedCosts = predictPageCosts(images, language);
+    QList<int> pageOrder;
+    pageOrder.reserve(totalPages);
+    for (int i = 0; i < totalPages; ++i) {
+        pageOrder.append(i);
+    }
+    if (concurrency > 1) {
+        std::stable_sort(pageOrder.begin(), pageOrder.end(), [&](int a, int b) {
+            return predictedCosts[a] > predictedCosts[b];
+        });
+    }
+    OCRBatchEstimator estimator(predictedCosts, concurrency);
+
+    QList<OCRResult> pageResults;
+    pageResults.reserve(totalPages);
+    for (int i = 0; i < totalPages; ++i) {
+        pageResults.append(OCRResult());
+    }
+
+    QList<PageTask> runningTasks;
+    QList<QByteArray> cacheKeys;
+    cacheKeys.reserve(totalPages);
+    for (int i = 0; i < totalPages; ++i) {
+        cacheKeys.append(QByteArray());
+    }
+    int nextPage = 0;
+    int finishedPages = 0;
+
+    // 页面完成时按完成数量更新整体进度，异步模式下同时立即交付该页结果
+    auto reportPageFinished = [&](int pageIndex, bool measured) {
+        finishedPages++;
+        if (promise) {
+            promise->addResult(pageResults[pageIndex], pageIndex);
+            promise->setProgressValue(finishedPages);
+        }
+        emit batchProgressUpdated((finishedPages * 100) / totalPages, pageIndex + 1, totalPages, 100);
+        estimator.pageFinished(pageIndex, measured);
+        emit batchThroughputUpdated(estimator.pagesPerSecond(), estimator.remainingSeconds());
+    };
+
+    // 异步任务被取消或引擎正在析构
+    auto isCanceled = [&]() {
+        return (promise && promise->isCanceled()) || m_asyncShutdown.loadRelaxed();
+    };
+
+    while (finishedPages < totalPages) {
+        // 取消时立即终止所有运行中的进程，未完成的页面标记为已取消
+        if (isCanceled()) {
+            for (PageTask &task : runningTasks) {
+                abortPageTask(task);
+            }
+            runningTasks.clear();
+            for (int i = 0; i < totalPages; ++i) {
+                if (!pageResults[i].success && pageResults[i].errorMessage.isEmpty()) {
+                    pageResults[i].errorMessage = "识别已取消";
+                }
+            }
+            break;
+        }
+
+        // 补充新的页面任务直到达到并发上限
+        while (runningTasks.size() < concurrency && nextPage < totalPages) {
+            int pageIndex = pageOrder[nextPage++];
+
+            if (images[pageIndex].isNull()) {
+                pageResults[pageIndex].errorMessage = QString("第%1页图像无效").arg(pageIndex + 1);
+                reportPageFinished(pageIndex, false);
+                continue;
+            }
+
+            // 空白页和缓存命中的页面不占用进程
+            if (detectBlankPage(images[pageIndex], pageResults[pageIndex])) {
+                reportPageFinished(pageIndex, false);
+                continue;
+            }
+            cacheKeys[pageIndex] = resultCacheKey(images[pageIndex], language);
+            if (lookupCachedResult(cacheKeys[pageIndex], pageResults[pageIndex])) {
+                reportPageFinished(pageIndex, false);
+                continue;
+            }
+
+            PageTask task;
+            task.pageIndex = pageIndex;
+            if (!startPageTask(task, images[pageIndex], language, true)) {
+                pageResults[pageIndex].errorMessage = m_lastError;
+                reportPageFinished(pageIndex, false);
+                continue;
+            }
+
+            emit batchProgressUpdated((finishedPages * 100) / totalPages, pageIndex + 1, totalPages, 20);
+            runningTasks.append(task);
+        }
+
+        if (runningTasks.isEmpty()) {
+            continue;
+        }
+
+        // 轮流等待各进程，等待时间平均分配，任一进程结束或取消请求都能及时被处理
+        const int waitSlice = qMax(1, pollInterval / runningTasks.size());
+        for (int i = runningTasks.size() - 1; i >= 0; --i) {
+            PageTask &task = runningTasks[i];
+            task.process->waitForFinished(waitSlice);
+
+            if (task.process->state() == QProcess::NotRunning) {
+                // 预热进程崩溃时换一个新进程重试该页
+                if (shouldRetryPageTask(task)) {
+                    PageTask retryTask;
+                    retryTask.pageIndex = task.pageIndex;
+                    retryTask.attempts = task.attempts;
+                    abortPageTask(task);
+                    if (startPageTask(retryTask, images[retryTask.pageIndex], language, true)) {
+                        runningTasks[i] = retryTask;
+                        continue;
+                    }
+                    pageResults[retryTask.pageIndex].errorMessage = m_lastError;
+                    reportPageFinished(retryTask.pageIndex, false);
+                    runningTasks.removeAt(i);
+                    continue;
+                }
+
+                const qint64 elapsedMs = task.timer.elapsed();
+                pageResults[task.pageIndex] = finishPageTask(task);
+                if (pageResults[task.pageIndex].success) {
+                    OCRCostModel::record(images[task.pageIndex].size(), language, elapsedMs);
+                }
+                storeCachedResult(cacheKeys[task.pageIndex], pageResults[task.pageIndex]);
+                reportPageFinished(task.pageIndex, true);
+                runningTasks.removeAt(i);
+            } else if (task.timer.elapsed() > OCRCostModel::timeoutMs(images[task.pageIndex].size(), language)) {
+                abortPageTask(task);
+                pageResults[task.pageIndex].errorMessage = "Tesseract处理超时";
+                reportPageFinished(task.pageIndex, true);
+                runningTasks.removeAt(i);
+            }
+        }
+    }
+
+    finalizeBatchResult(batchResult, pageResults, pageNames);
+    return batchResult;
+}
+
+/**
+ * @brief 是否对指定页数使用图像列表模式
+ * @param pageCount 页数
+ * @return 是否使用
+ */
+bool TesseractOCREngine::shouldUseImageList(int pageCount) const
+{
+    // 工作进程池中的进程已经加载了语言模型，页面经标准输入传递，不再写临时PNG和列表文件
+    if (m_useWorkerPool) {
+        return false;
+    }
+    return m_imageListMinPages > 0 && pageCount >= qMax(2, m_imageListMinPages);
+}
+
+/**
+ * @brief 图像列表模式执行批量识别
+ *
+ * 与逐页启动进程相比，每个进程只加载一次语言模型。tesseract按列表顺序识别，
+ * TSV结果写到标准输出，每输出完一页就交付该页结果并更新进度。
+ * @param images 待识别的图像列表
+ * @param pageNames 页面名称列表（已补齐）
+ * @param language 识别语言代码
+ * @param concurrency 同时运行的最大进程数
+ * @param promise 异步任务（可为空）
+ * @return 批量OCR识别结果
+ */
+OCREngine::BatchOCRResult TesseractOCREngine::performImageListBatchOCR(const QList<QImage> &images,
+                                                                       const QStringList &pageNames,
+                                                                       const QString &language,
+                                                                       int concurrency,
+                                                                       QPromise<OCRResult> *promise)
+{
+    BatchOCRResult batchResult;
+    batchResult.totalPages = images.size();
+
+    const int totalPages = images.size();
+    const int pollInterval = 100;   // 每轮轮询所有运行中进程的总等待时间
+    const QList<qint64> predictedCosts = predictPageCosts(images, language);
+
+    QList<OCRResult> pageResults;
+    QList<QByteArray> cacheKeys;
+    pageResults.reserve(totalPages);
+    cacheKeys.reserve(totalPages);
+    for (int i = 0; i < totalPages; ++i) {
+        pageResults.append(OCRResult());
+        cacheKeys.append(QByteArray());
+    }
+    int finishedPages = 0;
+
+    OCRBatchEstimator estimator(predictedCosts, qBound(1, concurrency, qMax(1, totalPages / 2)));
+
+    // 页面完成时按完成数量更新整体进度，异步模式下同时立即交付该页结果
+    auto reportPageFinished = [&](int pageIndex, bool measured) {
+        finishedPages++;
+        if (promise) {
+            promise->addResult(pageResults[pageIndex], pageIndex);
+            promise->setProgressValue(finishedPages);
+        }
+        emit batchProgressUpdated((finishedPages * 100) / totalPages, pageIndex + 1, totalPages, 100);
+        estimator.pageFinished(pageIndex, measured);
+        emit batchThroughputUpdated(estimator.pagesPerSecond(), estimator.remainingSeconds());
+    };
+
+    // 异步任务被取消或引擎正在析构
+    auto isCanceled = [&]() {
+        return (promise && promise->isCanceled()) || m_asyncShutdown.loadRelaxed();
+    };
+
+    // 无效页面、空白页和缓存命中的页面直接完成，其余页面进入列表
+    QList<int> pendingPages;
+    for (int i = 0; i < totalPages; ++i) {
+        if (images[i].isNull()) {
+            pageResults[i].errorMessage = QString("第%1页图像无效").arg(i + 1);
+            reportPageFinished(i, false);
+            continue;
+        }
+
+        if (detectBlankPage(images[i], pageResults[i])) {
+            reportPageFinished(i, false);
+            continue;
+        }
+        cacheKeys[i] = resultCacheKey(images[i], language);
+        if (lookupCachedResult(cacheKeys[i], pageResults[i])) {
+            reportPageFinished(i, false);
+            continue;
+        }
+
+        pendingPages.append(i);
+    }
+
+    // 每个进程至少处理两页以分摊模型加载时间
+    const int listCount = qBound(1, concurrency, qMax(1, pendingPages.size() / 2));
+
+    // 按预测耗时从大到小把页面分给当前总耗时最小的列表，使各进程大致同时结束；
+    // 列表内仍按页面顺序识别
+    QList<QList<int>> lists(listCount);
+    QList<qint64> listCosts(listCount, 0);
+    std::stable_sort(pendingPages.begin(), pendingPages.end(), [&](int a, int b) {
+        return predictedCosts[a] > predictedCosts[b];
+    });
+    for (int pageIndex : pendingPages) {
+        const int list = static_cast<int>(std::min_element(listCosts.begin(), listCosts.end()) - listCosts.begin());
+        lists[list].append(pageIndex);
+        listCosts[list] += predictedCosts[pageIndex];
+    }
+
+    QList<ImageListTask> runningTasks;
+    for (QList<int> &pages : lists) {
+        if (pages.isEmpty() || isCanceled()) {
+            continue;
+        }
+
+        ImageListTask task;
+        std::sort(pages.begin(), pages.end());
+        task.pageIndices = pages;
+        if (!startImageListTask(task, images, language, listCount > 1)) {
+            for (int pageIndex : task.pageIndices) {
+                pageResults[pageIndex].errorMessage = m_lastError;
+                reportPageFinished(pageIndex, false);
+            }
+            continue;
+        }
+
+        emit batchProgressUpdated((finishedPages * 100) / totalPages, task.pageIndices.first() + 1, totalPages, 20);
+        runningTasks.append(task);
+    }
+
+    // 未交付的页面统一标记为失败
+    auto failUndeliveredPages = [&](const ImageListTask &task, const QString &errorMessage) {
+        for (int i = task.deliveredPages; i < task.pageIndices.size(); ++i) {
+            pageResults[task.pageIndices[i]].errorMessage = errorMessage;
+            reportPageFinished(task.pageIndices[i], false);
+        }
+    };
+
+    while (!runningTasks.isEmpty()) {
+        // 取消时立即终止所有运行中的进程，已输出完整的页面保留结果
+        if (isCanceled()) {
+            for (ImageListTask &task : runningTasks) {
+                for (const ListPageResult &page : takeFinishedListPages(task, false)) {
+                    pageResults[page.pageIndex] = page.result;
+                    storeCachedResult(cacheKeys[page.pageIndex], page.result);
+                }
+                cleanupImageListTask(task);
+                for (int i = task.deliveredPages; i < task.pageIndices.size(); ++i) {
+                    pageResults[task.pageIndices[i]].errorMessage = "识别已取消";
+                }
+            }
+            runningTasks.clear();
+            break;
+        }
+
+        // 轮流等待各进程，等待期间QProcess会读取标准输出
+        const int waitSlice = qMax(1, pollInterval / runningTasks.size());
+        for (int i = runningTasks.size() - 1; i >= 0; --i) {
+            ImageListTask &task = runningTasks[i];
+            task.process->waitForFinished(waitSlice);
+
+            const bool stopped = task.process->state() == QProcess::NotRunning;
+            const bool succeeded = stopped && task.process->exitStatus() == QProcess::NormalExit
+                                   && task.process->exitCode() == 0;
+
+            for (const ListPageResult &page : takeFinishedListPages(task, succeeded)) {
+                pageResults[page.pageIndex] = page.result;
+                if (page.result.success) {
+                    // 首页耗时包含模型加载，之后的页面只有识别时间
+                    OCRCostModel::record(images[page.pageIndex].size(), language, page.elapsedMs,
+                                         page.pageIndex == task.pageIndices.first());
+                }
+                storeCachedResult(cacheKeys[page.pageIndex], page.result);
+                reportPageFinished(page.pageIndex, true);
+            }
+
+            if (stopped) {
+                if (!succeeded) {
+                    failUndeliveredPages(task, "Tesseract执行失败: " +
+                                               QString::fromUtf8(task.process->readAllStandardError()));
+                } else {
+                    failUndeliveredPages(task, "无法解析OCR结果");
+                }
+                cleanupImageListTask(task);
+                runningTasks.removeAt(i);
+            } else if (task.idleTimer.elapsed() > OCRCostModel::timeoutMs(
+                           images[task.pageIndices[qMin(task.deliveredPages, task.pageIndices.size() - 1)]].size(),
+                           language)) {
+                cleanupImageListTask(task);
+                failUndeliveredPages(task, "Tesseract处理超时");
+                runningTasks.removeAt(i);
+            }
+        }
+    }
+
+    finalizeBatchResult(batchResult, pageResults, pageNames);
+    return batchResult;
+}
+
+/**
+ * @brief 写入列表中的页面图像和列表文件，并启动tesseract进程
+ * @param task 列表任务
+ * @param images 全部页面图像
+ * @param language 识别语言代码
+ * @param singleThreaded 是否限制tesseract内部线程数
+ * @return 进程是否成功启动
+ */
+bool TesseractOCREngine::startImageListTask(ImageListTask &task, const QList<QImage> &images,
+                                            const QString &language, bool singleThreaded)
+{
+    QString baseName = createTempBaseName("ocr_list");
+    task.listPath = baseName + ".txt";
+
+    // 每页图像只写一次，列表文件每行一个路径
+    QByteArray listData;
+    for (int i = 0; i < task.pageIndices.size(); ++i) {
+        QString imagePath = QString("%1_%2.png").arg(baseName).arg(i + 1);
+        task.imagePaths.append(imagePath);
+
+        // 临时文件很快就会被删除，使用不压缩的PNG以节省编码时间
+        if (!encodeImageFile(images[task.pageIndices[i]], imagePath, 100, task.pageIndices[i])) {
+            m_lastError = "无法保存临时图像文件";
+            cleanupImageListTask(task);
+            return false;
+        }
+        listData += QDir::toNativeSeparators(imagePath).toUtf8() + '\n';
+    }
+
+    QFile listFile(task.listPath);
+    if (!listFile.open(QIODevice::WriteOnly) || listFile.write(listData) != listData.size()) {
+        m_lastError = "无法写入图像列表文件";
+        cleanupImageListTask(task);
+        return false;
+    }
+    listFile.close();
+
+    task.process = new QProcess();
+    configureTesseractProcess(task.process, singleThreaded);
+    if (!startTesseractProcess(task.process, m_tesseractPath,
+                               buildTesseractArguments(task.listPath, "stdout", language))) {
+        m_lastError = "无法启动Tesseract进程: " + task.process->errorString();
+        cleanupImageListTask(task);
+        return false;
+    }
+
+    task.idleTimer.start();
+    return true;
+}
+
+/**
+ * @brief 读取列表任务的标准输出，返回其中已完整输出的页面
+ * @param task 列表任务
+ * @param finished 进程是否已正常结束
+ * @return 已完成页面的(页面索引, 识别结果)列表
+ */
+QList<TesseractOCREngine::ListPageResult> TesseractOCREngine::takeFinishedListPages(ImageListTask &task,
+                                                                                    bool finished)
+{
+    QList<ListPageResult> finishedPages;
+
+    // 当前页输出完整，交付结果
+    auto completeCurrentPage = [&]() {
+        const int position = task.currentPage - 1;
+        if (position >= task.deliveredPages && position < task.pageIndices.size()) {
+            // 列表中间的页面没有任何输出时（如图像读取失败），按失败处理
+            while (task.deliveredPages < position) {
+                ListPageResult missingPage;
+                missingPage.pageIndex = task.pageIndices[task.deliveredPages++];
+                missingPage.result.errorMessage = "Tesseract未输出该页结果";
+                missingPage.elapsedMs = 0;
+                finishedPages.append(missingPage);
+            }
+
+            ListPageResult page;
+            page.pageIndex = task.pageIndices[position];
+            recordRecognize(task.idleTimer.nsecsElapsed(), page.pageIndex);
+            page.result = parseTSVOutput(task.pageOutput, page.pageIndex);
+            page.elapsedMs = task.idleTimer.restart();
+            finishedPages.append(page);
+            task.deliveredPages = position + 1;
+        }
+        task.pageOutput.clear();
+    };
+
+    if (task.process) {
+        task.pendingOutput += task.process->readAllStandardOutput();
+    }
+
+    // 只处理完整的行，不完整的行留到下次读取
+    qsizetype lineStart = 0;
+    qsizetype lineEnd;
+    while ((lineEnd = task.pendingOutput.indexOf('\n', lineStart)) >= 0) {
+        QByteArrayView line(task.pendingOutput.constData() + lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        // 前两列为level和page_num；表头行不是数字，直接跳过
+        const qsizetype firstTab = line.indexOf('\t');
+        const qsizetype secondTab = firstTab < 0 ? -1 : line.indexOf('\t', firstTab + 1);
+        if (secondTab < 0) {
+            continue;
+        }
+        bool levelOk = false;
+        bool pageOk = false;
+        const int level = line.first(firstTab).toInt(&levelOk);
+        const int page = line.sliced(firstTab + 1, secondTab - firstTab - 1).toInt(&pageOk);
+        if (!levelOk || !pageOk) {
+            continue;
+        }
+
+        // 新页面的第一行意味着上一页已经输出完整
+        if (level == 1 && page != task.currentPage) {
+            if (task.currentPage > 0) {
+                completeCurrentPage();
+            }
+            task.currentPage = page;
+        }
+        task.pageOutput.append(line.data(), line.size());
+        task.pageOutput.append('\n');
+    }
+    task.pendingOutput.remove(0, lineStart);
+
+    if (finished && task.currentPage > 0) {
+        completeCurrentPage();
+        task.currentPage = 0;
+    }
+
+    return finishedPages;
+}
+
+/**
+ * @brief 终止列表任务（如仍在运行）并清理其临时文件
+ * @param task 列表任务
+ */
+void TesseractOCREngine::cleanupImageListTask(ImageListTask &task)
+{
+    if (task.process) {
+        if (task.process->state() != QProcess::NotRunning) {
+            task.process->kill();
+            task.process->waitForFinished(3000);
+        }
+        delete task.process;
+        task.process = nullptr;
+    }
+
+    for (const QString &imagePath : task.imagePaths) {
+        QFile::remove(imagePath);
+    }
+    QFile::remove(task.listPath);
+}
+
+/**
+ * @brief 为页面启动独立的tesseract进程
+ * @param task 页面任务
+ * @param image 页面图像
+ * @param language 识别语言代码
+ * @param singleThreaded 是否限制tesseract内部线程数
+ * @return 进程是否成功启动
+ */
+bool TesseractOCREngine::startPageTask(PageTask &task, const QImage &image,
+                                       const QString &language, bool singleThreaded)
+{
+    task.attempts++;
+
+    // 工作进程池模式：图像编码后直接写入预热进程的标准输入
+    if (m_useWorkerPool) {
+        task.streamed = true;
+        TesseractWorkerPool *workerPool = currentWorkerPool();
+        task.process = workerPool->acquire(buildTesseractArguments("stdin", "stdout", language));
+        if (!task.process) {
+            m_lastError = workerPool->lastError();
+            return false;
+        }
+
+        // 管道传输不在乎体积，使用不压缩的PNG以节省编码时间
+        QByteArray imageData;
+        QBuffer buffer(&imageData);
+        buffer.open(QIODevice::WriteOnly);
+        bool encoded;
+        {
+            OCRMetrics::ScopedTimer encodeTimer("encode_image", task.pageIndex);
+            encoded = image.save(&buffer, "PNG", 100);
+        }
+        if (!encoded) {
+            m_lastError = "无法编码图像数据";
+            abortPageTask(task);
+            return false;
+        }
+        OCRMetrics::increment("bytes_encoded", imageData.size());
+
+        task.process->write(imageData);
+        task.process->closeWriteChannel();
+        task.timer.start();
+        return true;
+    }
+
+    QString baseName = createTempBaseName("ocr_page");
+    task.imagePath = baseName + ".png";
+    task.outputBase = baseName;
+
+    if (!encodeImageFile(image, task.imagePath, -1, task.pageIndex)) {
+        m_lastError = "无法保存临时图像文件";
+        return false;
+    }
+
+    task.process = new QProcess();
+    configureTesseractProcess(task.process, singleThreaded);
+    if (!startTesseractProcess(task.process, m_tesseractPath,
+                               buildTesseractArguments(task.imagePath, task.outputBase, language),
+                               task.pageIndex)) {
+        m_lastError = "无法启动Tesseract进程: " + task.process->errorString();
+        abortPageTask(task);
+        return false;
+    }
+
+    task.timer.start();
+    return true;
+}
+
+/**
+ * @brief 收集已结束页面任务的结果并清理其临时文件
+ * @param task 页面任务
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractOCREngine::finishPageTask(PageTask &task)
+{
+    recordRecognize(task.timer.nsecsElapsed(), task.pageIndex);
+    OCRResult result;
+
+    if (task.process->exitStatus() != QProcess::NormalExit || task.process->exitCode() != 0) {
+        result.errorMessage = "Tesseract执行失败: " +
+                              QString::fromUtf8(task.process->readAllStandardError());
+    } else if (task.streamed) {
+        result = parseTSVOutput(task.process->readAllStandardOutput(), task.pageIndex);
+    } else {
+        result = collectOutputFiles(task.outputBase, task.pageIndex);
+    }
+
+    if (task.streamed) {
+        delete task.process;
+        task.process = nullptr;
+        return result;
+    }
+
+    QFile::remove(task.imagePath);
+    QFile::remove(task.outputBase + ".tsv");
+    delete task.process;
+    task.process = nullptr;
+    return result;
+}
+
+/**
+ * @brief 终止页面任务并清理其临时文件
+ * @param task 页面任务
+ */
+void TesseractOCREngine::abortPageTask(PageTask &task)
+{
+    if (task.process) {
+        if (task.process->state() != QProcess::NotRunning) {
+            task.process->kill();
+            task.process->waitForFinished(3000);
+        }
+        delete task.process;
+        task.process = nullptr;
+    }
+
+    if (task.streamed) {
+        return;
+    }
+
+    QFile::remove(task.imagePath);
+    QFile::remove(task.outputBase + ".tsv");
+}
+
+/**
+ * @brief 生成全局唯一的临时文件基名
+ * @param prefix 文件名前缀
+ * @return 临时目录下的文件基名（不含扩展名）
+ */
+QString TesseractOCREngine::createTempBaseName(const QString &prefix)
+{
+    static QAtomicInteger<quint64> s_sequence(0);
+
+    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    return QString("%1/%2_%3_%4_%5")
+        .arg(tempDir, prefix)
+        .arg(QCoreApplication::applicationPid())
+        .arg(QDateTime::currentMSecsSinceEpoch())
+        .arg(s_sequence.fetchAndAddRelaxed(1));
+}
+
+/**
+ * @brief 构造tesseract命令行参数
+ * @param inputPath 输入图像路径
+ * @param outputBase 输出文件基名
+ * @param language 识别语言代码
+ * @return 参数列表
+ */
+QStringList TesseractOCREngine::buildTesseractArguments(const QString &inputPath,
+                                                        const QString &outputBase,
+                                                        const QString &language) const
+{
+    QStringList arguments;
+    arguments << inputPath;                                        // 输入图像文件
+    arguments << outputBase;                                       // 输出文件基名（不含扩展名）
+    arguments << "-l" << language;                                 // 语言参数
+    arguments << "--oem" << QString::number(m_ocrEngineMode);      // OCR引擎模式
+    arguments << "--psm" << QString::number(m_pageSegmentationMode); // 页面分割模式
+
+    // 如果指定了tessdata路径，添加到参数中
+    if (!m_tessDataPath.isEmpty()) {
+        arguments << "--tessdata-dir" << m_tessDataPath;
+    }
+
+    // 只输出TSV格式，纯文本由版面结构重建
+    arguments << "tsv";
+
+    return arguments;
+}
+
+/**
+ * @brief 为bundled版本设置工作目录和环境变量
+ * @param process 待启动的进程
+ * @param singleThreaded 是否将OpenMP线程数限制为1
+ */
+void TesseractOCREngine::configureTesseractProcess(QProcess *process, bool singleThreaded) const
+{
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    bool customEnvironment = false;
+
+    // 设置bundled版本的工作目录和环境变量（支持虚拟化环境）
+    if (m_tesseractPath.contains("tesseract") && m_tesseractPath.contains("tesseract.exe")) {
+        QString tesseractDir = QFileInfo(m_tesseractPath).absolutePath();
+
+        // 确保目录存在
+        if (QDir(tesseractDir).exists()) {
+            process->setWorkingDirectory(tesseractDir);
+        }
+
+        // 清除可能干扰的环境变量并添加tesseract目录到PATH，确保DLL能被找到
+        env.remove("TESSDATA_PREFIX");
+        env.insert("PATH", tesseractDir + ";" + env.value("PATH"));
+        customEnvironment = true;
+    }
+
+    // 多个进程并发时，每个进程只用一个线程，避免OpenMP线程数超过CPU核心数
+    if (singleThreaded) {
+        env.insert("OMP_THREAD_LIMIT", "1");
+        customEnvironment = true;
+    }
+
+    if (customEnvironment) {
+        process->setProcessEnvironment(env);
+    }
+}
+
+/**
+ * @brief 读取输出的tsv文件生成识别结果，并删除该文件
+ * @param outputBase 输出文件基名
+ * @param pageIndex 页面索引
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractOCREngine::collectOutputFiles(const QString &outputBase, int pageIndex)
+{
+    OCRResult result;
+    QString tsvOutputPath = outputBase + ".tsv";
+
+    QFile tsvFile(tsvOutputPath);
+    if (!tsvFile.open(QIODevice::ReadOnly)) {
+        result.success = false;
+        result.errorMessage = "无法读取OCR结果文件";
+        return result;
+    }
+
+    QByteArray tsvData;
+    {
+        OCRMetrics::ScopedTimer readTimer("read_output", pageIndex);
+        tsvData = tsvFile.readAll();
+    }
+    tsvFile.close();
+    result = parseTSVOutput(tsvData, pageIndex);
+
+    QFile::remove(tsvOutputPath);
+    return result;
+}
+
+/**
+ * @brief 通过预热进程识别单页，支持崩溃重试和超时
+ * @param image 待识别的图像
+ * @param language 识别语言代码
+ * @param pageIndex 批量处理中的页面索引，-1表示单页识别
+ * @param totalPages 批量处理的总页面数
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractOCREngine::performPooledOCR(const QImage &image, const QString &language,
+                                                          int pageIndex, int totalPages)
+{
+    OCRResult result;
+    const qint64 predictedMs = OCRCostModel::predictMs(image.size(), language);
+    const int maxWaitTime = OCRCostModel::timeoutMs(image.size(), language);
+    const int updateInterval = 500; // 每500毫秒更新一次进度
+
+    // 单页识别发送progressUpdated，批量识别发送batchProgressUpdated
+    auto reportProgress = [&](int pageProgress) {
+        if (pageIndex < 0) {
+            emit progressUpdated(pageProgress);
+        } else {
+            int overallProgress = (pageIndex * 100 + pageProgress) / totalPages;
+            emit batchProgressUpdated(overallProgress, pageIndex + 1, totalPages, pageProgress);
+        }
+    };
+
+    PageTask task;
+    task.pageIndex = qMax(0, pageIndex);
+
+    while (true) {
+        reportProgress(10);
+        if (!startPageTask(task, image, language, false)) {
+            result.success = false;
+            result.errorMessage = m_lastError;
+            reportProgress(100);
+            return result;
+        }
+        reportProgress(20);
+
+        while (task.process->state() == QProcess::Running && task.timer.elapsed() < maxWaitTime) {
+            task.process->waitForFinished(updateInterval);
+
+            // 计算进度: 20% -> 75% 根据已用时间与预测耗时之比
+            reportProgress(OCRCostModel::estimateProgress(task.timer.elapsed(), predictedMs, 20, 75));
+        }
+
+        // 检查是否超时
+        if (task.process->state() != QProcess::NotRunning) {
+            abortPageTask(task);
+            result.success = false;
+            result.errorMessage = "Tesseract处理超时";
+            reportProgress(100);
+            return result;
+        }
+
+        if (!shouldRetryPageTask(task)) {
+            break;
+        }
+
+        // 预热进程崩溃，换新进程重试
+        qDebug() << "Tesseract工作进程异常退出，正在重试第" << task.pageIndex + 1 << "页";
+        abortPageTask(task);
+    }
+
+    reportProgress(80);
+    const qint64 elapsedMs = task.timer.elapsed();
+    result = finishPageTask(task);
+    if (result.success) {
+        OCRCostModel::record(image.size(), language, elapsedMs);
+    }
+    // 失败的页面同样结束，批量识别的总进度不停留在该页
+    reportProgress(100);
+    return result;
+}
+
+/**
+ * @brief 判断页面任务是否因工作进程崩溃而失败且可以重试
+ * @param task 已结束的页面任务
+ * @return 是否应重试
+ */
+bool TesseractOCREngine::shouldRetryPageTask(const PageTask &task) const
+{
+    return task.streamed && task.attempts < 2 &&
+           task.process->exitStatus() == QProcess::CrashExit;
+}
+
+/**
+ * @brief 从tesseract输出的TSV数据生成识别结果
+ *
+ * 单次扫描TSV构建版面结构，纯文本由版面结构重建（与tesseract的txt输出格式一致），
+ * 置信度为所有单词置信度的平均值。
+ * @param tsvData TSV格式数据
+ * @param pageIndex 页面索引
+ * @return OCR识别结果
+ */
+OCREngine::OCRResult TesseractOCREngine::parseTSVOutput(const QByteArray &tsvData, int pageIndex)
+{
+    OCRMetrics::ScopedTimer parseTimer("parse_tsv", pageIndex);
+    OCRResult result;
+
+    bool ok = false;
+    result.layout = OCRLayout::fromTSV(tsvData, &ok);
+    if (!ok) {
+        result.success = false;
+        result.errorMessage = "无法解析OCR结果";
+        result.layout = OCRLayout();
+        return result;
+    }
+
+    result.success = true;
+    result.text = result.layout.text();
+    result.confidence = result.layout.meanConfidence();
+    OCRMetrics::increment("pages_recognized");
+    return result;
+}
+
+/**
+ * @brief 更新工作进程池的启动配置
+ * @param pool 要配置的工作进程池
+ */
+void TesseractOCREngine::updateWorkerPoolConfiguration(TesseractWorkerPool *pool)
+{
+    // 并发识别时每个工作进程限制为单线程
+    const bool singleThreaded = m_maxConcurrentPages > 1;
+    pool->setProgram(m_tesseractPath, [this, singleThreaded](QProcess *process) {
+        configureTesseractProcess(process, singleThreaded);
+    });
+    // 每个预热进程都常驻一份语言模型，只保留少量备用进程，批量时不足的部分按需冷启动
+    pool->setWarmWorkerCount(qMin(2, m_maxConcurrentPages));
+}
+
+/**
+ * @brief 识别参数改变后使所有工作进程池失效
+ */
+void TesseractOCREngine::invalidateWorkerPools()
+{
+    // 本线程的进程池立即重新配置；异步线程的进程池在下次使用时按版本号重新配置
+    updateWorkerPoolConfiguration(m_workerPool);
+    m_workerPoolGeneration.fetchAndAddRelaxed(1);
+}
+
+/**
+ * @brief 获取当前线程使用的工作进程池
+ * @return 工作进程池
+ */
+TesseractWorkerPool *TesseractOCREngine::currentWorkerPool()
+{
+    if (QThread::currentThread() == thread()) {
+        return m_workerPool;
+    }
+
+    // 异步任务线程：首次使用时创建，配置版本变化时重新配置
+    if (!m_asyncWorkerPool) {
+        m_asyncWorkerPool = new TesseractWorkerPool();
+    }
+    const int generation = m_workerPoolGeneration.loadRelaxed();
+    if (m_asyncWorkerPoolGeneration != generation) {
+        updateWorkerPoolConfiguration(m_asyncWorkerPool);
+        m_asyncWorkerPoolGeneration = generation;
+    }
+    return m_asyncWorkerPool;
+}
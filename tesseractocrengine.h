@@ -2,9 +2,14 @@
 #define TESSERACTOCRENGINE_H
 
 #include "ocrengine.h"
+#include "tesseractworkerpool.h"
+#include "toolregistry.h"
 #include <QProcess>
 #include <QTemporaryFile>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QAtomicInt>
 
 /**
  * @brief Tesseract OCR引擎实现类
@@ -31,6 +36,14 @@ public:
     bool isAvailable() const override;
     QStringList getSupportedLanguages() const override;
 
+    /**
+     * @brief 异步执行批量OCR识别
+     *
+     * 所有异步任务在引擎专用的后台线程中依次执行，页面仍按maxConcurrentPages并发识别。
+     * 取消时会立即终止正在运行的tesseract进程。
+     */
+    QFuture<OCRResult> submitBatch(const QList<QImage> &images, const QString &language = "chi_sim+eng") override;
+
     /**
      * @brief 设置Tesseract可执行文件路径
      * @param path Tesseract可执行文件的完整路径
@@ -55,12 +68,62 @@ public:
      */
     void setPageSegmentationMode(int mode);
 
-private slots:
     /**
-     * @brief 处理Tesseract进程完成信号
+     * @brief 设置批量识别时同时运行的最大页数
+     * @param count 并发页数，<=0表示按CPU核心数自动选择，1表示逐页串行处理
      */
-    void onTesseractFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void setMaxConcurrentPages(int count);
 
+    /**
+     * @brief 获取批量识别时同时运行的最大页数
+     * @return 并发页数
+     */
+    int maxConcurrentPages() const;
+
+    /**
+     * @brief 设置使用图像列表模式的最少页数
+     *
+     * 页数达到该值时，批量识别把页面图像写入临时目录并生成列表文件，每个tesseract进程
+     * 通过一次调用识别列表中的多个页面，语言模型只加载一次；结果从标准输出的TSV中
+     * 按page_num列拆分回各页，每识别完一页即更新进度。
+     * @param pages 最少页数，<=0表示禁用图像列表模式
+     */
+    void setImageListMinPages(int pages);
+
+    /**
+     * @brief 获取使用图像列表模式的最少页数
+     * @return 最少页数，0表示禁用
+     */
+    int imageListMinPages() const;
+
+    /**
+     * @brief 设置是否通过预热的工作进程池进行识别
+     *
+     * 启用后图像通过标准输入传给预先加载好模型的tesseract进程，结果从标准输出读取，
+     * 单页和批量识别都不再读写临时PNG/tsv文件。
+     * @param enabled 是否启用
+     */
+    void setUseWorkerPool(bool enabled);
+
+    /**
+     * @brief 是否通过预热的工作进程池进行识别
+     * @return 是否启用
+     */
+    bool useWorkerPool() const;
+
+    /**
+     * @brief 为指定语言预先启动工作进程（仅在启用工作进程池时有效）
+     * @param language 识别语言代码
+     */
+    void prewarmWorkers(const QString &language);
+
+protected:
+    /**
+     * @brief 缓存上下文：追加tesseract版本、引擎模式、页面分割模式和语言模型指纹
+     */
+    QString cacheContext(const QString &language) const override;
+
+private slots:
     /**
      * @brief 处理Tesseract进程错误信号
      */
@@ -80,31 +143,26 @@ private:
     QString getTesseractVersion();
 
     /**
-     * @brief 保存图像到临时文件
-     * @param image 要保存的图像
-     * @return 临时文件路径，失败返回空字符串
+     * @brief 获取tesseract的探测信息（版本、语言列表、tessdata目录）
+     *
+     * 由ToolRegistry缓存，只有可执行文件或tessdata目录变化时才会启动探测进程。
+     * @return 探测信息
      */
-    QString saveImageToTempFile(const QImage &image);
+    ToolRegistry::ToolInfo toolInfo() const;
 
     /**
-     * @brief 从文件读取OCR结果
-     * @param filePath 结果文件路径
-     * @return 读取到的文本内容
+     * @brief 保存图像到临时文件
+     * @param image 要保存的图像
+     * @param pageIndex 页面索引（仅用于时间线），-1表示单页识别
+     * @return 临时文件路径，失败返回空字符串
      */
-    QString readOCRResultFromFile(const QString &filePath);
+    QString saveImageToTempFile(const QImage &image, int pageIndex = -1);
 
     /**
      * @brief 清理临时文件
      */
     void cleanupTempFiles();
 
-    /**
-     * @brief 从TSV文件解析置信度信息
-     * @param tsvFilePath TSV文件路径
-     * @return 平均置信度（0.0-1.0）
-     */
-    float parseConfidenceFromTSV(const QString &tsvFilePath);
-
     /**
      * @brief 执行单页OCR识别（专用于批量处理，包含批量进度更新）
      * @param image 待识别的图像
@@ -118,15 +176,238 @@ private:
                                                    int pageIndex,
                                                    int totalPages);
 
+    /**
+     * @brief 并发批量识别中单个页面的运行状态
+     */
+    struct PageTask {
+        int pageIndex;          // 页面索引
+        QProcess *process;      // 该页面独占的tesseract进程
+        QString imagePath;      // 输入图像临时文件
+        QString outputBase;     // 输出文件基名（不含扩展名）
+        QElapsedTimer timer;    // 页面计时（用于超时判断）
+        bool streamed;          // 是否通过标准输入输出与预热进程交换数据
+        int attempts;           // 已尝试次数（预热进程崩溃时重试一次）
+
+        PageTask() : pageIndex(-1), process(nullptr), streamed(false), attempts(0) {}
+    };
+
+    /**
+     * @brief 通过预热进程识别单页，支持崩溃重试和超时
+     * @param image 待识别的图像
+     * @param language 识别语言代码
+     * @param pageIndex 批量处理中的页面索引，-1表示单页识别
+     * @param totalPages 批量处理的总页面数
+     * @return OCR识别结果
+     */
+    OCRResult performPooledOCR(const QImage &image, const QString &language,
+                               int pageIndex, int totalPages);
+
+    /**
+     * @brief 判断页面任务是否因工作进程崩溃而失败且可以重试
+     * @param task 已结束的页面任务
+     * @return 是否应重试
+     */
+    bool shouldRetryPageTask(const PageTask &task) const;
+
+    /**
+     * @brief 从tesseract输出的TSV数据生成识别结果
+     * @param tsvData TSV格式数据
+     * @param pageIndex 页面索引（仅用于时间线），-1表示单页识别
+     * @return OCR识别结果（版面结构及由其重建的文本）
+     */
+    static OCRResult parseTSVOutput(const QByteArray &tsvData, int pageIndex = -1);
+
+    /**
+     * @brief 更新工作进程池的启动配置（可执行文件、环境和预热数量改变时调用）
+     * @param pool 要配置的工作进程池
+     */
+    void updateWorkerPoolConfiguration(TesseractWorkerPool *pool);
+
+    /**
+     * @brief 识别参数改变后使所有工作进程池失效
+     */
+    void invalidateWorkerPools();
+
+    /**
+     * @brief 获取当前线程使用的工作进程池
+     *
+     * QProcess只能在创建它的线程中使用，因此引擎所在线程与异步任务线程各自拥有一个进程池。
+     * @return 工作进程池
+     */
+    TesseractWorkerPool *currentWorkerPool();
+
+    /**
+     * @brief 多进程并发执行批量识别，结果按页面顺序返回
+     * @param images 待识别的图像列表
+     * @param pageNames 页面名称列表（已补齐）
+     * @param language 识别语言代码
+     * @param concurrency 同时运行的最大页数
+     * @param promise 异步任务（可为空）；非空时逐页写入结果，并在取消时终止所有进程
+     * @return 批量OCR识别结果
+     */
+    BatchOCRResult performConcurrentBatchOCR(const QList<QImage> &images,
+                                            const QStringList &pageNames,
+                                            const QString &language,
+                                            int concurrency,
+                                            QPromise<OCRResult> *promise = nullptr);
+
+    /**
+     * @brief 图像列表模式下单个tesseract进程的运行状态
+     */
+    struct ImageListTask {
+        QList<int> pageIndices;     // 列表中各页对应的页面索引（按列表顺序）
+        QProcess *process;          // 识别整个列表的tesseract进程
+        QString listPath;           // 列表文件路径
+        QStringList imagePaths;     // 页面图像临时文件
+        QByteArray pendingOutput;   // 标准输出中尚未处理完整的行
+        QByteArray pageOutput;      // 当前页面已收到的TSV行
+        int currentPage;            // 当前正在输出的页码（从1开始，0表示尚未开始）
+        int deliveredPages;         // 已交付结果的页数
+        QElapsedTimer idleTimer;    // 距上一页完成的时间（用于超时判断）
+
+        ImageListTask() : process(nullptr), currentPage(0), deliveredPages(0) {}
+    };
+
+    /**
+     * @brief 图像列表模式下一个已完成页面的结果
+     */
+    struct ListPageResult {
+        int pageIndex;          // 页面索引
+        OCRResult result;       // 识别结果
+        qint64 elapsedMs;       // 从上一页完成（首页为进程启动）到该页完成的时间
+    };
+
+    /**
+     * @brief 是否对指定页数使用图像列表模式（启用工作进程池时不使用）
+     * @param pageCount 页数
+     * @return 是否使用
+     */
+    bool shouldUseImageList(int pageCount) const;
+
+    /**
+     * @brief 图像列表模式执行批量识别
+     *
+     * 待识别页面按预测耗时均衡地分到若干列表，每个列表由一个tesseract进程识别，
+     * 进程数不超过concurrency且每个进程至少处理两页。缓存命中的页面不写入列表。
+     * @param images 待识别的图像列表
+     * @param pageNames 页面名称列表（已补齐）
+     * @param language 识别语言代码
+     * @param concurrency 同时运行的最大进程数
+     * @param promise 异步任务（可为空）；非空时逐页写入结果，并在取消时终止所有进程
+     * @return 批量OCR识别结果
+     */
+    BatchOCRResult performImageListBatchOCR(const QList<QImage> &images,
+                                           const QStringList &pageNames,
+                                           const QString &language,
+                                           int concurrency,
+                                           QPromise<OCRResult> *promise = nullptr);
+
+    /**
+     * @brief 写入列表中的页面图像和列表文件，并启动tesseract进程
+     * @param task 列表任务（pageIndices需已设置）
+     * @param images 全部页面图像
+     * @param language 识别语言代码
+     * @param singleThreaded 是否限制tesseract内部线程数
+     * @return 进程是否成功启动
+     */
+    bool startImageListTask(ImageListTask &task, const QList<QImage> &images,
+                            const QString &language, bool singleThreaded);
+
+    /**
+     * @brief 读取列表任务的标准输出，返回其中已完整输出的页面
+     *
+     * tesseract在开始输出下一页时，上一页的TSV已经完整，因此以level为1的页面行
+     * 作为页面分界；进程正常结束时最后一页也视为完整。
+     * @param task 列表任务
+     * @param finished 进程是否已正常结束
+     * @return 已完成页面的结果（按列表顺序）
+     */
+    QList<ListPageResult> takeFinishedListPages(ImageListTask &task, bool finished);
+
+    /**
+     * @brief 终止列表任务（如仍在运行）并清理其临时文件
+     * @param task 列表任务
+     */
+    void cleanupImageListTask(ImageListTask &task);
+
+    /**
+     * @brief 为页面启动独立的tesseract进程
+     * @param task 页面任务（pageIndex需已设置）
+     * @param image 页面图像
+     * @param language 识别语言代码
+     * @param singleThreaded 是否限制tesseract内部线程数（并发运行时避免超额占用CPU）
+     * @return 进程是否成功启动
+     */
+    bool startPageTask(PageTask &task, const QImage &image, const QString &language, bool singleThreaded);
+
+    /**
+     * @brief 收集已结束页面任务的结果并清理其临时文件
+     * @param task 页面任务
+     * @return OCR识别结果
+     */
+    OCRResult finishPageTask(PageTask &task);
+
+    /**
+     * @brief 终止页面任务并清理其临时文件
+     * @param task 页面任务
+     */
+    void abortPageTask(PageTask &task);
+
+    /**
+     * @brief 生成全局唯一的临时文件基名
+     *
+     * 由进程ID、递增计数器和时间戳组成，多个页面在同一毫秒内创建也不会冲突。
+     * @param prefix 文件名前缀
+     * @return 临时目录下的文件基名（不含扩展名）
+     */
+    static QString createTempBaseName(const QString &prefix);
+
+    /**
+     * @brief 构造tesseract命令行参数
+     * @param inputPath 输入图像路径
+     * @param outputBase 输出文件基名
+     * @param language 识别语言代码
+     * @return 参数列表
+     */
+    QStringList buildTesseractArguments(const QString &inputPath,
+                                        const QString &outputBase,
+                                        const QString &language) const;
+
+    /**
+     * @brief 为bundled版本设置工作目录和环境变量（支持虚拟化环境）
+     * @param process 待启动的进程
+     * @param singleThreaded 是否将OpenMP线程数限制为1
+     */
+    void configureTesseractProcess(QProcess *process, bool singleThreaded) const;
+
+    /**
+     * @brief 读取输出的tsv文件生成识别结果，并删除该文件
+     * @param outputBase 输出文件基名
+     * @param pageIndex 页面索引（仅用于时间线），-1表示单页识别
+     * @return OCR识别结果
+     */
+    OCRResult collectOutputFiles(const QString &outputBase, int pageIndex = -1);
+
 private:
     QString m_tesseractPath;        // Tesseract可执行文件路径
     QString m_tessDataPath;         // tessdata数据目录路径
+    QString m_tesseractVersion;     // 初始化时获取的tesseract版本
+    QString m_resolvedTessDataPath; // tesseract实际使用的tessdata目录
     int m_ocrEngineMode;           // OCR引擎模式
     int m_pageSegmentationMode;    // 页面分割模式
     QProcess *m_tesseractProcess;  // Tesseract进程对象
     QStringList m_tempFiles;       // 临时文件列表，用于清理
-    OCRResult m_currentResult;     // 当前OCR结果（用于异步处理）
-    bool m_processingAsync;        // 是否正在异步处理
+    int m_maxConcurrentPages;      // 批量识别最大并发页数
+    int m_imageListMinPages;       // 使用图像列表模式的最少页数（0表示禁用）
+    TesseractWorkerPool *m_workerPool; // 预热的tesseract工作进程池
+    bool m_useWorkerPool;          // 是否通过工作进程池识别
+
+    // 异步识别
+    QThreadPool *m_asyncThreadPool;          // 异步任务线程（单线程，常驻）
+    TesseractWorkerPool *m_asyncWorkerPool;  // 异步任务线程专用的工作进程池
+    int m_asyncWorkerPoolGeneration;         // 异步进程池对应的配置版本
+    QAtomicInt m_workerPoolGeneration;       // 工作进程配置版本（参数改变时递增）
+    QAtomicInt m_asyncShutdown;              // 引擎析构时通知异步任务立即停止
 
     // 常用语言代码映射
     static const QMap<QString, QString> s_languageMap;
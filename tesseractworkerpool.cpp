@@ -0,0 +1,269 @@
+#include "tesseractworkerpool.h"
+#include "ocrmetrics.h"
+#include <QDebug>
+
+/**
+ * @brief TesseractWorkerPool构造函数
+ * @param parent 父对象指针
+ */
+TesseractWorkerPool::TesseractWorkerPool(QObject *parent)
+    : QObject(parent)
+    , m_program("tesseract")
+    , m_warmWorkerCount(1)
+    , m_maxIdleWorkers(2)
+    , m_launchedWorkers(0)
+    , m_restartedWorkers(0)
+{
+}
+
+/**
+ * @brief TesseractWorkerPool析构函数
+ */
+TesseractWorkerPool::~TesseractWorkerPool()
+{
+    clear();
+}
+
+/**
+ * @brief 设置tesseract可执行文件及进程配置回调
+ * @param program 可执行文件路径
+ * @param configurator 进程配置回调
+ */
+void TesseractWorkerPool::setProgram(const QString &program, const ProcessConfigurator &configurator)
+{
+    clear();
+    m_program = program;
+    m_configurator = configurator;
+}
+
+/**
+ * @brief 设置每组参数保持的预热进程数
+ * @param count 预热进程数
+ */
+void TesseractWorkerPool::setWarmWorkerCount(int count)
+{
+    m_warmWorkerCount = qMax(1, count);
+
+    // 多余的预热进程直接终止
+    for (auto it = m_idleWorkers.begin(); it != m_idleWorkers.end(); ++it) {
+        while (it.value().size() > m_warmWorkerCount) {
+            destroyWorker(it.value().takeLast());
+        }
+    }
+}
+
+/**
+ * @brief 获取每组参数保持的预热进程数
+ * @return 预热进程数
+ */
+int TesseractWorkerPool::warmWorkerCount() const
+{
+    return m_warmWorkerCount;
+}
+
+/**
+ * @brief 设置所有参数组合计保持的预热进程数上限
+ * @param count 上限
+ */
+void TesseractWorkerPool::setMaxIdleWorkers(int count)
+{
+    m_maxIdleWorkers = qMax(1, count);
+    if (!m_keyOrder.isEmpty()) {
+        evictIdleWorkers(m_keyOrder.last(), qMax(m_maxIdleWorkers, m_warmWorkerCount) - m_warmWorkerCount);
+    }
+}
+
+/**
+ * @brief 获取所有参数组合计保持的预热进程数上限
+ * @return 上限
+ */
+int TesseractWorkerPool::maxIdleWorkers() const
+{
+    return m_maxIdleWorkers;
+}
+
+/**
+ * @brief 取出一个按指定参数启动的工作进程
+ * @param arguments tesseract命令行参数
+ * @return 正在运行的进程，失败返回nullptr
+ */
+QProcess *TesseractWorkerPool::acquire(const QStringList &arguments)
+{
+    const QString key = arguments.join(QChar(0x1f));
+    QList<QProcess *> &idle = m_idleWorkers[key];
+
+    QProcess *worker = nullptr;
+    while (!idle.isEmpty()) {
+        QProcess *candidate = idle.takeFirst();
+
+        // 不阻塞地刷新进程状态，丢弃在等待期间已退出（崩溃或被杀）的进程
+        candidate->waitForFinished(0);
+        if (candidate->state() == QProcess::Running) {
+            worker = candidate;
+            break;
+        }
+
+        qDebug() << "预热的Tesseract进程已退出，重新启动:" << candidate->readAllStandardError();
+        destroyWorker(candidate);
+        m_restartedWorkers++;
+    }
+
+    // 没有可用的预热进程时冷启动一个
+    if (!worker) {
+        worker = launchWorker(arguments);
+    }
+
+    // 为下一次请求补充预热进程（模型加载与当前识别并行进行）
+    replenish(key, arguments);
+    return worker;
+}
+
+/**
+ * @brief 预先为指定参数启动预热进程
+ * @param arguments tesseract命令行参数
+ */
+void TesseractWorkerPool::prewarm(const QStringList &arguments)
+{
+    replenish(arguments.join(QChar(0x1f)), arguments);
+}
+
+/**
+ * @brief 终止并清空所有预热进程
+ */
+void TesseractWorkerPool::clear()
+{
+    for (QList<QProcess *> &workers : m_idleWorkers) {
+        for (QProcess *worker : workers) {
+            destroyWorker(worker);
+        }
+    }
+    m_idleWorkers.clear();
+    m_keyOrder.clear();
+}
+
+/**
+ * @brief 获取累计启动的工作进程数
+ * @return 进程数
+ */
+int TesseractWorkerPool::launchedWorkerCount() const
+{
+    return m_launchedWorkers;
+}
+
+/**
+ * @brief 获取因意外退出而重启的预热进程数
+ * @return 进程数
+ */
+int TesseractWorkerPool::restartedWorkerCount() const
+{
+    return m_restartedWorkers;
+}
+
+/**
+ * @brief 获取最近一次启动失败的错误信息
+ * @return 错误信息
+ */
+QString TesseractWorkerPool::lastError() const
+{
+    return m_lastError;
+}
+
+/**
+ * @brief 启动一个新的工作进程
+ * @param arguments tesseract命令行参数
+ * @return 已启动的进程，失败返回nullptr
+ */
+QProcess *TesseractWorkerPool::launchWorker(const QStringList &arguments)
+{
+    QProcess *worker = new QProcess();
+    if (m_configurator) {
+        m_configurator(worker);
+    }
+
+    bool started;
+    {
+        OCRMetrics::ScopedTimer spawnTimer("process_spawn");
+        OCRMetrics::increment("process_spawns");
+        worker->start(m_program, arguments);
+        started = worker->waitForStarted(5000);
+    }
+    if (!started) {
+        m_lastError = "无法启动Tesseract进程: " + worker->errorString();
+        delete worker;
+        return nullptr;
+    }
+
+    m_launchedWorkers++;
+    return worker;
+}
+
+/**
+ * @brief 补充预热进程直到达到设定数量
+ * @param key 参数组键值
+ * @param arguments tesseract命令行参数
+ */
+void TesseractWorkerPool::replenish(const QString &key, const QStringList &arguments)
+{
+    m_keyOrder.removeAll(key);
+    m_keyOrder.append(key);
+
+    // 先为本组腾出名额，再启动新进程，同时驻留的语言模型不超过上限
+    evictIdleWorkers(key, qMax(m_maxIdleWorkers, m_warmWorkerCount) - m_warmWorkerCount);
+
+    QList<QProcess *> &idle = m_idleWorkers[key];
+    while (idle.size() < m_warmWorkerCount) {
+        QProcess *worker = launchWorker(arguments);
+        if (!worker) {
+            break;
+        }
+        idle.append(worker);
+    }
+}
+
+/**
+ * @brief 从最久未使用的参数组开始终止预热进程
+ * @param keepKey 不终止的参数组键值
+ * @param othersLimit 其他参数组合计的预热进程数上限
+ */
+void TesseractWorkerPool::evictIdleWorkers(const QString &keepKey, int othersLimit)
+{
+    int others = 0;
+    for (auto it = m_idleWorkers.constBegin(); it != m_idleWorkers.constEnd(); ++it) {
+        if (it.key() != keepKey) {
+            others += int(it.value().size());
+        }
+    }
+
+    int i = 0;
+    while (others > othersLimit && i < m_keyOrder.size()) {
+        const QString key = m_keyOrder.at(i);
+        if (key == keepKey) {
+            i++;
+            continue;
+        }
+        QList<QProcess *> &idle = m_idleWorkers[key];
+        while (!idle.isEmpty() && others > othersLimit) {
+            destroyWorker(idle.takeFirst());
+            others--;
+        }
+        if (idle.isEmpty()) {
+            m_idleWorkers.remove(key);
+            m_keyOrder.removeAt(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+/**
+ * @brief 终止并删除进程
+ * @param process 进程对象
+ */
+void TesseractWorkerPool::destroyWorker(QProcess *process)
+{
+    if (process->state() != QProcess::NotRunning) {
+        process->kill();
+        process->waitForFinished(3000);
+    }
+    delete process;
+}
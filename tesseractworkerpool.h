@@ -0,0 +1,146 @@
+#ifndef TESSERACTWORKERPOOL_H
+#define TESSERACTWORKERPOOL_H
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QStringList>
+#include <functional>
+
+/**
+ * @brief 预热的tesseract工作进程池
+ *
+ * tesseract命令行以"stdin"作为输入名时，会先加载语言模型，再阻塞读取标准输入。
+ * 该类提前启动这样的进程，使其在等待图像数据时就完成模型加载；
+ * 需要识别时直接取出一个已预热的进程写入图像字节，并立即在后台启动替补进程。
+ *
+ * 每个工作进程只处理一张图像（tesseract读完标准输入后即退出），
+ * 取出后由调用方负责删除。该类不是线程安全的，只能在创建它的线程中使用。
+ *
+ * 每个进程都加载了完整的语言模型。切换语言或参数后，为新参数补充预热进程时，
+ * 最久未使用的参数组的预热进程会被终止，预热进程总数不超过maxIdleWorkers。
+ */
+class TesseractWorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 进程配置回调，用于在启动前设置工作目录和环境变量
+     */
+    using ProcessConfigurator = std::function<void(QProcess *process)>;
+
+    explicit TesseractWorkerPool(QObject *parent = nullptr);
+    ~TesseractWorkerPool() override;
+
+    /**
+     * @brief 设置tesseract可执行文件及进程配置回调，会清空现有的预热进程
+     * @param program 可执行文件路径
+     * @param configurator 进程配置回调（可为空）
+     */
+    void setProgram(const QString &program, const ProcessConfigurator &configurator);
+
+    /**
+     * @brief 设置每组参数保持的预热进程数
+     * @param count 预热进程数（至少为1）
+     */
+    void setWarmWorkerCount(int count);
+
+    /**
+     * @brief 获取每组参数保持的预热进程数
+     * @return 预热进程数
+     */
+    int warmWorkerCount() const;
+
+    /**
+     * @brief 设置所有参数组合计保持的预热进程数上限
+     * @param count 上限（不低于每组参数的预热进程数，默认2，即当前参数和上一次使用的参数）
+     */
+    void setMaxIdleWorkers(int count);
+
+    /**
+     * @brief 获取所有参数组合计保持的预热进程数上限
+     * @return 上限
+     */
+    int maxIdleWorkers() const;
+
+    /**
+     * @brief 取出一个按指定参数启动的工作进程
+     *
+     * 优先返回已预热的进程；已意外退出的预热进程会被丢弃并重启。
+     * 取出后会在后台补充新的预热进程。
+     * @param arguments tesseract命令行参数（输入输出名应为stdin/stdout）
+     * @return 正在运行的进程（调用方负责删除），启动失败返回nullptr
+     */
+    QProcess *acquire(const QStringList &arguments);
+
+    /**
+     * @brief 预先为指定参数启动预热进程
+     * @param arguments tesseract命令行参数
+     */
+    void prewarm(const QStringList &arguments);
+
+    /**
+     * @brief 终止并清空所有预热进程（识别参数改变时调用）
+     */
+    void clear();
+
+    /**
+     * @brief 获取累计启动的工作进程数
+     * @return 进程数
+     */
+    int launchedWorkerCount() const;
+
+    /**
+     * @brief 获取因意外退出而重启的预热进程数
+     * @return 进程数
+     */
+    int restartedWorkerCount() const;
+
+    /**
+     * @brief 获取最近一次启动失败的错误信息
+     * @return 错误信息
+     */
+    QString lastError() const;
+
+private:
+    /**
+     * @brief 启动一个新的工作进程
+     * @param arguments tesseract命令行参数
+     * @return 已启动的进程，失败返回nullptr
+     */
+    QProcess *launchWorker(const QStringList &arguments);
+
+    /**
+     * @brief 补充预热进程直到达到设定数量
+     * @param key 参数组键值
+     * @param arguments tesseract命令行参数
+     */
+    void replenish(const QString &key, const QStringList &arguments);
+
+    /**
+     * @brief 从最久未使用的参数组开始终止预热进程，使其他参数组合计不超过上限
+     * @param keepKey 不终止的参数组键值
+     * @param othersLimit 其他参数组合计的预热进程数上限
+     */
+    void evictIdleWorkers(const QString &keepKey, int othersLimit);
+
+    /**
+     * @brief 终止并删除进程
+     * @param process 进程对象
+     */
+    static void destroyWorker(QProcess *process);
+
+private:
+    QString m_program;                              // tesseract可执行文件路径
+    ProcessConfigurator m_configurator;             // 进程配置回调
+    QHash<QString, QList<QProcess *>> m_idleWorkers; // 按参数分组的预热进程
+    QStringList m_keyOrder;                         // 参数组键值（最近使用的排在最后）
+    int m_warmWorkerCount;                          // 每组参数的预热进程数
+    int m_maxIdleWorkers;                           // 所有参数组合计的预热进程数上限
+    int m_launchedWorkers;                          // 累计启动的进程数
+    int m_restartedWorkers;                         // 累计重启的进程数
+    QString m_lastError;                            // 最近一次错误信息
+};
+
+#endif // TESSERACTWORKERPOOL_H
@@ -0,0 +1,294 @@
+#include "tiledrecognizer.h"
+#include "fileprocessor.h"
+#include "ocrmetrics.h"
+#include <QImageReader>
+#include <QPainter>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtMath>
+
+// 缩略图的像素上限（用于寻找切分位置，不参与识别）
+static const double OVERVIEW_PIXELS = 2e6;
+
+// 按区域逐条解码缩略图时每条的像素上限
+static const double STRIP_PIXELS = 16e6;
+
+/**
+ * @brief 解码整图的灰度缩略图
+ *
+ * 解码器支持缩放解码时直接解码为缩略图；支持按区域解码时逐条解码并缩小，内存只与条带大小有关；
+ * 两者都不支持时整图解码，并通过fullImage返回，供后续裁剪分块。
+ * @param filePath 文件路径
+ * @param imageSize 整图尺寸
+ * @param fullImage 需要整图解码时返回整图
+ * @return 缩略图（解码失败时为空）
+ */
+static QImage readOverview(const QString &filePath, const QSize &imageSize, QImage *fullImage)
+{
+    const double ratio = qMin(1.0, std::sqrt(OVERVIEW_PIXELS / (double(imageSize.width()) * imageSize.height())));
+    const QSize overviewSize(qMax(1, qRound(imageSize.width() * ratio)), qMax(1, qRound(imageSize.height() * ratio)));
+
+    QImageReader reader(filePath);
+    if (reader.supportsOption(QImageIOHandler::ScaledSize)) {
+        reader.setScaledSize(overviewSize);
+        return reader.read().convertToFormat(QImage::Format_Grayscale8);
+    }
+
+    if (!reader.supportsOption(QImageIOHandler::ClipRect)) {
+        *fullImage = reader.read();
+        if (fullImage->isNull()) {
+            return QImage();
+        }
+        return fullImage->scaled(overviewSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+            .convertToFormat(QImage::Format_Grayscale8);
+    }
+
+    QImage overview(overviewSize, QImage::Format_Grayscale8);
+    overview.fill(Qt::white);
+    QPainter painter(&overview);
+    const int stripRows = qMax(1, int(STRIP_PIXELS / imageSize.width()));
+    for (int y = 0; y < imageSize.height(); y += stripRows) {
+        const QRect strip(0, y, imageSize.width(), qMin(stripRows, imageSize.height() - y));
+        QImageReader stripReader(filePath);
+        stripReader.setClipRect(strip);
+        const QImage part = stripReader.read();
+        if (part.isNull()) {
+            return QImage();
+        }
+        const QRectF target(0, y * ratio, overviewSize.width(), strip.height() * ratio);
+        painter.drawImage(target, part);
+    }
+    painter.end();
+    return overview;
+}
+
+/**
+ * @brief 在名义切分位置附近的墨迹投影中寻找空白处作为切分位置
+ * @param ink 缩略图每行（或每列）的暗像素数
+ * @param ratio 缩略图与整图的比例
+ * @param length 整图的高度（或宽度）
+ * @param tileSize 分块的名义边长
+ * @return 切分位置（首项为0，末项为length）
+ */
+static QList<int> findSeams(const QVector<int> &ink, double ratio, int length, int tileSize)
+{
+    QList<int> seams{0};
+    const int count = qMax(1, qRound(double(length) / tileSize));
+    for (int k = 1; k < count; ++k) {
+        // 在名义位置前后四分之一个分块的范围内取墨迹最少处，相同时取离名义位置最近的
+        const int nominal = int(qint64(length) * k / count);
+        const int window = tileSize / 4;
+        const int from = qBound(0, int((nominal - window) * ratio), int(ink.size()) - 1);
+        const int to = qBound(0, int((nominal + window) * ratio), int(ink.size()) - 1);
+        const int nominalIndex = int(nominal * ratio);
+        int best = nominalIndex;
+        for (int i = from; i <= to; ++i) {
+            if (best < 0 || best >= ink.size() || ink.at(i) < ink.at(best)
+                || (ink.at(i) == ink.at(best) && qAbs(i - nominalIndex) < qAbs(best - nominalIndex))) {
+                best = i;
+            }
+        }
+
+        const int seam = qBound(seams.last() + tileSize / 2, qRound(best / ratio), length - tileSize / 2);
+        if (seam > seams.last() && seam < length) {
+            seams.append(seam);
+        }
+    }
+    seams.append(length);
+    return seams;
+}
+
+/**
+ * @brief 判断图像文件是否需要分块识别
+ * @param filePath 文件路径
+ * @param options 分块识别选项
+ * @return 是否需要分块
+ */
+bool TiledRecognizer::shouldTile(const QString &filePath, const Options &options)
+{
+    if (!options.enabled || FileProcessor::getFileType(filePath) == FileProcessor::DOCUMENT_PDF) {
+        return false;
+    }
+
+    const QSize size = QImageReader(filePath).size();
+    if (!size.isValid()) {
+        return false;
+    }
+    // tesseract不接受边长超过32767像素的图像，这类图像无论像素数多少都需要分块
+    return qint64(size.width()) * size.height() >= options.minPixels || qMax(size.width(), size.height()) > 32000;
+}
+
+/**
+ * @brief 规划分块
+ * @param imageSize 整图尺寸
+ * @param overview 整图的灰度缩略图
+ * @param options 分块识别选项
+ * @return 分块
+ */
+QList<TiledRecognizer::Tile> TiledRecognizer::planTiles(const QSize &imageSize, const QImage &overview,
+                                                        const Options &options)
+{
+    // 行列墨迹投影：暗于Otsu阈值的像素数
+    const int threshold = ImagePreprocessor::otsuThreshold(overview);
+    QVector<int> rowInk(overview.height(), 0);
+    QVector<int> columnInk(overview.width(), 0);
+    for (int y = 0; y < overview.height(); ++y) {
+        const uchar *line = overview.constScanLine(y);
+        for (int x = 0; x < overview.width(); ++x) {
+            if (line[x] <= threshold) {
+                rowInk[y]++;
+                columnInk[x]++;
+            }
+        }
+    }
+
+    const int tileSize = qMax(512, options.tileSize);
+    const double ratio = double(overview.width()) / imageSize.width();
+    const QList<int> columns = findSeams(columnInk, ratio, imageSize.width(), tileSize);
+    const QList<int> rows = findSeams(rowInk, ratio, imageSize.height(), tileSize);
+
+    QList<Tile> tiles;
+    const QRect imageRect(QPoint(0, 0), imageSize);
+    const int overlap = qMax(0, options.overlap);
+    for (int row = 0; row + 1 < rows.size(); ++row) {
+        for (int column = 0; column + 1 < columns.size(); ++column) {
+            Tile tile;
+            tile.owned = QRect(QPoint(columns.at(column), rows.at(row)),
+                               QPoint(columns.at(column + 1) - 1, rows.at(row + 1) - 1));
+            tile.rect = tile.owned.adjusted(-overlap, -overlap, overlap, overlap) & imageRect;
+            tiles.append(tile);
+        }
+    }
+    return tiles;
+}
+
+/**
+ * @brief 异步分块识别图像文件
+ * @param engine OCR引擎
+ * @param filePath 图像文件路径
+ * @param language 识别语言代码
+ * @param options 分块识别选项
+ * @return 包含一个识别结果的QFuture
+ */
+QFuture<OCREngine::OCRResult> TiledRecognizer::submitFile(OCREngine *engine, const QString &filePath,
+                                                          const QString &language, const Options &options)
+{
+    return QtConcurrent::run([engine, filePath, language, options](QPromise<OCREngine::OCRResult> &promise) {
+        OCREngine::OCRResult failedResult;
+
+        const QSize imageSize = QImageReader(filePath).size();
+        QImage fullImage;
+        QImage overview;
+        if (imageSize.isValid()) {
+            OCRMetrics::ScopedTimer decodeTimer("image_decode");
+            overview = readOverview(filePath, imageSize, &fullImage);
+        }
+        if (overview.isNull()) {
+            failedResult.errorMessage = "图像文件损坏或格式不正确";
+            promise.addResult(failedResult);
+            return;
+        }
+
+        const QList<Tile> tiles = planTiles(imageSize, overview, options);
+        OCRMetrics::increment("tiles", tiles.size());
+
+        ImagePreprocessor::Options preprocess = options.preprocess;
+        preprocess.normalizeTextSize = false;
+        const int batchSize = options.maxTilesInFlight > 0 ? options.maxTilesInFlight
+                                                            : qMax(1, QThread::idealThreadCount());
+
+        // 分批解码和识别，每批完成后释放其分块图像
+        QList<OCREngine::OCRResult> tileResults;
+        for (int first = 0; first < tiles.size(); first += batchSize) {
+            if (promise.isCanceled()) {
+                return;
+            }
+
+            QList<QImage> images;
+            for (int i = first; i < qMin(first + batchSize, int(tiles.size())); ++i) {
+                QImage tile;
+                {
+                    OCRMetrics::ScopedTimer decodeTimer("image_decode", i);
+                    if (fullImage.isNull()) {
+                        QImageReader reader(filePath);
+                        reader.setClipRect(tiles.at(i).rect);
+                        tile = reader.read();
+                    } else {
+                        tile = fullImage.copy(tiles.at(i).rect);
+                    }
+                }
+                if (tile.isNull()) {
+                    failedResult.errorMessage = QString("无法解码第%1个分块").arg(i + 1);
+                    promise.addResult(failedResult);
+                    return;
+                }
+                images.append(ImagePreprocessor::process(tile, preprocess));
+            }
+
+            QFuture<OCREngine::OCRResult> future = engine->submitBatch(images, language);
+            if (!OCREngine::waitForBatch(future, promise)) {
+                return;
+            }
+
+            for (int i = 0; i < images.size(); ++i) {
+                OCREngine::OCRResult tileResult;
+                if (future.isResultReadyAt(i)) {
+                    tileResult = future.resultAt(i);
+                } else {
+                    tileResult.errorMessage = "识别未完成";
+                }
+                tileResults.append(tileResult);
+            }
+        }
+
+        promise.addResult(stitch(tiles, tileResults));
+    });
+}
+
+/**
+ * @brief 拼接各分块的识别结果
+ * @param tiles 分块
+ * @param results 识别结果
+ * @return 整页识别结果
+ */
+OCREngine::OCRResult TiledRecognizer::stitch(const QList<Tile> &tiles, const QList<OCREngine::OCRResult> &results)
+{
+    QList<OCRLayout> layouts;
+    QList<QPoint> offsets;
+    QList<QRect> ownedRegions;
+    QStringList errors;
+    QStringList unstructuredTexts;
+    float confidenceSum = 0.0f;
+    int recognizedTiles = 0;
+
+    for (int i = 0; i < tiles.size(); ++i) {
+        const OCREngine::OCRResult tileResult = results.value(i);
+        if (!tileResult.success) {
+            errors.append(QString("分块%1: %2").arg(i + 1).arg(tileResult.errorMessage));
+            continue;
+        }
+
+        recognizedTiles++;
+        confidenceSum += tileResult.confidence;
+        if (tileResult.layout.isEmpty() && !tileResult.text.trimmed().isEmpty()) {
+            // 引擎没有返回版面结构时无法去重，只能直接追加文本
+            unstructuredTexts.append(tileResult.text.trimmed());
+            continue;
+        }
+        layouts.append(tileResult.layout);
+        offsets.append(tiles.at(i).rect.topLeft());
+        ownedRegions.append(tiles.at(i).owned);
+    }
+
+    OCREngine::OCRResult result;
+    result.layout = OCRLayout::stitch(layouts, offsets, ownedRegions);
+    result.text = result.layout.text();
+    for (const QString &text : std::as_const(unstructuredTexts)) {
+        result.text += (result.text.isEmpty() ? QString() : QString("\n\n")) + text;
+    }
+    result.confidence = result.layout.meanConfidence(recognizedTiles > 0 ? confidenceSum / recognizedTiles : 0.0f);
+    result.success = errors.isEmpty();
+    result.errorMessage = errors.join("；");
+    return result;
+}
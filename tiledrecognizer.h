@@ -0,0 +1,90 @@
+#ifndef TILEDRECOGNIZER_H
+#define TILEDRECOGNIZER_H
+
+#include <QString>
+#include <QList>
+#include <QRect>
+#include <QFuture>
+#include "ocrengine.h"
+#include "imagepreprocessor.h"
+
+/**
+ * @brief 超大图像的分块并行识别
+ *
+ * 建筑图纸、扫描海报等上亿像素的图像作为一整页交给tesseract时，单次识别耗时数分钟且容易超时。
+ * 分块识别先解码一张缩略图，按行列墨迹投影在空白处选择切分位置，把图像切成带重叠边的分块；
+ * 各分块用QImageReader::setClipRect只解码所需区域，分批交给引擎并发识别，
+ * 同一时刻只有一批分块驻留内存。最后把各分块的文本和单词边框平移回整页坐标拼接，
+ * 重叠区域中的单词只保留一份。
+ *
+ * 解码器不支持按区域解码的格式（取决于Qt的图像插件）退回为整图解码一次后裁剪分块，
+ * 内存占用与不分块时相同，但仍可并行识别。
+ */
+class TiledRecognizer
+{
+public:
+    /**
+     * @brief 分块识别选项
+     */
+    struct Options {
+        bool enabled;               // 是否对超大图像分块识别
+        qint64 minPixels;           // 超过该像素数的图像才分块
+        int tileSize;               // 分块的名义边长（像素）
+        int overlap;                // 相邻分块向外扩展的重叠宽度（像素，应大于一行文字的高度）
+        int maxTilesInFlight;       // 同时解码并识别的分块数（0表示按CPU核数）
+        ImagePreprocessor::Options preprocess;  // 每个分块的预处理（不进行文字尺寸归一化，保证各分块比例一致）
+
+        Options() : enabled(true), minPixels(40000000), tileSize(3000), overlap(160), maxTilesInFlight(0) {}
+    };
+
+    /**
+     * @brief 分块
+     */
+    struct Tile {
+        QRect rect;     // 解码和识别的区域（含重叠边）
+        QRect owned;    // 该分块负责的区域（各分块互不重叠，拼接时用于去重）
+    };
+
+    /**
+     * @brief 判断图像文件是否需要分块识别（只读取文件头，不解码）
+     * @param filePath 文件路径
+     * @param options 分块识别选项
+     * @return 是否需要分块
+     */
+    static bool shouldTile(const QString &filePath, const Options &options);
+
+    /**
+     * @brief 规划分块：在缩略图的行列墨迹投影中，于名义切分位置附近寻找空白处切分
+     * @param imageSize 整图尺寸
+     * @param overview 整图的灰度缩略图
+     * @param options 分块识别选项
+     * @return 按行优先顺序排列的分块
+     */
+    static QList<Tile> planTiles(const QSize &imageSize, const QImage &overview, const Options &options);
+
+    /**
+     * @brief 异步分块识别图像文件
+     *
+     * 结果是一个整页识别结果（下标0），与单页的submitBatch结果形式相同。
+     * 对返回的QFuture调用cancel()会取消正在识别的分块并停止后续分块。
+     * @param engine 已初始化的OCR引擎（识别期间不可释放）
+     * @param filePath 图像文件路径
+     * @param language 识别语言代码
+     * @param options 分块识别选项
+     * @return 包含一个识别结果的QFuture
+     */
+    static QFuture<OCREngine::OCRResult> submitFile(OCREngine *engine, const QString &filePath,
+                                                    const QString &language, const Options &options);
+
+    /**
+     * @brief 拼接各分块的识别结果
+     *
+     * 有分块识别失败时整页结果为失败，但仍包含其余分块拼接出的文本和版面结构。
+     * @param tiles 分块
+     * @param results 与分块一一对应的识别结果
+     * @return 整页识别结果
+     */
+    static OCREngine::OCRResult stitch(const QList<Tile> &tiles, const QList<OCREngine::OCRResult> &results);
+};
+
+#endif // TILEDRECOGNIZER_H
@@ -0,0 +1,383 @@
+#include "toolregistry.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+
+/**
+ * @brief 内存中的探测记录
+ */
+struct ToolRecord {
+    QString fingerprint;
+    ToolRegistry::ToolInfo info;
+};
+
+QMutex s_registryMutex;                  // 保护s_records和QSettings读写
+QHash<QString, ToolRecord> s_records;    // 已加载的探测记录
+
+/**
+ * @brief 运行探测进程并返回合并后的输出
+ * @param process 已配置好的进程
+ * @param program 可执行文件路径
+ * @param arguments 命令行参数
+ * @param finished 返回进程是否在超时前正常结束
+ * @return 标准输出和标准错误的合并内容
+ */
+QString runProbe(QProcess &process, const QString &program, const QStringList &arguments, bool &finished)
+{
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(program, arguments);
+    finished = process.waitForFinished(10000) && process.exitStatus() == QProcess::NormalExit;
+    if (!finished && process.state() != QProcess::NotRunning) {
+        process.kill();
+        process.waitForFinished(3000);
+    }
+    return QString::fromLocal8Bit(process.readAll());
+}
+
+/**
+ * @brief 生成工具键对应的QSettings分组名
+ * @param key 工具键
+ * @return 分组名
+ */
+QString settingsGroup(const QString &key)
+{
+    return "ToolRegistry/" + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+}
+
+} // namespace
+
+/**
+ * @brief 获取tesseract的能力信息
+ * @param program tesseract程序名或路径
+ * @param tessDataDir 显式指定的tessdata目录
+ * @param configurator 探测进程的配置回调
+ * @return 能力信息
+ */
+ToolRegistry::ToolInfo ToolRegistry::tesseract(const QString &program, const QString &tessDataDir,
+                                               const ProcessConfigurator &configurator)
+{
+    ToolInfo info;
+    info.program = program;
+
+    // 找不到可执行文件时无需启动进程
+    QString resolvedPath = resolveExecutable(program);
+    if (resolvedPath.isEmpty()) {
+        return info;
+    }
+
+    // TESSDATA_PREFIX会改变tesseract的默认数据目录，也作为键的一部分
+    const QString key = QString("tesseract|%1|%2|%3")
+                            .arg(resolvedPath, tessDataDir, qEnvironmentVariable("TESSDATA_PREFIX"));
+    const QString binaryFingerprint = fileFingerprint(resolvedPath);
+
+    ToolInfo cached;
+    QString cachedFingerprint;
+    if (lookup(key, cached, cachedFingerprint)) {
+        QString dataDir = tessDataDir.isEmpty() ? cached.tessDataDir : tessDataDir;
+        if (cachedFingerprint == binaryFingerprint + "|" + tessDataFingerprint(dataDir)) {
+            cached.program = program;
+            return cached;
+        }
+    }
+
+    bool definitive = false;
+    info = probeTesseract(program, resolvedPath, tessDataDir, configurator, definitive);
+
+    QString dataDir = tessDataDir.isEmpty() ? info.tessDataDir : tessDataDir;
+    if (definitive) {
+        store(key, binaryFingerprint + "|" + tessDataFingerprint(dataDir), info);
+    }
+    return info;
+}
+
+/**
+ * @brief 获取pdftoppm的能力信息
+ * @param program pdftoppm程序名或路径
+ * @return 能力信息
+ */
+ToolRegistry::ToolInfo ToolRegistry::pdftoppm(const QString &program)
+{
+    ToolInfo info;
+    info.program = program;
+
+    QString resolvedPath = resolveExecutable(program);
+    if (resolvedPath.isEmpty()) {
+        return info;
+    }
+
+    const QString key = "pdftoppm|" + resolvedPath;
+    const QString fingerprint = fileFingerprint(resolvedPath);
+
+    ToolInfo cached;
+    QString cachedFingerprint;
+    if (lookup(key, cached, cachedFingerprint) && cachedFingerprint == fingerprint) {
+        cached.program = program;
+        return cached;
+    }
+
+    bool definitive = false;
+    info = probePdftoppm(program, resolvedPath, definitive);
+    if (definitive) {
+        store(key, fingerprint, info);
+    }
+    return info;
+}
+
+/**
+ * @brief 清除缓存的探测结果
+ */
+void ToolRegistry::invalidate()
+{
+    QMutexLocker locker(&s_registryMutex);
+    s_records.clear();
+
+    QSettings settings;
+    settings.remove("ToolRegistry");
+}
+
+/**
+ * @brief 将程序名解析为可执行文件的绝对路径
+ * @param program 程序名或路径
+ * @return 绝对路径
+ */
+QString ToolRegistry::resolveExecutable(const QString &program)
+{
+    if (program.isEmpty()) {
+        return QString();
+    }
+
+    // 带目录的路径直接检查文件，否则按PATH查找
+    if (program.contains('/') || program.contains('\\')) {
+        QFileInfo fileInfo(program);
+        return fileInfo.isFile() ? fileInfo.absoluteFilePath() : QString();
+    }
+    return QStandardPaths::findExecutable(program);
+}
+
+/**
+ * @brief 生成可执行文件的指纹
+ * @param resolvedPath 可执行文件路径
+ * @return 指纹字符串
+ */
+QString ToolRegistry::fileFingerprint(const QString &resolvedPath)
+{
+    // 通过符号链接安装的程序以实际文件为准，升级后链接目标会改变
+    QFileInfo fileInfo(resolvedPath);
+    QString target = fileInfo.canonicalFilePath();
+    QFileInfo targetInfo(target.isEmpty() ? resolvedPath : target);
+
+    return QString("%1:%2:%3")
+        .arg(targetInfo.absoluteFilePath())
+        .arg(targetInfo.size())
+        .arg(targetInfo.lastModified().toMSecsSinceEpoch());
+}
+
+/**
+ * @brief 生成tessdata目录中模型文件列表的指纹
+ * @param tessDataDir tessdata目录
+ * @return 指纹字符串
+ */
+QString ToolRegistry::tessDataFingerprint(const QString &tessDataDir)
+{
+    if (tessDataDir.isEmpty()) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const QFileInfoList models = QDir(tessDataDir).entryInfoList(QStringList() << "*.traineddata",
+                                                                 QDir::Files, QDir::Name);
+    for (const QFileInfo &model : models) {
+        hash.addData(QString("%1:%2:%3;")
+                         .arg(model.fileName())
+                         .arg(model.size())
+                         .arg(model.lastModified().toMSecsSinceEpoch())
+                         .toUtf8());
+    }
+    return hash.result().toHex();
+}
+
+/**
+ * @brief 查找缓存的探测结果
+ * @param key 工具键
+ * @param info 找到时写入的探测结果
+ * @param fingerprint 找到时写入记录对应的指纹
+ * @return 是否找到记录
+ */
+bool ToolRegistry::lookup(const QString &key, ToolInfo &info, QString &fingerprint)
+{
+    QMutexLocker locker(&s_registryMutex);
+
+    auto it = s_records.constFind(key);
+    if (it != s_records.constEnd()) {
+        info = it->info;
+        fingerprint = it->fingerprint;
+        return true;
+    }
+
+    // 内存中没有时从上次运行保存的记录中加载
+    QSettings settings;
+    settings.beginGroup(settingsGroup(key));
+    if (settings.value("key").toString() != key) {
+        return false;
+    }
+
+    ToolRecord record;
+    record.fingerprint = settings.value("fingerprint").toString();
+    record.info.resolvedPath = settings.value("resolvedPath").toString();
+    record.info.available = settings.value("available", false).toBool();
+    record.info.version = settings.value("version").toString();
+    record.info.languages = settings.value("languages").toStringList();
+    record.info.tessDataDir = settings.value("tessDataDir").toString();
+    record.info.capabilities = settings.value("capabilities").toStringList();
+    settings.endGroup();
+
+    s_records.insert(key, record);
+    info = record.info;
+    fingerprint = record.fingerprint;
+    return true;
+}
+
+/**
+ * @brief 保存探测结果
+ * @param key 工具键
+ * @param fingerprint 当前指纹
+ * @param info 探测结果
+ */
+void ToolRegistry::store(const QString &key, const QString &fingerprint, const ToolInfo &info)
+{
+    QMutexLocker locker(&s_registryMutex);
+
+    ToolRecord record;
+    record.fingerprint = fingerprint;
+    record.info = info;
+    s_records.insert(key, record);
+
+    QSettings settings;
+    settings.beginGroup(settingsGroup(key));
+    settings.setValue("key", key);
+    settings.setValue("fingerprint", fingerprint);
+    settings.setValue("resolvedPath", info.resolvedPath);
+    settings.setValue("available", info.available);
+    settings.setValue("version", info.version);
+    settings.setValue("languages", info.languages);
+    settings.setValue("tessDataDir", info.tessDataDir);
+    settings.setValue("capabilities", info.capabilities);
+    settings.endGroup();
+}
+
+/**
+ * @brief 启动tesseract探测进程获取版本、能力和语言列表
+ */
+ToolRegistry::ToolInfo ToolRegistry::probeTesseract(const QString &program, const QString &resolvedPath,
+                                                    const QString &tessDataDir,
+                                                    const ProcessConfigurator &configurator,
+                                                    bool &definitive)
+{
+    ToolInfo info;
+    info.program = program;
+    info.resolvedPath = resolvedPath;
+
+    // 版本信息：第一行为版本号，"Found AVX2"等行列出可用的SIMD指令集
+    QProcess versionProcess;
+    if (configurator) {
+        configurator(&versionProcess);
+    }
+    bool finished = false;
+    const QString versionOutput = runProbe(versionProcess, program, QStringList() << "--version", finished);
+    definitive = finished || versionProcess.error() == QProcess::FailedToStart;
+    if (!finished || versionProcess.exitCode() != 0) {
+        qDebug() << "Tesseract不可用:" << versionProcess.errorString();
+        return info;
+    }
+
+    const QStringList versionLines = versionOutput.split('\n', Qt::SkipEmptyParts);
+    if (!versionLines.isEmpty()) {
+        info.version = versionLines.first().trimmed();
+    }
+    for (const QString &line : versionLines) {
+        QString trimmed = line.trimmed();
+        if (trimmed.startsWith("Found ")) {
+            info.capabilities << trimmed.mid(6).section(' ', 0, 0);
+        }
+    }
+    info.available = true;
+
+    // 语言列表，第一行形如：List of available languages in "/usr/share/tessdata/" (3):
+    QProcess languageProcess;
+    if (configurator) {
+        configurator(&languageProcess);
+    }
+    QStringList arguments;
+    if (!tessDataDir.isEmpty()) {
+        arguments << "--tessdata-dir" << tessDataDir;
+    }
+    arguments << "--list-langs";
+    const QString languageOutput = runProbe(languageProcess, program, arguments, finished);
+    if (!finished) {
+        definitive = false;
+        return info;
+    }
+
+    const QStringList languageLines = languageOutput.split('\n', Qt::SkipEmptyParts);
+    for (int i = 0; i < languageLines.size(); ++i) {
+        QString line = languageLines[i].trimmed();
+        if (line.startsWith("List of available languages")) {
+            int begin = line.indexOf('"');
+            int end = line.lastIndexOf('"');
+            if (begin >= 0 && end > begin) {
+                info.tessDataDir = QDir(line.mid(begin + 1, end - begin - 1)).absolutePath();
+            }
+        } else if (!line.isEmpty() && !line.contains(' ')) {
+            info.languages << line;
+        }
+    }
+
+    qDebug() << "已探测Tesseract:" << info.version << "语言数:" << info.languages.size();
+    return info;
+}
+
+/**
+ * @brief 启动pdftoppm探测进程获取版本和命令行选项
+ */
+ToolRegistry::ToolInfo ToolRegistry::probePdftoppm(const QString &program, const QString &resolvedPath,
+                                                   bool &definitive)
+{
+    ToolInfo info;
+    info.program = program;
+    info.resolvedPath = resolvedPath;
+
+    QProcess process;
+    bool finished = false;
+    const QString output = runProbe(process, program, QStringList() << "-h", finished);
+    definitive = finished || process.error() == QProcess::FailedToStart;
+    if (!finished || process.exitCode() != 0) {
+        qDebug() << "Poppler不可用:" << process.errorString();
+        qDebug() << "错误输出:" << output;
+        return info;
+    }
+
+    // 第一行为版本信息，之后每个以"-"开头的行列出一个命令行选项
+    const QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    if (!lines.isEmpty()) {
+        info.version = lines.first().trimmed();
+    }
+    for (const QString &line : lines) {
+        QString trimmed = line.trimmed();
+        if (trimmed.startsWith('-')) {
+            info.capabilities << trimmed.section(' ', 0, 0);
+        }
+    }
+    info.available = true;
+
+    qDebug() << "已探测Poppler:" << info.version;
+    return info;
+}
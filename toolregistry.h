@@ -0,0 +1,128 @@
+#ifndef TOOLREGISTRY_H
+#define TOOLREGISTRY_H
+
+#include <QString>
+#include <QStringList>
+#include <QProcess>
+#include <functional>
+
+/**
+ * @brief 外部命令行工具（tesseract、pdftoppm）的能力信息缓存
+ *
+ * 每个可执行文件只在首次使用或发生变化时启动一次探测进程，获取版本、
+ * 支持的语言和命令行选项等信息，结果保存在QSettings中，程序重启后仍然有效。
+ * 之后的查询只比较可执行文件的路径、大小、修改时间（以及tessdata目录的
+ * 模型文件列表）是否变化，不再启动任何进程。
+ *
+ * 所有接口都是线程安全的。
+ */
+class ToolRegistry
+{
+public:
+    /**
+     * @brief 进程配置回调，用于在探测前设置工作目录和环境变量
+     */
+    using ProcessConfigurator = std::function<void(QProcess *process)>;
+
+    /**
+     * @brief 工具探测结果
+     */
+    struct ToolInfo {
+        QString program;            // 调用时使用的程序名或路径
+        QString resolvedPath;       // 实际的可执行文件路径
+        bool available;             // 是否可用
+        QString version;            // 版本信息（输出的第一行）
+        QStringList languages;      // 支持的语言（仅tesseract）
+        QString tessDataDir;        // tesseract报告的tessdata目录（仅tesseract）
+        QStringList capabilities;   // 能力列表（tesseract的SIMD支持、pdftoppm的命令行选项等）
+
+        ToolInfo() : available(false) {}
+
+        /**
+         * @brief 是否具备指定能力
+         * @param capability 能力名称（如"-png"、"AVX2"）
+         * @return 是否具备
+         */
+        bool hasCapability(const QString &capability) const
+        {
+            return capabilities.contains(capability);
+        }
+    };
+
+    /**
+     * @brief 获取tesseract的能力信息
+     * @param program tesseract程序名或路径
+     * @param tessDataDir 显式指定的tessdata目录（为空表示使用tesseract默认目录）
+     * @param configurator 探测进程的配置回调（可为空）
+     * @return 能力信息
+     */
+    static ToolInfo tesseract(const QString &program, const QString &tessDataDir = QString(),
+                              const ProcessConfigurator &configurator = ProcessConfigurator());
+
+    /**
+     * @brief 获取pdftoppm的能力信息
+     * @param program pdftoppm程序名或路径
+     * @return 能力信息
+     */
+    static ToolInfo pdftoppm(const QString &program);
+
+    /**
+     * @brief 清除缓存的探测结果，下次查询时重新探测
+     */
+    static void invalidate();
+
+private:
+    /**
+     * @brief 将程序名解析为可执行文件的绝对路径（在PATH中查找，不启动进程）
+     * @param program 程序名或路径
+     * @return 绝对路径，找不到时返回空字符串
+     */
+    static QString resolveExecutable(const QString &program);
+
+    /**
+     * @brief 生成可执行文件的指纹（路径、大小、修改时间）
+     * @param resolvedPath 可执行文件路径
+     * @return 指纹字符串
+     */
+    static QString fileFingerprint(const QString &resolvedPath);
+
+    /**
+     * @brief 生成tessdata目录中模型文件列表的指纹
+     * @param tessDataDir tessdata目录
+     * @return 指纹字符串
+     */
+    static QString tessDataFingerprint(const QString &tessDataDir);
+
+    /**
+     * @brief 查找缓存的探测结果（先查内存，再查QSettings）
+     * @param key 工具键
+     * @param info 找到时写入的探测结果
+     * @param fingerprint 找到时写入记录对应的指纹，由调用方与当前指纹比较
+     * @return 是否找到记录
+     */
+    static bool lookup(const QString &key, ToolInfo &info, QString &fingerprint);
+
+    /**
+     * @brief 保存探测结果
+     * @param key 工具键
+     * @param fingerprint 当前指纹
+     * @param info 探测结果
+     */
+    static void store(const QString &key, const QString &fingerprint, const ToolInfo &info);
+
+    /**
+     * @brief 启动tesseract探测进程获取版本、能力和语言列表
+     * @param definitive 返回探测结果是否可靠（进程超时等临时失败不应被持久化）
+     */
+    static ToolInfo probeTesseract(const QString &program, const QString &resolvedPath,
+                                   const QString &tessDataDir, const ProcessConfigurator &configurator,
+                                   bool &definitive);
+
+    /**
+     * @brief 启动pdftoppm探测进程获取版本和命令行选项
+     * @param definitive 返回探测结果是否可靠
+     */
+    static ToolInfo probePdftoppm(const QString &program, const QString &resolvedPath, bool &definitive);
+};
+
+#endif // TOOLREGISTRY_H